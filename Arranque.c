@@ -0,0 +1,137 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Arranque.c
+  * @author  MCD Application Team
+  * @brief   Fichero de medida de las fases del arranque y de conservacion del
+	*					 estado del LED en los registros de backup.
+	*
+	*					 La frecuencia del sistema cambia durante el arranque (HSI hasta
+	*					 SystemClock_Config, PLL despues), por lo que cada fase se pasa a
+	*					 microsegundos con la frecuencia que habia al empezar. El tiempo
+	*					 anterior a main (SystemInit y la inicializacion de las variables)
+	*					 no se mide ya que el contador de ciclos aun no esta en marcha.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Arranque.h"
+#include "USART.h"
+#include "Watchdog.h"
+
+/*Marca de validez del estado guardado en ARRANQUE_BKP_LED (bits 31..24)*/
+#define MARCA_LED  0xA7U
+
+/*Duracion de cada fase y marca y frecuencia del final de la fase anterior*/
+static uint32_t duracion_us[ARRANQUE_NUM_FASES];
+static uint32_t previo;
+static uint32_t hz_previo;
+
+#define ARRANQUE_NOMBRE_FASE(nombre)	#nombre,
+static const char * const nombres[ARRANQUE_NUM_FASES] = {
+	ARRANQUE_FASES(ARRANQUE_NOMBRE_FASE)
+};
+
+/**
+  * @brief Funcion que arranca el contador de ciclos y toma la marca de inicio. Es
+	*				 lo primero que se ejecuta en main.
+	* @param None
+  * @retval None
+  */
+void init_Arranque (void){
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	previo = DWT->CYCCNT;
+	hz_previo = SystemCoreClock;
+}
+
+/**
+  * @brief Funcion que cierra una fase del arranque
+	* @param fase: Fase que termina
+  * @retval None
+  */
+void marca_Arranque (Arranque_Fase fase){
+	uint32_t ahora = DWT->CYCCNT;
+
+	duracion_us[fase] = (ahora - previo) / (hz_previo / 1000000U);
+	previo = ahora;
+	hz_previo = SystemCoreClock;
+}
+
+/**
+  * @brief Prueba de regresion del tiempo de arranque: envia por la USART la duracion
+	*				 de cada fase y el tiempo hasta la primera luz frente al presupuesto. Se
+	*				 llama al terminar el arranque, con la USART ya inicializada.
+	* @param None
+  * @retval 0 si la primera luz llega dentro del presupuesto, -1 en caso contrario
+  */
+int comprobar_Arranque (void){
+	char buf[80];
+	int size;
+	uint32_t acumulado = 0, primera_luz = 0;
+
+	for (int f = 0; f < ARRANQUE_NUM_FASES; f++){
+		acumulado += duracion_us[f];
+		if (f == ARRANQUE_PRIMERA_LUZ)
+			primera_luz = acumulado;
+		size = sprintf(buf, "\r Arranque %-8s %6u us (total %6u us)\n", nombres[f],
+									 (unsigned)duracion_us[f], (unsigned)acumulado);
+		tx_USART(buf, size);
+		reset_Watchdog();
+	}
+	size = sprintf(buf, "\r Primera luz: %u us de %u us: %s\n", (unsigned)primera_luz,
+								 (unsigned)ARRANQUE_PRESUPUESTO_US, (primera_luz <= ARRANQUE_PRESUPUESTO_US) ? "OK" : "FALLO");
+	tx_USART(buf, size);
+	return (primera_luz <= ARRANQUE_PRESUPUESTO_US) ? 0 : -1;
+}
+
+/**
+  * @brief Funcion que repite el informe del arranque (comando del terminal)
+	* @param None
+  * @retval None
+  */
+void informe_Arranque (void){
+	(void)comprobar_Arranque();
+}
+
+/**
+  * @brief Funcion que guarda el estado de la maquina del LED en los registros de
+	*				 backup. Solo se escriben si han cambiado.
+	* @param c: Maquina de estados
+  * @retval None
+  */
+void guardar_Arranque (const Control *c){
+	uint32_t led = (MARCA_LED << 24) | ((uint32_t)c->estado << 20) | ((uint32_t)c->color << 16) |
+								 ((uint32_t)c->intensidad & 0xFFFFU);
+
+	if (led != ARRANQUE_BKP_LED || c->tono != ARRANQUE_BKP_TONO){
+		HAL_PWR_EnableBkUpAccess();
+		ARRANQUE_BKP_LED = led;
+		ARRANQUE_BKP_TONO = c->tono;
+	}
+}
+
+/**
+  * @brief Funcion que recupera el estado de la maquina del LED guardado antes del
+	*				 reset. Tras un arranque en frio los registros de backup estan a cero
+	*				 y no hay estado que recuperar.
+	* @param c: Maquina de estados ya inicializada
+  * @retval 0 si se ha recuperado el estado, -1 si no habia un estado valido
+  */
+int restaurar_Arranque (Control *c){
+	uint32_t led = ARRANQUE_BKP_LED;
+	uint32_t estado = (led >> 20) & 0xFU;
+	uint32_t color = (led >> 16) & 0xFU;
+
+	if ((led >> 24) != MARCA_LED || estado >= NUM_ESTADOS || color >= NUM_LEDS)
+		return -1;
+	c->estado = (Control_Estado)estado;
+	c->color = (uint8_t)color;
+	c->intensidad = (int)(led & 0xFFFFU);
+	c->tono = (uint16_t)ARRANQUE_BKP_TONO;
+	return 0;
+}
@@ -0,0 +1,63 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Arranque.h
+  * @author  MCD Application Team
+  * @brief   Libreria de arranque rapido. Se mide con el contador de ciclos DWT
+	*					 la duracion de cada fase de la inicializacion, desde la entrada en
+	*					 main hasta que la USART esta disponible, y se comprueba que el LED
+	*					 muestra su ultimo estado antes de ARRANQUE_PRESUPUESTO_US.
+	*
+	*					 El ultimo estado de la maquina del LED se conserva en registros de
+	*					 backup del RTC, de forma que tras un reset se restaura nada mas
+	*					 inicializar los Timers, antes incluso de arrancar el PLL.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __ARRANQUE_H
+#define __ARRANQUE_H
+
+#include "stm32f4xx_hal.h"
+#include "Control.h"
+
+/*Tiempo maximo desde la entrada en main hasta la primera luz del LED*/
+#define ARRANQUE_PRESUPUESTO_US  5000U
+
+/*Registros de backup del RTC con el estado del LED (BKP0R - BKP2R son del IWDG)*/
+#define ARRANQUE_BKP_LED   (RTC->BKP3R)
+#define ARRANQUE_BKP_TONO  (RTC->BKP4R)
+
+/*Fases del arranque en orden de ejecucion: FASE(nombre). Cada una termina con
+	marca_Arranque(ARRANQUE_nombre)*/
+#define ARRANQUE_FASES(FASE) \
+	FASE(HAL)      \
+	FASE(LED)      \
+	FASE(RELOJ)    \
+	FASE(WATCHDOG) \
+	FASE(GPIO)     \
+	FASE(REPOSO)   \
+	FASE(NUCLEO)   \
+	FASE(USART)
+
+#define ARRANQUE_ENUM_FASE(nombre)	ARRANQUE_##nombre,
+typedef enum {
+	ARRANQUE_FASES(ARRANQUE_ENUM_FASE)
+	ARRANQUE_NUM_FASES
+} Arranque_Fase;
+
+/*Fase tras la que el LED muestra su ultimo estado*/
+#define ARRANQUE_PRIMERA_LUZ  ARRANQUE_LED
+
+void init_Arranque (void);
+void marca_Arranque (Arranque_Fase fase);
+int comprobar_Arranque (void);
+void informe_Arranque (void);
+void guardar_Arranque (const Control *c);
+int restaurar_Arranque (Control *c);
+
+#endif /* __ARRANQUE_H */
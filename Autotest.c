@@ -0,0 +1,302 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Autotest.c
+  * @author  MCD Application Team
+  * @brief   Fichero del autotest de la PWM del LED RGB por captura (Autotest.h).
+	*
+	*					 El TIM3 funciona en modo PWM input: el flanco de subida del canal 1
+	*					 captura el periodo en el CCR1 y reinicia el contador, y el de bajada
+	*					 captura el tiempo en alto en el CCR2. Cada captura del CCR1 pide una
+	*					 rafaga de DMA que copia los dos registros en el buffer circular
+	*					 (DMA1 Stream4 canal 5), sin interrupciones.
+	*
+	*					 Solo se mide un color cada vez: los pines de captura comparten el
+	*					 canal 1 del TIM3, por lo que el resto quedan como entrada. Una
+	*					 medida se descarta si el canal esta apagado, si el ciclo de trabajo
+	*					 esta en los extremos o si el CCR cambia durante la medida (efectos),
+	*					 ya que entonces el buffer mezcla dos ciclos de trabajo. Sin ninguna
+	*					 captura (puente suelto o pin sin senal) la desviacion es total.
+	*
+	*					 El coste en la CPU es el promedio de AUTOTEST_MUESTRAS capturas cada
+	*					 AUTOTEST_PERIODO_MS en el hilo de salida.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Autotest.h"
+
+#if AUTOTEST_ENABLE
+
+#include "stdio.h"
+#include "string.h"
+#include "cmsis_os2.h"
+#include "Placa.h"
+#include "RGB.h"
+#include "Reloj.h"
+#include "USART.h"
+#include "Watchdog.h"
+#include "Metricas.h"
+#include "Traza.h"
+
+/*Periodo de la PWM del LED en cuentas del TIM3*/
+#define PERIODO_PWM  ((uint32_t)((RGB_ARR + 1ULL) * AUTOTEST_HZ / RELOJ_TICK_HZ))
+
+typedef struct {
+	Color color;
+	GPIO_TypeDef *Port;
+	uint16_t Pin;
+} Captura;
+
+typedef struct {
+	uint32_t medidas;					/*Medidas comparadas con el valor ordenado*/
+	uint32_t omitidas;				/*Medidas descartadas (apagado, extremos o CCR cambiado)*/
+	uint32_t fallos;					/*Medidas fuera del umbral*/
+	uint32_t seguidos;				/*Fallos seguidos*/
+	uint32_t periodo;					/*Ultima medida en cuentas del TIM3 (0: sin capturas)*/
+	uint32_t alto;
+	uint32_t ccr;							/*CCR ordenado durante la ultima medida*/
+	uint32_t desviacion;			/*Tanto por mil de la ultima medida*/
+	uint8_t alarma;
+} Estado;
+
+TIM_HandleTypeDef htim3;
+DMA_HandleTypeDef hdma_tim3_ch1;
+
+/*Tabla de pines de captura generada a partir de la descripcion de la placa*/
+#define AUTOTEST_CAPTURA(color, puerto, pin)	{LED_##color, puerto, (uint16_t)(1U << (pin))},
+static const Captura capturas[] = {
+	PLACA_AUTOTEST(AUTOTEST_CAPTURA)
+};
+
+#define NUM_CAPTURAS (sizeof(capturas) / sizeof(capturas[0]))
+
+#define AUTOTEST_NOMBRE(color, puerto, pin, tim, canal, af)	#color,
+static const char * const nombres[NUM_LEDS] = {
+	PLACA_LEDS(AUTOTEST_NOMBRE)
+};
+
+/*Pares periodo, tiempo en alto que el DMA copia desde TIM3->DMAR*/
+static uint32_t muestras[AUTOTEST_MUESTRAS][2];
+static Estado estados[NUM_CAPTURAS];
+static uint32_t actual = 0;
+static uint32_t siguiente_ms;
+static uint8_t iniciado = 0;
+/*Estado del canal al empezar la medida en curso*/
+static uint32_t ccr_inicio;
+static int activo_inicio;
+
+/**
+  * @brief Funcion que indica si la salida PWM de un color esta habilitada
+	* @param c: Color
+  * @retval 1 si esta habilitada, 0 en caso contrario
+  */
+static int activo (Color c){
+	return (rgb_leds[c].htim->Instance->CCER & (TIM_CCER_CC1E << rgb_leds[c].Canal)) != 0U;
+}
+
+/**
+  * @brief Funcion que conecta el TIM3 al pin de captura indicado y empieza una
+	*				 medida. Las capturas del color anterior que quedan en el buffer se
+	*				 sobrescriben en los AUTOTEST_MUESTRAS primeros periodos.
+	* @param i: Indice en la tabla de capturas
+  * @retval None
+  */
+static void seleccionar (uint32_t i){
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	GPIO_InitStruct.Pin = capturas[actual].Pin;
+	GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	HAL_GPIO_Init(capturas[actual].Port, &GPIO_InitStruct);
+
+	GPIO_InitStruct.Pin = capturas[i].Pin;
+	GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	GPIO_InitStruct.Alternate = PLACA_AUTOTEST_AF;
+	HAL_GPIO_Init(capturas[i].Port, &GPIO_InitStruct);
+
+	/*El reloj del TIM3 cambia con el nivel de reloj (Reloj.h)*/
+	htim3.Instance->PSC = timer_Reloj(TIM3) / AUTOTEST_HZ - 1U;
+	memset(muestras, 0, sizeof(muestras));
+	actual = i;
+	ccr_inicio = *rgb_leds[capturas[i].color].CCR;
+	activo_inicio = activo(capturas[i].color);
+}
+
+/**
+  * @brief Funcion que configura el TIM3 en modo PWM input y arranca la copia de
+	*				 las capturas por DMA. Si falla, el autotest queda desactivado.
+	* @param None
+  * @retval None
+  */
+void init_Autotest (void){
+	TIM_IC_InitTypeDef sConfigIC = {0};
+	TIM_SlaveConfigTypeDef sSlaveConfig = {0};
+
+	for (uint32_t i = 0; i < NUM_CAPTURAS; i++)
+		PLACA_GPIO_CLK_ENABLE(capturas[i].Port);
+
+	htim3.Instance = TIM3;
+	htim3.Init.Prescaler = timer_Reloj(TIM3) / AUTOTEST_HZ - 1U;
+	htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim3.Init.Period = 0xFFFF;
+	htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if (HAL_TIM_IC_Init(&htim3) != HAL_OK)
+		return;
+
+	/*Canal 1: flanco de subida (periodo). Canal 2: flanco de bajada de la misma
+		entrada (tiempo en alto)*/
+	sConfigIC.ICPolarity = TIM_INPUTCHANNELPOLARITY_RISING;
+	sConfigIC.ICSelection = TIM_ICSELECTION_DIRECTTI;
+	sConfigIC.ICPrescaler = TIM_ICPSC_DIV1;
+	sConfigIC.ICFilter = 0;
+	if (HAL_TIM_IC_ConfigChannel(&htim3, &sConfigIC, TIM_CHANNEL_1) != HAL_OK)
+		return;
+	sConfigIC.ICPolarity = TIM_INPUTCHANNELPOLARITY_FALLING;
+	sConfigIC.ICSelection = TIM_ICSELECTION_INDIRECTTI;
+	if (HAL_TIM_IC_ConfigChannel(&htim3, &sConfigIC, TIM_CHANNEL_2) != HAL_OK)
+		return;
+
+	/*El flanco de subida reinicia el contador*/
+	sSlaveConfig.SlaveMode = TIM_SLAVEMODE_RESET;
+	sSlaveConfig.InputTrigger = TIM_TS_TI1FP1;
+	sSlaveConfig.TriggerPolarity = TIM_TRIGGERPOLARITY_RISING;
+	sSlaveConfig.TriggerPrescaler = TIM_TRIGGERPRESCALER_DIV1;
+	sSlaveConfig.TriggerFilter = 0;
+	if (HAL_TIM_SlaveConfigSynchro(&htim3, &sSlaveConfig) != HAL_OK)
+		return;
+
+	seleccionar(0);
+	if (HAL_TIM_IC_Start(&htim3, TIM_CHANNEL_2) != HAL_OK ||
+			HAL_TIM_IC_Start(&htim3, TIM_CHANNEL_1) != HAL_OK ||
+			HAL_TIM_DMABurst_MultiReadStart(&htim3, TIM_DMABASE_CCR1, TIM_DMA_CC1, &muestras[0][0],
+																			TIM_DMABURSTLENGTH_2TRANSFERS, 2U * AUTOTEST_MUESTRAS) != HAL_OK)
+		return;
+	siguiente_ms = osKernelGetTickCount() + AUTOTEST_PERIODO_MS;
+	iniciado = 1;
+}
+
+/**
+  * @brief Funcion que compara la medida en curso con los valores ordenados
+	* @param e: Estado del color medido
+	* @param c: Color medido
+  * @retval None
+  */
+static void comprobar (Estado *e, Color c){
+	uint32_t ccr = *rgb_leds[c].CCR;
+	uint32_t n = 0, periodo = 0, alto = 0;
+	uint32_t esperado, desviacion, d;
+	char buf[100];
+	int size;
+
+	if (!activo_inicio || !activo(c) || ccr != ccr_inicio || ccr < AUTOTEST_CCR_MIN || ccr > AUTOTEST_CCR_MAX ||
+			timer_Reloj(TIM3) / (htim3.Instance->PSC + 1U) != AUTOTEST_HZ){
+		e->omitidas++;
+		return;
+	}
+	for (uint32_t i = 0; i < AUTOTEST_MUESTRAS; i++){
+		if (muestras[i][0] != 0U){
+			periodo += muestras[i][0];
+			alto += muestras[i][1];
+			n++;
+		}
+	}
+
+	/*Desviacion del periodo respecto a si mismo y del tiempo en alto respecto al
+		periodo (ciclo de trabajo), la mayor de las dos*/
+	esperado = (uint32_t)((uint64_t)ccr * AUTOTEST_HZ / RELOJ_TICK_HZ);
+	if (n == 0U){
+		e->periodo = e->alto = 0;
+		desviacion = 1000U;
+	}
+	else {
+		e->periodo = periodo / n;
+		e->alto = alto / n;
+		desviacion = (e->periodo > PERIODO_PWM) ? e->periodo - PERIODO_PWM : PERIODO_PWM - e->periodo;
+		desviacion = desviacion * 1000U / PERIODO_PWM;
+		d = (e->alto > esperado) ? e->alto - esperado : esperado - e->alto;
+		d = d * 1000U / PERIODO_PWM;
+		desviacion = (d > desviacion) ? d : desviacion;
+	}
+	e->ccr = ccr;
+	e->desviacion = desviacion;
+	e->medidas++;
+
+	if (desviacion <= AUTOTEST_UMBRAL_PERMIL){
+		e->seguidos = 0;
+		if (e->alarma){
+			e->alarma = 0;
+			size = sprintf(buf, "\r Autotest: LED %s correcto\n", nombres[c]);
+			tx_USART(buf, size);
+		}
+		return;
+	}
+	e->fallos++;
+	if (++e->seguidos == AUTOTEST_FALLOS_ALARMA){
+		e->alarma = 1;
+		METRICA_CONTAR(autotest_alarmas);
+		TRAZA_EVENTO(TRAZA_AUTOTEST, c, desviacion);
+		size = sprintf(buf, "\r Autotest: ALARMA LED %s, desviacion %u permil\n", nombres[c], (unsigned)desviacion);
+		tx_USART(buf, size);
+	}
+}
+
+/**
+  * @brief Funcion que se llama desde el bucle del hilo de salida: cada
+	*				 AUTOTEST_PERIODO_MS comprueba el color medido y pasa al siguiente
+	* @param None
+  * @retval None
+  */
+void periodico_Autotest (void){
+	if (!iniciado || (int32_t)(osKernelGetTickCount() - siguiente_ms) < 0)
+		return;
+	siguiente_ms += AUTOTEST_PERIODO_MS;
+	comprobar(&estados[actual], capturas[actual].color);
+	seleccionar((actual + 1U) % NUM_CAPTURAS);
+}
+
+/**
+  * @brief Funcion que envia por la USART el resultado del autotest de cada color:
+	*				 medidas, frecuencia y ciclo de trabajo medidos frente a los ordenados
+	* @param None
+  * @retval None
+  */
+void informe_Autotest (void){
+	char buf[120];
+	int size;
+	const Estado *e;
+
+	if (!iniciado){
+		size = sprintf(buf, "\r Autotest: no iniciado\n");
+		tx_USART(buf, size);
+		return;
+	}
+	size = sprintf(buf, "\r Autotest: %ums por color, umbral %u permil, PWM %u.%02uHz\n",
+								 (unsigned)AUTOTEST_PERIODO_MS, (unsigned)AUTOTEST_UMBRAL_PERMIL,
+								 (unsigned)(RELOJ_TICK_HZ / (RGB_ARR + 1U)), (unsigned)(RELOJ_TICK_HZ * 100ULL / (RGB_ARR + 1U) % 100U));
+	tx_USART(buf, size);
+	for (uint32_t i = 0; i < NUM_CAPTURAS; i++){
+		e = &estados[i];
+		size = sprintf(buf, "\r  %-5s %s medidas=%u omitidas=%u fallos=%u",
+									 nombres[capturas[i].color], e->alarma ? "ALARMA" : "OK    ",
+									 (unsigned)e->medidas, (unsigned)e->omitidas, (unsigned)e->fallos);
+		tx_USART(buf, size);
+		if (e->periodo != 0U)
+			size = sprintf(buf, " f=%u.%02uHz ciclo=%u (%u) permil desv=%u\n",
+										 (unsigned)(AUTOTEST_HZ / e->periodo), (unsigned)(AUTOTEST_HZ * 100ULL / e->periodo % 100U),
+										 (unsigned)(e->alto * 1000U / e->periodo), (unsigned)(e->ccr * 1000U / (RGB_ARR + 1U)),
+										 (unsigned)e->desviacion);
+		else
+			size = sprintf(buf, (e->medidas != 0U) ? " sin senal\n" : "\n");
+		tx_USART(buf, size);
+		reset_Watchdog();
+	}
+}
+
+#endif
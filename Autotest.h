@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Autotest.h
+  * @author  MCD Application Team
+  * @brief   Libreria de autotest de la PWM del LED RGB. Con un puente entre el pin
+	*					 de cada color y su pin de captura (PLACA_AUTOTEST), el TIM3 en modo
+	*					 PWM input mide el periodo y el tiempo en alto de la senal que
+	*					 realmente sale por el pin y los compara con los valores ordenados:
+	*
+	*						periodo = (RGB_ARR+1)/RELOJ_TICK_HZ		alto = CCR/RELOJ_TICK_HZ
+	*
+	*					 Las capturas las copia el DMA en un buffer circular, por lo que la
+	*					 medida no usa la CPU. El hilo de salida comprueba un color cada
+	*					 AUTOTEST_PERIODO_MS promediando el buffer y pasa el TIM3 al pin del
+	*					 siguiente. Si la desviacion de la frecuencia o del ciclo de trabajo
+	*					 supera AUTOTEST_UMBRAL_PERMIL en AUTOTEST_FALLOS_ALARMA comprobaciones
+	*					 seguidas, se envia un aviso por la USART y se cuenta en las metricas.
+	*
+	*					 Requiere los puentes, por lo que por defecto no se compila
+	*					 (AUTOTEST_ENABLE a 0).
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __AUTOTEST_H
+#define __AUTOTEST_H
+
+#include "stm32f4xx_hal.h"
+
+/*Habilitacion del autotest (requiere los puentes de PLACA_AUTOTEST)*/
+#ifndef AUTOTEST_ENABLE
+#define AUTOTEST_ENABLE 0
+#endif
+
+/*Frecuencia de cuenta del TIM3: el periodo de la PWM (256 us) son 2048 cuentas*/
+#define AUTOTEST_HZ               8000000U
+/*Tiempo de medida de cada color, al menos AUTOTEST_MUESTRAS + 1 periodos*/
+#define AUTOTEST_PERIODO_MS       200U
+/*Capturas (periodo y tiempo en alto) del buffer del DMA*/
+#define AUTOTEST_MUESTRAS         8U
+/*Desviacion maxima de la frecuencia y del ciclo de trabajo (tanto por mil)*/
+#define AUTOTEST_UMBRAL_PERMIL    20U
+/*Comprobaciones fuera del umbral seguidas que disparan la alarma*/
+#define AUTOTEST_FALLOS_ALARMA    2U
+/*Ciclos de trabajo que se comprueban (2% y 98% del periodo de RGB.h): con los
+	extremos no hay flancos que medir*/
+#define AUTOTEST_CCR_MIN          ((RGB_ARR + 1U) / 50U)
+#define AUTOTEST_CCR_MAX          ((RGB_ARR + 1U) * 49U / 50U)
+
+#if AUTOTEST_ENABLE
+
+extern TIM_HandleTypeDef htim3;
+extern DMA_HandleTypeDef hdma_tim3_ch1;
+
+void init_Autotest (void);
+void periodico_Autotest (void);
+void informe_Autotest (void);
+
+#else
+
+#define init_Autotest()           ((void)0)
+#define periodico_Autotest()      ((void)0)
+#define informe_Autotest()        ((void)0)
+
+#endif
+
+#endif /* __AUTOTEST_H */
@@ -0,0 +1,214 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Bench.c
+  * @author  MCD Application Team
+  * @brief   Fichero de micro-benchmarks de las rutinas del camino critico. Cada
+	*					 benchmark repite su rutina las iteraciones indicadas en BENCH_LISTA
+	*					 y se mide el total con el contador de la plataforma.
+	*
+	*					 Las medidas se hacen con el nucleo bloqueado para que ningun hilo
+	*					 interrumpa el bucle ni modifique el LED; las interrupciones siguen
+	*					 activas. El estado del LED, de la linea EXTI del boton medido y
+	*					 del registro de metricas se restaura al terminar, por lo que el
+	*					 comando se puede lanzar con el firmware en uso.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include "Bench.h"
+#include "cmsis_os2.h"
+#include "RGB.h"
+#include "USART.h"
+#include "joystick.h"
+#include "Watchdog.h"
+#include "Metricas.h"
+#include "Traza.h"
+
+/*Boton cuyo rearme se mide*/
+#define BENCH_BOTON  BOTON_CENTER
+
+typedef struct {
+	const char *nombre;
+	void (*iteracion)(uint32_t i);
+	uint32_t iteraciones;
+} Bench;
+
+/*Destino de los resultados que el compilador no puede eliminar*/
+static volatile uint32_t sumidero;
+static char texto[64];
+/*Linea EXTI sin boton con la que se mide el despacho del callback*/
+static uint16_t linea_libre;
+
+static void bench_vacio (uint32_t i){
+	sumidero = i;
+}
+
+static void bench_ccr_intensidad (uint32_t i){
+	intensidad_LED(LED_ROJO, (int)(i & 0xFFFFU));
+}
+
+static void bench_ccr_tono (uint32_t i){
+	tono_LED((uint16_t)(i * 97U), (int)(i & 0xFFFFU));
+}
+
+/*El retorno de carro no avanza la linea del terminal*/
+static void bench_tx_usart_byte (uint32_t i){
+	(void)i;
+	tx_USART("\r", 1);
+}
+
+static void bench_exti_callback (uint32_t i){
+	(void)i;
+	HAL_GPIO_EXTI_Callback(linea_libre);
+}
+
+static void bench_rebote_rearme (uint32_t i){
+	(void)i;
+	IRQ_Fall_Enable(BENCH_BOTON);
+	IRQ_Rise_Enable(BENCH_BOTON);
+}
+
+static void bench_sprintf_cola (uint32_t i){
+	sumidero = (uint32_t)sprintf(texto, "\r %s: capacidad=%u max=%u descartes=%u\n",
+															 "eventos", (unsigned)i, (unsigned)(i >> 1), (unsigned)(i >> 3));
+}
+
+static void bench_metrica_contador (uint32_t i){
+	(void)i;
+	METRICA_CONTAR(flancos);
+}
+
+static void bench_metrica_histograma (uint32_t i){
+	METRICA_HISTOGRAMA(usart_bloqueo_us, i);
+}
+
+/*Los eventos quedan en la traza con su propio identificador*/
+static void bench_traza_evento (uint32_t i){
+	TRAZA_EVENTO(TRAZA_BENCH, i, 0);
+}
+
+#define BENCH_ENTRADA(nombre, iteraciones)	{#nombre, bench_##nombre, iteraciones},
+static const Bench benchs[] = {
+	BENCH_LISTA(BENCH_ENTRADA)
+};
+
+#define NUM_BENCHS (sizeof(benchs) / sizeof(benchs[0]))
+
+/**
+  * @brief Fuentes de tiempo de la placa: contador de ciclos DWT a la frecuencia del
+	*				 sistema. El simulador las sustituye por el reloj del PC.
+  */
+__weak uint32_t bench_Contador (void){
+	return DWT->CYCCNT;
+}
+
+__weak uint32_t bench_Frecuencia (void){
+	return SystemCoreClock;
+}
+
+__weak const char *bench_Plataforma (void){
+	return "stm32f429";
+}
+
+/**
+  * @brief Funcion que ejecuta todos los benchmarks y envia una linea CSV por cada
+	*				 uno, precedidas de la cabecera.
+	* @param enviar: Funcion que envia una linea sin terminador
+  * @retval None
+  */
+void ejecutar_Bench (void (*enviar)(const char *linea)){
+	uint32_t ticks[NUM_BENCHS];
+	uint32_t ccr[NUM_LEDS], activo[NUM_LEDS];
+	uint32_t iteraciones[NUM_BENCHS];
+#if METRICAS_ENABLE
+	uint32_t metricas[MET_NUM_VALORES];
+#endif
+	uint32_t pin = joystick_botones[BENCH_BOTON].Pin;
+	uint32_t mascara = EXTI->IMR & pin;
+	uint32_t frecuencia, inicio;
+	uint64_t ns10, ciclos10;
+	char buf[100];
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	for (linea_libre = 1U; joystick_linea_boton[31U - __CLZ(linea_libre)] != 0U; linea_libre <<= 1)
+		;
+
+	osKernelLock();
+	for (int c = 0; c < NUM_LEDS; c++){
+		ccr[c] = (uint32_t)intensidad_RGB((Color)c);
+		activo[c] = rgb_leds[c].htim->Instance->CCER & (TIM_CCER_CC1E << rgb_leds[c].Canal);
+	}
+#if METRICAS_ENABLE
+	for (uint32_t m = 0; m < MET_NUM_VALORES; m++)
+		metricas[m] = metricas_valores[m];
+#endif
+	frecuencia = bench_Frecuencia();
+	for (uint32_t b = 0; b < NUM_BENCHS; b++){
+		iteraciones[b] = benchs[b].iteraciones;
+		/*El rearme solo se mide con el boton suelto (esperando el flanco de subida)*/
+		if (benchs[b].iteracion == bench_rebote_rearme && (EXTI->RTSR & pin) == 0U)
+			iteraciones[b] = 0;
+		inicio = bench_Contador();
+		for (uint32_t i = 0; i < iteraciones[b]; i++)
+			benchs[b].iteracion(i);
+		ticks[b] = bench_Contador() - inicio;
+	}
+	/*Se restaura el LED y la mascara de la linea del boton*/
+	for (int c = 0; c < NUM_LEDS; c++){
+		if (activo[c] == 0U)
+			apagar_LED((Color)c);
+		intensidad_LED((Color)c, (int)ccr[c]);
+	}
+	if (mascara == 0U)
+		EXTI->IMR &= ~pin;
+	/*Se restauran las metricas: las que actualice una interrupcion durante la
+		medida se pierden*/
+#if METRICAS_ENABLE
+	for (uint32_t m = 0; m < MET_NUM_VALORES; m++)
+		metricas_valores[m] = metricas[m];
+#endif
+	osKernelUnlock();
+
+	enviar(BENCH_CABECERA);
+	for (uint32_t b = 0; b < NUM_BENCHS; b++){
+		ns10 = (iteraciones[b] != 0U) ?
+					 (uint64_t)ticks[b] * 10000000000ULL / ((uint64_t)frecuencia * iteraciones[b]) : 0U;
+		ciclos10 = (iteraciones[b] != 0U && frecuencia == SystemCoreClock) ?
+							 (uint64_t)ticks[b] * 10U / iteraciones[b] : 0U;
+		sprintf(buf, "%s,%s,%u,%u,%u,%u.%u,%u.%u", bench_Plataforma(), benchs[b].nombre,
+						(unsigned)iteraciones[b], (unsigned)ticks[b], (unsigned)frecuencia,
+						(unsigned)(ns10 / 10U), (unsigned)(ns10 % 10U),
+						(unsigned)(ciclos10 / 10U), (unsigned)(ciclos10 % 10U));
+		enviar(buf);
+	}
+}
+
+/**
+  * @brief Funcion que envia una linea CSV por la USART
+	* @param linea: Linea sin terminador
+  * @retval None
+  */
+static void enviar_USART (const char *linea){
+	char buf[100];
+	int size;
+
+	size = sprintf(buf, "%s\r\n", linea);
+	tx_USART(buf, size);
+	reset_Watchdog();
+}
+
+/**
+  * @brief Funcion que ejecuta los benchmarks y envia el resultado por la USART
+	* @param None
+  * @retval None
+  */
+void informe_Bench (void){
+	ejecutar_Bench(enviar_USART);
+}
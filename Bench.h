@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Bench.h
+  * @author  MCD Application Team
+  * @brief   Libreria de micro-benchmarks de las rutinas del camino critico:
+	*					 escritura de los CCR del LED, envio de un byte por la USART,
+	*					 despacho del callback EXTI, rearme de un boton tras el rebote,
+	*					 formateo de mensajes con sprintf, actualizacion de las metricas y
+	*					 registro de un evento de traza.
+	*
+	*					 El mismo codigo se ejecuta en la placa (comando 'B', contador de
+	*					 ciclos DWT CYCCNT) y en el PC (rgb_sim -b, reloj de nanosegundos
+	*					 del sistema). Cada medida se envia como una linea CSV con el
+	*					 esquema BENCH_CABECERA, de forma que los resultados de distintas
+	*					 versiones y plataformas se pueden comparar directamente. Las
+	*					 medidas de referencia estan en Simulacion/referencias.
+	*
+	*					 Las fuentes de tiempo son funciones debiles (bench_Contador,
+	*					 bench_Frecuencia y bench_Plataforma) que el simulador sustituye.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include "stm32f4xx_hal.h"
+
+/*Esquema de las lineas CSV. La fila "vacio" mide el coste del bucle y de la
+	llamada indirecta, que esta incluido en el resto de filas. ciclos_op son los
+	ciclos del nucleo por operacion cuando el contador es el DWT (placa y modo
+	discreto del simulador); con el reloj del PC es 0*/
+#define BENCH_CABECERA "plataforma,bench,iteraciones,ticks,frecuencia_hz,ns_op,ciclos_op"
+
+/*Benchmarks: BENCH(nombre, iteraciones). El envio por la USART tarda cerca de
+	87 us por byte en la placa (1 ms a 9600 baudios), por lo que usa pocas
+	iteraciones*/
+#define BENCH_LISTA(BENCH) \
+	BENCH(vacio,              10000U) \
+	BENCH(ccr_intensidad,     10000U) \
+	BENCH(ccr_tono,           10000U) \
+	BENCH(tx_usart_byte,      16U)    \
+	BENCH(exti_callback,      10000U) \
+	BENCH(rebote_rearme,      1000U)  \
+	BENCH(sprintf_cola,       1000U)  \
+	BENCH(metrica_contador,   10000U) \
+	BENCH(metrica_histograma, 10000U) \
+	BENCH(traza_evento,       10000U)
+
+uint32_t bench_Contador (void);
+uint32_t bench_Frecuencia (void);
+const char *bench_Plataforma (void);
+void ejecutar_Bench (void (*enviar)(const char *linea));
+void informe_Bench (void);
+
+#endif /* __BENCH_H */
@@ -0,0 +1,307 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Comandos.c
+  * @author  MCD Application Team
+  * @brief   Fichero de atencion a los comandos recibidos por el terminal a traves
+	*					 de la USART3. Los comandos disponibles son:
+	*							- 'h': Lista de comandos
+	*							- 'l': Informe de latencias pulsacion->LED
+	*							- 'L': Reset de los histogramas de latencia
+	*							- 'g': Volcado de los flancos grabados
+	*							- 'G': Borrado de los flancos grabados
+	*							- 'C': Carga de flancos en el grabador con las lineas G, de un
+	*								volcado, terminada con una linea con '.'
+	*							- 'r': Reproduccion de los flancos grabados a velocidad real
+	*							- 'R': Reproduccion de los flancos grabados 10 veces mas rapido
+	*							- 'x': Reproduccion de los flancos grabados sin esperas
+	*							- 'b': Medida de eventos por segundo de la maquina de estados del LED
+	*							- 'B': Micro-benchmarks del camino critico en formato CSV
+	*							- 'i': Informe de reposo (tiempo dormido y reanudacion por profundidad)
+	*							- 'z': Cambio de la profundidad maxima de reposo (WFI, Sleep, STOP)
+	*							- 'w': Estado de las tareas supervisadas por el IWDG
+	*							- 'p': Informe de CPU y pila por hilo y de CPU por interrupcion
+	*							- 'P': Activacion del informe de perfil periodico
+	*							- 'q': Ocupacion maxima y descartes de las colas entre hilos
+	*							- 'm': RAM de cada objeto del RTX y total frente al presupuesto
+	*							- 'e': Parpadeo del LED hasta el siguiente evento del usuario
+	*							- 'E': Pulso del LED hasta el siguiente evento del usuario
+	*							- 'j': Efectos activos y retraso del temporizador de efectos
+	*							- 'n': Mapa de prioridades del NVIC y latencia maxima por interrupcion
+	*							- 'k': Tiempo y consumo estimado en cada nivel de reloj
+	*							- 'K': Cambio del nivel de reloj (automatico, ALTO, MEDIO, BAJO)
+	*							- 'a': Duracion de las fases del arranque y tiempo hasta la primera luz
+	*							- 'f': Ultimos fallos registrados y modulos en modo seguro
+	*							- 'M': Volcado binario del registro de metricas (Metricas.h)
+	*							- 'T': Volcado binario del buffer de trazas (Traza.h)
+	*							- 'v': Autotest de la PWM del LED por captura (Autotest.h)
+	*							- 'c': Consumo y temperatura estimados del LED y limitador de brillo
+	*							- 'F': Tramas recibidas, descartadas, perdidas y tardias del flujo de
+	*								color del PC (Flujo.h)
+	*
+	*					 Para anadir un comando basta con incluir una entrada en la tabla
+	*					 de comandos. Durante la carga de flancos los caracteres se agrupan
+	*					 en lineas y no se atienden los comandos hasta la linea con '.'; el
+	*					 resto de lineas del volcado (cabecera) se ignora.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Comandos.h"
+#include "main.h"
+#include "USART.h"
+#include "Latencia.h"
+#include "Grabador.h"
+#include "Control.h"
+#include "Watchdog.h"
+#include "Reposo.h"
+#include "Perfil.h"
+#include "Memoria.h"
+#include "Efectos.h"
+#include "Prioridades.h"
+#include "Reloj.h"
+#include "Arranque.h"
+#include "Fallo.h"
+#include "Bench.h"
+#include "Metricas.h"
+#include "Traza.h"
+#include "Autotest.h"
+#include "Energia.h"
+#include "Flujo.h"
+
+/*Eventos que se despachan en la medida de la maquina de estados*/
+#define BENCH_EVENTOS 100000U
+
+/*Longitud maxima de una linea de la carga de flancos (G,4294967295,4,1)*/
+#define CARGA_LINEA   24U
+
+typedef struct {
+	char letra;
+	void (*funcion)(void);
+	const char *descripcion;
+} Comando;
+
+static void ayuda (void);
+static void reproducir_x1 (void)      { reproducir_Grabador(1); }
+static void reproducir_x10 (void)     { reproducir_Grabador(10); }
+static void reproducir_rafaga (void)  { reproducir_Grabador(GRABADOR_SIN_ESPERA); }
+static void benchmark_Control (void);
+static void cargar_Flancos (void);
+
+/*Carga de flancos en curso: linea recibida y resultado*/
+static struct {
+	uint8_t activa;
+	uint8_t longitud;				/*CARGA_LINEA: linea demasiado larga*/
+	uint32_t cargados;
+	uint32_t errores;
+	char linea[CARGA_LINEA];
+} carga;
+
+static const Comando comandos[] = {
+	{'h', ayuda,            "lista de comandos"},
+#if LATENCIA_ENABLE
+	{'l', informe_Latencia, "informe de latencias"},
+	{'L', reset_Latencia,   "reset de latencias"},
+#endif
+	{'g', volcar_Grabador,   "volcado de flancos grabados"},
+	{'G', borrar_Grabador,   "borrado de flancos grabados"},
+	{'C', cargar_Flancos,    "carga de flancos (lineas G, y '.')"},
+	{'r', reproducir_x1,     "reproduccion a velocidad real"},
+	{'R', reproducir_x10,    "reproduccion x10"},
+	{'x', reproducir_rafaga, "reproduccion sin esperas"},
+	{'b', benchmark_Control, "eventos/s de la maquina de estados"},
+	{'B', informe_Bench,     "micro-benchmarks en CSV"},
+	{'w', informe_Watchdog,  "tareas supervisadas por el IWDG"},
+	{'q', informe_Colas,     "ocupacion de las colas entre hilos"},
+	{'m', informe_Memoria,   "RAM de los objetos del RTX"},
+	{'e', parpadeo_RGB,      "parpadeo del LED"},
+	{'E', pulso_RGB,         "pulso del LED"},
+	{'j', informe_Efectos,   "efectos y retraso del temporizador"},
+	{'n', informe_Prioridades, "prioridades y latencia maxima por IRQ"},
+	{'a', informe_Arranque,  "fases del arranque y primera luz"},
+	{'f', informe_Fallo,     "fallos y modulos en modo seguro"},
+#if METRICAS_ENABLE
+	{'M', volcar_Metricas,   "volcado binario de metricas"},
+#endif
+#if TRAZA_ENABLE && !TRAZA_EVENT_RECORDER
+	{'T', volcar_Traza,      "volcado binario de la traza"},
+#endif
+#if AUTOTEST_ENABLE
+	{'v', informe_Autotest,  "autotest de la PWM por captura"},
+#endif
+#if ENERGIA_ENABLE
+	{'c', informe_Energia,   "consumo y temperatura del LED"},
+#endif
+#if FLUJO_ENABLE
+	{'F', informe_Flujo,     "estadisticas del flujo de color"},
+#endif
+#if REPOSO_ENABLE
+	{'i', informe_Reposo,    "informe de reposo"},
+	{'z', cambiar_Reposo,    "cambio de profundidad de reposo"},
+#endif
+#if RELOJ_ENABLE
+	{'k', informe_Reloj,     "tiempo y consumo por nivel de reloj"},
+	{'K', cambiar_Reloj,     "cambio de nivel de reloj"},
+#endif
+#if PERFIL_ENABLE
+	{'p', informe_Perfil,    "CPU y pila por hilo, CPU por IRQ"},
+	{'P', cambiar_Perfil,    "informe de perfil periodico"},
+#endif
+};
+
+#define NUM_COMANDOS (sizeof(comandos) / sizeof(comandos[0]))
+
+/**
+  * @brief Funcion que envia por la USART la lista de comandos disponibles
+	* @param None
+  * @retval None
+  */
+static void ayuda (void){
+	char buf[100];
+	int size;
+
+	for (unsigned i = 0; i < NUM_COMANDOS; i++){
+		size = sprintf(buf, "\r %c: %s\n", comandos[i].letra, comandos[i].descripcion);
+		tx_USART(buf, size);
+		reset_Watchdog();
+	}
+}
+
+/*Salidas vacias para medir solo el coste del despacho de eventos*/
+static void nulo_encender (Color color, int intensidad) { (void)color; (void)intensidad; }
+static void nulo_apagar (Color color)                    { (void)color; }
+static void nulo_tono (uint16_t tono, int intensidad)    { (void)tono; (void)intensidad; }
+
+static const Control_Salidas salidas_nulas = {
+	nulo_encender,
+	nulo_apagar,
+	nulo_encender,
+	nulo_tono,
+	NULL
+};
+
+/**
+  * @brief Funcion que mide los eventos por segundo que procesa la maquina de estados
+	*				 del LED con una secuencia que recorre todos los estados. Se emplea una
+	*				 maquina propia con salidas vacias, por lo que el LED no cambia.
+	* @param None
+  * @retval None
+  */
+static void benchmark_Control (void){
+	static const Control_Evento secuencia[] = {
+		EV_CENTRAL, EV_DERECHA, EV_SUBIR, EV_IZQUIERDA, EV_BAJAR,
+		EV_BRILLO, EV_TONO, EV_SUBIR, EV_DERECHA, EV_CENTRAL
+	};
+	Control c;
+	char buf[100];
+	int size;
+	uint32_t inicio, ciclos;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	init_Control(&c, &salidas_nulas, 30000);
+
+	inicio = DWT->CYCCNT;
+	for (uint32_t i = 0; i < BENCH_EVENTOS; i++)
+		despachar_Control(&c, secuencia[i % (sizeof(secuencia) / sizeof(secuencia[0]))], (uint16_t)i);
+	ciclos = DWT->CYCCNT - inicio;
+
+	size = sprintf(buf, "\r Control: %u eventos, %u ciclos/evento, %u eventos/s\n",
+								 (unsigned)BENCH_EVENTOS,
+								 (unsigned)(ciclos / BENCH_EVENTOS),
+								 (unsigned)(((uint64_t)BENCH_EVENTOS * SystemCoreClock) / ciclos));
+	tx_USART(buf, size);
+}
+
+/**
+  * @brief Funcion que empieza la carga de flancos: descarta los grabados y agrupa los
+	*				 caracteres siguientes en lineas hasta la linea con '.'
+	* @param None
+  * @retval None
+  */
+static void cargar_Flancos (void){
+	char buf[60];
+	int size;
+
+	borrar_Grabador();
+	carga.activa = 1;
+	carga.longitud = 0;
+	carga.cargados = 0;
+	carga.errores = 0;
+	size = sprintf(buf, "\r Carga: lineas G, del volcado y '.' al final\n");
+	tx_USART(buf, size);
+}
+
+/**
+  * @brief Funcion que atiende una linea completa de la carga de flancos
+	* @param None
+  * @retval None
+  */
+static void linea_Carga (void){
+	Grabador_Evento e;
+	char buf[60];
+	int size;
+
+	if (carga.longitud == CARGA_LINEA){
+		carga.errores++;
+		return;
+	}
+	carga.linea[carga.longitud] = '\0';
+	if (strcmp(carga.linea, ".") == 0){
+		carga.activa = 0;
+		size = sprintf(buf, "\r Carga: %u flancos, %u lineas no validas\n",
+									 (unsigned)carga.cargados, (unsigned)carga.errores);
+		tx_USART(buf, size);
+	}
+	else if (carga.linea[0] == 'G' && carga.linea[1] == ','){
+		if (leer_Grabador(carga.linea, &e) == 0 && cargar_Grabador(&e) == 0)
+			carga.cargados++;
+		else
+			carga.errores++;
+	}
+}
+
+/**
+  * @brief Funcion que agrupa en lineas los caracteres de la carga de flancos. Las
+	*				 lineas vacias (fin de linea "\r\n" del terminal) se ignoran.
+	* @param c: Caracter recibido
+  * @retval None
+  */
+static void caracter_Carga (char c){
+	if (c == '\r' || c == '\n'){
+		if (carga.longitud > 0U)
+			linea_Carga();
+		carga.longitud = 0;
+	}
+	else if (carga.longitud < CARGA_LINEA - 1U)
+		carga.linea[carga.longitud++] = c;
+	else
+		carga.longitud = CARGA_LINEA;
+}
+
+/**
+  * @brief Funcion que atiende los caracteres recibidos por la USART ejecutando el
+	*				 comando asociado a cada uno. No se bloquea si no hay datos recibidos.
+	* @param None
+  * @retval None
+  */
+void procesar_Comandos (void){
+	char c;
+
+	while (rx_USART(&c)){
+		if (carga.activa){
+			caracter_Carga(c);
+			continue;
+		}
+		for (unsigned i = 0; i < NUM_COMANDOS; i++){
+			if (comandos[i].letra == c){
+				comandos[i].funcion();
+				break;
+			}
+		}
+	}
+}
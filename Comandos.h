@@ -0,0 +1,22 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Comandos.h
+  * @author  MCD Application Team
+  * @brief   Libreria de atencion a los comandos recibidos por la USART3. Cada
+	*					 comando es un unico caracter que se asocia a una funcion en la
+	*					 tabla de comandos de Comandos.c.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __COMANDOS_H
+#define __COMANDOS_H
+
+void procesar_Comandos (void);
+
+#endif /* __COMANDOS_H */
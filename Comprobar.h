@@ -0,0 +1,24 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Comprobar.h
+  * @author  MCD Application Team
+  * @brief   Comprobacion en compilacion comun a todos los modulos: las tablas de
+	*					 memoria (Memoria.h), de prioridades (Prioridades.h) y de niveles
+	*					 de reloj (Reloj.c) validan sus valores con COMPROBAR.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __COMPROBAR_H
+#define __COMPROBAR_H
+
+/*Error de tamano de array negativo si la condicion no se cumple; el nombre, unico
+	en cada fichero, aparece en el mensaje del compilador*/
+#define COMPROBAR(condicion, nombre)	typedef char comprobar_##nombre[(condicion) ? 1 : -1]
+
+#endif /* __COMPROBAR_H */
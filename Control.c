@@ -0,0 +1,235 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Control.c
+  * @author  MCD Application Team
+  * @brief   Fichero de la maquina de estados del LED RGB:
+	*							- Con la pulsacion central se enciende y se apaga.
+	*							- Con las pulsaciones LEFT y RIGHT se rota el color en un
+	*								sentido u otro (verde, rojo, azul).
+	*							- Con las pulsaciones UP y DOWN se aumenta o disminuye la
+	*								intensidad.
+	*							- El potenciometro de brillo fija la intensidad y el de tono
+	*								pasa el LED a la mezcla de colores que indica.
+	*							- Tras el fundido por inactividad se pasa a apagado.
+	*
+	*					 Cada casilla de la tabla de transiciones es la accion que se
+	*					 ejecuta al recibir un evento en un estado y devuelve el estado
+	*					 siguiente. Para anadir un comportamiento basta con anadir una
+	*					 fila (estado) o una columna (evento) a la tabla.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include "Control.h"
+
+typedef Control_Estado (*Control_Accion)(Control *c, uint16_t valor);
+
+/*Intensidades (valor del CCR) que recorren UP y DOWN. Al pasar de un extremo se
+	salta al otro; un paso que saldria del recorrido se queda en el extremo, de forma
+	que la intensidad fijada por el potenciometro nunca sale del rango del CCR*/
+#define INTENSIDAD_PASO  20000
+#define INTENSIDAD_MAX   10				/*CCR de la maxima intensidad*/
+#define INTENSIDAD_MIN   60010		/*CCR de la minima intensidad*/
+
+/*Orden de rotacion de los colores con las pulsaciones RIGHT*/
+static const Color rotacion[] = {LED_VERDE, LED_ROJO, LED_AZUL};
+static const char * const nombres[] = {"verde", "rojo", "azul"};
+#define NUM_ROTACION (sizeof(rotacion) / sizeof(rotacion[0]))
+
+/**
+  * @brief Funcion que envia un mensaje al terminal si hay salida de mensajes
+	* @param c: Maquina de estados
+	* @param texto: Mensaje a enviar
+  * @retval None
+  */
+static void mensaje (Control *c, const char *texto){
+	if (c->salidas->mensaje != NULL)
+		c->salidas->mensaje(texto);
+}
+
+/*Acciones auxiliares comunes a varios estados*/
+
+static void apagar_todos (Control *c){
+	for (int i = 0; i < NUM_LEDS; i++)
+		c->salidas->apagar((Color)i);
+}
+
+static void cambiar_color (Control *c, uint8_t color, const char *pulsacion){
+	char buf[64];
+
+	if (c->estado == EST_TONO)
+		apagar_todos(c);
+	else
+		c->salidas->apagar(rotacion[c->color]);
+	c->color = color;
+	c->salidas->encender(rotacion[color], c->intensidad);
+	if (c->salidas->mensaje != NULL){
+		sprintf(buf, "\r Pulsacion %s: Se enciende LED %s\n", pulsacion, nombres[color]);
+		mensaje(c, buf);
+	}
+}
+
+/*Aplica la intensidad actual a lo que se este mostrando*/
+static void aplicar_intensidad (Control *c){
+	if (c->estado == EST_COLOR)
+		c->salidas->intensidad(rotacion[c->color], c->intensidad);
+	else if (c->estado == EST_TONO)
+		c->salidas->tono(c->tono, c->intensidad);
+}
+
+/*Acciones de la tabla de transiciones*/
+
+static Control_Estado ignorar (Control *c, uint16_t valor){
+	(void)valor;
+	return c->estado;
+}
+
+static Control_Estado encender (Control *c, uint16_t valor){
+	(void)valor;
+	c->color = 0;
+	c->salidas->encender(rotacion[0], c->intensidad);
+	mensaje(c, "\r Pulsacion Central: Se enciende el RGB \n");
+	return EST_COLOR;
+}
+
+static Control_Estado apagar (Control *c, uint16_t valor){
+	(void)valor;
+	apagar_todos(c);
+	mensaje(c, "\r Pulsacion Central: Se apaga el RGB \n");
+	return EST_APAGADO;
+}
+
+static Control_Estado apagar_inactividad (Control *c, uint16_t valor){
+	(void)valor;
+	apagar_todos(c);
+	mensaje(c, "\r Inactividad: Se apaga el RGB \n");
+	return EST_APAGADO;
+}
+
+static Control_Estado rotar_izquierda (Control *c, uint16_t valor){
+	(void)valor;
+	/*Desde el modo tono se vuelve siempre al primer color*/
+	if (c->estado == EST_TONO)
+		cambiar_color(c, 0, "izquierda");
+	else
+		cambiar_color(c, (uint8_t)((c->color + NUM_ROTACION - 1U) % NUM_ROTACION), "izquierda");
+	return EST_COLOR;
+}
+
+static Control_Estado rotar_derecha (Control *c, uint16_t valor){
+	(void)valor;
+	if (c->estado == EST_TONO)
+		cambiar_color(c, 0, "derecha");
+	else
+		cambiar_color(c, (uint8_t)((c->color + 1U) % NUM_ROTACION), "derecha");
+	return EST_COLOR;
+}
+
+static Control_Estado subir (Control *c, uint16_t valor){
+	(void)valor;
+	if (c->intensidad < 2000)
+		c->intensidad = INTENSIDAD_MIN;
+	else if (c->intensidad - INTENSIDAD_PASO < INTENSIDAD_MAX)
+		c->intensidad = INTENSIDAD_MAX;
+	else
+		c->intensidad = c->intensidad - INTENSIDAD_PASO;
+	aplicar_intensidad(c);
+	mensaje(c, "\r Pulsacion UP: Se aumenta la intensidad \n");
+	return c->estado;
+}
+
+static Control_Estado bajar (Control *c, uint16_t valor){
+	(void)valor;
+	if (c->intensidad > 60000)
+		c->intensidad = INTENSIDAD_MAX;
+	else if (c->intensidad + INTENSIDAD_PASO > INTENSIDAD_MIN)
+		c->intensidad = INTENSIDAD_MIN;
+	else
+		c->intensidad = c->intensidad + INTENSIDAD_PASO;
+	aplicar_intensidad(c);
+	mensaje(c, "\r Pulsacion DOWN: Se disminuye la intensidad \n");
+	return c->estado;
+}
+
+static Control_Estado brillo (Control *c, uint16_t valor){
+	/*Potenciometro al maximo = maxima intensidad = CCR minimo*/
+	c->intensidad = 65535 - (int)valor;
+	aplicar_intensidad(c);
+	return c->estado;
+}
+
+static Control_Estado guardar_tono (Control *c, uint16_t valor){
+	c->tono = valor;
+	return c->estado;
+}
+
+static Control_Estado mostrar_tono (Control *c, uint16_t valor){
+	c->tono = valor;
+	c->salidas->tono(c->tono, c->intensidad);
+	return EST_TONO;
+}
+
+/*Tabla de transiciones estado x evento*/
+static const Control_Accion transiciones[NUM_ESTADOS][NUM_EVENTOS] = {
+	/*               IZQUIERDA        DERECHA        SUBIR  BAJAR  CENTRAL   BRILLO  TONO          INACTIVIDAD*/
+	[EST_APAGADO] = {ignorar,         ignorar,       subir, bajar, encender, brillo, guardar_tono, ignorar},
+	[EST_COLOR]   = {rotar_izquierda, rotar_derecha, subir, bajar, apagar,   brillo, mostrar_tono, apagar_inactividad},
+	[EST_TONO]    = {rotar_izquierda, rotar_derecha, subir, bajar, apagar,   brillo, mostrar_tono, apagar_inactividad},
+};
+
+/**
+  * @brief Funcion de inicializacion de la maquina de estados en el estado apagado
+	* @param c: Maquina de estados
+	* @param salidas: Acciones sobre el LED y el terminal
+	* @param intensidad: Intensidad inicial (valor del CCR)
+  * @retval None
+  */
+void init_Control (Control *c, const Control_Salidas *salidas, int intensidad){
+	c->estado = EST_APAGADO;
+	c->color = 0;
+	c->intensidad = intensidad;
+	c->tono = 0;
+	c->salidas = salidas;
+}
+
+/**
+  * @brief Funcion que procesa un evento ejecutando la accion de la tabla de
+	*				 transiciones y pasando al estado que esta devuelve.
+	* @param c: Maquina de estados
+	* @param evento: Evento recibido
+	* @param valor: Dato asociado al evento (lectura del potenciometro)
+  * @retval None
+  */
+void despachar_Control (Control *c, Control_Evento evento, uint16_t valor){
+	if ((unsigned)evento >= NUM_EVENTOS)
+		return;
+	c->estado = transiciones[c->estado][evento](c, valor);
+}
+
+/**
+  * @brief Funcion que devuelve el color seleccionado en la rotacion
+	* @param c: Maquina de estados
+  * @retval Color del LED
+  */
+Color color_Control (const Control *c){
+	return rotacion[c->color];
+}
+
+/**
+  * @brief Funcion que muestra en el LED el estado de la maquina, por ejemplo tras
+	*				 recuperar el ultimo estado en el arranque.
+	* @param c: Maquina de estados
+  * @retval None
+  */
+void mostrar_Control (const Control *c){
+	if (c->estado == EST_COLOR)
+		c->salidas->encender(rotacion[c->color], c->intensidad);
+	else if (c->estado == EST_TONO)
+		c->salidas->tono(c->tono, c->intensidad);
+}
@@ -0,0 +1,71 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Control.h
+  * @author  MCD Application Team
+  * @brief   Libreria de la maquina de estados que controla el LED RGB. Los
+	*					 eventos (pulsaciones del joystick y cambios en los potenciometros)
+	*					 se despachan a traves de una tabla estado x evento, por lo que el
+	*					 coste de cada evento no depende del numero de eventos existentes.
+	*
+	*					 La maquina no accede al hardware: las acciones sobre el LED y los
+	*					 mensajes se realizan a traves de la estructura Control_Salidas, de
+	*					 forma que las transiciones pueden probarse fuera de la placa.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __CONTROL_H
+#define __CONTROL_H
+
+#include <stdint.h>
+#include "Placa.h"
+
+/*Estados del LED RGB*/
+typedef enum {
+	EST_APAGADO,		/*LED apagado*/
+	EST_COLOR,			/*Encendido con un unico color (Control.color)*/
+	EST_TONO,				/*Encendido con la mezcla fijada por el potenciometro de tono*/
+	NUM_ESTADOS
+} Control_Estado;
+
+/*Eventos que recibe la maquina de estados*/
+typedef enum {
+	EV_IZQUIERDA,		/*Pulsacion LEFT*/
+	EV_DERECHA,			/*Pulsacion RIGHT*/
+	EV_SUBIR,				/*Pulsacion UP*/
+	EV_BAJAR,				/*Pulsacion DOWN*/
+	EV_CENTRAL,			/*Pulsacion CENTER*/
+	EV_BRILLO,			/*Cambio del potenciometro de brillo (valor 0 - 65535)*/
+	EV_TONO,				/*Cambio del potenciometro de tono (valor 0 - 65535)*/
+	EV_INACTIVIDAD,	/*Fin del fundido por inactividad (Efectos.c)*/
+	NUM_EVENTOS
+} Control_Evento;
+
+/*Acciones de la maquina sobre el exterior. mensaje puede ser NULL*/
+typedef struct {
+	void (*encender)(Color color, int intensidad);
+	void (*apagar)(Color color);
+	void (*intensidad)(Color color, int intensidad);
+	void (*tono)(uint16_t tono, int intensidad);
+	void (*mensaje)(const char *texto);
+} Control_Salidas;
+
+typedef struct {
+	Control_Estado estado;
+	uint8_t color;				/*Posicion en la rotacion de colores*/
+	int intensidad;				/*Valor del CCR: 0 maxima intensidad, 65535 apagado*/
+	uint16_t tono;
+	const Control_Salidas *salidas;
+} Control;
+
+void init_Control (Control *c, const Control_Salidas *salidas, int intensidad);
+void despachar_Control (Control *c, Control_Evento evento, uint16_t valor);
+Color color_Control (const Control *c);
+void mostrar_Control (const Control *c);
+
+#endif /* __CONTROL_H */
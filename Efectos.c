@@ -0,0 +1,383 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Efectos.c
+  * @author  MCD Application Team
+  * @brief   Fichero del planificador de efectos temporizados del LED RGB.
+	*
+	*					 Los efectos activos se guardan en un monticulo ordenado por el tick
+	*					 de su siguiente paso, de forma que cada paso (extraer, avanzar y
+	*					 reinsertar) y cada cancelacion cuestan O(log n). El temporizador
+	*					 del RTX es de un solo disparo y se programa siempre para la cima
+	*					 del monticulo, por lo que solo hay una expiracion por paso.
+	*
+	*					 Los pasos se ejecutan en el hilo de temporizadores del RTX. Las
+	*					 funciones de la API se llaman desde hilos de menor prioridad y
+	*					 modifican el monticulo con el nucleo bloqueado.
+	*
+	*					 En cada expiracion se mide el retraso respecto al plazo programado
+	*					 con el contador del temporizador del sistema (osKernelGetSysTimerCount),
+	*					 que tiene resolucion de un ciclo de reloj.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Efectos.h"
+#include "cmsis_os2.h"
+#include "USART.h"
+#include "Watchdog.h"
+#include "Memoria.h"
+
+typedef struct {
+	Efecto cfg;
+	uint32_t plazo;				/*Tick del siguiente paso*/
+	uint32_t paso;				/*Paso dentro del periodo (fase en el parpadeo)*/
+	uint32_t periodos;		/*Periodos completados*/
+	int8_t pos;						/*Posicion en el monticulo, -1 si el hueco esta libre*/
+} Activo;
+
+static Activo efectos[EFECTOS_MAX];
+/*Monticulo de indices de efectos ordenado por plazo*/
+static uint8_t monticulo[EFECTOS_MAX];
+static uint32_t num_activos = 0;
+static uint32_t max_activos = 0;
+
+static osTimerId_t temporizador;
+/*Tick para el que esta programado el temporizador*/
+static uint32_t plazo_armado;
+
+/*Retraso de la expiracion respecto a su plazo, en cuentas del temporizador del sistema*/
+static uint32_t retraso_n;
+static int32_t retraso_min;
+static int32_t retraso_max;
+static int64_t retraso_suma;
+
+static const osTimerAttr_t efectos_attr = {
+	.name = "efectos",
+	MEMORIA_TEMPORIZADOR_ATTR(efectos)
+};
+
+static const char * const nombres[NUM_EFECTOS] = {
+	"parpadeo",
+	"pulso",
+	"apagado",
+	"periodico"
+};
+
+/*Operaciones del monticulo*/
+
+static int antes (uint8_t a, uint8_t b){
+	return (int32_t)(efectos[a].plazo - efectos[b].plazo) < 0;
+}
+
+static void intercambiar (uint32_t i, uint32_t j){
+	uint8_t t = monticulo[i];
+
+	monticulo[i] = monticulo[j];
+	monticulo[j] = t;
+	efectos[monticulo[i]].pos = (int8_t)i;
+	efectos[monticulo[j]].pos = (int8_t)j;
+}
+
+static void subir (uint32_t i){
+	uint32_t padre;
+
+	while (i > 0U){
+		padre = (i - 1U) / 2U;
+		if (!antes(monticulo[i], monticulo[padre]))
+			break;
+		intercambiar(i, padre);
+		i = padre;
+	}
+}
+
+static void hundir (uint32_t i){
+	uint32_t hijo, menor;
+
+	while (1){
+		menor = i;
+		hijo = 2U * i + 1U;
+		if (hijo < num_activos && antes(monticulo[hijo], monticulo[menor]))
+			menor = hijo;
+		if (hijo + 1U < num_activos && antes(monticulo[hijo + 1U], monticulo[menor]))
+			menor = hijo + 1U;
+		if (menor == i)
+			return;
+		intercambiar(i, menor);
+		i = menor;
+	}
+}
+
+static void quitar (uint32_t i){
+	uint8_t id = monticulo[i];
+	uint8_t movido;
+
+	num_activos--;
+	if (i != num_activos){
+		movido = monticulo[num_activos];
+		monticulo[i] = movido;
+		efectos[movido].pos = (int8_t)i;
+		subir(i);
+		hundir((uint32_t)efectos[movido].pos);
+	}
+	efectos[id].pos = -1;
+}
+
+/**
+  * @brief Funcion que programa el temporizador para el efecto mas proximo o lo para
+	*				 si no quedan efectos.
+	* @param None
+  * @retval None
+  */
+static void rearmar (void){
+	uint32_t ahora = osKernelGetTickCount();
+	int32_t espera;
+
+	if (num_activos == 0U){
+		(void)osTimerStop(temporizador);
+		return;
+	}
+	plazo_armado = efectos[monticulo[0]].plazo;
+	espera = (int32_t)(plazo_armado - ahora);
+	if (espera < 1){
+		espera = 1;
+		plazo_armado = ahora + 1U;
+	}
+	(void)osTimerStart(temporizador, (uint32_t)espera);
+}
+
+/**
+  * @brief Funcion que avanza un paso de un efecto y calcula el plazo del siguiente
+	* @param a: Efecto activo
+  * @retval 1 si el efecto continua, 0 si ha terminado
+  */
+static int avanzar (Activo *a){
+	const Efecto *e = &a->cfg;
+	uint32_t pasos, mitad, fase;
+	int rango = EFECTOS_APAGADO - e->intensidad;
+
+	switch (e->tipo){
+		case EFECTO_PARPADEO:
+			a->paso ^= 1U;
+			e->aplicar(a->paso ? EFECTOS_APAGADO : e->intensidad);
+			if (a->paso == 0U && ++a->periodos == e->repeticiones)
+				return 0;
+			a->plazo += e->periodo_ms;
+			return 1;
+
+		case EFECTO_PULSO:
+			pasos = e->periodo_ms / EFECTOS_PASO_MS;
+			if (pasos < 2U)
+				pasos = 2U;
+			mitad = pasos / 2U;
+			if (++a->paso >= pasos){
+				a->paso = 0;
+				if (++a->periodos == e->repeticiones){
+					e->aplicar(e->intensidad);
+					return 0;
+				}
+			}
+			fase = (a->paso <= mitad) ? a->paso : pasos - a->paso;
+			e->aplicar(e->intensidad + (int)(((uint32_t)rango * fase) / mitad));
+			a->plazo += EFECTOS_PASO_MS;
+			return 1;
+
+		case EFECTO_APAGADO:
+			pasos = e->periodo_ms / EFECTOS_PASO_MS;
+			if (pasos < 1U)
+				pasos = 1U;
+			a->paso++;
+			e->aplicar(e->intensidad + (int)(((uint32_t)rango * a->paso) / pasos));
+			if (a->paso >= pasos)
+				return 0;
+			a->plazo += EFECTOS_PASO_MS;
+			return 1;
+
+		case EFECTO_PERIODICO:
+			e->aplicar((int)a->paso);
+			if (++a->paso == e->repeticiones)
+				return 0;
+			a->plazo += e->periodo_ms;
+			return 1;
+
+		default:
+			return 0;
+	}
+}
+
+/**
+  * @brief Funcion de expiracion del temporizador. Ejecuta los pasos de todos los
+	*				 efectos cuyo plazo ha vencido y vuelve a programar el temporizador.
+	* @param arg
+  * @retval None
+  */
+static void tick_Efectos (void *arg){
+	uint32_t ahora = osKernelGetTickCount();
+	uint32_t cuentas_tick = osKernelGetSysTimerFreq() / osKernelGetTickFreq();
+	int32_t retraso;
+	Activo *a;
+	uint8_t id;
+
+	(void)arg;
+	/*Una expiracion anterior a una reprogramacion puede llegar antes de plazo*/
+	if (num_activos != 0U && (int32_t)(ahora - plazo_armado) >= 0){
+		retraso = (int32_t)(osKernelGetSysTimerCount() - plazo_armado * cuentas_tick);
+		if (retraso_n == 0U || retraso < retraso_min)
+			retraso_min = retraso;
+		if (retraso_n == 0U || retraso > retraso_max)
+			retraso_max = retraso;
+		retraso_suma += retraso;
+		retraso_n++;
+	}
+
+	while (num_activos != 0U && (int32_t)(ahora - efectos[monticulo[0]].plazo) >= 0){
+		id = monticulo[0];
+		a = &efectos[id];
+		if (avanzar(a)){
+			/*Si el sistema ha estado ocupado no se recuperan los pasos perdidos*/
+			if ((int32_t)(a->plazo - ahora) <= 0)
+				a->plazo = ahora + 1U;
+			hundir(0);
+		}
+		else {
+			quitar(0);
+			if (a->cfg.fin != NULL)
+				a->cfg.fin();
+		}
+	}
+	rearmar();
+}
+
+/**
+  * @brief Funcion de inicializacion del planificador donde se crea su temporizador
+	* @param None
+  * @retval 0 si se ha creado el temporizador, -1 en caso contrario
+  */
+int init_Efectos (void){
+	for (int i = 0; i < EFECTOS_MAX; i++)
+		efectos[i].pos = -1;
+	temporizador = osTimerNew(tick_Efectos, osTimerOnce, NULL, &efectos_attr);
+	if (temporizador == NULL)
+		return -1;
+	return 0;
+}
+
+/**
+  * @brief Funcion que inicia un efecto. El primer paso se da tras espera_ms (o en el
+	*				 siguiente tick si es 0).
+	* @param efecto: Descripcion del efecto (se copia)
+  * @retval Identificador del efecto, -1 si no caben mas efectos
+  */
+int iniciar_Efecto (const Efecto *efecto){
+	int id = -1;
+	Activo *a;
+
+	osKernelLock();
+	for (int i = 0; i < EFECTOS_MAX; i++){
+		if (efectos[i].pos < 0){
+			id = i;
+			break;
+		}
+	}
+	if (id >= 0){
+		a = &efectos[id];
+		a->cfg = *efecto;
+		a->paso = 0;
+		a->periodos = 0;
+		a->plazo = osKernelGetTickCount() + ((efecto->espera_ms != 0U) ? efecto->espera_ms : 1U);
+		a->pos = (int8_t)num_activos;
+		monticulo[num_activos++] = (uint8_t)id;
+		subir((uint32_t)a->pos);
+		if (num_activos > max_activos)
+			max_activos = num_activos;
+		rearmar();
+	}
+	osKernelUnlock();
+	return id;
+}
+
+/**
+  * @brief Funcion que retira un efecto activo y, si ya habia modificado el LED, le
+	*				 devuelve su intensidad de partida. Los periodicos no modifican el LED
+	*				 con su intensidad. Se llama con el nucleo bloqueado.
+	* @param id: Identificador del efecto
+  * @retval None
+  */
+static void retirar (int id){
+	Activo *a = &efectos[id];
+
+	quitar((uint32_t)a->pos);
+	if (a->cfg.tipo != EFECTO_PERIODICO && (a->paso != 0U || a->periodos != 0U))
+		a->cfg.aplicar(a->cfg.intensidad);
+}
+
+/**
+  * @brief Funcion que cancela un efecto sin llamar a su funcion fin
+	* @param id: Identificador devuelto por iniciar_Efecto
+  * @retval None
+  */
+void cancelar_Efecto (int id){
+	if (id < 0 || id >= EFECTOS_MAX)
+		return;
+	osKernelLock();
+	if (efectos[id].pos >= 0){
+		retirar(id);
+		rearmar();
+	}
+	osKernelUnlock();
+}
+
+/**
+  * @brief Funcion que cancela todos los efectos interrumpibles. Se llama con cada
+	*				 evento del usuario antes de que la maquina de estados actue sobre el LED.
+	* @param None
+  * @retval None
+  */
+void cancelar_Efectos (void){
+	osKernelLock();
+	for (int i = 0; i < EFECTOS_MAX; i++){
+		if (efectos[i].pos >= 0 && efectos[i].cfg.interrumpible)
+			retirar(i);
+	}
+	rearmar();
+	osKernelUnlock();
+}
+
+/**
+  * @brief Funcion que envia por la USART los efectos activos y el retraso minimo,
+	*				 medio y maximo de las expiraciones del temporizador en nanosegundos.
+	* @param None
+  * @retval None
+  */
+void informe_Efectos (void){
+	char buf[100];
+	int size;
+	uint32_t mhz = osKernelGetSysTimerFreq() / 1000000U;
+	uint32_t ahora = osKernelGetTickCount();
+
+	size = sprintf(buf, "\r Efectos: activos=%u max=%u\n", (unsigned)num_activos, (unsigned)max_activos);
+	tx_USART(buf, size);
+	for (int i = 0; i < EFECTOS_MAX; i++){
+		if (efectos[i].pos >= 0){
+			size = sprintf(buf, "\r  %d %s: siguiente paso en %dms\n", i, nombres[efectos[i].cfg.tipo],
+										 (int)(int32_t)(efectos[i].plazo - ahora));
+			tx_USART(buf, size);
+			reset_Watchdog();
+		}
+	}
+	if (retraso_n == 0U){
+		size = sprintf(buf, "\r Retraso del temporizador: sin medidas\n");
+	}
+	else {
+		size = sprintf(buf, "\r Retraso del temporizador: n=%u min=%dns avg=%dns max=%dns\n",
+									 (unsigned)retraso_n,
+									 (int)((int64_t)retraso_min * 1000 / mhz),
+									 (int)((retraso_suma / retraso_n) * 1000 / mhz),
+									 (int)((int64_t)retraso_max * 1000 / mhz));
+	}
+	tx_USART(buf, size);
+}
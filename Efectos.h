@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Efectos.h
+  * @author  MCD Application Team
+  * @brief   Libreria de efectos temporizados del LED RGB (parpadeo, pulso y
+	*					 apagado por inactividad). Todos los efectos activos comparten un
+	*					 unico temporizador del RTX que se programa para el paso mas proximo.
+	*
+	*					 La intensidad de los efectos es el valor del CCR (0 maxima
+	*					 intensidad, 65535 apagado) y se aplica mediante la funcion aplicar
+	*					 de cada efecto, de forma que la libreria no depende de si el LED
+	*					 muestra un color o un tono. Los efectos periodicos no cambian la
+	*					 intensidad: aplicar recibe el numero de paso (modelo de consumo,
+	*					 Energia.h).
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __EFECTOS_H
+#define __EFECTOS_H
+
+#include <stdint.h>
+
+/*Efectos activos a la vez*/
+#define EFECTOS_MAX       8
+/*Periodo de actualizacion del pulso y del fundido*/
+#define EFECTOS_PASO_MS   20U
+/*Intensidad (CCR) con el LED apagado*/
+#define EFECTOS_APAGADO   65535
+
+typedef enum {
+	EFECTO_PARPADEO,		/*Alterna intensidad y apagado cada periodo_ms*/
+	EFECTO_PULSO,				/*Sube y baja la intensidad con un periodo de periodo_ms*/
+	EFECTO_APAGADO,			/*Tras espera_ms funde a apagado en periodo_ms y llama a fin*/
+	EFECTO_PERIODICO,		/*Llama a aplicar con el numero de paso cada periodo_ms*/
+	NUM_EFECTOS
+} Efecto_Tipo;
+
+typedef struct {
+	Efecto_Tipo tipo;
+	uint32_t periodo_ms;
+	uint32_t espera_ms;						/*Retardo hasta el primer paso*/
+	uint32_t repeticiones;				/*Periodos de parpadeo, pulso o periodico (0: indefinido)*/
+	int intensidad;								/*Intensidad de partida, que se restaura al cancelar*/
+	uint8_t interrumpible;				/*Lo cancela cancelar_Efectos (actividad del usuario)*/
+	void (*aplicar)(int intensidad);
+	void (*fin)(void);						/*Al terminar sin cancelarse (puede ser NULL)*/
+} Efecto;
+
+int init_Efectos (void);
+int iniciar_Efecto (const Efecto *efecto);
+void cancelar_Efecto (int id);
+void cancelar_Efectos (void);
+void informe_Efectos (void);
+
+#endif /* __EFECTOS_H */
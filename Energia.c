@@ -0,0 +1,233 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Energia.c
+  * @author  MCD Application Team
+  * @brief   Fichero del modelo de consumo y temperatura del LED RGB y del
+	*					 limitador de brillo (Energia.h).
+	*
+	*					 El fotograma se ejecuta en el hilo de temporizadores del RTX como
+	*					 un efecto periodico no interrumpible (Efectos.c). Integra el
+	*					 intervalo real desde el fotograma anterior, por lo que un retraso
+	*					 del temporizador no falsea la energia. Las unidades internas son
+	*					 uA, uW, nJ (uW*ms) y milesimas de C en Q8; el factor de brillo es
+	*					 Q16 (65536 sin limite).
+	*
+	*					 El hilo de control arranca y detiene el efecto (periodico_Energia),
+	*					 de forma que con el LED apagado y frio el temporizador no despierta
+	*					 al sistema.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Energia.h"
+
+#if ENERGIA_ENABLE
+
+#include <stdio.h>
+#include "cmsis_os2.h"
+#include "RGB.h"
+#include "Efectos.h"
+#include "USART.h"
+#include "Watchdog.h"
+#include "Metricas.h"
+#include "Traza.h"
+
+#define SIN_LIMITE  65536U
+
+/*Causa del limite de brillo (valor1 de TRAZA_ENERGIA)*/
+typedef enum {
+	LIMITE_NINGUNO,
+	LIMITE_POTENCIA,
+	LIMITE_TEMPERATURA
+} Limite;
+
+typedef struct {
+	uint32_t ma;
+	uint32_t mv;
+} Led;
+
+#define ENERGIA_LED(color, ma, mv)	[LED_##color] = {ma, mv},
+static const Led leds[NUM_LEDS] = {
+	ENERGIA_LEDS(ENERGIA_LED)
+};
+
+static const char * const nombres[NUM_LEDS] = {
+	[LED_ROJO] = "rojo",
+	[LED_VERDE] = "verde",
+	[LED_AZUL] = "azul"
+};
+
+static const char * const causas[] = {"sin limite", "potencia", "temperatura"};
+
+/*Estado del modelo, escrito solo en el fotograma*/
+static volatile uint32_t corriente_ua[NUM_LEDS];
+static volatile uint32_t potencia_uw;
+static volatile uint64_t energia_nj;
+static volatile int32_t incremento_q8;			/*dT en milesimas de C, Q8*/
+static volatile int32_t incremento_max_q8;
+static volatile uint32_t factor = SIN_LIMITE;
+static volatile Limite causa = LIMITE_NINGUNO;
+static volatile uint32_t limitaciones;
+static uint8_t limite_termico;
+static uint32_t ultimo_ms;
+
+/*Efecto del fotograma, que solo maneja el hilo de control*/
+static int efecto = -1;
+
+/**
+  * @brief Funcion que calcula el factor de brillo Q16 que lleva la potencia ordenada
+	*				 a la permitida
+	* @param ordenada: Potencia ordenada en uW
+	* @param permitida: Potencia maxima en uW
+  * @retval Factor Q16, SIN_LIMITE si la ordenada no supera la permitida
+  */
+static uint32_t ajustar (uint32_t ordenada, uint32_t permitida){
+	if (ordenada <= permitida)
+		return SIN_LIMITE;
+	return (uint32_t)(((uint64_t)permitida << 16) / ordenada);
+}
+
+/**
+  * @brief Funcion del fotograma: integra la corriente, la energia y la temperatura
+	*				 desde el anterior y actualiza el limitador de brillo
+	* @param paso: Numero de fotograma (no se usa)
+  * @retval None
+  */
+static void fotograma (int paso){
+	uint32_t ahora = osKernelGetTickCount();
+	uint32_t dt = ahora - ultimo_ms;
+	uint32_t nivel, ordenada = 0, real, estable_q8, alfa, objetivo, termico;
+	Limite nueva = LIMITE_NINGUNO;
+
+	(void)paso;
+	ultimo_ms = ahora;
+	if (dt > ENERGIA_TAU_MS)
+		dt = ENERGIA_TAU_MS;
+
+	/*Potencia ordenada y corriente real de cada color con el factor vigente*/
+	for (int c = 0; c < NUM_LEDS; c++){
+		nivel = nivel_RGB((Color)c);
+		ordenada += (uint32_t)(((uint64_t)nivel * (leds[c].ma * leds[c].mv)) >> 16);
+		corriente_ua[c] = (uint32_t)(((uint64_t)nivel * leds[c].ma * 1000U * factor) >> 32);
+	}
+	real = (uint32_t)(((uint64_t)ordenada * factor) >> 16);
+	potencia_uw = real;
+	energia_nj += (uint64_t)real * dt;
+
+	/*Primer orden: el incremento tiende a P * Rth con constante ENERGIA_TAU_MS*/
+	estable_q8 = real * ENERGIA_RTH / 1000U << 8;
+	alfa = (dt << 16) / ENERGIA_TAU_MS;
+	incremento_q8 += (int32_t)(((int64_t)((int32_t)estable_q8 - incremento_q8) * alfa) / 65536);
+	if (incremento_q8 > incremento_max_q8)
+		incremento_max_q8 = incremento_q8;
+
+	/*Limites: potencia ordenada y, una vez alcanzada la temperatura maxima, la
+		potencia que la mantiene*/
+	if (incremento_q8 >= (int32_t)(ENERGIA_TEMP_MAX_MC << 8))
+		limite_termico = 1;
+	else if (incremento_q8 < (int32_t)((ENERGIA_TEMP_MAX_MC - ENERGIA_HISTERESIS_MC) << 8))
+		limite_termico = 0;
+	objetivo = ajustar(ordenada, ENERGIA_POTENCIA_MAX_MW * 1000U);
+	if (objetivo != SIN_LIMITE)
+		nueva = LIMITE_POTENCIA;
+	if (limite_termico){
+		termico = ajustar(ordenada, ENERGIA_TEMP_MAX_MC * 1000U / ENERGIA_RTH);
+		if (termico < objetivo){
+			objetivo = termico;
+			nueva = LIMITE_TEMPERATURA;
+		}
+	}
+	if (nueva != causa){
+		if (causa == LIMITE_NINGUNO){
+			limitaciones++;
+			METRICA_CONTAR(energia_limitaciones);
+		}
+		TRAZA_EVENTO(TRAZA_ENERGIA, nueva, objetivo);
+		causa = nueva;
+	}
+
+	/*El factor se acerca al objetivo como mucho ENERGIA_RAMPA por fotograma*/
+	if (factor > objetivo)
+		factor -= (factor - objetivo > ENERGIA_RAMPA) ? ENERGIA_RAMPA : factor - objetivo;
+	else
+		factor += (objetivo - factor > ENERGIA_RAMPA) ? ENERGIA_RAMPA : objetivo - factor;
+	limitar_RGB(factor);
+}
+
+/**
+  * @brief Funcion que arranca el fotograma al encenderse el LED y lo detiene con el
+	*				 LED apagado, la temperatura de vuelta al ambiente y sin limite. Se
+	*				 llama desde el hilo de control tras cada evento y en cada espera.
+	* @param None
+  * @retval None
+  */
+void periodico_Energia (void){
+	Efecto e = {
+		.tipo = EFECTO_PERIODICO,
+		.periodo_ms = EFECTOS_PASO_MS,
+		.intensidad = EFECTOS_APAGADO,
+		.aplicar = fotograma
+	};
+
+	if (efecto < 0){
+		if (encendido_RGB()){
+			ultimo_ms = osKernelGetTickCount();
+			efecto = iniciar_Efecto(&e);
+		}
+	}
+	else if (!encendido_RGB() && factor == SIN_LIMITE &&
+					 incremento_q8 < (int32_t)(ENERGIA_REPOSO_MC << 8)){
+		cancelar_Efecto(efecto);
+		efecto = -1;
+	}
+}
+
+/**
+  * @brief Funcion que envia por la USART la corriente, la potencia, la energia y la
+	*				 temperatura estimadas y el estado del limitador de brillo
+	* @param None
+  * @retval None
+  */
+void informe_Energia (void){
+	char buf[100];
+	int size;
+	uint32_t total = 0, p = potencia_uw, f = factor, mj, media;
+	uint32_t ms = osKernelGetTickCount();
+	uint64_t nj;
+	int32_t t = incremento_q8 >> 8, t_max = incremento_max_q8 >> 8;
+
+	/*La energia es de 64 bits y el fotograma no debe cambiarla a media lectura*/
+	osKernelLock();
+	nj = energia_nj;
+	osKernelUnlock();
+	mj = (uint32_t)(nj / 1000000U);
+	media = (ms != 0U) ? (uint32_t)(nj / ms) : 0U;
+
+	for (int c = 0; c < NUM_LEDS; c++){
+		total += corriente_ua[c];
+		size = sprintf(buf, "\r %s: I=%u.%02umA\n", nombres[c],
+									 (unsigned)(corriente_ua[c] / 1000U), (unsigned)(corriente_ua[c] % 1000U / 10U));
+		tx_USART(buf, size);
+		reset_Watchdog();
+	}
+	size = sprintf(buf, "\r Total: I=%u.%02umA P=%u.%02umW E=%umJ media=%u.%02umW\n",
+								 (unsigned)(total / 1000U), (unsigned)(total % 1000U / 10U),
+								 (unsigned)(p / 1000U), (unsigned)(p % 1000U / 10U), (unsigned)mj,
+								 (unsigned)(media / 1000U), (unsigned)(media % 1000U / 10U));
+	tx_USART(buf, size);
+	size = sprintf(buf, "\r Temperatura: +%d.%02dC (max +%d.%02dC, limite +%u.%02uC)\n",
+								 (int)(t / 1000), (int)(t % 1000 / 10), (int)(t_max / 1000), (int)(t_max % 1000 / 10),
+								 (unsigned)(ENERGIA_TEMP_MAX_MC / 1000U), (unsigned)(ENERGIA_TEMP_MAX_MC % 1000U / 10U));
+	tx_USART(buf, size);
+	size = sprintf(buf, "\r Limitador: brillo=%u.%u%% (%s) limitaciones=%u\n",
+								 (unsigned)(f * 100U >> 16), (unsigned)(f * 1000U >> 16) % 10U,
+								 causas[causa], (unsigned)limitaciones);
+	tx_USART(buf, size);
+}
+
+#endif
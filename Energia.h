@@ -0,0 +1,76 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Energia.h
+  * @author  MCD Application Team
+  * @brief   Libreria de estimacion del consumo y de la temperatura del LED RGB
+	*					 y limitador de brillo. En cada fotograma de los efectos
+	*					 (EFECTOS_PASO_MS) se integra el ciclo de trabajo de cada color:
+	*
+	*						I = nivel * ENERGIA_LEDS(mA)				P = I * ENERGIA_LEDS(mV)
+	*						dT += (P * ENERGIA_RTH - dT) * t / ENERGIA_TAU_MS
+	*
+	*					 siendo nivel la intensidad ordenada (65535 - CCR) en Q16 y dT el
+	*					 incremento de temperatura sobre el ambiente (modelo de primer
+	*					 orden). Todo se calcula con aritmetica entera.
+	*
+	*					 Si la potencia ordenada supera ENERGIA_POTENCIA_MAX_MW, o la
+	*					 temperatura ha llegado a ENERGIA_TEMP_MAX_MC, el limitador reduce
+	*					 el brillo de todos los colores por igual hasta la potencia
+	*					 permitida (la que mantiene la temperatura en el limite en el caso
+	*					 termico). El factor varia como mucho ENERGIA_RAMPA por fotograma
+	*					 para que el cambio no se aprecie, y RGB.c lo aplica a cada CCR.
+	*
+	*					 El modelo se evalua con un efecto periodico que el hilo de control
+	*					 arranca al encenderse el LED y detiene con el LED apagado y la
+	*					 temperatura de vuelta al ambiente. Estado con el comando 'c'.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __ENERGIA_H
+#define __ENERGIA_H
+
+#include "stm32f4xx_hal.h"
+
+/*Habilitacion del modelo y del limitador (0: el LED se muestra sin limite)*/
+#ifndef ENERGIA_ENABLE
+#define ENERGIA_ENABLE 1
+#endif
+
+/*Colores: LED(color, corriente al 100 % en mA, tension directa en mV)*/
+#define ENERGIA_LEDS(LED) \
+	LED(ROJO,  20, 2000) \
+	LED(VERDE, 20, 3200) \
+	LED(AZUL,  20, 3200)
+
+/*Resistencia termica del LED al ambiente (C/W) y constante de tiempo*/
+#define ENERGIA_RTH               400U
+#define ENERGIA_TAU_MS            20000U
+/*Presupuestos: potencia ordenada e incremento de temperatura (milesimas de C)*/
+#define ENERGIA_POTENCIA_MAX_MW   100U
+#define ENERGIA_TEMP_MAX_MC       20000U
+/*El limite termico se retira al bajar ENERGIA_HISTERESIS_MC del maximo*/
+#define ENERGIA_HISTERESIS_MC     2000U
+/*Temperatura por debajo de la cual se detiene el modelo con el LED apagado*/
+#define ENERGIA_REPOSO_MC         100U
+/*Variacion maxima del factor de brillo por fotograma (Q16): 1 s de 0 a 100 %*/
+#define ENERGIA_RAMPA             1311U
+
+#if ENERGIA_ENABLE
+
+void periodico_Energia (void);
+void informe_Energia (void);
+
+#else
+
+#define periodico_Energia()       ((void)0)
+#define informe_Energia()         ((void)0)
+
+#endif
+
+#endif /* __ENERGIA_H */
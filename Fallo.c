@@ -0,0 +1,344 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Fallo.c
+  * @author  MCD Application Team
+  * @brief   Fichero de gestion de fallos: registro con instante, senal con el
+	*					 LED rojo y accion de recuperacion de cada modulo (Fallo.h).
+	*
+	*					 La senal no depende de los Timers ni de la USART: el pin del LED
+	*					 rojo se pasa a salida mientras dura el parpadeo y despues recupera
+	*					 su funcion alternativa. El parpadeo depende del momento del fallo:
+	*							- Antes de arrancar el sistema operativo, y al detener el
+	*								sistema tras FALLO_MAX_REINICIOS resets, se espera con el
+	*								contador de ciclos refrescando el IWDG
+	*							- Con el sistema operativo en marcha lo recorre un temporizador
+	*								del RTX, de forma que el hilo que registra el fallo continua
+	*								y el IWDG lo sigue refrescando el supervisor (Watchdog.h).
+	*								Un fallo que llega durante el parpadeo de otro no se senala
+	*								(se registra igualmente) y en una interrupcion tampoco
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include "Fallo.h"
+#include "Placa.h"
+#include "USART.h"
+#include "cmsis_os2.h"
+#include "Memoria.h"
+
+typedef struct {
+	uint32_t codigo;
+	uint32_t tiempo;		/*HAL_GetTick en ms*/
+} Fallo_Registro;
+
+/*Ultimos fallos (lista circular) y fallos registrados desde el arranque*/
+static Fallo_Registro registros[FALLO_MAX_REGISTROS];
+static uint32_t num_fallos = 0;
+/*Reintentos consumidos por cada modulo y modulos en modo seguro (un bit por modulo)*/
+static uint8_t intentos[FALLO_NUM_MODULOS];
+static uint32_t seguro = 0;
+
+#define FALLO_REINTENTOS_MODULO(nombre, reintentos, accion)	(reintentos),
+static const uint8_t reintentos[FALLO_NUM_MODULOS] = {
+	FALLO_MODULOS(FALLO_REINTENTOS_MODULO)
+};
+
+#define FALLO_ACCION_MODULO(nombre, reintentos, accion)	(accion),
+static const Fallo_Accion acciones[FALLO_NUM_MODULOS] = {
+	FALLO_MODULOS(FALLO_ACCION_MODULO)
+};
+
+#define FALLO_NOMBRE_MODULO(nombre, reintentos, accion)	#nombre,
+static const char * const nombres[FALLO_NUM_MODULOS] = {
+	FALLO_MODULOS(FALLO_NOMBRE_MODULO)
+};
+
+/*Pines del LED RGB, activos a nivel bajo*/
+#define FALLO_PUERTO_LED(color, puerto, pin, tim, canal, af)	puerto,
+static GPIO_TypeDef * const puertos[NUM_LEDS] = {
+	PLACA_LEDS(FALLO_PUERTO_LED)
+};
+
+#define FALLO_PIN_LED(color, puerto, pin, tim, canal, af)	(pin),
+static const uint8_t pines[NUM_LEDS] = {
+	PLACA_LEDS(FALLO_PIN_LED)
+};
+
+/*Parpadeo con el sistema operativo en marcha: pasos pares encienden el rojo y
+	pasos impares lo apagan*/
+static const osTimerAttr_t fallo_attr = {
+	.name = "fallo",
+	MEMORIA_TEMPORIZADOR_ATTR(fallo)
+};
+static osTimerId_t temporizador = NULL;
+static uint8_t parpadeando = 0;
+static uint32_t paso, pasos, pulsos;
+static uint32_t modo_senal[NUM_LEDS];
+
+/**
+  * @brief Funcion que espera sin el sistema operativo refrescando el IWDG cada ms
+	* @param ms: Tiempo de espera
+  * @retval None
+  */
+static void esperar (uint32_t ms){
+	uint32_t ciclos_ms = SystemCoreClock / 1000U;
+	uint32_t inicio;
+
+	for (uint32_t i = 0; i < ms; i++){
+		inicio = DWT->CYCCNT;
+		while (DWT->CYCCNT - inicio < ciclos_ms)
+			;
+		/*Clave de recarga del IWDG*/
+		IWDG->KR = 0xAAAAU;
+	}
+}
+
+/**
+  * @brief Funcion que apaga los tres colores y pasa sus pines a salida
+	* @param modo: Modo anterior de cada pin
+  * @retval None
+  */
+static void tomar_Pines (uint32_t modo[NUM_LEDS]){
+	for (int i = 0; i < NUM_LEDS; i++){
+		PLACA_GPIO_CLK_ENABLE(puertos[i]);
+		modo[i] = (puertos[i]->MODER >> (2U * pines[i])) & 3U;
+		puertos[i]->BSRR = 1U << pines[i];
+		puertos[i]->MODER = (puertos[i]->MODER & ~(3U << (2U * pines[i]))) | (1U << (2U * pines[i]));
+	}
+}
+
+/**
+  * @brief Funcion que devuelve los pines de los tres colores a su modo anterior
+	* @param modo: Modo anterior de cada pin
+  * @retval None
+  */
+static void devolver_Pines (const uint32_t modo[NUM_LEDS]){
+	for (int i = 0; i < NUM_LEDS; i++)
+		puertos[i]->MODER = (puertos[i]->MODER & ~(3U << (2U * pines[i]))) | (modo[i] << (2U * pines[i]));
+}
+
+/**
+  * @brief Funcion que senala un fallo con el LED rojo esperando sin el sistema
+	*				 operativo: tantos pulsos como el numero del modulo y una pausa,
+	*				 FALLO_REPETICIONES veces. Los pines del LED se devuelven despues a su
+	*				 modo anterior.
+	* @param modulo: Modulo del fallo
+  * @retval None
+  */
+static void senalar (Fallo_Modulo modulo){
+	uint32_t modo[NUM_LEDS];
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	/*Los tres colores apagados y como salida*/
+	tomar_Pines(modo);
+
+	for (uint32_t r = 0; r < FALLO_REPETICIONES; r++){
+		for (uint32_t p = 0; p <= (uint32_t)modulo; p++){
+			puertos[LED_ROJO]->BSRR = 1U << (pines[LED_ROJO] + 16U);
+			esperar(FALLO_PULSO_MS);
+			puertos[LED_ROJO]->BSRR = 1U << pines[LED_ROJO];
+			esperar(FALLO_PULSO_MS);
+		}
+		esperar(FALLO_PAUSA_MS);
+	}
+
+	devolver_Pines(modo);
+}
+
+/**
+  * @brief Callback del temporizador que da un paso del parpadeo y programa el
+	*				 siguiente con la misma secuencia que senalar
+	* @param arg: No se usa
+  * @retval None
+  */
+static void paso_Senal (void *arg){
+	uint32_t espera = FALLO_PULSO_MS;
+
+	(void)arg;
+	if (paso == pasos){
+		devolver_Pines(modo_senal);
+		parpadeando = 0;
+		return;
+	}
+	if ((paso & 1U) == 0U)
+		puertos[LED_ROJO]->BSRR = 1U << (pines[LED_ROJO] + 16U);
+	else
+		puertos[LED_ROJO]->BSRR = 1U << pines[LED_ROJO];
+	paso++;
+	/*Tras el ultimo pulso de cada repeticion se hace la pausa*/
+	if (paso % (2U * pulsos) == 0U)
+		espera += FALLO_PAUSA_MS;
+	(void)osTimerStart(temporizador, espera);
+}
+
+/**
+  * @brief Funcion que inicia el parpadeo de un fallo con el temporizador del RTX.
+	*				 Solo se llama desde un hilo con el sistema operativo en marcha.
+	* @param modulo: Modulo del fallo
+  * @retval None
+  */
+static void senalar_Temporizador (Fallo_Modulo modulo){
+	uint32_t primask;
+
+	if (temporizador == NULL)
+		temporizador = osTimerNew(paso_Senal, osTimerOnce, NULL, &fallo_attr);
+	if (temporizador == NULL)
+		return;
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (parpadeando){
+		__set_PRIMASK(primask);
+		return;
+	}
+	parpadeando = 1;
+	__set_PRIMASK(primask);
+	pulsos = (uint32_t)modulo + 1U;
+	pasos = FALLO_REPETICIONES * 2U * pulsos;
+	paso = 0;
+	tomar_Pines(modo_senal);
+	paso_Senal(NULL);
+}
+
+/**
+  * @brief Funcion que reinicia el sistema tras un fallo. El fallo se guarda en los
+	*				 registros de backup para informar de el tras el reset. Si el arranque
+	*				 anterior tambien termino asi FALLO_MAX_REINICIOS veces, se detiene el
+	*				 sistema senalando el fallo hasta que se apague la placa.
+	* @param modulo: Modulo del fallo
+	* @param codigo: Codigo del fallo
+	* @param tiempo: Instante del fallo
+  * @retval None
+  */
+static __NO_RETURN void reiniciar (Fallo_Modulo modulo, uint32_t codigo, uint32_t tiempo){
+	__HAL_RCC_PWR_CLK_ENABLE();
+	HAL_PWR_EnableBkUpAccess();
+	FALLO_BKP_CODIGO = codigo;
+	FALLO_BKP_TIEMPO = tiempo;
+	if (FALLO_BKP_REINICIOS >= FALLO_MAX_REINICIOS){
+		/*Sistema detenido: ningun hilo vuelve a ejecutarse*/
+		__disable_irq();
+		while (1)
+			senalar(modulo);
+	}
+	FALLO_BKP_REINICIOS++;
+	NVIC_SystemReset();
+}
+
+/**
+  * @brief Funcion que registra un fallo, lo senala con el LED y decide la accion de
+	*				 recuperacion. Se llama con la macro FALLO(modulo, estado).
+	* @param modulo: Modulo que ha fallado
+	* @param estado: Estado devuelto por la funcion que ha fallado
+	* @param linea: Linea del fichero donde se ha detectado
+  * @retval FALLO_REINTENTAR o FALLO_SEGURO. Con FALLO_REINICIAR no se retorna
+  */
+Fallo_Accion registrar_Fallo (Fallo_Modulo modulo, uint32_t estado, uint32_t linea){
+	uint32_t codigo = FALLO_CODIGO(modulo, estado, linea);
+	uint32_t tiempo = HAL_GetTick();
+	uint32_t primask = __get_PRIMASK();
+	Fallo_Accion accion;
+
+	__disable_irq();
+	registros[num_fallos % FALLO_MAX_REGISTROS].codigo = codigo;
+	registros[num_fallos % FALLO_MAX_REGISTROS].tiempo = tiempo;
+	num_fallos++;
+	if (intentos[modulo] < reintentos[modulo]){
+		intentos[modulo]++;
+		accion = FALLO_REINTENTAR;
+	}
+	else
+		accion = acciones[modulo];
+	if (accion == FALLO_SEGURO)
+		seguro |= 1U << modulo;
+	__set_PRIMASK(primask);
+
+	/*Con el sistema operativo en marcha el reset es inmediato (el fallo se informa
+		tras el) y el parpadeo no bloquea al hilo*/
+	if (osKernelGetState() != osKernelRunning)
+		senalar(modulo);
+	else if (accion != FALLO_REINICIAR && __get_IPSR() == 0U)
+		senalar_Temporizador(modulo);
+	if (accion == FALLO_REINICIAR)
+		reiniciar(modulo, codigo, tiempo);
+	return accion;
+}
+
+/**
+  * @brief Funcion que indica si un modulo ha quedado en modo seguro
+	* @param modulo: Modulo
+  * @retval 1 si el modulo esta en modo seguro, 0 en caso contrario
+  */
+int seguro_Fallo (Fallo_Modulo modulo){
+	return (seguro >> modulo) & 1U;
+}
+
+/**
+  * @brief Funcion que envia por la USART un fallo
+	* @param texto: Encabezado de la linea
+	* @param codigo: Codigo del fallo
+	* @param tiempo: Instante del fallo
+  * @retval None
+  */
+static void enviar (const char *texto, uint32_t codigo, uint32_t tiempo){
+	char buf[100];
+	int size;
+	uint32_t modulo = FALLO_MODULO(codigo);
+
+	size = sprintf(buf, "\r %s %s estado=%u linea=%u t=%ums\n", texto,
+								 (modulo < FALLO_NUM_MODULOS) ? nombres[modulo] : "?",
+								 (unsigned)FALLO_ESTADO(codigo), (unsigned)FALLO_LINEA(codigo), (unsigned)tiempo);
+	tx_USART(buf, size);
+}
+
+/**
+  * @brief Funcion que informa del fallo que provoco el ultimo reset, si lo hubo, y de
+	*				 los fallos del arranque actual. Se llama al arrancar el sistema
+	*				 operativo, por lo que tambien pone a cero la cuenta de resets seguidos.
+	* @param None
+  * @retval None
+  */
+void causa_Fallo (void){
+	char buf[50];
+	int size;
+
+	if (FALLO_BKP_REINICIOS != 0U){
+		size = sprintf(buf, "\r Reset por fallo (%u seguidos):\n", (unsigned)FALLO_BKP_REINICIOS);
+		tx_USART(buf, size);
+		enviar("Fallo", FALLO_BKP_CODIGO, FALLO_BKP_TIEMPO);
+		HAL_PWR_EnableBkUpAccess();
+		FALLO_BKP_REINICIOS = 0;
+	}
+	if (num_fallos != 0U)
+		informe_Fallo();
+}
+
+/**
+  * @brief Funcion que envia por la USART los ultimos fallos y los modulos que estan en
+	*				 modo seguro.
+	* @param None
+  * @retval None
+  */
+void informe_Fallo (void){
+	char buf[100];
+	int size;
+	uint32_t primero = (num_fallos > FALLO_MAX_REGISTROS) ? num_fallos - FALLO_MAX_REGISTROS : 0U;
+
+	size = sprintf(buf, "\r Fallos desde el arranque: %u\n", (unsigned)num_fallos);
+	tx_USART(buf, size);
+	for (uint32_t i = primero; i < num_fallos; i++)
+		enviar("Fallo", registros[i % FALLO_MAX_REGISTROS].codigo, registros[i % FALLO_MAX_REGISTROS].tiempo);
+	for (int m = 0; m < FALLO_NUM_MODULOS; m++){
+		if (seguro_Fallo((Fallo_Modulo)m)){
+			size = sprintf(buf, "\r Modo seguro: %s\n", nombres[m]);
+			tx_USART(buf, size);
+		}
+	}
+}
@@ -0,0 +1,104 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Fallo.h
+  * @author  MCD Application Team
+  * @brief   Libreria de gestion de fallos. Cada fallo se identifica con un codigo
+	*					 que contiene el modulo, el estado devuelto (HAL_StatusTypeDef o el
+	*					 codigo de retorno del modulo) y la linea del fichero:
+	*
+	*							bits 31..24: modulo   bits 23..16: estado   bits 15..0: linea
+	*
+	*					 Al registrar un fallo se guarda con su instante en una lista en RAM
+	*					 y en registros de backup del RTC, se senala con parpadeos del LED
+	*					 rojo (tantos como el numero del modulo, sin necesidad de la USART
+	*					 y, con el sistema operativo en marcha, sin bloquear al hilo) y se
+	*					 decide la accion de recuperacion del modulo:
+	*							- FALLO_REINTENTAR: se repite la inicializacion mientras queden
+	*								reintentos
+	*							- FALLO_SEGURO: se continua sin el modulo (modo seguro)
+	*							- FALLO_REINICIAR: reset inmediato sin esperar al IWDG. Tras
+	*								FALLO_MAX_REINICIOS resets seguidos sin completar el arranque el
+	*								sistema se detiene senalando el fallo
+	*
+	*					 El fallo que provoco el ultimo reset se envia por la USART al
+	*					 arrancar el sistema operativo (causa_Fallo).
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __FALLO_H
+#define __FALLO_H
+
+#include "stm32f4xx_hal.h"
+
+/*Acciones de recuperacion*/
+typedef enum {
+	FALLO_REINTENTAR,
+	FALLO_SEGURO,
+	FALLO_REINICIAR
+} Fallo_Accion;
+
+/*Modulos: MODULO(nombre, reintentos, accion al agotar los reintentos). El numero de
+	parpadeos del LED es la posicion en la lista mas uno*/
+#define FALLO_MODULOS(MODULO) \
+	MODULO(HAL,      1, FALLO_REINICIAR) \
+	MODULO(RELOJ,    3, FALLO_REINICIAR) \
+	MODULO(RGB,      3, FALLO_SEGURO)    \
+	MODULO(WATCHDOG, 3, FALLO_SEGURO)    \
+	MODULO(REPOSO,   3, FALLO_SEGURO)    \
+	MODULO(USART,    3, FALLO_SEGURO)    \
+	MODULO(HILOS,    0, FALLO_SEGURO)
+
+#define FALLO_ENUM_MODULO(nombre, reintentos, accion)	FALLO_##nombre,
+typedef enum {
+	FALLO_MODULOS(FALLO_ENUM_MODULO)
+	FALLO_NUM_MODULOS
+} Fallo_Modulo;
+
+/*Campos del codigo de fallo*/
+#define FALLO_CODIGO(modulo, estado, linea) \
+	(((uint32_t)(modulo) << 24) | (((uint32_t)(estado) & 0xFFU) << 16) | ((uint32_t)(linea) & 0xFFFFU))
+#define FALLO_MODULO(codigo)   ((codigo) >> 24)
+#define FALLO_ESTADO(codigo)   (((codigo) >> 16) & 0xFFU)
+#define FALLO_LINEA(codigo)    ((codigo) & 0xFFFFU)
+
+/*Fallos que se conservan en RAM (los mas recientes)*/
+#define FALLO_MAX_REGISTROS  8U
+/*Resets seguidos por fallo antes de detener el sistema*/
+#define FALLO_MAX_REINICIOS  3U
+
+/*Registros de backup del RTC con el ultimo fallo (BKP3R - BKP4R son de Arranque.c)*/
+#define FALLO_BKP_CODIGO     (RTC->BKP5R)
+#define FALLO_BKP_TIEMPO     (RTC->BKP6R)
+#define FALLO_BKP_REINICIOS  (RTC->BKP7R)
+
+/*Parpadeo del LED rojo: pulsos de FALLO_PULSO_MS encendido y apagado y pausa de
+	FALLO_PAUSA_MS, repetido FALLO_REPETICIONES veces*/
+#define FALLO_PULSO_MS       200U
+#define FALLO_PAUSA_MS       1000U
+#define FALLO_REPETICIONES   2U
+
+/*Registro de un fallo del modulo con el estado devuelto y la linea actual*/
+#define FALLO(modulo, estado)	registrar_Fallo(FALLO_##modulo, (uint32_t)(estado), __LINE__)
+
+/*Ejecuta una inicializacion que devuelve 0 si es correcta hasta que lo es o hasta que
+	la accion del modulo deja de ser FALLO_REINTENTAR*/
+#define FALLO_INTENTAR(modulo, llamada) \
+	do { \
+		uint32_t estado_fallo; \
+		while ((estado_fallo = (uint32_t)(llamada)) != 0U && \
+					 FALLO(modulo, estado_fallo) == FALLO_REINTENTAR) \
+			; \
+	} while (0)
+
+Fallo_Accion registrar_Fallo (Fallo_Modulo modulo, uint32_t estado, uint32_t linea);
+int seguro_Fallo (Fallo_Modulo modulo);
+void causa_Fallo (void);
+void informe_Fallo (void);
+
+#endif /* __FALLO_H */
@@ -0,0 +1,267 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Flujo.c
+  * @author  MCD Application Team
+  * @brief   Fichero del analizador de las tramas del flujo de color del PC
+	*					 (formato en Flujo.h).
+	*
+	*					 El analizador se ejecuta en la interrupcion de la USART3 byte a
+	*					 byte, de forma que una trama se muestra en cuanto llega su ultimo
+	*					 byte sin esperar a ningun hilo. Se cuentan:
+	*							- descartadas: cabecera, longitud o suma incorrectas, o trama
+	*								cortada durante mas de FLUJO_PAUSA_MS. El resto de una trama
+	*								descartada se consume con la longitud que declara (la
+	*								esperada si la cabecera no es valida) y, hasta la siguiente
+	*								trama correcta o una pausa, los bytes que no empiezan una
+	*								cabecera tampoco llegan a los comandos
+	*							- perdidas: saltos del numero de secuencia (tramas que el PC
+	*								envio y no han llegado enteras)
+	*							- tardias: tramas sustituidas por la siguiente antes del evento
+	*								de actualizacion de la PWM, que no se llegaron a mostrar
+	*					 y el intervalo entre tramas con el contador del temporizador del
+	*					 sistema.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Flujo.h"
+
+#if FLUJO_ENABLE
+
+#include <stdio.h>
+#include "cmsis_os2.h"
+#include "RGB.h"
+#include "USART.h"
+#include "Metricas.h"
+#include "Traza.h"
+
+/*Motivo de descarte (valor1 de TRAZA_FLUJO)*/
+typedef enum {
+	DESCARTE_CABECERA,
+	DESCARTE_LONGITUD,
+	DESCARTE_SUMA,
+	DESCARTE_PAUSA,
+	NUM_DESCARTES
+} Descarte;
+
+static const char * const nombres[NUM_DESCARTES] = {"cabecera", "longitud", "suma", "pausa"};
+
+/*Trama en curso y bytes que quedan de una trama descartada*/
+static uint8_t trama[FLUJO_TRAMA];
+static uint32_t pos = 0;
+static uint32_t saltar = 0;
+static uint32_t ultimo_byte_ms;
+/*Tras un descarte se busca la siguiente cabecera sin ceder bytes a los comandos*/
+static uint8_t sincronizando = 0;
+
+/*Estado del flujo: activo lo pone la interrupcion y lo retira el hilo de control*/
+static volatile uint8_t activo = 0;
+static uint8_t anunciado = 0;
+static volatile uint32_t ultima_ms;
+static uint16_t secuencia;
+static uint16_t brillo[NUM_LEDS];
+
+/*Estadisticas*/
+static volatile uint32_t tramas;
+static volatile uint32_t perdidas;
+static volatile uint32_t tardias;
+static volatile uint32_t descartes[NUM_DESCARTES];
+static uint32_t ultima_cuenta;
+static uint32_t intervalo_n, intervalo_min, intervalo_max;
+static uint64_t intervalo_suma;
+
+static void descartar (Descarte motivo){
+	descartes[motivo]++;
+	TRAZA_EVENTO(TRAZA_FLUJO, motivo, pos);
+	pos = 0;
+	sincronizando = (motivo != DESCARTE_PAUSA);
+}
+
+/**
+  * @brief Funcion que muestra una trama correcta y actualiza las estadisticas
+	* @param None
+  * @retval None
+  */
+static void aplicar (void){
+	uint32_t cuenta = osKernelGetSysTimerCount();
+	uint16_t s = (uint16_t)(trama[6] | (trama[7] << 8));
+	uint16_t salto = (uint16_t)(s - secuencia - 1U);
+
+	for (uint32_t c = 0; c < NUM_LEDS; c++)
+		brillo[c] = (uint16_t)(trama[8U + 2U * c] | (trama[9U + 2U * c] << 8));
+	if (trama_RGB(brillo) && activo){
+		tardias++;
+		METRICA_CONTAR(flujo_tardias);
+		TRAZA_EVENTO(TRAZA_FLUJO, NUM_DESCARTES, secuencia);
+	}
+
+	/*Un salto hacia atras es un PC que vuelve a empezar, no una perdida*/
+	if (activo){
+		if (salto < 0x8000U){
+			perdidas += salto;
+			METRICA_SUMAR(flujo_perdidas, salto);
+		}
+		if (intervalo_n == 0U || cuenta - ultima_cuenta < intervalo_min)
+			intervalo_min = cuenta - ultima_cuenta;
+		if (cuenta - ultima_cuenta > intervalo_max)
+			intervalo_max = cuenta - ultima_cuenta;
+		intervalo_suma += cuenta - ultima_cuenta;
+		intervalo_n++;
+	}
+	ultima_cuenta = cuenta;
+	secuencia = s;
+	tramas++;
+	METRICA_CONTAR(flujo_tramas);
+	ultima_ms = osKernelGetTickCount();
+	activo = 1;
+}
+
+/**
+  * @brief Filtro de la recepcion de la USART3 que analiza las tramas. Se ejecuta en
+	*				 la interrupcion con cada byte recibido.
+	* @param byte: Byte recibido
+  * @retval 1 si el byte es de una trama, 0 si debe llegar a los comandos
+  */
+static int recibir_Flujo (uint8_t byte){
+	static const uint8_t cabecera[3] = {'A', 'd', 'a'};
+	uint32_t ahora = osKernelGetTickCount();
+	uint32_t a = 0, b = 0, longitud;
+
+	/*Una pausa termina la trama en curso y la resincronizacion*/
+	if ((pos != 0U || saltar != 0U || sincronizando) && ahora - ultimo_byte_ms > FLUJO_PAUSA_MS){
+		if (pos != 0U)
+			descartar(DESCARTE_PAUSA);
+		saltar = 0;
+		sincronizando = 0;
+	}
+	ultimo_byte_ms = ahora;
+
+	/*Carga y suma de una trama descartada*/
+	if (saltar != 0U){
+		saltar--;
+		return 1;
+	}
+
+	/*Un byte que no sigue la cabecera se vuelve a examinar como inicio; fuera de
+		una trama solo llega a los comandos si no hay flujo*/
+	if (pos < sizeof(cabecera) && byte != cabecera[pos])
+		pos = 0;
+	if (pos == 0U && byte != cabecera[0])
+		return (activo || sincronizando) ? 1 : 0;
+	trama[pos++] = byte;
+
+	if (pos == FLUJO_CABECERA){
+		longitud = (uint32_t)trama[3] << 8 | trama[4];
+		if ((trama[3] ^ trama[4] ^ FLUJO_COMPROBACION) != trama[5]){
+			descartar(DESCARTE_CABECERA);
+			saltar = FLUJO_CARGA + 2U;
+		}
+		else if (longitud != FLUJO_CARGA){
+			descartar(DESCARTE_LONGITUD);
+			saltar = (longitud + 2U < FLUJO_SALTO_MAX) ? longitud + 2U : FLUJO_SALTO_MAX;
+		}
+	}
+	else if (pos == FLUJO_TRAMA){
+		for (uint32_t i = FLUJO_CABECERA; i < FLUJO_CABECERA + FLUJO_CARGA; i++){
+			a = (a + trama[i]) % 255U;
+			b = (b + a) % 255U;
+		}
+		if (trama[FLUJO_TRAMA - 2U] != a || trama[FLUJO_TRAMA - 1U] != b)
+			descartar(DESCARTE_SUMA);
+		else {
+			aplicar();
+			pos = 0;
+			sincronizando = 0;
+		}
+	}
+	return 1;
+}
+
+/**
+  * @brief Funcion que conecta el analizador de tramas a la recepcion de la USART3
+	* @param None
+  * @retval None
+  */
+void init_Flujo (void){
+	filtro_USART(recibir_Flujo);
+}
+
+/**
+  * @brief Funcion que indica al hilo de control el inicio y el fin del flujo. Se
+	*				 llama tras cada evento y en cada espera.
+	* @param None
+  * @retval Cambio desde la llamada anterior
+  */
+Flujo_Cambio periodico_Flujo (void){
+	Flujo_Cambio cambio = FLUJO_SIN_CAMBIO;
+	uint32_t primask = __get_PRIMASK();
+
+	/*La interrupcion puede reactivar el flujo entre la comprobacion y el fin*/
+	__disable_irq();
+	if (activo && !anunciado){
+		anunciado = 1;
+		cambio = FLUJO_INICIO;
+	}
+	else if (activo && osKernelGetTickCount() - ultima_ms >= FLUJO_PLAZO_MS){
+		activo = 0;
+		anunciado = 0;
+		cambio = FLUJO_FIN;
+	}
+	__set_PRIMASK(primask);
+	return cambio;
+}
+
+/**
+  * @brief Funcion que indica si el LED lo controla el flujo de color
+	* @param None
+  * @retval 1 si llegan tramas, 0 en caso contrario
+  */
+int activo_Flujo (void){
+	return activo;
+}
+
+/**
+  * @brief Funcion que envia por la USART las tramas recibidas, descartadas,
+	*				 perdidas y tardias y el intervalo minimo, medio y maximo entre tramas
+	* @param None
+  * @retval None
+  */
+void informe_Flujo (void){
+	char buf[100];
+	int size;
+	uint32_t mhz = osKernelGetSysTimerFreq() / 1000000U;
+	uint32_t n, min, max, primask;
+	uint64_t suma;
+
+	size = sprintf(buf, "\r Flujo: %s tramas=%u perdidas=%u tardias=%u secuencia=%u\n",
+								 activo ? "activo" : "inactivo", (unsigned)tramas, (unsigned)perdidas,
+								 (unsigned)tardias, (unsigned)secuencia);
+	tx_USART(buf, size);
+	size = sprintf(buf, "\r Descartadas:");
+	for (uint32_t i = 0; i < NUM_DESCARTES; i++)
+		size += sprintf(&buf[size], " %s=%u", nombres[i], (unsigned)descartes[i]);
+	size += sprintf(&buf[size], "\n");
+	tx_USART(buf, size);
+
+	/*Copia coherente de las medidas que actualiza la interrupcion*/
+	primask = __get_PRIMASK();
+	__disable_irq();
+	n = intervalo_n;
+	min = intervalo_min;
+	max = intervalo_max;
+	suma = intervalo_suma;
+	__set_PRIMASK(primask);
+	if (n == 0U || mhz == 0U)
+		size = sprintf(buf, "\r Intervalo entre tramas: sin medidas\n");
+	else
+		size = sprintf(buf, "\r Intervalo entre tramas: n=%u min=%uus avg=%uus max=%uus\n", (unsigned)n,
+									 (unsigned)(min / mhz), (unsigned)(suma / n / mhz), (unsigned)(max / mhz));
+	tx_USART(buf, size);
+}
+
+#endif
@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Flujo.h
+  * @author  MCD Application Team
+  * @brief   Libreria del flujo de color del PC (ambilight): el PC envia por la
+	*					 USART3 tramas binarias con el brillo de 16 bits de cada color y el
+	*					 firmware las muestra a medida que llegan.
+	*
+	*					 Cada byte recibido pasa por el analizador de tramas en la
+	*					 interrupcion de la USART (filtro_USART); fuera del flujo los que no
+	*					 forman parte de una trama siguen llegando a los comandos del
+	*					 terminal. Mientras el flujo esta activo, y tras una trama
+	*					 descartada hasta una pausa, ningun byte llega a los comandos, de
+	*					 forma que la carga de una trama rota no se ejecuta. Una trama
+	*					 correcta se escribe en los tres CCR a la vez (trama_RGB), que
+	*					 entran en vigor en el siguiente evento de actualizacion de la PWM.
+	*
+	*					 Mientras llegan tramas el LED es del flujo: el hilo de control
+	*					 cancela los efectos y descarta los eventos del usuario. Tras
+	*					 FLUJO_PLAZO_MS sin tramas se vuelve a mostrar el estado de la
+	*					 maquina de estados. Estadisticas con el comando 'F'.
+	*
+	*					 A los 115200 baudios por defecto de la USART caben unas 720
+	*					 tramas por segundo; compilada con USART_BAUDIOS=9600, solo 60. El
+	*					 generador del PC con el que se mide la tasa y el jitter es
+	*					 Simulacion/rgb_flujo.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __FLUJO_H
+#define __FLUJO_H
+
+#include "stm32f4xx_hal.h"
+#include "Placa.h"
+
+/*Habilitacion del flujo de color (0: todos los bytes van a los comandos)*/
+#ifndef FLUJO_ENABLE
+#define FLUJO_ENABLE 1
+#endif
+
+/*Trama (cabecera de Adalight, carga y suma en little-endian):
+		'A' 'd' 'a' longitud_alta longitud_baja comprobacion
+		secuencia(16) brillo[NUM_LEDS](16) fletcher16(16)
+	La comprobacion es longitud_alta ^ longitud_baja ^ 0x55 y la longitud son los
+	bytes de la carga (FLUJO_CARGA). El brillo va de 0 (apagado) a 65535 (maximo),
+	en el orden de PLACA_LEDS. El Fletcher-16 se calcula sobre la carga*/
+#define FLUJO_CABECERA     6U
+#define FLUJO_CARGA        (2U + 2U * NUM_LEDS)
+#define FLUJO_TRAMA        (FLUJO_CABECERA + FLUJO_CARGA + 2U)
+#define FLUJO_COMPROBACION 0x55U
+
+/*Tiempo sin tramas que da por terminado el flujo*/
+#define FLUJO_PLAZO_MS     1000U
+/*Pausa maxima entre dos bytes de una trama: una trama cortada se descarta para
+	que los siguientes caracteres lleguen a los comandos*/
+#define FLUJO_PAUSA_MS     5U
+/*Bytes maximos que se consumen de una trama con longitud incorrecta*/
+#define FLUJO_SALTO_MAX    256U
+
+/*Cambios del flujo que atiende el hilo de control*/
+typedef enum {
+	FLUJO_SIN_CAMBIO,
+	FLUJO_INICIO,
+	FLUJO_FIN
+} Flujo_Cambio;
+
+#if FLUJO_ENABLE
+
+void init_Flujo (void);
+Flujo_Cambio periodico_Flujo (void);
+int activo_Flujo (void);
+void informe_Flujo (void);
+
+#else
+
+#define init_Flujo()         ((void)0)
+#define periodico_Flujo()    FLUJO_SIN_CAMBIO
+#define activo_Flujo()       0
+#define informe_Flujo()      ((void)0)
+
+#endif
+
+#endif /* __FLUJO_H */
@@ -0,0 +1,295 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Grabador.c
+  * @author  MCD Application Team
+  * @brief   Fichero de grabacion y reproduccion de los flancos del joystick.
+	*
+	*					 Cada flanco que recibe el hilo de entrada se guarda en un buffer
+	*					 circular junto al tiempo transcurrido desde el flanco anterior,
+	*					 medido con el contador de ciclos DWT (o con el tick del sistema si
+	*					 han pasado mas de 20 s y el contador ha dado la vuelta).
+	*
+	*					 La reproduccion se realiza desde un hilo propio que inyecta los
+	*					 flancos en el mismo punto en el que lo hace la interrupcion EXTI,
+	*					 esperando el tiempo grabado dividido por la velocidad indicada.
+	*					 Cada flanco lleva su sentido grabado, que fija el nivel del boton,
+	*					 y pasa por la misma mascara EXTI que uno real, por lo que una rafaga
+	*					 reproducida pierde los mismos flancos que la original.
+	*					 Con velocidad GRABADOR_SIN_ESPERA los flancos se inyectan sin
+	*					 esperas para medir el comportamiento ante rafagas de pulsaciones.
+	*					 Mientras se reproduce no se graba y se ignoran las interrupciones
+	*					 reales del joystick.
+	*
+	*					 Formato del volcado por la USART (una linea por flanco):
+	*							G,<delta_us>,<boton>,<flanco>
+	*					 Las mismas lineas se vuelven a cargar en el buffer (comando 'C' de
+	*					 Comandos.c) para reproducir una captura de otra placa o de una
+	*					 sesion anterior.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Grabador.h"
+#include "stm32f4xx_hal.h"
+#include "cmsis_os2.h"
+#include "USART.h"
+#include "Watchdog.h"
+#include "Memoria.h"
+#include "Placa.h"
+
+#define SIG_REPRODUCIR 0x01U
+
+/*Tiempo a partir del cual el contador de ciclos puede haber dado la vuelta*/
+#define GRABADOR_MAX_CICLOS_MS 20000U
+
+static Grabador_Evento eventos[GRABADOR_NUM_EVENTOS];
+static volatile uint32_t grabados = 0;
+static uint32_t ultimo_ciclo;
+static uint32_t ultimo_tick;
+
+static volatile uint8_t reproduciendo = 0;
+static uint32_t velocidad_rep;
+static void (*inyectar_evento)(int boton, int flanco);
+
+static __NO_RETURN void reproductor (void *arg);
+static osThreadId_t tid_reproductor;
+static const osThreadAttr_t reproductor_attr = {
+	.name = "reproductor",
+	MEMORIA_HILO_ATTR(reproductor)
+};
+
+/**
+  * @brief Funcion de inicializacion del grabador donde se crea el hilo de reproduccion
+	* @param inyectar: Funcion que introduce un flanco (boton y sentido) en el hilo de
+	*				 entrada
+  * @retval None
+  */
+void init_Grabador (void (*inyectar)(int boton, int flanco)){
+	inyectar_evento = inyectar;
+	tid_reproductor = osThreadNew(reproductor, NULL, &reproductor_attr);
+}
+
+/**
+  * @brief Funcion que guarda un flanco en el buffer circular. Se llama desde la
+	*				 interrupcion EXTI por lo que no se bloquea.
+	* @param boton: Indice del boton que genera el flanco
+	* @param flanco: 1 si es de subida, 0 si es de bajada
+  * @retval None
+  */
+void grabar_Grabador (int boton, int flanco){
+	uint32_t ciclo = DWT->CYCCNT;
+	uint32_t tick = osKernelGetTickCount();
+	Grabador_Evento *e;
+
+	if (reproduciendo)
+		return;
+
+	e = &eventos[grabados & (GRABADOR_NUM_EVENTOS - 1U)];
+	if (grabados == 0U)
+		e->delta_us = 0;
+	else if (tick - ultimo_tick > GRABADOR_MAX_CICLOS_MS)
+		e->delta_us = (tick - ultimo_tick) * 1000U;
+	else
+		e->delta_us = (ciclo - ultimo_ciclo) / (SystemCoreClock / 1000000U);
+	e->boton = (uint8_t)boton;
+	e->flanco = (uint8_t)flanco;
+	ultimo_ciclo = ciclo;
+	ultimo_tick = tick;
+	grabados++;
+}
+
+/**
+  * @brief Funcion que indica si hay una reproduccion en curso
+	* @param None
+  * @retval 1 si se estan inyectando flancos grabados, 0 en caso contrario
+  */
+int reproduciendo_Grabador (void){
+	return reproduciendo;
+}
+
+/**
+  * @brief Funcion que lanza la reproduccion de los flancos grabados
+	* @param velocidad: Factor de aceleracion (1: tiempo original, GRABADOR_SIN_ESPERA: sin esperas)
+  * @retval None
+  */
+void reproducir_Grabador (uint32_t velocidad){
+	if (reproduciendo)
+		return;
+	velocidad_rep = velocidad;
+	osThreadFlagsSet(tid_reproductor, SIG_REPRODUCIR);
+}
+
+/**
+  * @brief Funcion que inyecta una traza de flancos respetando los tiempos entre ellos
+	*				 divididos por la velocidad. El primer flanco se inyecta inmediatamente.
+	* @param traza: Flancos a inyectar
+	* @param num: Numero de flancos de la traza
+	* @param velocidad: Factor de aceleracion (GRABADOR_SIN_ESPERA: sin esperas)
+  * @retval Numero de flancos inyectados
+  */
+uint32_t reproducir_Traza (const Grabador_Evento *traza, uint32_t num, uint32_t velocidad){
+	uint32_t espera_us = 0;
+
+	for (uint32_t i = 0; i < num; i++){
+		if (i > 0U && velocidad != GRABADOR_SIN_ESPERA){
+			/*Se acumula el resto para que el redondeo a ms no produzca deriva*/
+			espera_us += traza[i].delta_us / velocidad;
+			if (espera_us >= 1000U){
+				osDelay(espera_us / 1000U);
+				espera_us %= 1000U;
+			}
+		}
+		inyectar_evento(traza[i].boton, traza[i].flanco);
+	}
+	return num;
+}
+
+/**
+  * @brief Hilo de reproduccion que inyecta el contenido del buffer circular desde el
+	*				 flanco mas antiguo y envia por la USART el tiempo empleado.
+	* @param arg
+  * @retval None
+  */
+static __NO_RETURN void reproductor (void *arg){
+	char buf[100];
+	int size;
+	uint32_t num, primero, inicio, n;
+
+	(void)arg;
+	while (1){
+		osThreadFlagsWait(SIG_REPRODUCIR, osFlagsWaitAny, osWaitForever);
+		reproduciendo = 1;
+
+		num = (grabados < GRABADOR_NUM_EVENTOS) ? grabados : GRABADOR_NUM_EVENTOS;
+		primero = grabados - num;
+		inicio = osKernelGetTickCount();
+		n = 0;
+		/*El buffer circular se reproduce en dos tramos contiguos*/
+		while (n < num){
+			uint32_t idx = (primero + n) & (GRABADOR_NUM_EVENTOS - 1U);
+			uint32_t tramo = GRABADOR_NUM_EVENTOS - idx;
+			if (tramo > num - n)
+				tramo = num - n;
+			n += reproducir_Traza(&eventos[idx], tramo, velocidad_rep);
+		}
+
+		reproduciendo = 0;
+		size = sprintf(buf, "\r Reproduccion: %u flancos en %u ms\n",
+									 (unsigned)num, (unsigned)(osKernelGetTickCount() - inicio));
+		tx_USART(buf, size);
+	}
+}
+
+/**
+  * @brief Funcion que envia por la USART los flancos grabados, del mas antiguo al
+	*				 mas reciente.
+	* @param None
+  * @retval None
+  */
+void volcar_Grabador (void){
+	char buf[40];
+	int size;
+	uint32_t total = grabados;
+	uint32_t num = (total < GRABADOR_NUM_EVENTOS) ? total : GRABADOR_NUM_EVENTOS;
+	const Grabador_Evento *e;
+
+	size = sprintf(buf, "\r Grabador: %u flancos\n", (unsigned)num);
+	tx_USART(buf, size);
+	for (uint32_t i = total - num; i != total; i++){
+		e = &eventos[i & (GRABADOR_NUM_EVENTOS - 1U)];
+		size = sprintf(buf, "G,%u,%u,%u\n", (unsigned)e->delta_us, e->boton, e->flanco);
+		tx_USART(buf, size);
+		/*Los 256 flancos tardan unos 0.3 s a 115200 baudios, mas que la ventana del
+			IWDG, y cerca de 4 s con USART_BAUDIOS=9600*/
+		reset_Watchdog();
+	}
+}
+
+/**
+  * @brief Funcion que descarta los flancos grabados
+	* @param None
+  * @retval None
+  */
+void borrar_Grabador (void){
+	grabados = 0;
+}
+
+/**
+  * @brief Funcion que lee un numero decimal sin signo de 32 bits
+	* @param p: Cursor en el texto, que avanza hasta el primer caracter no numerico
+	* @param valor: Numero leido
+  * @retval 0 si es correcto, -1 si no hay digitos o no cabe en 32 bits
+  */
+static int leer_Numero (const char **p, uint32_t *valor){
+	const char *c = *p;
+	uint64_t v = 0;
+
+	if (*c < '0' || *c > '9')
+		return -1;
+	while (*c >= '0' && *c <= '9'){
+		v = 10U * v + (uint64_t)(*c - '0');
+		if (v > 0xFFFFFFFFU)
+			return -1;
+		c++;
+	}
+	*valor = (uint32_t)v;
+	*p = c;
+	return 0;
+}
+
+/**
+  * @brief Funcion que interpreta una linea del volcado (G,<delta_us>,<boton>,<flanco>).
+	*				 Se admiten espacios y fin de linea al final.
+	* @param linea: Texto de la linea terminado en '\0'
+	* @param e: Flanco leido
+  * @retval 0 si es correcta, -1 en caso contrario
+  */
+int leer_Grabador (const char *linea, Grabador_Evento *e){
+	const char *c = linea + 2;
+	uint32_t delta, boton, flanco;
+
+	if (linea[0] != 'G' || linea[1] != ',' ||
+			leer_Numero(&c, &delta) != 0 || *c++ != ',' ||
+			leer_Numero(&c, &boton) != 0 || *c++ != ',' ||
+			leer_Numero(&c, &flanco) != 0)
+		return -1;
+	while (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n')
+		c++;
+	if (*c != '\0' || boton >= NUM_BOTONES || flanco > 1U)
+		return -1;
+	e->delta_us = delta;
+	e->boton = (uint8_t)boton;
+	e->flanco = (uint8_t)flanco;
+	e->reservado = 0;
+	return 0;
+}
+
+/**
+  * @brief Funcion que anade un flanco al final del buffer circular como si se hubiera
+	*				 grabado. Los flancos reales que lleguen despues miden su tiempo desde
+	*				 este.
+	* @param e: Flanco a anadir
+  * @retval 0 si se anade, -1 si hay una reproduccion en curso
+  */
+int cargar_Grabador (const Grabador_Evento *e){
+	uint32_t ciclo = DWT->CYCCNT;
+	uint32_t tick = osKernelGetTickCount();
+	uint32_t primask;
+
+	if (reproduciendo)
+		return -1;
+	/*La interrupcion EXTI tambien escribe en el buffer*/
+	primask = __get_PRIMASK();
+	__disable_irq();
+	eventos[grabados & (GRABADOR_NUM_EVENTOS - 1U)] = *e;
+	ultimo_ciclo = ciclo;
+	ultimo_tick = tick;
+	grabados++;
+	__set_PRIMASK(primask);
+	return 0;
+}
@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Grabador.h
+  * @author  MCD Application Team
+  * @brief   Libreria de grabacion y reproduccion de los flancos del joystick.
+	*					 Los flancos que llegan al hilo de entrada se guardan con su marca
+	*					 de tiempo en un buffer circular en RAM que se puede volcar por la
+	*					 USART, volver a cargar desde el volcado y volver a inyectar en el
+	*					 hilo a la velocidad original o acelerada.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __GRABADOR_H
+#define __GRABADOR_H
+
+#include <stdint.h>
+
+/*Numero de flancos que se guardan (potencia de 2)*/
+#define GRABADOR_NUM_EVENTOS 256U
+
+/*Velocidad de reproduccion que inyecta los flancos sin esperas*/
+#define GRABADOR_SIN_ESPERA  0U
+
+typedef struct {
+	uint32_t delta_us;		/*Tiempo desde el flanco anterior*/
+	uint8_t boton;				/*Indice del boton en la tabla de la placa*/
+	uint8_t flanco;				/*1: subida (pulsacion), 0: bajada*/
+	uint16_t reservado;
+} Grabador_Evento;
+
+void init_Grabador (void (*inyectar)(int boton, int flanco));
+void grabar_Grabador (int boton, int flanco);
+int reproduciendo_Grabador (void);
+void reproducir_Grabador (uint32_t velocidad);
+void volcar_Grabador (void);
+void borrar_Grabador (void);
+int leer_Grabador (const char *linea, Grabador_Evento *e);
+int cargar_Grabador (const Grabador_Evento *e);
+uint32_t reproducir_Traza (const Grabador_Evento *traza, uint32_t num, uint32_t velocidad);
+
+#endif /* __GRABADOR_H */
@@ -0,0 +1,207 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Latencia.c
+  * @author  MCD Application Team
+  * @brief   Fichero de medida de la latencia desde la interrupcion del joystick
+	*					 hasta la escritura del registro CCR del LED RGB.
+	*
+	*					 Cada medida completa (ISR, despertar del hilo, decision y CCR) se
+	*					 acumula en un histograma por etapa con minimo, media, maximo y
+	*					 percentil 99. Los histogramas son logaritmicos con 4 subdivisiones
+	*					 por potencia de 2, de forma que el indice de la cubeta se calcula
+	*					 con una instruccion CLZ y el error del percentil es menor del 25%.
+	*
+	*					 La medida se cierra desde el hilo (cerrar_Latencia) por lo que los
+	*					 histogramas solo se modifican desde un unico contexto. Al cerrarla
+	*					 cada etapa se pasa a nanosegundos con la frecuencia actual, y
+	*					 Reloj.c descarta con reloj_Latencia la medida abierta antes de cada
+	*					 cambio de nivel, ya que sus marcas tendrian ciclos de dos
+	*					 frecuencias.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Latencia.h"
+
+#if LATENCIA_ENABLE
+
+#include <stdio.h>
+#include <string.h>
+#include "USART.h"
+#include "Watchdog.h"
+
+#define LAT_NUM_CUBETAS 124
+
+typedef struct {
+	uint32_t n;
+	uint32_t min;
+	uint32_t max;
+	uint64_t suma;
+	uint32_t cubetas[LAT_NUM_CUBETAS];
+} Histograma;
+
+volatile uint32_t lat_marcas[LAT_NUM_MARCAS];
+volatile uint32_t lat_mascara = 0;
+
+static Histograma histogramas[LAT_NUM_ETAPAS];
+
+static const char * const nombres[LAT_NUM_ETAPAS] = {
+	"ISR->hilo",
+	"hilo->decision",
+	"decision->CCR",
+	"ISR->CCR"
+};
+
+/**
+  * @brief Funcion que calcula la cubeta del histograma para una duracion.
+	*				 Las 4 primeras cubetas son exactas y a partir de ahi cada potencia
+	*				 de 2 se divide en 4 cubetas.
+	* @param ns: Duracion medida
+  * @retval Indice de la cubeta
+  */
+static uint32_t cubeta (uint32_t ns){
+	uint32_t msb;
+
+	if (ns < 4U)
+		return ns;
+	msb = 31U - __CLZ(ns);
+	return ((msb - 1U) << 2) + ((ns >> (msb - 2U)) & 3U);
+}
+
+/**
+  * @brief Funcion que devuelve el limite superior (en ns) de una cubeta
+	* @param i: Indice de la cubeta
+  * @retval Mayor duracion que cae en la cubeta
+  */
+static uint32_t limite_cubeta (uint32_t i){
+	uint32_t msb;
+
+	if (i < 4U)
+		return i;
+	msb = (i >> 2) + 1U;
+	return (((4U + (i & 3U)) + 1U) << (msb - 2U)) - 1U;
+}
+
+static void acumular (Histograma *h, uint32_t ciclos, uint32_t mhz){
+	uint32_t ns = (uint32_t)((uint64_t)ciclos * 1000U / mhz);
+
+	if (h->n == 0U || ns < h->min)
+		h->min = ns;
+	if (ns > h->max)
+		h->max = ns;
+	h->n++;
+	h->suma += ns;
+	h->cubetas[cubeta(ns)]++;
+}
+
+static uint32_t percentil_99 (const Histograma *h){
+	uint32_t objetivo = h->n - h->n / 100U;
+	uint32_t acumulado = 0;
+	uint32_t lim;
+
+	for (uint32_t i = 0; i < LAT_NUM_CUBETAS; i++){
+		acumulado += h->cubetas[i];
+		if (acumulado >= objetivo){
+			lim = limite_cubeta(i);
+			return (lim > h->max) ? h->max : lim;
+		}
+	}
+	return h->max;
+}
+
+/**
+  * @brief Funcion de inicializacion del contador de ciclos DWT CYCCNT que se
+	*				 utiliza como base de tiempos de las marcas.
+	* @param None
+  * @retval None
+  */
+void init_Latencia (void){
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	reset_Latencia();
+}
+
+/**
+  * @brief Funcion que cierra la medida en curso. Si se han registrado las cuatro
+	*				 marcas se acumulan las etapas en los histogramas. Se llama desde el
+	*				 hilo despues de tratar cada evento.
+	* @param None
+  * @retval None
+  */
+void cerrar_Latencia (void){
+	uint32_t m[LAT_NUM_MARCAS];
+	uint32_t mhz = SystemCoreClock / 1000000U;
+
+	if (lat_mascara != ((1U << LAT_NUM_MARCAS) - 1U))
+		return;
+
+	__disable_irq();
+	for (int i = 0; i < LAT_NUM_MARCAS; i++)
+		m[i] = lat_marcas[i];
+	lat_mascara = 0;
+	__enable_irq();
+
+	acumular(&histogramas[LAT_ETAPA_ISR_HILO], m[LAT_DESPIERTA] - m[LAT_ISR], mhz);
+	acumular(&histogramas[LAT_ETAPA_HILO_DECISION], m[LAT_DECISION] - m[LAT_DESPIERTA], mhz);
+	acumular(&histogramas[LAT_ETAPA_DECISION_CCR], m[LAT_CCR] - m[LAT_DECISION], mhz);
+	acumular(&histogramas[LAT_ETAPA_TOTAL], m[LAT_CCR] - m[LAT_ISR], mhz);
+}
+
+/**
+  * @brief Funcion que descarta la medida en curso antes de un cambio de nivel del
+	*				 reloj. La llama Reloj.c con las interrupciones deshabilitadas.
+	* @param None
+  * @retval None
+  */
+void reloj_Latencia (void){
+	lat_mascara = 0;
+}
+
+/**
+  * @brief Funcion que pone a cero los histogramas de latencia
+	* @param None
+  * @retval None
+  */
+void reset_Latencia (void){
+	lat_mascara = 0;
+	memset(histogramas, 0, sizeof(histogramas));
+}
+
+/**
+  * @brief Funcion que envia por la USART el minimo, la media, el maximo y el
+	*				 percentil 99 de cada etapa en microsegundos.
+	* @param None
+  * @retval None
+  */
+void informe_Latencia (void){
+	char buf[100];
+	int size;
+	const Histograma *h;
+
+	for (int i = 0; i < LAT_NUM_ETAPAS; i++){
+		h = &histogramas[i];
+		if (h->n == 0U){
+			size = sprintf(buf, "\r %s: sin medidas\n", nombres[i]);
+		}
+		else {
+			size = sprintf(buf, "\r %s: n=%u min=%uus avg=%uus max=%uus p99=%uus\n", nombres[i],
+										 (unsigned)h->n,
+										 (unsigned)(h->min / 1000U),
+										 (unsigned)((h->suma / h->n) / 1000U),
+										 (unsigned)(h->max / 1000U),
+										 (unsigned)(percentil_99(h) / 1000U));
+		}
+		tx_USART(buf, size);
+		/*Cada linea tarda unos 6 ms a 115200 baudios y hasta 70 ms en el peor caso,
+			la compilacion con USART_BAUDIOS=9600*/
+		reset_Watchdog();
+	}
+}
+
+#endif
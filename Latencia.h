@@ -0,0 +1,76 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Latencia.h
+  * @author  MCD Application Team
+  * @brief   Libreria de medida de la latencia entre la pulsacion del joystick
+	*					 y la escritura del registro CCR del LED RGB. Se toman marcas del
+	*					 contador de ciclos DWT CYCCNT en cuatro puntos:
+	*							- Entrada a la rutina de interrupcion EXTI
+	*							- Despertar del hilo que gestiona la pulsacion
+	*							- Decision de la accion a realizar
+	*							- Escritura del registro CCR
+	*
+	*					 Con LATENCIA_ENABLE a 0 las marcas no generan codigo.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __LATENCIA_H
+#define __LATENCIA_H
+
+#include "stm32f4xx_hal.h"
+
+/*Habilitacion de las sondas de latencia (0: sin coste en el camino critico)*/
+#ifndef LATENCIA_ENABLE
+#define LATENCIA_ENABLE 1
+#endif
+
+/*Puntos de medida*/
+#define LAT_ISR        0
+#define LAT_DESPIERTA  1
+#define LAT_DECISION   2
+#define LAT_CCR        3
+#define LAT_NUM_MARCAS 4
+
+/*Etapas medidas entre marcas consecutivas y latencia total ISR->CCR*/
+#define LAT_ETAPA_ISR_HILO       0
+#define LAT_ETAPA_HILO_DECISION  1
+#define LAT_ETAPA_DECISION_CCR   2
+#define LAT_ETAPA_TOTAL          3
+#define LAT_NUM_ETAPAS           4
+
+#if LATENCIA_ENABLE
+
+extern volatile uint32_t lat_marcas[LAT_NUM_MARCAS];
+extern volatile uint32_t lat_mascara;
+
+/*La marca de la ISR abre una nueva medida y descarta las marcas anteriores*/
+#define LATENCIA_ISR()      do { lat_marcas[LAT_ISR] = DWT->CYCCNT; lat_mascara = 1U << LAT_ISR; } while (0)
+/*El resto de marcas solo se registran si hay una medida abierta*/
+#define LATENCIA_MARCA(m)   do { if (lat_mascara != 0U) { lat_marcas[(m)] = DWT->CYCCNT; lat_mascara |= 1U << (m); } } while (0)
+
+void init_Latencia (void);
+void cerrar_Latencia (void);
+void reloj_Latencia (void);
+void reset_Latencia (void);
+void informe_Latencia (void);
+
+#else
+
+#define LATENCIA_ISR()      ((void)0)
+#define LATENCIA_MARCA(m)   ((void)0)
+
+#define init_Latencia()     ((void)0)
+#define cerrar_Latencia()   ((void)0)
+#define reloj_Latencia()    ((void)0)
+#define reset_Latencia()    ((void)0)
+#define informe_Latencia()  ((void)0)
+
+#endif
+
+#endif /* __LATENCIA_H */
@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Memoria.c
+  * @author  MCD Application Team
+  * @brief   Fichero de reserva estatica de los objetos del RTX declarados en
+	*					 Memoria.h. Los nombres de las secciones son los que usa el RTX
+	*					 para sus propios objetos, de forma que el visor de componentes y el
+	*					 fichero de mapa los agrupan con los del sistema operativo.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Memoria.h"
+#include "USART.h"
+#include "Watchdog.h"
+
+#define MEMORIA_DEF_HILO(nombre, pila) \
+	osRtxThread_t memoria_tcb_##nombre __attribute__((section(".bss.os.thread.cb"))); \
+	uint64_t memoria_stk_##nombre[(pila) / 8] __attribute__((section(".bss.os.thread.stack")));
+#define MEMORIA_DEF_COLA(nombre, num, tam) \
+	osRtxMessageQueue_t memoria_qcb_##nombre __attribute__((section(".bss.os.msgqueue.cb"))); \
+	uint32_t memoria_mq_##nombre[osRtxMessageQueueMemSize(num, tam) / 4] __attribute__((section(".bss.os.msgqueue.mem")));
+#define MEMORIA_DEF_TEMPORIZADOR(nombre) \
+	osRtxTimer_t memoria_tmr_##nombre __attribute__((section(".bss.os.timer.cb")));
+MEMORIA_HILOS(MEMORIA_DEF_HILO)
+MEMORIA_COLAS(MEMORIA_DEF_COLA)
+MEMORIA_TEMPORIZADORES(MEMORIA_DEF_TEMPORIZADOR)
+
+/*RAM total de los objetos, calculada en compilacion*/
+#define MEMORIA_SUMA_HILO(nombre, pila)       + osRtxThreadCbSize + (pila)
+#define MEMORIA_SUMA_COLA(nombre, num, tam)   + osRtxMessageQueueCbSize + osRtxMessageQueueMemSize(num, tam)
+#define MEMORIA_SUMA_TEMPORIZADOR(nombre)     + osRtxTimerCbSize
+#define MEMORIA_TOTAL (0U MEMORIA_HILOS(MEMORIA_SUMA_HILO) MEMORIA_COLAS(MEMORIA_SUMA_COLA) \
+											 MEMORIA_TEMPORIZADORES(MEMORIA_SUMA_TEMPORIZADOR))
+
+COMPROBAR(MEMORIA_TOTAL <= MEMORIA_PRESUPUESTO, presupuesto);
+#define MEMORIA_COMPROBAR_PILA(nombre, pila)	COMPROBAR((pila) % 8 == 0, pila_##nombre);
+MEMORIA_HILOS(MEMORIA_COMPROBAR_PILA)
+
+typedef struct {
+	const char *nombre;
+	const char *tipo;
+	uint32_t control;			/*Bytes del bloque de control*/
+	uint32_t datos;				/*Bytes de pila o de buffer de mensajes*/
+} Objeto;
+
+#define MEMORIA_TABLA_HILO(nombre, pila) \
+	{ #nombre, "hilo", osRtxThreadCbSize, (pila) },
+#define MEMORIA_TABLA_COLA(nombre, num, tam) \
+	{ #nombre, "cola", osRtxMessageQueueCbSize, osRtxMessageQueueMemSize(num, tam) },
+#define MEMORIA_TABLA_TEMPORIZADOR(nombre) \
+	{ #nombre, "temp", osRtxTimerCbSize, 0 },
+static const Objeto objetos[] = {
+	MEMORIA_HILOS(MEMORIA_TABLA_HILO)
+	MEMORIA_COLAS(MEMORIA_TABLA_COLA)
+	MEMORIA_TEMPORIZADORES(MEMORIA_TABLA_TEMPORIZADOR)
+};
+
+#define NUM_OBJETOS (sizeof(objetos) / sizeof(objetos[0]))
+
+/**
+  * @brief Funcion que envia por la USART la RAM de cada objeto del RTX (bloque de
+	*				 control y datos) y el total frente al presupuesto.
+	* @param None
+  * @retval None
+  */
+void informe_Memoria (void){
+	char buf[100];
+	int size;
+
+	for (unsigned i = 0; i < NUM_OBJETOS; i++){
+		size = sprintf(buf, "\r %-11s %s: control=%u datos=%u total=%u\n", objetos[i].nombre,
+									 objetos[i].tipo, (unsigned)objetos[i].control, (unsigned)objetos[i].datos,
+									 (unsigned)(objetos[i].control + objetos[i].datos));
+		tx_USART(buf, size);
+		reset_Watchdog();
+	}
+	size = sprintf(buf, "\r Total RTX: %u de %u bytes\n", (unsigned)MEMORIA_TOTAL,
+								 (unsigned)MEMORIA_PRESUPUESTO);
+	tx_USART(buf, size);
+}
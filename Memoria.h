@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Memoria.h
+  * @author  MCD Application Team
+  * @brief   Libreria de asignacion estatica de los objetos del RTX. Todos los
+	*					 hilos, colas y temporizadores de la aplicacion se declaran en las
+	*					 listas de este fichero, que son la unica fuente de sus tamanos.
+	*					 A partir de ellas:
+	*							- Memoria.c reserva los bloques de control, pilas y buffers en
+	*								las secciones .bss.os.* del RTX, por lo que el fichero de
+	*								mapa (Listings/RGB.map) muestra la RAM de cada objeto
+	*							- Se comprueba en compilacion que el total no supera
+	*								MEMORIA_PRESUPUESTO
+	*							- Cada modulo obtiene los campos de memoria de sus atributos con
+	*								MEMORIA_HILO_ATTR, MEMORIA_COLA_ATTR y MEMORIA_TEMPORIZADOR_ATTR
+	*
+	*					 Con todos los objetos estaticos OS_DYNAMIC_MEM_SIZE es 0, de forma
+	*					 que un objeto creado sin memoria propia falla en el arranque en
+	*					 lugar de depender del estado del heap del RTX. Los mutex que la
+	*					 libreria C crea antes de main (stdio y heap) no tienen memoria
+	*					 propia y salen del conjunto de OS_MUTEX_NUM de RTX_Config.h.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __MEMORIA_H
+#define __MEMORIA_H
+
+#include "cmsis_os2.h"
+#include "rtx_os.h"
+#include "Comprobar.h"
+
+/*RAM maxima para los objetos del RTX de la aplicacion (bloques de control y datos)*/
+#define MEMORIA_PRESUPUESTO 8192U
+
+/*Hilos: HILO(nombre, pila en bytes). Las pilas se ajustan con el comando 'p'*/
+#define MEMORIA_HILOS(HILO) \
+	HILO(app_main,    1024) \
+	HILO(supervisor,  512)  \
+	HILO(reproductor, 768)  \
+	HILO(entrada,     768)  \
+	HILO(control,     1024) \
+	HILO(salida,      2048)
+
+/*Colas de mensajes: COLA(nombre, numero de mensajes, bytes por mensaje)*/
+#define MEMORIA_COLAS(COLA) \
+	COLA(eventos,   16, 4)  \
+	COLA(registros, 8,  64)
+
+/*Temporizadores: TEMPORIZADOR(nombre)*/
+#define MEMORIA_TEMPORIZADORES(TEMPORIZADOR) \
+	TEMPORIZADOR(efectos) \
+	TEMPORIZADOR(fallo)
+
+/*Bloques de control, pilas y buffers definidos en Memoria.c*/
+#define MEMORIA_EXTERN_HILO(nombre, pila) \
+	extern osRtxThread_t memoria_tcb_##nombre; \
+	extern uint64_t memoria_stk_##nombre[(pila) / 8];
+#define MEMORIA_EXTERN_COLA(nombre, num, tam) \
+	extern osRtxMessageQueue_t memoria_qcb_##nombre; \
+	extern uint32_t memoria_mq_##nombre[osRtxMessageQueueMemSize(num, tam) / 4];
+#define MEMORIA_EXTERN_TEMPORIZADOR(nombre) \
+	extern osRtxTimer_t memoria_tmr_##nombre;
+MEMORIA_HILOS(MEMORIA_EXTERN_HILO)
+MEMORIA_COLAS(MEMORIA_EXTERN_COLA)
+MEMORIA_TEMPORIZADORES(MEMORIA_EXTERN_TEMPORIZADOR)
+
+/*Numero de mensajes y bytes por mensaje de cada cola: MEMORIA_NUM_eventos...*/
+#define MEMORIA_ENUM_COLA(nombre, num, tam)	MEMORIA_NUM_##nombre = (num), MEMORIA_TAM_##nombre = (tam),
+enum {
+	MEMORIA_COLAS(MEMORIA_ENUM_COLA)
+};
+
+/*Campos de memoria de osThreadAttr_t, osMessageQueueAttr_t y osTimerAttr_t*/
+#define MEMORIA_HILO_ATTR(nombre) \
+	.cb_mem     = &memoria_tcb_##nombre, \
+	.cb_size    = sizeof(memoria_tcb_##nombre), \
+	.stack_mem  = &memoria_stk_##nombre[0], \
+	.stack_size = sizeof(memoria_stk_##nombre)
+#define MEMORIA_COLA_ATTR(nombre) \
+	.cb_mem     = &memoria_qcb_##nombre, \
+	.cb_size    = sizeof(memoria_qcb_##nombre), \
+	.mq_mem     = &memoria_mq_##nombre[0], \
+	.mq_size    = sizeof(memoria_mq_##nombre)
+#define MEMORIA_TEMPORIZADOR_ATTR(nombre) \
+	.cb_mem     = &memoria_tmr_##nombre, \
+	.cb_size    = sizeof(memoria_tmr_##nombre)
+
+void informe_Memoria (void);
+
+#endif /* __MEMORIA_H */
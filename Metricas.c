@@ -0,0 +1,116 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Metricas.c
+  * @author  MCD Application Team
+  * @brief   Fichero del registro de metricas de funcionamiento. La tabla de
+	*					 valores y los tipos de cada metrica se generan a partir de la
+	*					 lista METRICAS_LISTA de Metricas.h.
+	*
+	*					 El volcado copia la tabla palabra a palabra, por lo que cada valor
+	*					 es coherente aunque se actualice desde una interrupcion durante la
+	*					 copia; las cubetas de un histograma pueden diferir en una cuenta
+	*					 de su suma. El decodificador del PC es Simulacion/rgb_metricas.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Metricas.h"
+
+#if METRICAS_ENABLE
+
+#include "cmsis_os2.h"
+#include "USART.h"
+#include "Watchdog.h"
+
+#define TIPO_CONTADOR(n)    METRICAS_TIPO_CONTADOR,
+#define TIPO_MEDIDOR(n)     METRICAS_TIPO_MEDIDOR,
+#define TIPO_HISTOGRAMA(n)  METRICAS_TIPO_HISTOGRAMA,
+static const uint8_t tipos[] = {
+	METRICAS_LISTA(TIPO_CONTADOR, TIPO_MEDIDOR, TIPO_HISTOGRAMA)
+};
+
+#define NUM_METRICAS  (sizeof(tipos) / sizeof(tipos[0]))
+/*Cabecera, tipos, valores y suma de comprobacion*/
+#define TAM_TRAMA     (10U + NUM_METRICAS + 4U * MET_NUM_VALORES + 2U)
+
+volatile uint32_t metricas_valores[MET_NUM_VALORES];
+
+static uint8_t trama[TAM_TRAMA];
+
+/**
+  * @brief Funcion que habilita el contador de ciclos con el que se mide el tiempo
+	*				 de bloqueo de la USART
+	* @param None
+  * @retval None
+  */
+void init_Metricas (void){
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+  * @brief Funcion que escribe una palabra en little-endian
+	* @param p: Destino
+	* @param v: Valor
+  * @retval Posicion siguiente
+  */
+static uint8_t *escribir_32 (uint8_t *p, uint32_t v){
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+	return p + 4;
+}
+
+/**
+  * @brief Funcion que calcula la suma de comprobacion Fletcher-16
+	* @param p: Datos
+	* @param n: Numero de bytes
+  * @retval Suma (segundo acumulador en el byte alto)
+  */
+static uint16_t fletcher16 (const uint8_t *p, uint32_t n){
+	uint32_t a = 0, b = 0;
+
+	while (n-- != 0U){
+		a = (a + *p++) % 255U;
+		b = (b + a) % 255U;
+	}
+	return (uint16_t)((b << 8) | a);
+}
+
+/**
+  * @brief Funcion que envia por la USART una trama con el valor de todas las
+	*				 metricas (formato en Metricas.h)
+	* @param None
+  * @retval None
+  */
+void volcar_Metricas (void){
+	uint8_t *p = trama;
+	uint16_t suma;
+
+	*p++ = 'M';
+	*p++ = 'T';
+	*p++ = METRICAS_VERSION;
+	*p++ = (uint8_t)NUM_METRICAS;
+	*p++ = (uint8_t)MET_NUM_VALORES;
+	*p++ = (uint8_t)(MET_NUM_VALORES >> 8);
+	p = escribir_32(p, osKernelGetTickCount());
+	for (uint32_t i = 0; i < NUM_METRICAS; i++)
+		*p++ = tipos[i];
+	for (uint32_t i = 0; i < MET_NUM_VALORES; i++)
+		p = escribir_32(p, metricas_valores[i]);
+	suma = fletcher16(&trama[2], (uint32_t)(p - &trama[2]));
+	*p++ = (uint8_t)suma;
+	*p++ = (uint8_t)(suma >> 8);
+
+	reset_Watchdog();
+	tx_USART((char *)trama, (int)(p - trama));
+	reset_Watchdog();
+}
+
+#endif
@@ -0,0 +1,146 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Metricas.h
+  * @author  MCD Application Team
+  * @brief   Registro de metricas de funcionamiento que se vuelca en binario por
+	*					 la USART (comando 'M'). Hay tres tipos de metricas:
+	*							- Contador: valor que solo crece (pulsaciones, bytes...)
+	*							- Medidor: ultimo valor o maximo observado
+	*							- Histograma: METRICAS_CUBETAS cubetas de potencias de 2 y la
+	*								suma de los valores registrados
+	*
+	*					 Todas las metricas son palabras de 32 bits de una tabla estatica.
+	*					 Las actualizaciones son un bucle LDREX/STREX sin bloqueos, por lo
+	*					 que se pueden llamar desde cualquier hilo o interrupcion y cuestan
+	*					 pocos ciclos (un contador: carga, suma, almacenamiento y salto).
+	*
+	*					 Con METRICAS_ENABLE a 0 las actualizaciones no generan codigo.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __METRICAS_H
+#define __METRICAS_H
+
+#include "stm32f4xx_hal.h"
+
+/*Habilitacion del registro de metricas (0: sin coste en el camino critico)*/
+#ifndef METRICAS_ENABLE
+#define METRICAS_ENABLE 1
+#endif
+
+/*Metricas: CONTADOR(nombre), MEDIDOR(nombre) o HISTOGRAMA(nombre). El orden
+	de la lista es el del volcado binario*/
+#define METRICAS_LISTA(CONTADOR, MEDIDOR, HISTOGRAMA) \
+	CONTADOR(flancos)                 \
+	CONTADOR(pulsaciones)             \
+	CONTADOR(rebotes_filtrados)       \
+	CONTADOR(usart_bytes)             \
+	HISTOGRAMA(usart_bloqueo_us)      \
+	MEDIDOR(watchdog_margen_ms)       \
+	MEDIDOR(watchdog_retraso_max_ms)  \
+	CONTADOR(autotest_alarmas)        \
+	CONTADOR(energia_limitaciones)    \
+	CONTADOR(flujo_tramas)            \
+	CONTADOR(flujo_perdidas)          \
+	CONTADOR(flujo_tardias)
+
+/*Cubetas de un histograma: la 0 para el valor 0, la i para [2^(i-1), 2^i) y
+	la ultima para el resto*/
+#define METRICAS_CUBETAS  16U
+
+/*Tipos de metrica en el volcado*/
+#define METRICAS_TIPO_CONTADOR    1U
+#define METRICAS_TIPO_MEDIDOR     2U
+#define METRICAS_TIPO_HISTOGRAMA  3U
+
+/*Trama del volcado (little-endian):
+		'M' 'T' version num_metricas num_valores(16) tick_ms(32)
+		tipo[num_metricas] valor[num_valores](32) fletcher16(16)
+	El Fletcher-16 se calcula desde la version hasta el ultimo valor*/
+#define METRICAS_VERSION   1U
+
+/*Posicion de cada metrica en la tabla de valores: MET_flancos...*/
+#define METRICAS_POS_CONTADOR(n)    MET_##n,
+#define METRICAS_POS_MEDIDOR(n)     MET_##n,
+#define METRICAS_POS_HISTOGRAMA(n)  MET_##n, MET_##n##_suma = MET_##n + METRICAS_CUBETAS,
+enum {
+	METRICAS_LISTA(METRICAS_POS_CONTADOR, METRICAS_POS_MEDIDOR, METRICAS_POS_HISTOGRAMA)
+	MET_NUM_VALORES
+};
+
+#if METRICAS_ENABLE
+
+extern volatile uint32_t metricas_valores[MET_NUM_VALORES];
+
+/**
+  * @brief Funcion que suma un valor a una palabra de la tabla sin bloqueos
+	* @param i: Posicion en la tabla
+	* @param n: Valor a sumar
+  * @retval None
+  */
+__STATIC_INLINE void metrica_Sumar (uint32_t i, uint32_t n){
+	uint32_t v;
+
+	do {
+		v = __LDREXW(&metricas_valores[i]);
+	} while (__STREXW(v + n, &metricas_valores[i]) != 0U);
+}
+
+/**
+  * @brief Funcion que guarda un valor si es mayor que el de la tabla
+	* @param i: Posicion en la tabla
+	* @param n: Valor observado
+  * @retval None
+  */
+__STATIC_INLINE void metrica_Maximo (uint32_t i, uint32_t n){
+	do {
+		if (__LDREXW(&metricas_valores[i]) >= n){
+			__CLREX();
+			return;
+		}
+	} while (__STREXW(n, &metricas_valores[i]) != 0U);
+}
+
+/**
+  * @brief Funcion que registra un valor en un histograma
+	* @param i: Posicion del histograma en la tabla
+	* @param n: Valor observado
+  * @retval None
+  */
+__STATIC_INLINE void metrica_Histograma (uint32_t i, uint32_t n){
+	uint32_t c = 32U - __CLZ(n);
+
+	metrica_Sumar(i + ((c < METRICAS_CUBETAS) ? c : METRICAS_CUBETAS - 1U), 1U);
+	metrica_Sumar(i + METRICAS_CUBETAS, n);
+}
+
+#define METRICA_CONTAR(m)         metrica_Sumar(MET_##m, 1U)
+#define METRICA_SUMAR(m, n)       metrica_Sumar(MET_##m, (n))
+#define METRICA_FIJAR(m, n)       do { metricas_valores[MET_##m] = (n); } while (0)
+#define METRICA_MAXIMO(m, n)      metrica_Maximo(MET_##m, (n))
+#define METRICA_HISTOGRAMA(m, n)  metrica_Histograma(MET_##m, (n))
+
+void init_Metricas (void);
+void volcar_Metricas (void);
+
+#else
+
+/*sizeof no evalua el valor pero evita avisos de variables sin usar*/
+#define METRICA_CONTAR(m)         ((void)0)
+#define METRICA_SUMAR(m, n)       ((void)sizeof(n))
+#define METRICA_FIJAR(m, n)       ((void)sizeof(n))
+#define METRICA_MAXIMO(m, n)      ((void)sizeof(n))
+#define METRICA_HISTOGRAMA(m, n)  ((void)sizeof(n))
+
+#define init_Metricas()           ((void)0)
+#define volcar_Metricas()         ((void)0)
+
+#endif
+
+#endif /* __METRICAS_H */
@@ -0,0 +1,334 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Perfil.c
+  * @author  MCD Application Team
+  * @brief   Fichero de perfilado del tiempo de CPU por hilo, del tiempo en cada
+	*					 interrupcion y del uso de pila de los hilos.
+	*
+	*					 El RTX llama a EvrRtxThreadSwitched en cada cambio de contexto
+	*					 (OS_EVR_THREAD en RTX_Config.h). La libreria la define como weak
+	*					 para el Event Recorder, por lo que aqui se sustituye por una que
+	*					 carga al hilo saliente los ciclos DWT transcurridos desde el cambio
+	*					 anterior, descontando los ciclos pasados en las ISR instrumentadas.
+	*
+	*					 Las ISR anidadas se suman a su propia interrupcion pero solo la mas
+	*					 externa se descuenta del hilo, para no restar dos veces el mismo
+	*					 tiempo. Cada informe cierra la ventana de medida y abre la siguiente.
+	*
+	*					 Los ciclos solo son comparables a una misma frecuencia, por lo que
+	*					 Reloj.c llama a reloj_Perfil antes de cada cambio de nivel para
+	*					 pasarlos a nanosegundos con la frecuencia saliente. El CYCCNT se
+	*					 detiene en el modo STOP, y Reposo.c carga ese tiempo al hilo idle
+	*					 con parado_Perfil.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Perfil.h"
+
+#if PERFIL_ENABLE
+
+#include "cmsis_os2.h"
+#include "USART.h"
+#include "Watchdog.h"
+
+/*Los ciclos se acumulan a la frecuencia actual y los ns a las anteriores*/
+typedef struct {
+	osThreadId_t hilo;
+	uint64_t ciclos;
+	uint64_t ns;
+} Hilo;
+
+typedef struct {
+	uint32_t n;
+	uint32_t max;
+	uint64_t ciclos;
+	uint64_t ns;
+} Irq;
+
+volatile uint32_t perfil_anidamiento = 0;
+
+static Hilo hilos[PERFIL_MAX_HILOS];
+static uint32_t num_hilos = 0;
+/*Hilo en ejecucion (PERFIL_MAX_HILOS si no se contabiliza)*/
+static uint32_t actual = PERFIL_MAX_HILOS;
+/*CYCCNT del ultimo cambio de contexto*/
+static uint32_t ultimo;
+
+static Irq irqs[PERFIL_NUM_IRQS];
+/*Duracion maxima de cada interrupcion desde el arranque (no se borra en los informes).
+	Los maximos se guardan en ciclos y se expresan con la frecuencia del informe*/
+static uint32_t peor[PERFIL_NUM_IRQS];
+/*Ciclos en ISR de la ventana (solo las mas externas) y parte ya descontada a los hilos*/
+static uint64_t irq_total;
+static uint64_t irq_descontado;
+static uint64_t irq_ns;
+
+static uint32_t inicio_ms;
+static int periodico = 0;
+static uint32_t siguiente_ms;
+
+#define PERFIL_NOMBRE_IRQ(nombre)	#nombre,
+static const char * const nombres_irq[PERFIL_NUM_IRQS] = {
+	PERFIL_IRQS(PERFIL_NOMBRE_IRQ)
+};
+
+/*Sustituye a la definicion weak de la libreria del RTX*/
+void EvrRtxThreadSwitched (osThreadId_t thread_id);
+
+/**
+  * @brief Funcion que carga al hilo en ejecucion los ciclos desde el ultimo cambio
+	*				 de contexto menos los pasados en interrupciones. Se llama con las
+	*				 interrupciones deshabilitadas.
+	* @param ahora: Valor actual de CYCCNT
+  * @retval None
+  */
+static void cargar (uint32_t ahora){
+	uint32_t ciclos = ahora - ultimo;
+	uint64_t isr = irq_total - irq_descontado;
+
+	ultimo = ahora;
+	irq_descontado = irq_total;
+	if (actual < PERFIL_MAX_HILOS)
+		hilos[actual].ciclos += (ciclos > isr) ? ciclos - isr : 0U;
+}
+
+/**
+  * @brief Funcion que pasa a nanosegundos los ciclos acumulados en la ventana con
+	*				 la frecuencia actual. Se llama con las interrupciones deshabilitadas.
+	* @param None
+  * @retval None
+  */
+static void convertir (void){
+	uint32_t mhz = SystemCoreClock / 1000000U;
+
+	cargar(DWT->CYCCNT);
+	for (uint32_t i = 0; i < num_hilos; i++){
+		hilos[i].ns += hilos[i].ciclos * 1000U / mhz;
+		hilos[i].ciclos = 0;
+	}
+	for (uint32_t i = 0; i < PERFIL_NUM_IRQS; i++){
+		irqs[i].ns += irqs[i].ciclos * 1000U / mhz;
+		irqs[i].ciclos = 0;
+	}
+	/*Tras cargar todo el tiempo de ISR esta ya descontado a los hilos*/
+	irq_ns += irq_total * 1000U / mhz;
+	irq_total = 0;
+	irq_descontado = 0;
+}
+
+/**
+  * @brief Funcion del RTX que se ejecuta en cada cambio de contexto con el hilo
+	*				 que pasa a ejecutarse.
+	* @param thread_id: Hilo entrante
+  * @retval None
+  */
+void EvrRtxThreadSwitched (osThreadId_t thread_id){
+	uint32_t primask = __get_PRIMASK();
+	uint32_t i;
+
+	__disable_irq();
+	cargar(DWT->CYCCNT);
+	for (i = 0; i < num_hilos && hilos[i].hilo != thread_id; i++)
+		;
+	if (i == num_hilos && num_hilos < PERFIL_MAX_HILOS){
+		hilos[i].hilo = thread_id;
+		hilos[i].ciclos = 0;
+		hilos[i].ns = 0;
+		num_hilos++;
+	}
+	actual = i;
+	__set_PRIMASK(primask);
+}
+
+/**
+  * @brief Funcion que acumula la duracion de una ISR. La llama PERFIL_IRQ_SALIDA.
+	* @param irq: Interrupcion instrumentada
+	* @param t0: CYCCNT a la entrada de la ISR
+  * @retval None
+  */
+void salir_Perfil (Perfil_Irq irq, uint32_t t0){
+	uint32_t ciclos = DWT->CYCCNT - t0;
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	irqs[irq].n++;
+	irqs[irq].ciclos += ciclos;
+	if (ciclos > irqs[irq].max)
+		irqs[irq].max = ciclos;
+	if (ciclos > peor[irq])
+		peor[irq] = ciclos;
+	if (--perfil_anidamiento == 0U)
+		irq_total += ciclos;
+	__set_PRIMASK(primask);
+}
+
+/**
+  * @brief Funcion que cierra la ventana de ciclos antes de un cambio de nivel del
+	*				 reloj. La llama Reloj.c con las interrupciones deshabilitadas y
+	*				 SystemCoreClock todavia con la frecuencia saliente.
+	* @param None
+  * @retval None
+  */
+void reloj_Perfil (void){
+	convertir();
+}
+
+/**
+  * @brief Funcion que carga al hilo en ejecucion (el idle) el tiempo en modo STOP,
+	*				 en el que el CYCCNT no avanza. La llama Reposo.c al despertar.
+	* @param ms: Tiempo dormido
+  * @retval None
+  */
+void parado_Perfil (uint32_t ms){
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	cargar(DWT->CYCCNT);
+	if (actual < PERFIL_MAX_HILOS)
+		hilos[actual].ns += (uint64_t)ms * 1000000U;
+	__set_PRIMASK(primask);
+}
+
+/**
+  * @brief Funcion que devuelve la duracion maxima de una interrupcion desde el arranque
+	* @param irq: Interrupcion instrumentada
+  * @retval Duracion maxima en ciclos
+  */
+uint32_t maximo_Perfil (Perfil_Irq irq){
+	return peor[irq];
+}
+
+/**
+  * @brief Funcion de inicializacion del contador de ciclos DWT CYCCNT. Se llama
+	*				 antes de arrancar el sistema operativo.
+	* @param None
+  * @retval None
+  */
+void init_Perfil (void){
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	ultimo = DWT->CYCCNT;
+	inicio_ms = 0;
+}
+
+/**
+  * @brief Funcion que expresa una parte del total en centesimas de porcentaje
+	* @param parte: Tiempo de la parte
+	* @param total: Tiempo total (distinto de 0)
+  * @retval Porcentaje x100
+  */
+static uint32_t porcentaje (uint64_t parte, uint64_t total){
+	return (uint32_t)((parte * 10000U) / total);
+}
+
+/**
+  * @brief Funcion que envia por la USART el uso de CPU y de pila de cada hilo vivo
+	*				 y el numero de ejecuciones, uso de CPU y duracion maxima de cada
+	*				 interrupcion desde el informe anterior.
+	* @param None
+  * @retval None
+  */
+void informe_Perfil (void){
+	char buf[100];
+	int size;
+	Hilo h[PERFIL_MAX_HILOS];
+	Irq q[PERFIL_NUM_IRQS];
+	osThreadId_t vivos[PERFIL_MAX_HILOS];
+	uint32_t n, num_vivos, ahora_ms, pct, j;
+	uint64_t total, isr, ns;
+	uint32_t ciclos_us = SystemCoreClock / 1000000U;
+	const char *nombre;
+
+	/*Se cierra la ventana actual y se abre la siguiente*/
+	__disable_irq();
+	convertir();
+	n = num_hilos;
+	memcpy(h, hilos, sizeof(h));
+	memcpy(q, irqs, sizeof(q));
+	isr = irq_ns;
+	for (uint32_t i = 0; i < n; i++)
+		hilos[i].ns = 0;
+	memset(irqs, 0, sizeof(irqs));
+	irq_ns = 0;
+	__enable_irq();
+
+	total = isr;
+	for (uint32_t i = 0; i < n; i++)
+		total += h[i].ns;
+	if (total == 0U)
+		total = 1;
+
+	ahora_ms = osKernelGetTickCount();
+	pct = porcentaje(isr, total);
+	size = sprintf(buf, "\r Perfil %ums: irq=%u.%02u%%\n", (unsigned)(ahora_ms - inicio_ms),
+								 (unsigned)(pct / 100U), (unsigned)(pct % 100U));
+	inicio_ms = ahora_ms;
+	tx_USART(buf, size);
+	reset_Watchdog();
+
+	num_vivos = osThreadEnumerate(vivos, PERFIL_MAX_HILOS);
+	for (uint32_t i = 0; i < num_vivos; i++){
+		ns = 0;
+		for (j = 0; j < n; j++){
+			if (h[j].hilo == vivos[i]){
+				ns = h[j].ns;
+				break;
+			}
+		}
+		nombre = osThreadGetName(vivos[i]);
+		pct = porcentaje(ns, total);
+		size = sprintf(buf, "\r %-15s cpu=%3u.%02u%% pila=%u/%u\n", (nombre != NULL) ? nombre : "?",
+									 (unsigned)(pct / 100U), (unsigned)(pct % 100U),
+									 (unsigned)(osThreadGetStackSize(vivos[i]) - osThreadGetStackSpace(vivos[i])),
+									 (unsigned)osThreadGetStackSize(vivos[i]));
+		tx_USART(buf, size);
+		/*Cada linea tarda unos 4 ms a 115200 baudios y hasta 50 ms en el peor caso,
+			la compilacion con USART_BAUDIOS=9600*/
+		reset_Watchdog();
+	}
+
+	for (uint32_t i = 0; i < PERFIL_NUM_IRQS; i++){
+		pct = porcentaje(q[i].ns, total);
+		size = sprintf(buf, "\r IRQ %-11s n=%u cpu=%3u.%02u%% max=%uus\n", nombres_irq[i],
+									 (unsigned)q[i].n, (unsigned)(pct / 100U), (unsigned)(pct % 100U),
+									 (unsigned)(q[i].max / ciclos_us));
+		tx_USART(buf, size);
+		reset_Watchdog();
+	}
+}
+
+/**
+  * @brief Funcion que activa o desactiva el informe automatico cada PERFIL_PERIODO_MS
+	* @param None
+  * @retval None
+  */
+void cambiar_Perfil (void){
+	char buf[50];
+	int size;
+
+	periodico = !periodico;
+	siguiente_ms = osKernelGetTickCount() + PERFIL_PERIODO_MS;
+	size = sprintf(buf, "\r Informe de perfil periodico: %s\n", periodico ? "si" : "no");
+	tx_USART(buf, size);
+}
+
+/**
+  * @brief Funcion que envia el informe si esta activo el modo periodico y ha vencido
+	*				 su plazo. Se llama desde el bucle del hilo de salida.
+	* @param None
+  * @retval None
+  */
+void periodico_Perfil (void){
+	if (periodico && (int32_t)(osKernelGetTickCount() - siguiente_ms) >= 0){
+		siguiente_ms += PERFIL_PERIODO_MS;
+		informe_Perfil();
+	}
+}
+
+#endif
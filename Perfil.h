@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Perfil.h
+  * @author  MCD Application Team
+  * @brief   Libreria de perfilado del sistema. Se mide con el contador de ciclos
+	*					 DWT CYCCNT:
+	*							- El tiempo de CPU de cada hilo, acumulado en cada cambio de
+	*								contexto del RTX
+	*							- El tiempo y el numero de ejecuciones de cada interrupcion
+	*								instrumentada con PERFIL_IRQ_ENTRADA/PERFIL_IRQ_SALIDA
+	*					 y se informa ademas del maximo de pila usado por cada hilo (marca de
+	*					 agua del RTX, OS_STACK_WATERMARK). La duracion maxima de cada
+	*					 interrupcion desde el arranque alimenta la tabla de latencias de
+	*					 Prioridades.c.
+	*
+	*					 Con PERFIL_ENABLE a 0 no se genera codigo.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __PERFIL_H
+#define __PERFIL_H
+
+#include "stm32f4xx_hal.h"
+
+/*Habilitacion del perfilado (0: sin coste en los cambios de contexto ni en las ISR)*/
+#ifndef PERFIL_ENABLE
+#define PERFIL_ENABLE 1
+#endif
+
+/*Hilos que se pueden contabilizar a la vez*/
+#define PERFIL_MAX_HILOS  10
+/*Periodo del informe automatico*/
+#define PERFIL_PERIODO_MS 10000U
+
+/*Interrupciones instrumentadas: IRQ(nombre)*/
+#define PERFIL_IRQS(IRQ) \
+	IRQ(EXTI)  \
+	IRQ(ADC)   \
+	IRQ(USART) \
+	IRQ(RTC)
+
+#define PERFIL_ENUM_IRQ(nombre)	PERFIL_IRQ_##nombre,
+typedef enum {
+	PERFIL_IRQS(PERFIL_ENUM_IRQ)
+	PERFIL_NUM_IRQS
+} Perfil_Irq;
+
+#if PERFIL_ENABLE
+
+extern volatile uint32_t perfil_anidamiento;
+
+/*La entrada guarda la marca en una variable local de la ISR, por lo que debe ser
+	la primera sentencia del manejador y la salida la ultima*/
+#define PERFIL_IRQ_ENTRADA()      uint32_t perfil_t0 = (perfil_anidamiento++, DWT->CYCCNT)
+#define PERFIL_IRQ_SALIDA(irq)    salir_Perfil((irq), perfil_t0)
+
+void init_Perfil (void);
+void salir_Perfil (Perfil_Irq irq, uint32_t t0);
+void reloj_Perfil (void);
+void parado_Perfil (uint32_t ms);
+void informe_Perfil (void);
+void cambiar_Perfil (void);
+void periodico_Perfil (void);
+uint32_t maximo_Perfil (Perfil_Irq irq);
+
+#else
+
+#define PERFIL_IRQ_ENTRADA()      ((void)0)
+#define PERFIL_IRQ_SALIDA(irq)    ((void)0)
+
+#define init_Perfil()             ((void)0)
+#define reloj_Perfil()            ((void)0)
+#define parado_Perfil(ms)         ((void)0)
+#define informe_Perfil()          ((void)0)
+#define cambiar_Perfil()          ((void)0)
+#define periodico_Perfil()        ((void)0)
+#define maximo_Perfil(irq)        (0U)
+
+#endif
+
+#endif /* __PERFIL_H */
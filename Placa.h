@@ -0,0 +1,57 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Placa.h
+  * @author  MCD Application Team
+  * @brief   Descripcion de la placa para la que se compila el firmware. Se
+	*					 incluye el fichero de conexionado indicado en PLACA_PINOUT (por
+	*					 defecto el de la mbed application shield) y se generan a partir
+	*					 de sus listas los indices de los botones del joystick y de los
+	*					 colores del LED RGB.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __PLACA_H
+#define __PLACA_H
+
+#include "stm32f4xx_hal.h"
+
+#ifndef PLACA_PINOUT
+#define PLACA_PINOUT "mbedAppBoard_PINOUT.h"
+#endif
+#include PLACA_PINOUT
+
+/*Indices de los botones del joystick: BOTON_LEFT, BOTON_DOWN...*/
+#define PLACA_ENUM_BOTON(rol, puerto, pin, irq)	BOTON_##rol,
+typedef enum {
+	PLACA_BOTONES(PLACA_ENUM_BOTON)
+	NUM_BOTONES
+} Boton;
+
+/*Indices de los colores del LED RGB: LED_ROJO, LED_VERDE...*/
+#define PLACA_ENUM_LED(color, puerto, pin, tim, canal, af)	LED_##color,
+typedef enum {
+	PLACA_LEDS(PLACA_ENUM_LED)
+	NUM_LEDS
+} Color;
+
+/*Indices de los potenciometros: POT_BRILLO, POT_TONO...*/
+#define PLACA_ENUM_POT(funcion, puerto, pin, canal)	POT_##funcion,
+typedef enum {
+	PLACA_POTS(PLACA_ENUM_POT)
+	NUM_POTS
+} Potenciometro;
+
+/*Indice de un puerto GPIO (GPIOA = 0, GPIOB = 1...) a partir de su direccion*/
+#define PLACA_GPIO_INDICE(puerto)	((uint32_t)(((uintptr_t)(puerto) - GPIOA_BASE) >> 10))
+
+/*Habilitacion del reloj de un puerto GPIO a partir de su direccion*/
+#define PLACA_GPIO_CLK_ENABLE(puerto) \
+	do { RCC->AHB1ENR |= 1U << PLACA_GPIO_INDICE(puerto); (void)RCC->AHB1ENR; } while (0)
+
+#endif /* __PLACA_H */
@@ -0,0 +1,211 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Potenciometros.c
+  * @author  MCD Application Team
+  * @brief   Fichero de lectura continua de los potenciometros de la tarjeta de
+	*					 aplicaciones:
+	*							- POT_2 (PC0, ADC1 canal 10): intensidad del LED RGB
+	*							- POT_3 (PA3, ADC1 canal 3): tono del LED RGB
+	*
+	*					 El TIM2 dispara una conversion de todos los canales a POT_FREC_HZ
+	*					 y el DMA2 Stream 0 guarda los resultados en un buffer circular. La
+	*					 CPU solo interviene en las interrupciones de mitad y final de
+	*					 buffer, donde se promedian las POT_MUESTRAS muestras de cada canal
+	*					 (sobremuestreo por software, el ADC del STM32F4 no lo tiene por
+	*					 hardware), se aplica un filtro IIR de primer orden y se notifica
+	*					 al hilo solo si el valor filtrado varia mas de POT_HISTERESIS.
+	*
+	*					 Los valores se escalan a 16 bits (0 - 65535).
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Potenciometros.h"
+#include "Reloj.h"
+
+ADC_HandleTypeDef hadc1;
+DMA_HandleTypeDef hdma_adc1;
+TIM_HandleTypeDef htim2;
+
+/*Tabla de potenciometros generada a partir de la descripcion de la placa*/
+typedef struct {
+	GPIO_TypeDef *Port;
+	uint16_t Pin;
+	uint32_t Canal;
+} Pot;
+
+#define POT_TABLA(funcion, puerto, pin, canal)	{puerto, (uint16_t)(1U << (pin)), canal},
+static const Pot pots[NUM_POTS] = {
+	PLACA_POTS(POT_TABLA)
+};
+
+/*Buffer circular del DMA: dos mitades de POT_MUESTRAS conversiones de todos los canales*/
+static uint16_t buffer[2U * POT_MUESTRAS * NUM_POTS];
+
+static int32_t filtrado[NUM_POTS];
+static volatile uint16_t publicado[NUM_POTS];
+static volatile uint32_t cambios = 0;
+
+static osThreadId_t hilo_pot;
+static uint32_t senal_pot;
+
+/**
+  * @brief Funcion de inicializacion del ADC1, el DMA y el TIM2 que dispara las
+	*				 conversiones. Al terminar queda en marcha el muestreo continuo.
+	* @param hilo: Hilo al que se notifican los cambios
+	* @param senal: Flag que se activa en el hilo cuando cambia algun potenciometro
+  * @retval 0 si la inicializacion es correcta, -1 en caso contrario
+  */
+int init_Potenciometros (osThreadId_t hilo, uint32_t senal){
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	ADC_ChannelConfTypeDef sConfig = {0};
+	TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+	hilo_pot = hilo;
+	senal_pot = senal;
+
+	/*Pines de los potenciometros en modo analogico*/
+	for (int p = 0; p < NUM_POTS; p++){
+		PLACA_GPIO_CLK_ENABLE(pots[p].Port);
+		GPIO_InitStruct.Pin = pots[p].Pin;
+		GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+		GPIO_InitStruct.Pull = GPIO_NOPULL;
+		HAL_GPIO_Init(pots[p].Port, &GPIO_InitStruct);
+	}
+
+	/*ADC1: secuencia de todos los canales disparada por el TRGO del TIM2*/
+	hadc1.Instance = ADC1;
+	hadc1.Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV4;
+	hadc1.Init.Resolution = ADC_RESOLUTION_12B;
+	hadc1.Init.ScanConvMode = ENABLE;
+	hadc1.Init.ContinuousConvMode = DISABLE;
+	hadc1.Init.DiscontinuousConvMode = DISABLE;
+	hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+	hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T2_TRGO;
+	hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+	hadc1.Init.NbrOfConversion = NUM_POTS;
+	hadc1.Init.DMAContinuousRequests = ENABLE;
+	hadc1.Init.EOCSelection = ADC_EOC_SEQ_CONV;
+	if (HAL_ADC_Init(&hadc1) != HAL_OK)
+		return -1;
+
+	for (int p = 0; p < NUM_POTS; p++){
+		sConfig.Channel = pots[p].Canal;
+		sConfig.Rank = p + 1;
+		sConfig.SamplingTime = ADC_SAMPLETIME_480CYCLES;
+		if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+			return -1;
+	}
+
+	/*TIM2 a 1 MHz con desbordamiento a POT_FREC_HZ como disparo del ADC*/
+	htim2.Instance = TIM2;
+	htim2.Init.Prescaler = timer_Reloj(TIM2) / 1000000U - 1U;
+	htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim2.Init.Period = 1000000U / POT_FREC_HZ - 1U;
+	htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if (HAL_TIM_Base_Init(&htim2) != HAL_OK)
+		return -1;
+	sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+	sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+	if (HAL_TIMEx_MasterConfigSynchronization(&htim2, &sMasterConfig) != HAL_OK)
+		return -1;
+
+	if (HAL_ADC_Start_DMA(&hadc1, (uint32_t *)buffer, sizeof(buffer) / sizeof(buffer[0])) != HAL_OK)
+		return -1;
+	if (HAL_TIM_Base_Start(&htim2) != HAL_OK)
+		return -1;
+	return 0;
+}
+
+/**
+  * @brief Funcion que procesa una mitad del buffer: promedio, filtro IIR e histeresis
+	* @param muestras: Primera conversion de la mitad del buffer a procesar
+  * @retval None
+  */
+static void procesar (const uint16_t *muestras){
+	uint32_t suma;
+	int32_t valor, diferencia;
+	uint32_t nuevos = 0;
+
+	for (int p = 0; p < NUM_POTS; p++){
+		suma = 0;
+		for (uint32_t i = 0; i < POT_MUESTRAS; i++)
+			suma += muestras[i * NUM_POTS + p];
+		/*Media de 12 bits escalada a 16 bits*/
+		valor = (int32_t)((suma << 4) / POT_MUESTRAS);
+		/*Filtro IIR de primer orden con coeficiente 1/4*/
+		filtrado[p] += (valor - filtrado[p]) / 4;
+
+		diferencia = filtrado[p] - publicado[p];
+		if (diferencia > POT_HISTERESIS || diferencia < -POT_HISTERESIS){
+			publicado[p] = (uint16_t)filtrado[p];
+			nuevos |= 1U << p;
+		}
+	}
+	if (nuevos != 0U){
+		cambios |= nuevos;
+		osThreadFlagsSet(hilo_pot, senal_pot);
+	}
+}
+
+/**
+  * @brief Callback de la primera mitad del buffer del DMA completada
+	* @param hadc: Handle del ADC
+  * @retval None
+  */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc){
+	if (hadc->Instance == ADC1)
+		procesar(&buffer[0]);
+}
+
+/**
+  * @brief Callback de la segunda mitad del buffer del DMA completada
+	* @param hadc: Handle del ADC
+  * @retval None
+  */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc){
+	if (hadc->Instance == ADC1)
+		procesar(&buffer[POT_MUESTRAS * NUM_POTS]);
+}
+
+/**
+  * @brief Funcion que devuelve el ultimo valor notificado de un potenciometro
+	* @param pot: Potenciometro que se quiere leer
+  * @retval Valor entre 0 y 65535
+  */
+uint16_t leer_Potenciometro (Potenciometro pot){
+	return publicado[pot];
+}
+
+/**
+  * @brief Funcion que devuelve y borra la mascara de potenciometros que han
+	*				 cambiado desde la ultima llamada.
+	* @param None
+  * @retval Mascara con el bit (1 << pot) activo si el potenciometro ha cambiado
+  */
+uint32_t cambios_Potenciometros (void){
+	uint32_t c;
+
+	HAL_NVIC_DisableIRQ(DMA2_Stream0_IRQn);
+	c = cambios;
+	cambios = 0;
+	HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+	return c;
+}
+
+/**
+  * @brief Funcion que mantiene el TIM2 a 1 MHz tras un cambio de la frecuencia del
+	*				 sistema. El prescaler se carga en el siguiente desbordamiento, por lo
+	*				 que solo se desplaza una muestra.
+	* @param None
+  * @retval None
+  */
+void reloj_Potenciometros (void){
+	TIM2->PSC = timer_Reloj(TIM2) / 1000000U - 1U;
+}
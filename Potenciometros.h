@@ -0,0 +1,41 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Potenciometros.h
+  * @author  MCD Application Team
+  * @brief   Libreria de lectura de los potenciometros de la tarjeta de
+	*					 aplicaciones mediante el ADC1 y el DMA en modo circular.
+	*					 El potenciometro POT_BRILLO fija la intensidad del LED RGB y el
+	*					 POT_TONO su tono.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __POTENCIOMETROS_H
+#define __POTENCIOMETROS_H
+
+#include "stm32f4xx_hal.h"
+#include "cmsis_os2.h"
+#include "Placa.h"
+
+/*Muestras por canal que se promedian en cada mitad del buffer del DMA*/
+#define POT_MUESTRAS    32U
+/*Frecuencia de muestreo de cada canal (disparo del TIM2)*/
+#define POT_FREC_HZ     1000U
+/*Variacion minima del valor filtrado (sobre 65535) para notificar un cambio*/
+#define POT_HISTERESIS  512
+
+extern ADC_HandleTypeDef hadc1;
+extern DMA_HandleTypeDef hdma_adc1;
+extern TIM_HandleTypeDef htim2;
+
+int init_Potenciometros (osThreadId_t hilo, uint32_t senal);
+uint16_t leer_Potenciometro (Potenciometro pot);
+uint32_t cambios_Potenciometros (void);
+void reloj_Potenciometros (void);
+
+#endif /* __POTENCIOMETROS_H */
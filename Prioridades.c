@@ -0,0 +1,177 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Prioridades.c
+  * @author  MCD Application Team
+  * @brief   Fichero de aplicacion y comprobacion del mapa de prioridades de
+	*					 Prioridades.h y de la tabla de latencia maxima de cada interrupcion.
+	*
+	*					 La latencia maxima de una interrupcion se calcula a partir de las
+	*					 duraciones maximas medidas por el perfil (Perfil.c):
+	*							latencia = entrada + max(ISR de igual prioridad)
+	*											 + suma(ISR de mayor prioridad)
+	*					 considerando solo las interrupciones habilitadas, cada una una vez.
+	*					 No incluye las secciones con las interrupciones deshabilitadas.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Prioridades.h"
+#include "Perfil.h"
+#include "USART.h"
+#include "Watchdog.h"
+
+/*Ciclos de apilado de contexto a la entrada de una ISR en el Cortex-M4*/
+#define PRIORIDAD_ENTRADA_CICLOS 12U
+
+/*Las bandas quedan en el rango del RTX y ordenadas sin solaparse*/
+#define PRIORIDADES_COMPROBAR_BANDA(nombre, alta, baja) \
+	COMPROBAR((alta) >= PRIORIDAD_RTOS && (alta) <= (baja) && (baja) < PRIORIDAD_SVC, banda_##nombre);
+PRIORIDADES_BANDAS(PRIORIDADES_COMPROBAR_BANDA)
+COMPROBAR(PRIORIDAD_ALTA_USART > PRIORIDAD_BAJA_DMA, orden_usart);
+COMPROBAR(PRIORIDAD_ALTA_TIM > PRIORIDAD_BAJA_USART, orden_tim);
+COMPROBAR(PRIORIDAD_ALTA_EXTI > PRIORIDAD_BAJA_TIM, orden_exti);
+COMPROBAR(PRIORIDAD_ALTA_RTC > PRIORIDAD_BAJA_EXTI, orden_rtc);
+
+/*Cada interrupcion esta dentro de su banda*/
+#define PRIORIDADES_COMPROBAR_IRQ(nombre, banda, prioridad, fuente) \
+	COMPROBAR((prioridad) >= PRIORIDAD_ALTA_##banda && (prioridad) <= PRIORIDAD_BAJA_##banda, irq_##nombre);
+PRIORIDADES_IRQS(PRIORIDADES_COMPROBAR_IRQ)
+
+typedef struct {
+	const char *nombre;
+	const char *banda;
+	IRQn_Type irq;
+	uint8_t prioridad;
+	Perfil_Irq fuente;
+} Irq;
+
+#define PRIORIDADES_TABLA_IRQ(nombre, banda, prioridad, fuente) \
+	{ #nombre, #banda, nombre##_IRQn, (prioridad), PERFIL_IRQ_##fuente },
+static const Irq irqs[] = {
+	PRIORIDADES_IRQS(PRIORIDADES_TABLA_IRQ)
+};
+
+#define NUM_IRQS (sizeof(irqs) / sizeof(irqs[0]))
+
+/**
+  * @brief Funcion que aplica el mapa de prioridades al NVIC. Se llama despues de
+	*				 HAL_Init, que fija NVIC_PRIORITYGROUP_4, y antes de habilitar ninguna
+	*				 interrupcion.
+	* @param None
+  * @retval None
+  */
+void init_Prioridades (void){
+	for (unsigned i = 0; i < NUM_IRQS; i++)
+		HAL_NVIC_SetPriority(irqs[i].irq, irqs[i].prioridad, 0);
+}
+
+/**
+  * @brief Funcion que envia por la USART una prioridad que no coincide con el mapa
+	* @param nombre: Interrupcion o excepcion
+	* @param leida: Prioridad leida del NVIC
+	* @param esperada: Prioridad del mapa
+  * @retval None
+  */
+static void error_Prioridad (const char *nombre, uint32_t leida, uint32_t esperada){
+	char buf[80];
+	int size;
+
+	size = sprintf(buf, "\r Prioridad de %s: %u en lugar de %u\n", nombre,
+								 (unsigned)leida, (unsigned)esperada);
+	tx_USART(buf, size);
+}
+
+/**
+  * @brief Funcion que comprueba que el NVIC coincide con el mapa de prioridades. Se
+	*				 llama con el sistema operativo arrancado, una vez que el RTX ha fijado
+	*				 las prioridades de SVC, PendSV y SysTick y que todos los modulos han
+	*				 habilitado sus interrupciones. Las diferencias se envian por la USART.
+	* @param None
+  * @retval Numero de prioridades que no coinciden con el mapa
+  */
+int comprobar_Prioridades (void){
+	int errores = 0;
+	uint32_t p;
+
+	if ((p = NVIC_GetPriorityGrouping()) != NVIC_PRIORITYGROUP_4){
+		error_Prioridad("grupo", p, NVIC_PRIORITYGROUP_4);
+		errores++;
+	}
+	if ((p = NVIC_GetPriority(SysTick_IRQn)) != PRIORIDAD_SYSTICK){
+		error_Prioridad("SysTick", p, PRIORIDAD_SYSTICK);
+		errores++;
+	}
+	if ((p = NVIC_GetPriority(PendSV_IRQn)) != PRIORIDAD_SYSTICK){
+		error_Prioridad("PendSV", p, PRIORIDAD_SYSTICK);
+		errores++;
+	}
+	if ((p = NVIC_GetPriority(SVCall_IRQn)) != PRIORIDAD_SVC){
+		error_Prioridad("SVC", p, PRIORIDAD_SVC);
+		errores++;
+	}
+	for (unsigned i = 0; i < NUM_IRQS; i++){
+		if ((p = NVIC_GetPriority(irqs[i].irq)) != irqs[i].prioridad){
+			error_Prioridad(irqs[i].nombre, p, irqs[i].prioridad);
+			errores++;
+		}
+	}
+	return errores;
+}
+
+/**
+  * @brief Funcion que calcula la latencia maxima de una interrupcion con las
+	*				 duraciones maximas medidas de las demas interrupciones habilitadas.
+	* @param i: Indice de la interrupcion en la tabla
+  * @retval Latencia maxima en ciclos
+  */
+static uint32_t latencia_maxima (unsigned i){
+	uint32_t bloqueo = 0;
+	uint32_t expulsion = 0;
+	uint32_t ciclos;
+
+	for (unsigned j = 0; j < NUM_IRQS; j++){
+		if (j == i || NVIC_GetEnableIRQ(irqs[j].irq) == 0U)
+			continue;
+		ciclos = maximo_Perfil(irqs[j].fuente);
+		if (irqs[j].prioridad < irqs[i].prioridad)
+			expulsion += ciclos;
+		else if (irqs[j].prioridad == irqs[i].prioridad && ciclos > bloqueo)
+			bloqueo = ciclos;
+	}
+	return PRIORIDAD_ENTRADA_CICLOS + bloqueo + expulsion;
+}
+
+/**
+  * @brief Funcion que envia por la USART el mapa de prioridades con la duracion
+	*				 maxima medida de cada interrupcion y su latencia maxima. Sin el perfil
+	*				 (PERFIL_ENABLE a 0) solo se envia el mapa.
+	* @param None
+  * @retval None
+  */
+void informe_Prioridades (void){
+	char buf[100];
+	int size;
+	uint32_t ciclos_us = SystemCoreClock / 1000000U;
+	uint32_t isr, latencia;
+
+	for (unsigned i = 0; i < NUM_IRQS; i++){
+		if (PERFIL_ENABLE){
+			isr = maximo_Perfil(irqs[i].fuente);
+			latencia = latencia_maxima(i);
+			size = sprintf(buf, "\r %-12s %-5s prio=%2u %s isr=%uus latencia=%uus\n", irqs[i].nombre,
+										 irqs[i].banda, (unsigned)irqs[i].prioridad,
+										 NVIC_GetEnableIRQ(irqs[i].irq) ? "on " : "off",
+										 (unsigned)(isr / ciclos_us), (unsigned)((latencia + ciclos_us - 1U) / ciclos_us));
+		}
+		else
+			size = sprintf(buf, "\r %-12s %-5s prio=%2u %s\n", irqs[i].nombre, irqs[i].banda,
+										 (unsigned)irqs[i].prioridad, NVIC_GetEnableIRQ(irqs[i].irq) ? "on " : "off");
+		tx_USART(buf, size);
+		reset_Watchdog();
+	}
+}
@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Prioridades.h
+  * @author  MCD Application Team
+  * @brief   Mapa de prioridades de las interrupciones del NVIC. Es la unica
+	*					 fuente de las prioridades de la aplicacion: init_Prioridades las
+	*					 aplica todas despues de HAL_Init y los modulos solo habilitan sus
+	*					 interrupciones.
+	*
+	*					 Con 4 bits de prioridad (NVIC_PRIORITYGROUP_4, sin subprioridad)
+	*					 el reparto es, de mas a menos urgente:
+	*							- 0..3:   Reservadas para ISR que no llaman al RTX (ninguna)
+	*							- 4..5:   DMA. El buffer circular del ADC se sobreescribe si la
+	*												ISR se retrasa media vuelta
+	*							- 6..7:   USART. Un caracter cada ~87 us a 115200 baudios
+	*							- 8..9:   Temporizadores
+	*							- 10..11: EXTI. Los rebotes de los pulsadores generan rafagas de
+	*												interrupciones que no deben retrasar al resto
+	*							- 12..13: RTC. Despertar del reposo, sin plazo
+	*							- 14:     SVC del RTX (SVC_Setup la fija un nivel sobre PendSV)
+	*							- 15:     SysTick y PendSV del RTX
+	*
+	*					 Todas las ISR de la aplicacion llaman al RTX (osThreadFlagsSet), por
+	*					 lo que deben quedar entre PRIORIDAD_RTOS y PRIORIDAD_SVC - 1. Las
+	*					 bandas y el mapa se comprueban en compilacion y comprobar_Prioridades
+	*					 verifica con el sistema arrancado que el NVIC coincide con el mapa.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __PRIORIDADES_H
+#define __PRIORIDADES_H
+
+#include "stm32f4xx_hal.h"
+#include "Comprobar.h"
+
+/*Niveles de prioridad del NVIC (0 la mas alta)*/
+#define PRIORIDAD_NIVELES  (1U << __NVIC_PRIO_BITS)
+/*SysTick y PendSV: el RTX los deja en la prioridad mas baja*/
+#define PRIORIDAD_SYSTICK  (PRIORIDAD_NIVELES - 1U)
+/*SVC: un nivel por encima de PendSV*/
+#define PRIORIDAD_SVC      (PRIORIDAD_NIVELES - 2U)
+/*Prioridad mas alta de una ISR que llama a funciones del RTX*/
+#define PRIORIDAD_RTOS     4U
+
+/*Bandas: BANDA(nombre, prioridad mas alta, prioridad mas baja), de mas a menos urgente*/
+#define PRIORIDADES_BANDAS(BANDA) \
+	BANDA(DMA,   4,  5)  \
+	BANDA(USART, 6,  7)  \
+	BANDA(TIM,   8,  9)  \
+	BANDA(EXTI,  10, 11) \
+	BANDA(RTC,   12, 13)
+
+/*Interrupciones: IRQ(nombre, banda, prioridad, fuente del perfil). El nombre es el
+	del IRQn_Type sin el sufijo _IRQn*/
+#define PRIORIDADES_IRQS(IRQ) \
+	IRQ(DMA2_Stream0, DMA,   5,  ADC)   \
+	IRQ(USART3,       USART, 6,  USART) \
+	IRQ(EXTI0,        EXTI,  10, EXTI)  \
+	IRQ(EXTI1,        EXTI,  10, EXTI)  \
+	IRQ(EXTI2,        EXTI,  10, EXTI)  \
+	IRQ(EXTI3,        EXTI,  10, EXTI)  \
+	IRQ(EXTI4,        EXTI,  10, EXTI)  \
+	IRQ(EXTI9_5,      EXTI,  10, EXTI)  \
+	IRQ(EXTI15_10,    EXTI,  10, EXTI)  \
+	IRQ(RTC_WKUP,     RTC,   12, RTC)
+
+/*Limites de cada banda: PRIORIDAD_ALTA_DMA, PRIORIDAD_BAJA_DMA...*/
+#define PRIORIDADES_ENUM_BANDA(nombre, alta, baja)	PRIORIDAD_ALTA_##nombre = (alta), PRIORIDAD_BAJA_##nombre = (baja),
+enum {
+	PRIORIDADES_BANDAS(PRIORIDADES_ENUM_BANDA)
+};
+
+/*Prioridad de cada interrupcion: PRIORIDAD_DMA2_Stream0...*/
+#define PRIORIDADES_ENUM_IRQ(nombre, banda, prioridad, fuente)	PRIORIDAD_##nombre = (prioridad),
+enum {
+	PRIORIDADES_IRQS(PRIORIDADES_ENUM_IRQ)
+};
+
+void init_Prioridades (void);
+int comprobar_Prioridades (void);
+void informe_Prioridades (void);
+
+#endif /* __PRIORIDADES_H */
@@ -13,21 +13,22 @@
 	*					 - LED RGB verde: Timer 4 Canal 4 pin PD15
 	*					 - LED RGB azul: Timer 1 Canal 3 pin PE13
 	*					
-  *					 La frecuencia de la seal PWM depender de la frecuencia del sistema
-	*					 configurada para cada proyecto siendo:
+  *					 Los Timers cuentan a RELOJ_TICK_HZ en todos los niveles de frecuencia
+	*					 del sistema (Reloj.h) hasta RGB_ARR (RGB.h), por lo que la frecuencia
+	*					 de la seal PWM es:
 	*					 
-	*				 	 F(PWM) = f(sistema)/65536
+	*				 	 F(PWM) = RELOJ_TICK_HZ/(RGB_ARR+1) = 3906 Hz
 	*
 	*					 Para imponer la intensidad en el RGB depender del ciclo de trabajo 
 	*					 de la seal PWM, por lo que a mayor ciclo de trabajo menor intensidad
 	*					 y viceversa. 
 	*					 El ciclo de trabajo se calcula de la siguiente manera:
 	*					 
-	*					CT(%) = CCRx/ARR 
+	*					CT(%) = CCRx/(ARR+1) 
 	*		
-	*					Siendo CCRx la intensidad que se pasa por parametro al llamar a la 
-	*				  funcin y ARR el valor definido de 65536. Por lo que la intensidad 
-	*					puede tener un valor mximo de 65535.
+	*					Siendo CCRx los RGB_BITS_PWM bits altos de la intensidad que se pasa
+	*					por parametro al llamar a la funcin y ARR el valor RGB_ARR. La
+	*					intensidad puede tener un valor mximo de 65535.
 	*
   * @note    modified by ARM
   *          The modifications allow to use this file as User Code Template
@@ -38,11 +39,63 @@
   */
 	
 #include "RGB.h"
+#include "Latencia.h"
+#include "Traza.h"
+#include "Reloj.h"
+#include "Energia.h"
 
 int initRGB (void);
 
-TIM_HandleTypeDef htim1;
-TIM_HandleTypeDef htim4;
+/*Handles de los Timers de la placa: htim1, htim4...*/
+#define RGB_HANDLE(n)	TIM_HandleTypeDef htim##n;
+PLACA_TIMERS(RGB_HANDLE)
+
+#define RGB_HANDLE_PTR(n)	&htim##n,
+static TIM_HandleTypeDef * const timers[] = {
+	PLACA_TIMERS(RGB_HANDLE_PTR)
+};
+#define RGB_INSTANCIA(n)	TIM##n,
+static const TIM_TypeDef * const instancias[] = {
+	PLACA_TIMERS(RGB_INSTANCIA)
+};
+
+#define NUM_TIMERS (sizeof(timers) / sizeof(timers[0]))
+
+/*Tabla de canales PWM de cada color generada a partir de la descripcion de la placa*/
+#define RGB_LED(color, puerto, pin, tim, canal, af) \
+	{puerto, (uint16_t)(1U << (pin)), af, &htim##tim, TIM_CHANNEL_##canal, &TIM##tim->CCR##canal},
+const RGB_Led rgb_leds[NUM_LEDS] = {
+	PLACA_LEDS(RGB_LED)
+};
+
+#if ENERGIA_ENABLE
+/*Intensidad ordenada de cada color (CCR) y factor del limitador de brillo (Q16,
+	65536 sin limite) con el que se escribe el CCR (Energia.h)*/
+static uint16_t ordenada[NUM_LEDS];
+static volatile uint32_t limite = 65536U;
+#endif
+
+/**
+  * @brief Funcion que guarda la intensidad ordenada de un color y calcula el CCR
+	*				 con el limite de brillo vigente
+	* @param color: Color del LED
+	* @param intensidad: Intensidad ordenada (0 maxima, 65535 apagado)
+  * @retval Valor del CCR
+  */
+__STATIC_INLINE uint32_t calcular_CCR (Color color, int intensidad){
+#if ENERGIA_ENABLE
+	uint32_t factor = limite;
+
+	ordenada[color] = (uint16_t)intensidad;
+	/*Sin limite el CCR sale de la intensidad ordenada, como sin el modelo de consumo*/
+	if (factor == 65536U)
+		return RGB_CCR(intensidad);
+	return RGB_CCR(65535U - (((65535U - (uint32_t)intensidad) * factor) >> 16));
+#else
+	(void)color;
+	return RGB_CCR(intensidad);
+#endif
+}
 
 /**
   * @brief Funcin de inicializacin del LED RGB, incializando los Timers 1 y 4.
@@ -52,7 +105,7 @@ TIM_HandleTypeDef htim4;
 	*				 - LED RGB verde: Timer 4 Canal 4 pin PD15
 	*				 - LED RGB azul: Timer 1 Canal 3 pin PE13
 	*				 Todas las seales PWM estan configuradas para tener una frecuencia: 
-	*				 F(PWM) = f(sistema)/65536			
+	*				 F(PWM) = RELOJ_TICK_HZ/(RGB_ARR+1)			
 	* @param None
   * @retval None
   */
@@ -61,103 +114,271 @@ int initRGB (void){
   TIM_MasterConfigTypeDef sMasterConfig = {0};
   TIM_OC_InitTypeDef sConfigOC = {0};
   TIM_BreakDeadTimeConfigTypeDef sBreakDeadTimeConfig = {0};
+	TIM_HandleTypeDef *htim;
 
-	/*Inicializacin del Timer 1*/
-  htim1.Instance = TIM1;
-  htim1.Init.Prescaler = 0;
-  htim1.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim1.Init.Period = 65535;
-  htim1.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
-  htim1.Init.RepetitionCounter = 0;
-  htim1.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
-  if (HAL_TIM_Base_Init(&htim1) != HAL_OK)
-  {
-    return -1;
-  }
-  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
-  if (HAL_TIM_ConfigClockSource(&htim1, &sClockSourceConfig) != HAL_OK)
-  {
-    return -1;
-  }
-  if (HAL_TIM_PWM_Init(&htim1) != HAL_OK)
-  {
-		return -1;  
-	}
-  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
-  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
-  if (HAL_TIMEx_MasterConfigSynchronization(&htim1, &sMasterConfig) != HAL_OK)
-  {
-		 return -1;  
+	/*Inicializacin de los Timers de la placa*/
+	for (unsigned i = 0; i < NUM_TIMERS; i++){
+		htim = timers[i];
+		htim->Instance = (TIM_TypeDef *)instancias[i];
+		htim->Init.Prescaler = timer_Reloj(instancias[i]) / RELOJ_TICK_HZ - 1U;
+		htim->Init.CounterMode = TIM_COUNTERMODE_UP;
+		htim->Init.Period = RGB_ARR;
+		htim->Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+		htim->Init.RepetitionCounter = 0;
+		htim->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+		if (HAL_TIM_Base_Init(htim) != HAL_OK)
+		{
+			return -1;
+		}
+		sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+		if (HAL_TIM_ConfigClockSource(htim, &sClockSourceConfig) != HAL_OK)
+		{
+			return -1;
+		}
+		if (HAL_TIM_PWM_Init(htim) != HAL_OK)
+		{
+			return -1;
+		}
+		sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+		sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+		if (HAL_TIMEx_MasterConfigSynchronization(htim, &sMasterConfig) != HAL_OK)
+		{
+			return -1;
+		}
+		/*Los Timers avanzados (TIM1 y TIM8) necesitan la configuracin del break*/
+		if (IS_TIM_BREAK_INSTANCE(htim->Instance))
+		{
+			sBreakDeadTimeConfig.OffStateRunMode = TIM_OSSR_DISABLE;
+			sBreakDeadTimeConfig.OffStateIDLEMode = TIM_OSSI_DISABLE;
+			sBreakDeadTimeConfig.LockLevel = TIM_LOCKLEVEL_OFF;
+			sBreakDeadTimeConfig.DeadTime = 0;
+			sBreakDeadTimeConfig.BreakState = TIM_BREAK_DISABLE;
+			sBreakDeadTimeConfig.BreakPolarity = TIM_BREAKPOLARITY_HIGH;
+			sBreakDeadTimeConfig.AutomaticOutput = TIM_AUTOMATICOUTPUT_DISABLE;
+			if (HAL_TIMEx_ConfigBreakDeadTime(htim, &sBreakDeadTimeConfig) != HAL_OK)
+			{
+				return -1;
+			}
+		}
 	}
+
+	/*Configuracin del canal PWM de cada color*/
   sConfigOC.OCMode = TIM_OCMODE_PWM1;
-  sConfigOC.Pulse = 65536/2;
+  sConfigOC.Pulse = (RGB_ARR + 1U)/2;
   sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
   sConfigOC.OCNPolarity = TIM_OCNPOLARITY_HIGH;
   sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
   sConfigOC.OCIdleState = TIM_OCIDLESTATE_RESET;
   sConfigOC.OCNIdleState = TIM_OCNIDLESTATE_RESET;
-  if (HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_2) != HAL_OK)
-  {
-    return -1;
-  }
-  if (HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_3) != HAL_OK)
-  {
-    return -1;
-  }
-  sBreakDeadTimeConfig.OffStateRunMode = TIM_OSSR_DISABLE;
-  sBreakDeadTimeConfig.OffStateIDLEMode = TIM_OSSI_DISABLE;
-  sBreakDeadTimeConfig.LockLevel = TIM_LOCKLEVEL_OFF;
-  sBreakDeadTimeConfig.DeadTime = 0;
-  sBreakDeadTimeConfig.BreakState = TIM_BREAK_DISABLE;
-  sBreakDeadTimeConfig.BreakPolarity = TIM_BREAKPOLARITY_HIGH;
-  sBreakDeadTimeConfig.AutomaticOutput = TIM_AUTOMATICOUTPUT_DISABLE;
-  if (HAL_TIMEx_ConfigBreakDeadTime(&htim1, &sBreakDeadTimeConfig) != HAL_OK)
-  {
-    return -1;
-  }
-
-  HAL_TIM_MspPostInit(&htim1);
-	
-	/*Configuracin del Timer 4*/
-	htim4.Instance = TIM4;
-  htim4.Init.Prescaler = 0;
-  htim4.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim4.Init.Period = 65535;
-  htim4.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
-  htim4.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
-  if (HAL_TIM_Base_Init(&htim4) != HAL_OK)
-  {
-    return -1;
-  }
-  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
-  if (HAL_TIM_ConfigClockSource(&htim4, &sClockSourceConfig) != HAL_OK)
-  {
-    return -1;
-  }
-  if (HAL_TIM_PWM_Init(&htim4) != HAL_OK)
-  {
-    return -1;
-  }
-  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
-  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
-  if (HAL_TIMEx_MasterConfigSynchronization(&htim4, &sMasterConfig) != HAL_OK)
-  {
-    return -1;
-  }
-  sConfigOC.OCMode = TIM_OCMODE_PWM1;
-  sConfigOC.Pulse = 65536/2;
-  sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
-  sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
-  if (HAL_TIM_PWM_ConfigChannel(&htim4, &sConfigOC, TIM_CHANNEL_4) != HAL_OK)
-  {
-    return -1;
-  }
+	for (int c = 0; c < NUM_LEDS; c++){
+		if (HAL_TIM_PWM_ConfigChannel(rgb_leds[c].htim, &sConfigOC, rgb_leds[c].Canal) != HAL_OK)
+		{
+			return -1;
+		}
+	}
 
-  HAL_TIM_MspPostInit(&htim4);
+	for (unsigned i = 0; i < NUM_TIMERS; i++)
+		HAL_TIM_MspPostInit(timers[i]);
 	
 	return 0;
 }
 
+/**
+  * @brief Funcion que reprograma el prescaler de los Timers tras un cambio de la
+	*				 frecuencia del sistema. El UG carga el prescaler al momento y se
+	*				 restaura el contador, de forma que el periodo en curso continua sin
+	*				 alterar la frecuencia ni el ciclo de trabajo de la PWM. Se llama con
+	*				 las interrupciones deshabilitadas.
+	* @param None
+  * @retval None
+  */
+void reloj_RGB (void){
+	TIM_TypeDef *tim;
+	uint32_t cnt;
+
+	for (unsigned i = 0; i < NUM_TIMERS; i++){
+		tim = timers[i]->Instance;
+		cnt = tim->CNT;
+		tim->PSC = timer_Reloj(tim) / RELOJ_TICK_HZ - 1U;
+		tim->EGR = TIM_EGR_UG;
+		tim->CNT = cnt;
+	}
+}
+
+/**
+  * @brief Funcin para encender un color del LED RGB con la intensidad que se pasa 
+	*				 por parametro activando la seal PWM de su canal.
+	* @param color: Color que se quiere encender
+	* @param intensidad: Intensidad que se quiere establecer en el LED.
+  * @retval None
+  */
+void encender_LED (Color color, int intensidad){
+	uint32_t ccr = calcular_CCR(color, intensidad);
+
+	HAL_TIM_PWM_Start(rgb_leds[color].htim, rgb_leds[color].Canal);
+	*rgb_leds[color].CCR = ccr;
+	LATENCIA_MARCA(LAT_CCR);
+	TRAZA_EVENTO(TRAZA_CCR, color, ccr);
+}
+
+/**
+  * @brief Funcin para apagar un color del LED RGB
+	* @param color: Color que se quiere apagar
+  * @retval None
+  */
+void apagar_LED (Color color){
+	HAL_TIM_PWM_Stop(rgb_leds[color].htim, rgb_leds[color].Canal);
+	TRAZA_EVENTO(TRAZA_LED_APAGADO, color, 0);
+}
+
+/**
+  * @brief Funcin para modificar la intensidad de un color del LED RGB
+	* @param color: Color cuya intensidad se modifica
+	* @param intensidad: Nueva intensidad quese desea establecer.
+	*				 El parmetro tiene que ser inferior a 65536.
+  * @retval None
+  */
+void intensidad_LED (Color color, int intensidad){
+	uint32_t ccr = calcular_CCR(color, intensidad);
+
+	*rgb_leds[color].CCR = ccr;
+	LATENCIA_MARCA(LAT_CCR);
+	TRAZA_EVENTO(TRAZA_CCR, color, ccr);
+}
+
+/**
+  * @brief Funcion que devuelve la intensidad ordenada de un color, antes del
+	*				 limitador de brillo
+	* @param color: Color del LED
+  * @retval Intensidad (0 maxima, 65535 apagado)
+  */
+int intensidad_RGB (Color color){
+#if ENERGIA_ENABLE
+	return ordenada[color];
+#else
+	return (int)RGB_INTENSIDAD(*rgb_leds[color].CCR);
+#endif
+}
+
+/**
+  * @brief Funcion que devuelve el nivel ordenado de un color para el modelo de
+	*				 consumo: 65535 - intensidad con la salida PWM activa y 0 apagado
+	* @param color: Color del LED
+  * @retval Nivel entre 0 y 65535
+  */
+uint32_t nivel_RGB (Color color){
+	if ((rgb_leds[color].htim->Instance->CCER & (TIM_CCER_CC1E << rgb_leds[color].Canal)) == 0U)
+		return 0;
+	return 65535U - (uint32_t)intensidad_RGB(color);
+}
+
+#if ENERGIA_ENABLE
+/**
+  * @brief Funcion que fija el factor del limitador de brillo y reescribe el CCR de
+	*				 todos los colores con su intensidad ordenada. Se llama en cada
+	*				 fotograma del modelo de consumo, de forma que una escritura de otro
+	*				 hilo con el factor anterior se corrige en el siguiente. Las
+	*				 interrupciones se deshabilitan para no mezclar los colores con una
+	*				 trama del flujo (trama_RGB).
+	* @param factor: Factor Q16 (65536 sin limite)
+  * @retval None
+  */
+void limitar_RGB (uint32_t factor){
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	limite = factor;
+	for (int c = 0; c < NUM_LEDS; c++)
+		*rgb_leds[c].CCR = RGB_CCR(65535U - (((65535U - ordenada[c]) * factor) >> 16));
+	__set_PRIMASK(primask);
+}
+#endif
+
+/**
+  * @brief Funcion que indica si alguno de los colores del LED RGB tiene la salida
+	*				 PWM activa, en cuyo caso los Timers no se pueden detener.
+	* @param None
+  * @retval 1 si algun color esta encendido, 0 en caso contrario
+  */
+int encendido_RGB (void){
+	for (int c = 0; c < NUM_LEDS; c++){
+		if ((rgb_leds[c].htim->Instance->CCER & (TIM_CCER_CC1E << rgb_leds[c].Canal)) != 0U)
+			return 1;
+	}
+	return 0;
+}
+
+/**
+  * @brief Funcion para mostrar un tono en el LED RGB mezclando los tres colores.
+	*				 El tono recorre la rueda de color (rojo, amarillo, verde, cian, azul,
+	*				 magenta) con saturacion maxima y se calcula con aritmetica entera.
+	* @param tono: Posicion en la rueda de color entre 0 y 65535
+	* @param intensidad: Intensidad con el mismo criterio que intensidad_LED
+	*				 (0 maxima, 65535 apagado).
+  * @retval None
+  */
+void tono_LED (uint16_t tono, int intensidad){
+	uint32_t v = 65535U - (uint32_t)intensidad;
+	uint32_t h = (uint32_t)tono * 6U;
+	uint32_t f = h & 0xFFFFU;
+	uint32_t sube = (v * f) >> 16;
+	uint32_t baja = (v * (65535U - f)) >> 16;
+	uint32_t nivel[NUM_LEDS];
+
+	switch (h >> 16){
+		case 0:  nivel[LED_ROJO] = v;    nivel[LED_VERDE] = sube; nivel[LED_AZUL] = 0;    break;
+		case 1:  nivel[LED_ROJO] = baja; nivel[LED_VERDE] = v;    nivel[LED_AZUL] = 0;    break;
+		case 2:  nivel[LED_ROJO] = 0;    nivel[LED_VERDE] = v;    nivel[LED_AZUL] = sube; break;
+		case 3:  nivel[LED_ROJO] = 0;    nivel[LED_VERDE] = baja; nivel[LED_AZUL] = v;    break;
+		case 4:  nivel[LED_ROJO] = sube; nivel[LED_VERDE] = 0;    nivel[LED_AZUL] = v;    break;
+		default: nivel[LED_ROJO] = v;    nivel[LED_VERDE] = 0;    nivel[LED_AZUL] = baja; break;
+	}
+	for (int c = 0; c < NUM_LEDS; c++)
+		encender_LED((Color)c, (int)(65535U - nivel[c]));
+}
+
+/**
+  * @brief Funcion que muestra los tres colores a la vez, como una trama del flujo de
+	*				 color (Flujo.h). Con los eventos de actualizacion deshabilitados (UDIS)
+	*				 se escriben todos los CCR, cuya precarga los lleva a la salida en el
+	*				 siguiente evento de actualizacion, de forma que ningun periodo de la
+	*				 PWM mezcla dos tramas. Un Timer parado se arranca con un UG para que
+	*				 la trama no espere un periodo. No usa la HAL, por lo que se puede
+	*				 llamar desde una interrupcion; las escrituras no se trazan una a una.
+	* @param nivel: Brillo de cada color (0 apagado, 65535 maximo)
+  * @retval 1 si la trama anterior no habia llegado a la salida (UIF a 0), 0 en caso
+	*				 contrario
+  */
+int trama_RGB (const uint16_t nivel[NUM_LEDS]){
+	TIM_TypeDef *tim;
+	int pendiente = 0;
+
+	for (unsigned i = 0; i < NUM_TIMERS; i++){
+		tim = timers[i]->Instance;
+		if ((tim->CR1 & TIM_CR1_CEN) != 0U && (tim->SR & TIM_SR_UIF) == 0U)
+			pendiente = 1;
+		tim->CR1 |= TIM_CR1_UDIS;
+	}
+	for (int c = 0; c < NUM_LEDS; c++){
+		*rgb_leds[c].CCR = calcular_CCR((Color)c, 65535 - (int)nivel[c]);
+		rgb_leds[c].htim->Instance->CCER |= TIM_CCER_CC1E << rgb_leds[c].Canal;
+	}
+	for (unsigned i = 0; i < NUM_TIMERS; i++){
+		tim = timers[i]->Instance;
+		if (IS_TIM_BREAK_INSTANCE(tim))
+			tim->BDTR |= TIM_BDTR_MOE;
+		tim->SR = ~TIM_SR_UIF;
+		tim->CR1 &= ~TIM_CR1_UDIS;
+		if ((tim->CR1 & TIM_CR1_CEN) == 0U){
+			tim->EGR = TIM_EGR_UG;
+			tim->SR = ~TIM_SR_UIF;
+			tim->CR1 |= TIM_CR1_CEN;
+		}
+	}
+	LATENCIA_MARCA(LAT_CCR);
+	return pendiente;
+}
+
 /**
   * @brief Funcin para encender el LED rojo con la intensidad que se pasa por parametro
 	*				 activando la seal PWM a traves del Timer 1 canal 2.
@@ -165,8 +386,7 @@ int initRGB (void){
   * @retval None
   */
 void encender_LED_rojo ( int intensidad){
-	HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_2);
-	htim1.Instance->CCR2 = intensidad;
+	encender_LED(LED_ROJO, intensidad);
 }
 
 /**
@@ -176,8 +396,7 @@ void encender_LED_rojo ( int intensidad){
   * @retval None
   */
 void encender_LED_azul (int intensidad){
-	HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_3);
-	htim1.Instance->CCR3 = intensidad;
+	encender_LED(LED_AZUL, intensidad);
 }
 
 /**
@@ -187,8 +406,7 @@ void encender_LED_azul (int intensidad){
   * @retval None
   */
 void encender_LED_verde (int intensidad){
-	HAL_TIM_PWM_Start(&htim4, TIM_CHANNEL_4);
-	htim4.Instance->CCR4 = intensidad;
+	encender_LED(LED_VERDE, intensidad);
 }
 
 /**
@@ -197,7 +415,7 @@ void encender_LED_verde (int intensidad){
   * @retval None
   */
 void apagar_LED_rojo (){
-	HAL_TIM_PWM_Stop(&htim1, TIM_CHANNEL_2);
+	apagar_LED(LED_ROJO);
 }
 
 /**
@@ -206,7 +424,7 @@ void apagar_LED_rojo (){
   * @retval None
   */
 void apagar_LED_azul (){
-	HAL_TIM_PWM_Stop(&htim1, TIM_CHANNEL_3);
+	apagar_LED(LED_AZUL);
 }
 
 /**
@@ -215,7 +433,7 @@ void apagar_LED_azul (){
   * @retval None
   */
 void apagar_LED_verde (){
-	HAL_TIM_PWM_Stop(&htim4, TIM_CHANNEL_4);
+	apagar_LED(LED_VERDE);
 }
 
 /**
@@ -225,7 +443,7 @@ void apagar_LED_verde (){
   * @retval None
   */
 void intensidad_LED_rojo (int intensidad){
-		htim1.Instance->CCR2 = intensidad;
+		intensidad_LED(LED_ROJO, intensidad);
 }
 
 /**
@@ -235,7 +453,7 @@ void intensidad_LED_rojo (int intensidad){
   * @retval None
   */
 void intensidad_LED_azul (int intensidad){
-		htim1.Instance->CCR3 = intensidad;
+		intensidad_LED(LED_AZUL, intensidad);
 }
 
 /**
@@ -245,7 +463,7 @@ void intensidad_LED_azul (int intensidad){
   * @retval None
   */
 void intensidad_LED_verde (int intensidad){
-		htim4.Instance->CCR4 = intensidad;
+		intensidad_LED(LED_VERDE, intensidad);
 }
 
 
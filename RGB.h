@@ -1,7 +1,42 @@
+#ifndef __RGB_H
+#define __RGB_H
+
 #include "stm32f4xx_hal.h"
+#include "Placa.h"
+
+/*Resolucion de la PWM: los Timers cuentan de 0 a RGB_ARR a RELOJ_TICK_HZ, por lo
+	que F(PWM) = RELOJ_TICK_HZ/4096 = 3906 Hz. Las intensidades son de 16 bits y el
+	CCR conserva sus RGB_BITS_PWM bits altos*/
+#define RGB_BITS_PWM           12U
+#define RGB_ARR                ((1U << RGB_BITS_PWM) - 1U)
+#define RGB_CCR(intensidad)    ((uint32_t)(intensidad) >> (16U - RGB_BITS_PWM))
+/*Intensidad de 16 bits de un CCR: se repiten sus bits altos para que RGB_ARR sea 65535*/
+#define RGB_INTENSIDAD(ccr)    (((uint32_t)(ccr) << (16U - RGB_BITS_PWM)) | \
+								((uint32_t)(ccr) >> (2U * RGB_BITS_PWM - 16U)))
+
+typedef struct {
+	GPIO_TypeDef *Port;
+	uint16_t Pin;
+	uint8_t AF;
+	TIM_HandleTypeDef *htim;
+	uint32_t Canal;
+	__IO uint32_t *CCR;
+} RGB_Led;
+
+extern const RGB_Led rgb_leds[NUM_LEDS];
 
 void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
 int initRGB (void);
+void reloj_RGB (void);
+void encender_LED (Color color, int intensidad);
+void apagar_LED (Color color);
+void intensidad_LED (Color color, int intensidad);
+void tono_LED (uint16_t tono, int intensidad);
+int trama_RGB (const uint16_t nivel[NUM_LEDS]);
+int encendido_RGB (void);
+int intensidad_RGB (Color color);
+uint32_t nivel_RGB (Color color);
+void limitar_RGB (uint32_t factor);
 void encender_LED_rojo ( int intensidad);
 void encender_LED_azul (int intensidad);
 void encender_LED_verde (int intensidad);
@@ -11,3 +46,5 @@ void apagar_LED_verde ();
 void intensidad_LED_rojo (int intensidad);
 void intensidad_LED_azul (int intensidad);
 void intensidad_LED_verde (int intensidad);
+
+#endif /* __RGB_H */
@@ -44,7 +44,7 @@
 //   <i> Defines the combined global dynamic memory size.
 //   <i> Default: 32768
 #ifndef OS_DYNAMIC_MEM_SIZE
-#define OS_DYNAMIC_MEM_SIZE         32768
+#define OS_DYNAMIC_MEM_SIZE         0
 #endif
  
 //   <o>Kernel Tick Frequency [Hz] <1-1000000>
@@ -153,7 +153,7 @@
 //   <i> Initializes thread stack with watermark pattern for analyzing stack usage.
 //   <i> Enabling this option increases significantly the execution time of thread creation.
 #ifndef OS_STACK_WATERMARK
-#define OS_STACK_WATERMARK          0
+#define OS_STACK_WATERMARK          1
 #endif
  
 //   <o>Processor mode for Thread execution 
@@ -200,7 +200,7 @@
 //   <i> May be set to 0 when timers are not used.
 //   <i> Default: 512
 #ifndef OS_TIMER_THREAD_STACK_SIZE
-#define OS_TIMER_THREAD_STACK_SIZE  512
+#define OS_TIMER_THREAD_STACK_SIZE  1024
 #endif
  
 //   <o>Timer Thread TrustZone Module Identifier
@@ -247,14 +247,17 @@
 //   <e>Object specific Memory allocation
 //   <i> Enables object specific memory allocation.
 #ifndef OS_MUTEX_OBJ_MEM
-#define OS_MUTEX_OBJ_MEM            0
+#define OS_MUTEX_OBJ_MEM            1
 #endif
  
 //     <o>Number of Mutex objects <1-1000>
 //     <i> Defines maximum number of objects that can be active at the same time.
 //     <i> Applies to objects with system provided memory for control blocks.
+// Sin memoria dinamica los mutex de la libreria C (_mutex_initialize: stdin,
+// stdout, stderr, heap y reserva) salen de este conjunto; la aplicacion no crea
+// mutex propios.
 #ifndef OS_MUTEX_NUM
-#define OS_MUTEX_NUM                1
+#define OS_MUTEX_NUM                8
 #endif
  
 //   </e>
@@ -569,7 +572,7 @@
 // (when thread specific memory allocation is not used).
 #if (OS_THREAD_OBJ_MEM == 0)
 #ifndef OS_THREAD_LIBSPACE_NUM
-#define OS_THREAD_LIBSPACE_NUM      4
+#define OS_THREAD_LIBSPACE_NUM      6
 #endif
 #else
 #define OS_THREAD_LIBSPACE_NUM      OS_THREAD_NUM
@@ -32,6 +32,8 @@
         #define RTE_Drivers_USART10             /* Driver USART10 */
 /*  Keil::Device:STM32Cube Framework:Classic:1.7.9 */
 #define RTE_DEVICE_FRAMEWORK_CLASSIC
+/*  Keil::Device:STM32Cube HAL:ADC:1.7.9 */
+#define RTE_DEVICE_HAL_ADC
 /*  Keil::Device:STM32Cube HAL:Common:1.7.9 */
 #define RTE_DEVICE_HAL_COMMON
 /*  Keil::Device:STM32Cube HAL:Cortex:1.7.9 */
@@ -46,6 +48,8 @@
 #define RTE_DEVICE_HAL_PWR
 /*  Keil::Device:STM32Cube HAL:RCC:1.7.9 */
 #define RTE_DEVICE_HAL_RCC
+/*  Keil::Device:STM32Cube HAL:RTC:1.7.9 */
+#define RTE_DEVICE_HAL_RTC
 /*  Keil::Device:STM32Cube HAL:TIM:1.7.9 */
 #define RTE_DEVICE_HAL_TIM
 /*  Keil::Device:Startup:2.6.3 */
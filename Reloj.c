@@ -0,0 +1,354 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Reloj.c
+  * @author  MCD Application Team
+  * @brief   Fichero de cambio de nivel de la frecuencia del sistema.
+	*
+	*					 Los niveles con PLL comparten el VCO y solo cambian el PLLP, pero
+	*					 el PLLP y la escala del regulador solo se pueden modificar con el
+	*					 PLL apagado, por lo que todo cambio pasa por el nivel del HSI:
+	*							1. Conmutacion del reloj del sistema al HSI
+	*							2. Reconfiguracion y enganche del PLL con el nuevo PLLP y la
+	*								 nueva escala del regulador (solo si el nivel usa el PLL)
+	*							3. Conmutacion del reloj del sistema al PLL
+	*
+	*					 Cada conmutacion se hace con las interrupciones deshabilitadas y
+	*					 reprograma a continuacion los Timers, la USART y el SysTick, por lo
+	*					 que dura unos pocos microsegundos, muy por debajo del periodo de la
+	*					 PWM. Solo se conmuta con la USART sin transmitir para no corromper
+	*					 un caracter; si esta ocupada se reintenta en el siguiente periodo.
+	*
+	*					 Las medidas basadas en el contador de ciclos solo son validas a una
+	*					 frecuencia, por lo que antes de cada conmutacion se cierran con la
+	*					 frecuencia saliente: Perfil pasa a tiempo los ciclos acumulados y
+	*					 Latencia descarta la medida abierta. El Grabador convierte cada
+	*					 intervalo entre flancos con la frecuencia del flanco, por lo que es
+	*					 aproximado si el intervalo abarca un cambio.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Reloj.h"
+
+/**
+  * @brief Funcion que devuelve la frecuencia de cuenta de un Timer. Con el APB
+	*				 dividido el reloj de los Timers es el doble del PCLK.
+	* @param tim: Instancia del Timer
+  * @retval Frecuencia en Hz
+  */
+uint32_t timer_Reloj (const TIM_TypeDef *tim){
+	uint32_t apb2 = ((uint32_t)tim >= APB2PERIPH_BASE) ? 1U : 0U;
+	uint32_t pclk = apb2 ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+	uint32_t ppre = RCC->CFGR & (apb2 ? RCC_CFGR_PPRE2 : RCC_CFGR_PPRE1);
+
+	return (ppre == 0U) ? pclk : 2U * pclk;
+}
+
+#if RELOJ_ENABLE
+
+#include "cmsis_os2.h"
+#include "RGB.h"
+#include "Potenciometros.h"
+#include "USART.h"
+#include "Watchdog.h"
+#include "Perfil.h"
+#include "Latencia.h"
+#include "Comprobar.h"
+
+/*Frecuencia de los Timers de un APB con el divisor dado*/
+#define RELOJ_TIMER_MHZ(mhz, apb)	(((apb) == 1) ? (mhz) : 2 * (mhz) / (apb))
+
+/*Comprobaciones de cada nivel: Timers multiplos del tick de la PWM, frecuencia del
+	PLL o del HSI, maximos de la escala del regulador (sin Over Drive) y de los APB*/
+#define RELOJ_COMPROBAR_NIVEL(nombre, mhz, pllp, escala, apb1, apb2, ma) \
+	COMPROBAR(RELOJ_TIMER_MHZ(mhz, apb1) * 1000000U % RELOJ_TICK_HZ == 0U && \
+									RELOJ_TIMER_MHZ(mhz, apb2) * 1000000U % RELOJ_TICK_HZ == 0U, tick_##nombre); \
+	COMPROBAR(((pllp) == 0) ? ((mhz) * 1000000U == HSI_VALUE && (apb1) == 1 && (apb2) == 1) : \
+									((mhz) * 1000000U == HSI_VALUE / RELOJ_PLLM * RELOJ_PLLN / (pllp)), pll_##nombre); \
+	COMPROBAR((mhz) <= (((escala) == 1) ? 168 : ((escala) == 2) ? 144 : 120), escala_##nombre); \
+	COMPROBAR((mhz) / (apb1) <= 45 && (mhz) / (apb2) <= 90, apb_##nombre);
+RELOJ_NIVELES(RELOJ_COMPROBAR_NIVEL)
+
+/*Exactamente un nivel funciona con el HSI, y es el paso intermedio de los cambios*/
+#define RELOJ_CUENTA_HSI(nombre, mhz, pllp, escala, apb1, apb2, ma)	+ ((pllp) == 0)
+COMPROBAR((0 RELOJ_NIVELES(RELOJ_CUENTA_HSI)) == 1, un_nivel_hsi);
+
+typedef struct {
+	const char *nombre;
+	uint32_t hz;
+	uint32_t pllp;
+	uint32_t escala;
+	uint32_t apb1;
+	uint32_t apb2;
+	uint32_t ma;
+} Nivel;
+
+#define RELOJ_TABLA_NIVEL(nombre, mhz, pllp, escala, apb1, apb2, ma) \
+	{ #nombre, (mhz) * 1000000U, (pllp), (escala), (apb1), (apb2), (ma) },
+static const Nivel niveles[RELOJ_NUM_NIVELES] = {
+	RELOJ_NIVELES(RELOJ_TABLA_NIVEL)
+};
+
+/*Modo automatico de cambiar_Reloj*/
+#define RELOJ_AUTO RELOJ_NUM_NIVELES
+
+static Reloj_Nivel actual = RELOJ_ALTO;
+static Reloj_Nivel nivel_hsi;
+static volatile uint32_t forzado = RELOJ_AUTO;
+static uint32_t ultima_actividad;
+/*Tiempo en cada nivel e instante del ultimo cambio*/
+static uint32_t ms_nivel[RELOJ_NUM_NIVELES];
+static uint32_t desde_ms;
+static uint32_t cambios = 0;
+static uint32_t reintentos = 0;
+/*Duracion maxima de una conmutacion con las interrupciones deshabilitadas*/
+static uint32_t max_ns = 0;
+
+/**
+  * @brief Funcion que fija los estados de espera de la Flash (3.3 V: uno cada 30 MHz)
+	* @param hz: Frecuencia del sistema
+  * @retval None
+  */
+static void latencia_Flash (uint32_t hz){
+	uint32_t ws = (hz - 1U) / 30000000U;
+
+	MODIFY_REG(FLASH->ACR, FLASH_ACR_LATENCY, ws);
+	while ((FLASH->ACR & FLASH_ACR_LATENCY) != ws) {}
+}
+
+/**
+  * @brief Funcion que codifica un divisor del APB en el formato de los campos PPRE
+	* @param div: Divisor (1, 2, 4, 8 o 16)
+  * @retval Valor del campo PPRE1 o PPRE2
+  */
+static uint32_t ppre (uint32_t div){
+	return (div == 1U) ? 0U : 3U + (31U - __CLZ(div));
+}
+
+/**
+  * @brief Funcion que conmuta el reloj del sistema y reprograma los perifericos que
+	*				 dependen de el. Al subir se fijan primero los divisores de los APB y
+	*				 al bajar despues, para no superar en ningun momento sus maximos.
+	* @param sw: RCC_CFGR_SW_HSI o RCC_CFGR_SW_PLL
+	* @param n: Nivel de destino
+  * @retval 0 si se ha conmutado, -1 si la USART estaba transmitiendo
+  */
+static int conmutar (uint32_t sw, const Nivel *n){
+	uint32_t previo = SystemCoreClock;
+	uint32_t apb = (ppre(n->apb1) << RCC_CFGR_PPRE1_Pos) | (ppre(n->apb2) << RCC_CFGR_PPRE2_Pos);
+	uint32_t primask, t0, t1, ns;
+
+	if (n->hz > previo)
+		latencia_Flash(n->hz);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (!libre_USART()){
+		__set_PRIMASK(primask);
+		return -1;
+	}
+	/*Cierre de las medidas en ciclos con SystemCoreClock todavia en la frecuencia saliente*/
+	reloj_Perfil();
+	reloj_Latencia();
+	t0 = DWT->CYCCNT;
+	if (n->hz > previo)
+		MODIFY_REG(RCC->CFGR, RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2, apb);
+	MODIFY_REG(RCC->CFGR, RCC_CFGR_SW, sw);
+	while ((RCC->CFGR & RCC_CFGR_SWS) != (sw << RCC_CFGR_SWS_Pos)) {}
+	if (n->hz < previo)
+		MODIFY_REG(RCC->CFGR, RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2, apb);
+	t1 = DWT->CYCCNT;
+
+	SystemCoreClock = n->hz;
+	reloj_RGB();
+	reloj_Potenciometros();
+	reloj_USART();
+	/*El tick en curso termina al momento: error inferior a un tick por cambio*/
+	SysTick->LOAD = n->hz / osKernelGetTickFreq() - 1U;
+	SysTick->VAL = 0;
+
+	ns = (t1 - t0) * 1000U / (previo / 1000000U) + (DWT->CYCCNT - t1) * 1000U / (n->hz / 1000000U);
+	__set_PRIMASK(primask);
+
+	if (n->hz < previo)
+		latencia_Flash(n->hz);
+	if (ns > max_ns)
+		max_ns = ns;
+	return 0;
+}
+
+/**
+  * @brief Funcion que reconfigura y engancha el PLL para un nivel. El reloj del
+	*				 sistema debe ser el HSI.
+	* @param n: Nivel con PLL
+  * @retval None
+  */
+static void arrancar_PLL (const Nivel *n){
+	RCC->CR &= ~RCC_CR_PLLON;
+	while ((RCC->CR & RCC_CR_PLLRDY) != 0U) {}
+	MODIFY_REG(PWR->CR, PWR_CR_VOS, (4U - n->escala) << PWR_CR_VOS_Pos);
+	RCC->PLLCFGR = RCC_PLLCFGR_PLLSRC_HSI | (RELOJ_PLLM << RCC_PLLCFGR_PLLM_Pos) |
+								 (RELOJ_PLLN << RCC_PLLCFGR_PLLN_Pos) | (((n->pllp >> 1) - 1U) << RCC_PLLCFGR_PLLP_Pos) |
+								 (RELOJ_PLLQ << RCC_PLLCFGR_PLLQ_Pos);
+	RCC->CR |= RCC_CR_PLLON;
+	while ((RCC->CR & RCC_CR_PLLRDY) == 0U) {}
+	while ((PWR->CSR & PWR_CSR_VOSRDY) == 0U) {}
+}
+
+/**
+  * @brief Funcion que acumula el tiempo del nivel actual y pasa al indicado
+	* @param n: Nuevo nivel
+  * @retval None
+  */
+static void apuntar (Reloj_Nivel n){
+	uint32_t ahora = osKernelGetTickCount();
+
+	ms_nivel[actual] += ahora - desde_ms;
+	desde_ms = ahora;
+	actual = n;
+}
+
+/**
+  * @brief Funcion que cambia el nivel de la frecuencia del sistema pasando por el HSI
+	* @param n: Nivel de destino
+  * @retval 0 si se ha cambiado, -1 si la USART estaba ocupada (se reintenta despues)
+  */
+static int cambiar_Nivel (Reloj_Nivel n){
+	if (niveles[actual].pllp != 0U){
+		if (conmutar(RCC_CFGR_SW_HSI, &niveles[nivel_hsi]) != 0)
+			return -1;
+		apuntar(nivel_hsi);
+		RCC->CR &= ~RCC_CR_PLLON;
+	}
+	if (niveles[n].pllp != 0U){
+		arrancar_PLL(&niveles[n]);
+		if (conmutar(RCC_CFGR_SW_PLL, &niveles[n]) != 0){
+			RCC->CR &= ~RCC_CR_PLLON;
+			return -1;
+		}
+		apuntar(n);
+	}
+	cambios++;
+	return 0;
+}
+
+/**
+  * @brief Funcion de inicializacion del escalado. Se llama desde el hilo de control
+	*				 con el sistema en el nivel que ha configurado SystemClock_Config.
+	* @param None
+  * @retval None
+  */
+void init_Reloj (void){
+	for (int i = 0; i < RELOJ_NUM_NIVELES; i++){
+		if (niveles[i].pllp == 0U)
+			nivel_hsi = (Reloj_Nivel)i;
+		if (niveles[i].hz == SystemCoreClock)
+			actual = (Reloj_Nivel)i;
+	}
+	desde_ms = osKernelGetTickCount();
+	ultima_actividad = desde_ms;
+}
+
+/**
+  * @brief Funcion que aplica el nivel forzado o, en modo automatico, el que
+	*				 corresponde al tiempo sin eventos del usuario. Se llama desde el bucle
+	*				 del hilo de control.
+	* @param None
+  * @retval None
+  */
+void periodico_Reloj (void){
+	uint32_t inactivo = osKernelGetTickCount() - ultima_actividad;
+	Reloj_Nivel n;
+
+	if (forzado != RELOJ_AUTO)
+		n = (Reloj_Nivel)forzado;
+	else if (inactivo >= RELOJ_BAJO_MS)
+		n = RELOJ_BAJO;
+	else if (inactivo >= RELOJ_MEDIO_MS)
+		n = RELOJ_MEDIO;
+	else
+		n = RELOJ_ALTO;
+	if (n != actual && cambiar_Nivel(n) != 0)
+		reintentos++;
+}
+
+/**
+  * @brief Funcion que registra un evento del usuario y sube al nivel alto. Se llama
+	*				 desde el hilo de control despues de actuar sobre el LED.
+	* @param None
+  * @retval None
+  */
+void actividad_Reloj (void){
+	ultima_actividad = osKernelGetTickCount();
+	periodico_Reloj();
+}
+
+/**
+  * @brief Funcion que recorre los modos automatico, ALTO, MEDIO y BAJO. El hilo de
+	*				 control aplica el cambio en su siguiente vuelta.
+	* @param None
+  * @retval None
+  */
+void cambiar_Reloj (void){
+	char buf[50];
+	int size;
+
+	forzado = (forzado == RELOJ_AUTO) ? 0U : forzado + 1U;
+	size = sprintf(buf, "\r Nivel de reloj: %s\n", (forzado == RELOJ_AUTO) ? "auto" : niveles[forzado].nombre);
+	tx_USART(buf, size);
+}
+
+/**
+  * @brief Funcion que envia por la USART el tiempo en cada nivel con su consumo
+	*				 estimado, el consumo medio y el ahorro frente a estar siempre en el
+	*				 nivel alto, y la duracion maxima de una conmutacion.
+	* @param None
+  * @retval None
+  */
+void informe_Reloj (void){
+	char buf[100];
+	int size;
+	uint32_t ms[RELOJ_NUM_NIVELES];
+	uint32_t ahora, total = 0, media, ahorro;
+	uint64_t carga = 0;
+
+	/*Se lee con el nucleo bloqueado para no cruzarse con un cambio del hilo de control*/
+	osKernelLock();
+	ahora = osKernelGetTickCount();
+	for (int i = 0; i < RELOJ_NUM_NIVELES; i++)
+		ms[i] = ms_nivel[i];
+	ms[actual] += ahora - desde_ms;
+	osKernelUnlock();
+
+	for (int i = 0; i < RELOJ_NUM_NIVELES; i++)
+		total += ms[i];
+	if (total == 0U)
+		total = 1;
+
+	for (int i = 0; i < RELOJ_NUM_NIVELES; i++){
+		carga += (uint64_t)ms[i] * niveles[i].ma;
+		size = sprintf(buf, "\r %-5s %3u MHz: %u ms (%u%%) ~%u mA\n", niveles[i].nombre,
+									 (unsigned)(niveles[i].hz / 1000000U), (unsigned)ms[i],
+									 (unsigned)((uint64_t)ms[i] * 100U / total), (unsigned)niveles[i].ma);
+		tx_USART(buf, size);
+		reset_Watchdog();
+	}
+	/*Consumo medio en decimas de mA y ahorro frente al nivel alto en %*/
+	media = (uint32_t)(carga * 10U / total);
+	ahorro = 100U - media * 10U / niveles[RELOJ_ALTO].ma;
+	size = sprintf(buf, "\r Medio ~%u.%u mA, ahorro ~%u%% frente a %s\n", (unsigned)(media / 10U),
+								 (unsigned)(media % 10U), (unsigned)ahorro, niveles[RELOJ_ALTO].nombre);
+	tx_USART(buf, size);
+	size = sprintf(buf, "\r Nivel %s (%s) cambios=%u reintentos=%u conmutacion max=%u.%03uus\n",
+								 niveles[actual].nombre, (forzado == RELOJ_AUTO) ? "auto" : "fijo",
+								 (unsigned)cambios, (unsigned)reintentos, (unsigned)(max_ns / 1000U),
+								 (unsigned)(max_ns % 1000U));
+	tx_USART(buf, size);
+}
+
+#endif
@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Reloj.h
+  * @author  MCD Application Team
+  * @brief   Libreria de escalado dinamico de la frecuencia del sistema. Se
+	*					 definen varios niveles de rendimiento y el hilo de control pasa al
+	*					 nivel alto con cada evento del usuario y baja de nivel tras un
+	*					 tiempo sin actividad.
+	*
+	*					 Todos los niveles son multiplos de RELOJ_TICK_HZ, que es el reloj
+	*					 de cuenta de los Timers de la PWM del LED RGB. En cada cambio se
+	*					 reprograman sus prescalers conservando el contador, por lo que la
+	*					 frecuencia y el ciclo de trabajo de la PWM no varian. Tambien se
+	*					 recalculan el divisor de la USART, el prescaler del TIM2 que
+	*					 dispara el ADC y la recarga del SysTick.
+	*
+	*					 Con RELOJ_ENABLE a 0 el sistema se queda en el nivel alto.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __RELOJ_H
+#define __RELOJ_H
+
+#include "stm32f4xx_hal.h"
+
+/*Habilitacion del cambio de nivel (0: siempre en el nivel alto)*/
+#ifndef RELOJ_ENABLE
+#define RELOJ_ENABLE 1
+#endif
+
+/*Reloj de cuenta de los Timers de la PWM en todos los niveles (PWM de 3906 Hz con
+	el periodo de RGB_ARR + 1 cuentas de RGB.h)*/
+#define RELOJ_TICK_HZ   16000000U
+/*PLL: VCO = HSI / RELOJ_PLLM * RELOJ_PLLN = 320 MHz, comun a todos los niveles*/
+#define RELOJ_PLLM      8U
+#define RELOJ_PLLN      160U
+#define RELOJ_PLLQ      7U
+
+/*Niveles: NIVEL(nombre, MHz, PLLP (0: HSI sin PLL), escala del regulador, divisor
+	APB1, divisor APB2, consumo estimado en mA). El consumo es el tipico de la hoja de
+	datos en ejecucion desde la Flash y se usa solo para estimar el ahorro*/
+#define RELOJ_NIVELES(NIVEL) \
+	NIVEL(ALTO,  160, 2, 1, 4, 2, 45) \
+	NIVEL(MEDIO, 80,  4, 3, 2, 1, 24) \
+	NIVEL(BAJO,  16,  0, 3, 1, 1, 7)
+
+#define RELOJ_ENUM_NIVEL(nombre, mhz, pllp, escala, apb1, apb2, ma)	RELOJ_##nombre,
+typedef enum {
+	RELOJ_NIVELES(RELOJ_ENUM_NIVEL)
+	RELOJ_NUM_NIVELES
+} Reloj_Nivel;
+
+/*Tiempo sin eventos del usuario para bajar a cada nivel*/
+#define RELOJ_MEDIO_MS  1000U
+#define RELOJ_BAJO_MS   10000U
+
+uint32_t timer_Reloj (const TIM_TypeDef *tim);
+
+#if RELOJ_ENABLE
+
+void init_Reloj (void);
+void actividad_Reloj (void);
+void periodico_Reloj (void);
+void cambiar_Reloj (void);
+void informe_Reloj (void);
+
+#else
+
+#define init_Reloj()         ((void)0)
+#define actividad_Reloj()    ((void)0)
+#define periodico_Reloj()    ((void)0)
+#define cambiar_Reloj()      ((void)0)
+#define informe_Reloj()      ((void)0)
+
+#endif
+
+#endif /* __RELOJ_H */
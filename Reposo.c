@@ -0,0 +1,403 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Reposo.c
+  * @author  MCD Application Team
+  * @brief   Fichero del hilo idle de bajo consumo (tickless idle) del RTX5.
+	*
+	*					 Cuando todos los hilos estan bloqueados se suspende el planificador
+	*					 (osKernelSuspend), lo que detiene el SysTick, y se programa el
+	*					 temporizador de despertar del RTC con los ticks que faltan hasta el
+	*					 siguiente vencimiento. Al despertar se mide el tiempo dormido con el
+	*					 contador de subsegundos del RTC y se devuelve al sistema operativo
+	*					 (osKernelResume) para que actualice su cuenta de ticks.
+	*
+	*					 El RTC funciona con el LSI, cuya frecuencia real (17 - 47 kHz) se
+	*					 calibra al inicio midiendo su periodo con la captura del TIM5.
+	*
+	*					 En modo STOP se para el reloj de los Timers, por lo que solo se
+	*					 entra si el LED RGB esta apagado. Despiertan del modo STOP las
+	*					 lineas EXTI del joystick, el temporizador del RTC y el pin RX de
+	*					 la USART3 (el primer caracter recibido solo despierta al sistema).
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Reposo.h"
+
+#if REPOSO_ENABLE
+
+#include "cmsis_os2.h"
+#include "RTE_Device.h"
+#include "Placa.h"
+#include "RGB.h"
+#include "USART.h"
+#include "Watchdog.h"
+#include "Perfil.h"
+
+RTC_HandleTypeDef hrtc;
+
+/*Prescalers del RTC: el contador de subsegundos (SSR) avanza a LSI/8 (~4 kHz)*/
+#define RTC_PREDIV_A          7U
+#define RTC_PREDIV_S          0x7FFFU
+/*Periodos de LSI/8 que se promedian en la calibracion*/
+#define CALIBRACION_PERIODOS  4U
+
+/*Linea EXTI del pin RX de la USART3*/
+#define LINEA_RX  (1U << RTE_USART3_RX_BIT)
+
+typedef struct {
+	uint32_t entradas;
+	uint32_t por_rtc;					/*Despertares por el temporizador del RTC*/
+	uint64_t ms;							/*Tiempo total dormido*/
+	uint64_t suma_ns;					/*Tiempo de reanudacion acumulado*/
+	uint32_t max_ns;
+} Estadistica;
+
+static Estadistica estadisticas[REPOSO_NUM];
+static volatile uint32_t profundidad_max = REPOSO_STOP;
+static uint32_t lsi_hz;
+/*Fraccion de tick (en periodos de LSI/8 x 1000) pendiente de devolver al sistema*/
+static uint32_t resto = 0;
+
+static const char * const nombres[REPOSO_NUM] = {"WFI", "Sleep", "STOP"};
+
+/**
+  * @brief Funcion que mide la frecuencia del LSI capturando con el TIM5 (TI4
+	*				 conectada internamente al LSI) la duracion de varios grupos de 8
+	*				 flancos.
+	* @param None
+  * @retval Frecuencia del LSI en Hz
+  */
+static uint32_t calibrar_LSI (void){
+	uint32_t reloj_tim = HAL_RCC_GetPCLK1Freq();
+	uint32_t inicio, fin = 0;
+
+	/*El reloj de los Timers del APB1 es el doble del PCLK1 si el APB1 esta dividido*/
+	if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1)
+		reloj_tim *= 2U;
+
+	__HAL_RCC_TIM5_CLK_ENABLE();
+	TIM5->PSC = 0;
+	TIM5->ARR = 0xFFFFFFFFU;
+	TIM5->OR = TIM_OR_TI4_RMP_0;
+	TIM5->CCMR2 = TIM_CCMR2_CC4S_0 | TIM_CCMR2_IC4PSC;
+	TIM5->CCER = TIM_CCER_CC4E;
+	TIM5->EGR = TIM_EGR_UG;
+	TIM5->SR = 0;
+	TIM5->CR1 = TIM_CR1_CEN;
+
+	while ((TIM5->SR & TIM_SR_CC4IF) == 0U) {}
+	inicio = TIM5->CCR4;
+	for (uint32_t i = 0; i < CALIBRACION_PERIODOS; i++){
+		while ((TIM5->SR & TIM_SR_CC4IF) == 0U) {}
+		fin = TIM5->CCR4;
+	}
+
+	TIM5->CR1 = 0;
+	__HAL_RCC_TIM5_CLK_DISABLE();
+	return (uint32_t)(((uint64_t)reloj_tim * 8U * CALIBRACION_PERIODOS) / (fin - inicio));
+}
+
+/**
+  * @brief Funcion que devuelve el contador de subsegundos del RTC. Se lee dos
+	*				 veces ya que se accede sin registros sombra.
+	* @param None
+  * @retval Valor del registro SSR
+  */
+static uint32_t leer_SSR (void){
+	uint32_t a, b;
+
+	do {
+		a = hrtc.Instance->SSR;
+		b = hrtc.Instance->SSR;
+	} while (a != b);
+	return a;
+}
+
+/**
+  * @brief Funcion que programa el temporizador de despertar del RTC
+	* @param ms: Tiempo hasta el despertar
+  * @retval None
+  */
+static void programar_Despertador (uint32_t ms){
+	/*El temporizador cuenta a RTCCLK/16*/
+	uint32_t cuenta = (ms * (lsi_hz / 16U)) / 1000U;
+
+	if (cuenta == 0U)
+		cuenta = 1U;
+	__HAL_RTC_WRITEPROTECTION_DISABLE(&hrtc);
+	__HAL_RTC_WAKEUPTIMER_DISABLE(&hrtc);
+	while (__HAL_RTC_WAKEUPTIMER_GET_FLAG(&hrtc, RTC_FLAG_WUTWF) == RESET) {}
+	hrtc.Instance->WUTR = cuenta - 1U;
+	MODIFY_REG(hrtc.Instance->CR, RTC_CR_WUCKSEL, RTC_WAKEUPCLOCK_RTCCLK_DIV16);
+	__HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(&hrtc, RTC_FLAG_WUTF);
+	__HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG();
+	__HAL_RTC_WAKEUPTIMER_ENABLE_IT(&hrtc, RTC_IT_WUT);
+	__HAL_RTC_WAKEUPTIMER_ENABLE(&hrtc);
+	__HAL_RTC_WRITEPROTECTION_ENABLE(&hrtc);
+}
+
+/**
+  * @brief Funcion que detiene el temporizador de despertar del RTC
+	* @param None
+  * @retval 1 si el temporizador ha vencido, 0 en caso contrario
+  */
+static uint32_t parar_Despertador (void){
+	uint32_t vencido = (__HAL_RTC_WAKEUPTIMER_GET_FLAG(&hrtc, RTC_FLAG_WUTF) != RESET) ? 1U : 0U;
+
+	__HAL_RTC_WRITEPROTECTION_DISABLE(&hrtc);
+	__HAL_RTC_WAKEUPTIMER_DISABLE(&hrtc);
+	__HAL_RTC_WAKEUPTIMER_DISABLE_IT(&hrtc, RTC_IT_WUT);
+	__HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(&hrtc, RTC_FLAG_WUTF);
+	__HAL_RTC_WRITEPROTECTION_ENABLE(&hrtc);
+	__HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG();
+	NVIC_ClearPendingIRQ(RTC_WKUP_IRQn);
+	return vencido;
+}
+
+/**
+  * @brief Funcion que arranca el PLL y el Over Drive al salir del modo STOP, en el
+	*				 que el hardware selecciona el HSI como reloj del sistema.
+	* @param od: Distinto de 0 si el Over Drive estaba activo antes de entrar en STOP
+  * @retval None
+  */
+static void arrancar_PLL (uint32_t od){
+	RCC->CR |= RCC_CR_PLLON;
+	while ((RCC->CR & RCC_CR_PLLRDY) == 0U) {}
+	if (od != 0U && (PWR->CSR & PWR_CSR_ODSWRDY) == 0U){
+		PWR->CR |= PWR_CR_ODEN;
+		while ((PWR->CSR & PWR_CSR_ODRDY) == 0U) {}
+		PWR->CR |= PWR_CR_ODSWEN;
+		while ((PWR->CSR & PWR_CSR_ODSWRDY) == 0U) {}
+	}
+}
+
+/**
+  * @brief Funcion que duerme el sistema en la profundidad indicada hasta que vence
+	*				 el temporizador del RTC o llega una interrupcion. Se llama con el
+	*				 planificador suspendido.
+	* @param profundidad: REPOSO_SLEEP o REPOSO_STOP
+	* @param ticks: Ticks hasta el siguiente vencimiento del sistema operativo
+  * @retval Ticks transcurridos
+  */
+static uint32_t dormir (uint32_t profundidad, uint32_t ticks){
+	Estadistica *e = &estadisticas[profundidad];
+	uint32_t ssr, t0, ciclos, reloj, periodos, ms, ns;
+	uint32_t pll = 0, od = 0;
+
+	__disable_irq();
+	programar_Despertador(ticks);
+	if (profundidad == REPOSO_STOP){
+		pll = ((RCC->CFGR & RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL) ? 1U : 0U;
+		od = PWR->CR & PWR_CR_ODEN;
+		/*El pin RX despierta al sistema por flanco de bajada (bit de start)*/
+		EXTI->PR = LINEA_RX;
+		EXTI->FTSR |= LINEA_RX;
+		EXTI->IMR |= LINEA_RX;
+		MODIFY_REG(PWR->CR, (PWR_CR_PDDS | PWR_CR_LPDS), PWR_LOWPOWERREGULATOR_ON);
+		SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+	}
+	ssr = leer_SSR();
+
+	/*Con SEVONPEND cualquier interrupcion pendiente, aun enmascarada, despierta al WFE.
+		Si se ha atendido una interrupcion desde la suspension el WFE retorna al momento*/
+	__DSB();
+	__WFE();
+	t0 = DWT->CYCCNT;
+
+	if (profundidad == REPOSO_STOP){
+		SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+		reloj = HSI_VALUE;
+		if (pll != 0U)
+			arrancar_PLL(od);
+		ciclos = DWT->CYCCNT - t0;
+		if (pll != 0U){
+			MODIFY_REG(RCC->CFGR, RCC_CFGR_SW, RCC_CFGR_SW_PLL);
+			while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL) {}
+		}
+		EXTI->IMR &= ~LINEA_RX;
+		EXTI->FTSR &= ~LINEA_RX;
+		EXTI->PR = LINEA_RX;
+	}
+	else {
+		reloj = SystemCoreClock;
+		ciclos = DWT->CYCCNT - t0;
+	}
+
+	periodos = (ssr - leer_SSR()) & RTC_PREDIV_S;
+	if (parar_Despertador())
+		e->por_rtc++;
+	__enable_irq();
+
+	/*Conversion a ticks de 1 ms conservando la fraccion para no acumular deriva*/
+	resto += periodos * 8000U;
+	ms = resto / lsi_hz;
+	resto -= ms * lsi_hz;
+	if (ms > ticks)
+		ms = ticks;
+	/*El CYCCNT no avanza en STOP: el perfil carga el tiempo dormido al hilo idle*/
+	if (profundidad == REPOSO_STOP)
+		parado_Perfil(ms);
+
+	ns = (uint32_t)(((uint64_t)ciclos * 1000000000U) / reloj);
+	e->entradas++;
+	e->ms += ms;
+	e->suma_ns += ns;
+	if (ns > e->max_ns)
+		e->max_ns = ns;
+	return ms;
+}
+
+/**
+  * @brief Hilo idle del RTX5. Sustituye a la definicion debil de RTX_Config.c
+	* @param argument
+  * @retval None
+  */
+__NO_RETURN void osRtxIdleThread (void *argument){
+	uint32_t ticks;
+	uint32_t profundidad;
+
+	(void)argument;
+	for (;;){
+		if (profundidad_max == REPOSO_WFI){
+			estadisticas[REPOSO_WFI].entradas++;
+			__WFI();
+			continue;
+		}
+
+		ticks = osKernelSuspend();
+		if (ticks < REPOSO_MIN_MS){
+			/*No compensa detener el SysTick*/
+			osKernelResume(0);
+			estadisticas[REPOSO_WFI].entradas++;
+			__WFI();
+			continue;
+		}
+		if (ticks > REPOSO_MAX_MS)
+			ticks = REPOSO_MAX_MS;
+
+		if (profundidad_max == REPOSO_STOP && ticks >= REPOSO_STOP_MIN_MS && !encendido_RGB())
+			profundidad = REPOSO_STOP;
+		else
+			profundidad = REPOSO_SLEEP;
+		osKernelResume(dormir(profundidad, ticks));
+	}
+}
+
+/**
+  * @brief Funcion de inicializacion del RTC, de la calibracion del LSI y de las
+	*				 fuentes de despertar del modo STOP. Se llama antes de arrancar el
+	*				 sistema operativo.
+	* @param None
+  * @retval 0 si la inicializacion es correcta, -1 en caso contrario
+  */
+int init_Reposo (void){
+	uint32_t desplazamiento = 4U * (RTE_USART3_RX_BIT & 3U);
+
+	/*Contador de ciclos para medir el tiempo de reanudacion*/
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	hrtc.Instance = RTC;
+	hrtc.Init.HourFormat = RTC_HOURFORMAT_24;
+	hrtc.Init.AsynchPrediv = RTC_PREDIV_A;
+	hrtc.Init.SynchPrediv = RTC_PREDIV_S;
+	hrtc.Init.OutPut = RTC_OUTPUT_DISABLE;
+	hrtc.Init.OutPutPolarity = RTC_OUTPUT_POLARITY_HIGH;
+	hrtc.Init.OutPutType = RTC_OUTPUT_TYPE_OPENDRAIN;
+	if (HAL_RTC_Init(&hrtc) != HAL_OK)
+		return -1;
+	if (HAL_RTCEx_EnableBypassShadow(&hrtc) != HAL_OK)
+		return -1;
+
+	lsi_hz = calibrar_LSI();
+
+	/*Temporizador de despertar del RTC: linea EXTI 22*/
+	__HAL_RTC_WAKEUPTIMER_EXTI_ENABLE_IT();
+	__HAL_RTC_WAKEUPTIMER_EXTI_ENABLE_RISING_EDGE();
+	HAL_NVIC_EnableIRQ(RTC_WKUP_IRQn);
+
+	/*Linea EXTI del pin RX de la USART3. Solo se desenmascara durante el modo STOP*/
+	SYSCFG->EXTICR[RTE_USART3_RX_BIT >> 2] = (SYSCFG->EXTICR[RTE_USART3_RX_BIT >> 2] & ~(0xFU << desplazamiento)) |
+																					 (PLACA_GPIO_INDICE(RTE_USART3_RX_PORT) << desplazamiento);
+	if (RTE_USART3_RX_BIT < 5)
+		HAL_NVIC_EnableIRQ((IRQn_Type)(EXTI0_IRQn + RTE_USART3_RX_BIT));
+	else if (RTE_USART3_RX_BIT < 10)
+		HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+	else
+		HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+
+	/*Flash apagada durante STOP y despertar del WFE con interrupciones enmascaradas*/
+	HAL_PWREx_EnableFlashPowerDown();
+	HAL_PWR_EnableSEVOnPend();
+	return 0;
+}
+
+/**
+  * @brief Funcion que fija la profundidad maxima de reposo
+	* @param profundidad: REPOSO_WFI, REPOSO_SLEEP o REPOSO_STOP
+  * @retval None
+  */
+void profundidad_Reposo (uint32_t profundidad){
+	if (profundidad < REPOSO_NUM)
+		profundidad_max = profundidad;
+}
+
+/**
+  * @brief Funcion que pasa a la siguiente profundidad maxima de reposo, para medir
+	*				 el consumo de cada una, y la envia por la USART.
+	* @param None
+  * @retval None
+  */
+void cambiar_Reposo (void){
+	char buf[60];
+	int size;
+
+	profundidad_Reposo((profundidad_max + 1U) % REPOSO_NUM);
+	size = sprintf(buf, "\r Reposo maximo: %s\n", nombres[profundidad_max]);
+	tx_USART(buf, size);
+}
+
+/**
+  * @brief Funcion que envia por la USART, para cada profundidad de reposo, el
+	*				 numero de entradas, los despertares por el RTC, el tiempo dormido y
+	*				 el tiempo de reanudacion medio y maximo. El tiempo de reanudacion es
+	*				 el que tarda el software en tener el reloj del sistema listo, sin el
+	*				 arranque del regulador que indica la hoja de datos.
+	* @param None
+  * @retval None
+  */
+void informe_Reposo (void){
+	char buf[100];
+	int size;
+	uint32_t total = osKernelGetTickCount();
+	const Estadistica *e;
+
+	size = sprintf(buf, "\r LSI: %u Hz, reposo maximo: %s, t=%ums\n", (unsigned)lsi_hz, nombres[profundidad_max], (unsigned)total);
+	tx_USART(buf, size);
+	reset_Watchdog();
+	for (int i = 0; i < REPOSO_NUM; i++){
+		e = &estadisticas[i];
+		if (i == REPOSO_WFI || e->entradas == 0U){
+			size = sprintf(buf, "\r %s: n=%u\n", nombres[i], (unsigned)e->entradas);
+		}
+		else {
+			size = sprintf(buf, "\r %s: n=%u rtc=%u dormido=%ums (%u%%) reanudacion avg=%uns max=%uns\n", nombres[i],
+										 (unsigned)e->entradas,
+										 (unsigned)e->por_rtc,
+										 (unsigned)e->ms,
+										 (unsigned)((e->ms * 100U) / (total ? total : 1U)),
+										 (unsigned)(e->suma_ns / e->entradas),
+										 (unsigned)e->max_ns);
+		}
+		tx_USART(buf, size);
+		reset_Watchdog();
+	}
+}
+
+#endif
@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Reposo.h
+  * @author  MCD Application Team
+  * @brief   Libreria de bajo consumo del sistema. Sustituye el hilo idle del
+	*					 RTX5 por uno que detiene el SysTick mientras todos los hilos estan
+	*					 bloqueados (tickless idle) y duerme hasta el siguiente vencimiento
+	*					 del sistema operativo o hasta una interrupcion del joystick o de
+	*					 la USART. Profundidades de reposo:
+	*							- REPOSO_WFI: WFI con el SysTick en marcha (sin tickless)
+	*							- REPOSO_SLEEP: modo Sleep sin SysTick. Los Timers siguen
+	*								generando la PWM del LED RGB.
+	*							- REPOSO_STOP: modo STOP con el regulador en bajo consumo. Solo
+	*								se usa si el LED RGB esta apagado.
+	*
+	*					 Con REPOSO_ENABLE a 0 se usa el hilo idle por defecto del RTX5.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __REPOSO_H
+#define __REPOSO_H
+
+#include "stm32f4xx_hal.h"
+
+/*Habilitacion del tickless idle*/
+#ifndef REPOSO_ENABLE
+#define REPOSO_ENABLE 1
+#endif
+
+/*Profundidades de reposo*/
+#define REPOSO_WFI          0
+#define REPOSO_SLEEP        1
+#define REPOSO_STOP         2
+#define REPOSO_NUM          3
+
+/*Ticks minimos hasta el siguiente vencimiento para suprimir el SysTick*/
+#define REPOSO_MIN_MS       2U
+/*Ticks minimos para compensar el arranque del PLL al salir de STOP*/
+#define REPOSO_STOP_MIN_MS  5U
+/*Reposo maximo, inferior a la ventana de 250 ms del IWDG*/
+#define REPOSO_MAX_MS       200U
+
+#if REPOSO_ENABLE
+
+extern RTC_HandleTypeDef hrtc;
+
+int init_Reposo (void);
+void profundidad_Reposo (uint32_t profundidad);
+void cambiar_Reposo (void);
+void informe_Reposo (void);
+
+#else
+
+#define init_Reposo()            (0)
+#define profundidad_Reposo(p)    ((void)0)
+#define cambiar_Reposo()         ((void)0)
+#define informe_Reposo()         ((void)0)
+
+#endif
+
+#endif /* __REPOSO_H */
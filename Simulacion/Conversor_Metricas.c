@@ -0,0 +1,149 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Conversor_Metricas.c
+  * @author  MCD Application Team
+  * @brief   Decodificador de las tramas del registro de metricas (comando 'M',
+	*					 formato en Metricas.h). Busca las tramas en la secuencia de bytes
+	*					 recibida por la USART, descarta el texto del resto de comandos y
+	*					 las tramas con la suma de comprobacion incorrecta, y muestra cada
+	*					 volcado en texto.
+	*
+	*					 Uso: rgb_metricas [captura]
+	*							 stty -F /dev/ttyACM0 115200 raw && rgb_metricas < /dev/ttyACM0
+	*					 La captura puede ser la del simulador (rgb_sim -t). Sin fichero se
+	*					 lee la entrada estandar segun llegan los datos.
+	*
+	*					 Los nombres de las metricas salen de METRICAS_LISTA, por lo que el
+	*					 decodificador se debe compilar con la misma version de Metricas.h
+	*					 que el firmware; una trama con otros tipos se rechaza.
+  *
+  ******************************************************************************
+  */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "Metricas.h"
+
+#define TAM_BUFFER  4096U
+
+#define NOMBRE(n)  #n,
+static const char *const nombres[] = {
+	METRICAS_LISTA(NOMBRE, NOMBRE, NOMBRE)
+};
+
+#define TIPO_CONTADOR(n)    METRICAS_TIPO_CONTADOR,
+#define TIPO_MEDIDOR(n)     METRICAS_TIPO_MEDIDOR,
+#define TIPO_HISTOGRAMA(n)  METRICAS_TIPO_HISTOGRAMA,
+static const uint8_t tipos[] = {
+	METRICAS_LISTA(TIPO_CONTADOR, TIPO_MEDIDOR, TIPO_HISTOGRAMA)
+};
+
+#define NUM_METRICAS  (sizeof(tipos) / sizeof(tipos[0]))
+#define TAM_TRAMA     (10U + NUM_METRICAS + 4U * MET_NUM_VALORES + 2U)
+
+static uint32_t leer_32 (const uint8_t *p){
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t fletcher16 (const uint8_t *p, uint32_t n){
+	uint32_t a = 0, b = 0;
+
+	while (n-- != 0U){
+		a = (a + *p++) % 255U;
+		b = (b + a) % 255U;
+	}
+	return (uint16_t)((b << 8) | a);
+}
+
+/**
+  * @brief Funcion que muestra un histograma: cuentas, media y cubetas no vacias
+	* @param v: Cubetas seguidas de la suma
+  * @retval None
+  */
+static void mostrar_Histograma (const char *nombre, const uint8_t *v){
+	uint64_t n = 0;
+	uint32_t suma = leer_32(v + 4U * METRICAS_CUBETAS);
+	uint32_t c;
+
+	for (uint32_t i = 0; i < METRICAS_CUBETAS; i++)
+		n += leer_32(v + 4U * i);
+	printf("  %-24s n=%llu suma=%u media=%.1f\n", nombre, (unsigned long long)n, (unsigned)suma,
+				 (n > 0U) ? (double)suma / (double)n : 0.0);
+	for (uint32_t i = 0; i < METRICAS_CUBETAS; i++){
+		if ((c = leer_32(v + 4U * i)) == 0U)
+			continue;
+		if (i == 0U)
+			printf("  %-24s   0: %u\n", "", (unsigned)c);
+		else if (i == METRICAS_CUBETAS - 1U)
+			printf("  %-24s   >= %u: %u\n", "", 1U << (i - 1U), (unsigned)c);
+		else
+			printf("  %-24s   %u..%u: %u\n", "", 1U << (i - 1U), (1U << i) - 1U, (unsigned)c);
+	}
+}
+
+/**
+  * @brief Funcion que valida y muestra una trama
+	* @param t: Trama completa (TAM_TRAMA bytes desde 'M' 'T')
+  * @retval 0 si es valida, -1 en caso contrario
+  */
+static int mostrar_Trama (const uint8_t *t){
+	const uint8_t *v = t + 10U + NUM_METRICAS;
+	uint16_t suma = (uint16_t)(t[TAM_TRAMA - 2U] | (t[TAM_TRAMA - 1U] << 8));
+
+	if (t[2] != METRICAS_VERSION || t[3] != NUM_METRICAS || (t[4] | (t[5] << 8)) != MET_NUM_VALORES ||
+			memcmp(t + 10, tipos, NUM_METRICAS) != 0 || fletcher16(t + 2, TAM_TRAMA - 4U) != suma)
+		return -1;
+
+	printf("metricas t=%u ms\n", (unsigned)leer_32(t + 6));
+	for (uint32_t m = 0; m < NUM_METRICAS; m++){
+		if (tipos[m] == METRICAS_TIPO_HISTOGRAMA){
+			mostrar_Histograma(nombres[m], v);
+			v += 4U * (METRICAS_CUBETAS + 1U);
+		}
+		else {
+			printf("  %-24s %u\n", nombres[m], (unsigned)leer_32(v));
+			v += 4;
+		}
+	}
+	fflush(stdout);
+	return 0;
+}
+
+int main (int argc, char *argv[]){
+	static uint8_t buf[TAM_BUFFER];
+	size_t usado = 0, i;
+	ssize_t n;
+	int fd = 0;
+	unsigned tramas = 0, erroneas = 0;
+
+	if (argc > 2){
+		fprintf(stderr, "uso: %s [captura]\n", argv[0]);
+		return 1;
+	}
+	if (argc == 2 && (fd = open(argv[1], O_RDONLY)) < 0){
+		perror(argv[1]);
+		return 1;
+	}
+	while ((n = read(fd, buf + usado, sizeof(buf) - usado)) > 0){
+		usado += (size_t)n;
+		/*Se busca el inicio de trama; una trama incompleta espera a mas datos*/
+		for (i = 0; i + 1U < usado; i++){
+			if (buf[i] != 'M' || buf[i + 1U] != 'T')
+				continue;
+			if (usado - i < TAM_TRAMA)
+				break;
+			if (mostrar_Trama(&buf[i]) == 0){
+				tramas++;
+				i += TAM_TRAMA - 1U;
+			}
+			else
+				erroneas++;
+		}
+		memmove(buf, buf + i, usado - i);
+		usado -= i;
+	}
+	fprintf(stderr, "%u tramas, %u descartadas\n", tramas, erroneas);
+	return (tramas > 0U) ? 0 : 1;
+}
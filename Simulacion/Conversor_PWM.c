@@ -0,0 +1,339 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Conversor_PWM.c
+  * @author  MCD Application Team
+  * @brief   Conversor de la traza binaria de la PWM del LED (rgb_sim -p) a VCD,
+	*					 CSV y grafica SVG, con estadisticas de escalones, destellos y
+	*					 desgarros.
+	*
+	*					 Uso: rgb_pwm [-v f.vcd] [-c f.csv] [-g f.svg] [-u umbral]
+	*											 [-f periodos] traza.pwm
+	*							- -v: forma de onda para GTKWave (brillo real y habilitacion)
+	*							- -c: un cambio por linea: t_ms,canal,ccr,activo,brillo
+	*							- -g: grafica del brillo de cada canal frente al tiempo
+	*							- -u: escalon visible en % de brillo por periodo (2)
+	*							- -f: duracion maxima en periodos de un destello (3)
+	*
+	*					 Brillo de un periodo: (65535 - CCR) / 65535 con la salida activa y
+	*					 0 sin ella. Estadisticas por canal:
+	*							- escalon maximo: mayor cambio de brillo entre dos periodos
+	*								consecutivos, que es lo que el ojo percibe en un fundido
+	*							- escalones visibles: cambios mayores que el umbral
+	*							- destellos: niveles que duran menos de -f periodos y a los que
+	*								sigue un cambio de sentido contrario (pico o valle)
+	*					 Desgarro: lote de cambios de varios canales (una misma
+	*					 actualizacion del firmware) que entra en vigor en instantes
+	*					 distintos porque los Timers de los canales no estan en fase, de
+	*					 forma que durante ese intervalo el LED muestra un color mezcla.
+  *
+  ******************************************************************************
+  */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Sim_PWM.h"
+
+#define SVG_ANCHO  1200
+#define SVG_ALTO   160
+
+/*Linea temporal de un canal: cambios efectivos ordenados por instante de efecto*/
+typedef struct {
+	const Sim_PWM_Registro **r;
+	uint32_t num;
+} Linea;
+
+static const Sim_PWM_Cabecera *cab;
+static const Sim_PWM_Registro *regs;
+static Linea lineas[SIM_PWM_CANALES];
+
+static double brillo (const Sim_PWM_Registro *r){
+	if (r == NULL || (r->flags & SIM_PWM_ACTIVO) == 0U)
+		return 0.0;
+	return (65535.0 - r->ccr) / 65535.0;
+}
+
+static double ms (uint64_t ns){
+	return (double)ns / 1e6;
+}
+
+/**
+  * @brief Funcion que construye la linea temporal de cada canal. Un registro con
+	*				 un instante de efecto no posterior al de los anteriores los sustituye:
+	*				 esos valores se reemplazaron antes de llegar a mostrarse (dos
+	*				 escrituras en el mismo periodo o un cambio inmediato tras uno
+	*				 pendiente de la precarga).
+	* @param None
+  * @retval 0 si es correcto, -1 en caso contrario
+  */
+static int construir_Lineas (void){
+	for (uint32_t c = 0; c < cab->num_canales; c++)
+		if ((lineas[c].r = malloc(cab->num_registros * sizeof(*lineas[c].r))) == NULL)
+			return -1;
+	for (uint64_t i = 0; i < cab->num_registros; i++){
+		const Sim_PWM_Registro *r = &regs[i];
+		Linea *l;
+
+		if (r->canal >= cab->num_canales)
+			return -1;
+		l = &lineas[r->canal];
+		while (l->num > 0U && l->r[l->num - 1U]->efecto_ns >= r->efecto_ns)
+			l->num--;
+		l->r[l->num++] = r;
+	}
+	return 0;
+}
+
+/**
+  * @brief Funcion que calcula y muestra las estadisticas de un canal
+	* @param c: Canal
+	* @param umbral: Escalon visible (fraccion de brillo)
+	* @param max_destello: Duracion maxima de un destello en periodos
+  * @retval None
+  */
+static void estadisticas_Canal (uint32_t c, double umbral, uint32_t max_destello){
+	const Linea *l = &lineas[c];
+	uint64_t periodo = cab->canal[c].periodo_ns ? cab->canal[c].periodo_ns : 1U;
+	double escalon_max = 0.0, previo = 0.0, delta_previo = 0.0;
+	uint64_t t_escalon = 0, t_destello = 0;
+	uint32_t visibles = 0, destellos = 0;
+
+	for (uint32_t i = 0; i < l->num; i++){
+		double b = brillo(l->r[i]);
+		double d = b - previo;
+
+		if (d == 0.0)
+			continue;
+		if (d > escalon_max || -d > escalon_max){
+			escalon_max = (d > 0.0) ? d : -d;
+			t_escalon = l->r[i]->efecto_ns;
+		}
+		if (d > umbral || -d > umbral)
+			visibles++;
+		/*El nivel anterior duro menos de max_destello periodos y se invierte el sentido*/
+		if (i > 0U && delta_previo * d < 0.0 &&
+				l->r[i]->efecto_ns - l->r[i - 1U]->efecto_ns < max_destello * periodo){
+			if (destellos++ == 0U)
+				t_destello = l->r[i - 1U]->efecto_ns;
+		}
+		delta_previo = d;
+		previo = b;
+	}
+	printf("%-6s periodo=%.3f ms cambios=%u escalon_max=%.2f%% (t=%.3f ms) escalones>%.1f%%=%u destellos=%u",
+				 cab->canal[c].nombre, ms(periodo), (unsigned)l->num, escalon_max * 100.0, ms(t_escalon),
+				 umbral * 100.0, (unsigned)visibles, (unsigned)destellos);
+	if (destellos != 0U)
+		printf(" (primero t=%.3f ms)", ms(t_destello));
+	putchar('\n');
+}
+
+/**
+  * @brief Funcion que cuenta los desgarros: lotes de cambios de varios canales que
+	*				 entran en vigor en instantes distintos
+	* @param None
+  * @retval None
+  */
+static void estadisticas_Desgarro (void){
+	uint64_t desgarros = 0, lotes = 0, max_ns = 0, t_max = 0;
+	uint64_t i = 0;
+
+	while (i < cab->num_registros){
+		uint64_t j = i, min_e = regs[i].efecto_ns, max_e = regs[i].efecto_ns;
+		uint32_t canales = 0;
+
+		while (j < cab->num_registros && regs[j].escrito_ns == regs[i].escrito_ns){
+			canales |= 1U << regs[j].canal;
+			if (regs[j].efecto_ns < min_e)
+				min_e = regs[j].efecto_ns;
+			if (regs[j].efecto_ns > max_e)
+				max_e = regs[j].efecto_ns;
+			j++;
+		}
+		if ((canales & (canales - 1U)) != 0U){
+			lotes++;
+			if (max_e != min_e){
+				desgarros++;
+				if (max_e - min_e > max_ns){
+					max_ns = max_e - min_e;
+					t_max = min_e;
+				}
+			}
+		}
+		i = j;
+	}
+	printf("desgarros=%llu de %llu lotes de varios canales, maximo=%.3f ms (t=%.3f ms)\n",
+				 (unsigned long long)desgarros, (unsigned long long)lotes, ms(max_ns), ms(t_max));
+}
+
+/**
+  * @brief Funcion que recorre los cambios de todos los canales por orden de efecto
+	* @param visitar: Funcion llamada con cada cambio
+	* @param arg: Argumento de la funcion
+  * @retval None
+  */
+static void recorrer (void (*visitar)(const Sim_PWM_Registro *r, void *arg), void *arg){
+	uint32_t pos[SIM_PWM_CANALES] = {0};
+
+	while (1){
+		const Sim_PWM_Registro *s = NULL;
+		uint32_t cs = 0;
+
+		for (uint32_t c = 0; c < cab->num_canales; c++){
+			if (pos[c] < lineas[c].num && (s == NULL || lineas[c].r[pos[c]]->efecto_ns < s->efecto_ns)){
+				s = lineas[c].r[pos[c]];
+				cs = c;
+			}
+		}
+		if (s == NULL)
+			return;
+		pos[cs]++;
+		visitar(s, arg);
+	}
+}
+
+static void linea_CSV (const Sim_PWM_Registro *r, void *arg){
+	fprintf(arg, "%.6f,%s,%u,%u,%.5f\n", ms(r->efecto_ns), cab->canal[r->canal].nombre,
+					(unsigned)r->ccr, (unsigned)(r->flags & SIM_PWM_ACTIVO), brillo(r));
+}
+
+static void cambio_VCD (const Sim_PWM_Registro *r, void *arg){
+	static uint64_t ultimo = UINT64_MAX;
+
+	if (r->efecto_ns != ultimo){
+		fprintf(arg, "#%llu\n", (unsigned long long)r->efecto_ns);
+		ultimo = r->efecto_ns;
+	}
+	fprintf(arg, "r%.5f b%u\n%ua%u\n", brillo(r), r->canal, (unsigned)(r->flags & SIM_PWM_ACTIVO), r->canal);
+}
+
+static int escribir_VCD (const char *ruta){
+	FILE *f = fopen(ruta, "w");
+
+	if (f == NULL)
+		return -1;
+	fprintf(f, "$timescale 1ns $end\n$scope module led $end\n");
+	for (uint32_t c = 0; c < cab->num_canales; c++)
+		fprintf(f, "$var real 64 b%u %.8s_brillo $end\n$var wire 1 a%u %.8s_activo $end\n",
+						c, cab->canal[c].nombre, c, cab->canal[c].nombre);
+	fprintf(f, "$upscope $end\n$enddefinitions $end\n");
+	recorrer(cambio_VCD, f);
+	fprintf(f, "#%llu\n", (unsigned long long)cab->fin_ns);
+	return fclose(f);
+}
+
+static int escribir_CSV (const char *ruta){
+	FILE *f = fopen(ruta, "w");
+
+	if (f == NULL)
+		return -1;
+	fprintf(f, "t_ms,canal,ccr,activo,brillo\n");
+	recorrer(linea_CSV, f);
+	return fclose(f);
+}
+
+/**
+  * @brief Funcion que dibuja el brillo de cada canal. Por cada columna de la grafica
+	*				 se dibujan el primer, minimo, maximo y ultimo valor, de forma que la
+	*				 grafica no crece con el numero de cambios y no oculta los destellos.
+	* @param ruta: Fichero SVG
+  * @retval 0 si es correcto, -1 en caso contrario
+  */
+static int escribir_SVG (const char *ruta){
+	static const char *const colores[] = {"#d62728", "#2ca02c", "#1f77b4", "#7f7f7f"};
+	FILE *f = fopen(ruta, "w");
+	double fin = (cab->fin_ns != 0U) ? (double)cab->fin_ns : 1.0;
+
+	if (f == NULL)
+		return -1;
+	fprintf(f, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%u\">\n",
+					SVG_ANCHO + 60, (unsigned)(cab->num_canales * (SVG_ALTO + 20U) + 20U));
+	for (uint32_t c = 0; c < cab->num_canales; c++){
+		const Linea *l = &lineas[c];
+		uint32_t y0 = 10U + c * (SVG_ALTO + 20U);
+		int columna = -1;
+		double ultimo = 0.0, mn = 0.0, mx = 0.0;
+
+		fprintf(f, "<text x=\"2\" y=\"%u\" font-size=\"12\">%.8s</text>\n", y0 + 12U, cab->canal[c].nombre);
+		fprintf(f, "<rect x=\"50\" y=\"%u\" width=\"%d\" height=\"%d\" fill=\"none\" stroke=\"#ccc\"/>\n",
+						y0, SVG_ANCHO, SVG_ALTO);
+		fprintf(f, "<polyline fill=\"none\" stroke=\"%s\" points=\"50,%u", colores[c < 3U ? c : 3U], y0 + SVG_ALTO);
+		for (uint32_t i = 0; i <= l->num; i++){
+			int x = (i < l->num) ? (int)((double)l->r[i]->efecto_ns / fin * SVG_ANCHO) : SVG_ANCHO;
+			double b = (i < l->num) ? brillo(l->r[i]) : ultimo;
+
+			if (x > SVG_ANCHO)
+				x = SVG_ANCHO;
+			if (x != columna){
+				if (columna >= 0)
+					fprintf(f, " %d,%.1f %d,%.1f %d,%.1f", 50 + columna, y0 + SVG_ALTO * (1.0 - mn),
+									50 + columna, y0 + SVG_ALTO * (1.0 - mx), 50 + columna, y0 + SVG_ALTO * (1.0 - ultimo));
+				fprintf(f, " %d,%.1f", 50 + x, y0 + SVG_ALTO * (1.0 - ultimo));
+				columna = x;
+				mn = mx = b;
+			}
+			if (b < mn)
+				mn = b;
+			if (b > mx)
+				mx = b;
+			ultimo = b;
+		}
+		fprintf(f, "\"/>\n");
+	}
+	fprintf(f, "<text x=\"50\" y=\"%u\" font-size=\"12\">0 .. %.1f ms</text>\n</svg>\n",
+					(unsigned)(cab->num_canales * (SVG_ALTO + 20U) + 15U), ms(cab->fin_ns));
+	return fclose(f);
+}
+
+int main (int argc, char *argv[]){
+	const char *vcd = NULL, *csv = NULL, *svg = NULL;
+	double umbral = 0.02;
+	uint32_t max_destello = 3;
+	struct stat st;
+	void *mapa;
+	int opcion, fd;
+
+	while ((opcion = getopt(argc, argv, "v:c:g:u:f:")) != -1){
+		switch (opcion){
+			case 'v': vcd = optarg; break;
+			case 'c': csv = optarg; break;
+			case 'g': svg = optarg; break;
+			case 'u': umbral = strtod(optarg, NULL) / 100.0; break;
+			case 'f': max_destello = (uint32_t)strtoul(optarg, NULL, 0); break;
+			default: optind = argc; break;
+		}
+	}
+	if (optind != argc - 1){
+		fprintf(stderr, "uso: %s [-v f.vcd] [-c f.csv] [-g f.svg] [-u umbral] [-f periodos] traza.pwm\n", argv[0]);
+		return 1;
+	}
+	if ((fd = open(argv[optind], O_RDONLY)) < 0 || fstat(fd, &st) != 0 ||
+			(mapa = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED){
+		perror(argv[optind]);
+		return 1;
+	}
+	cab = mapa;
+	regs = (const Sim_PWM_Registro *)(cab + 1);
+	if ((size_t)st.st_size < sizeof(*cab) || memcmp(cab->magico, SIM_PWM_MAGICO, sizeof(cab->magico)) != 0 ||
+			cab->tam_registro != sizeof(Sim_PWM_Registro) || cab->num_canales > SIM_PWM_CANALES ||
+			(size_t)st.st_size < sizeof(*cab) + cab->num_registros * sizeof(Sim_PWM_Registro) ||
+			construir_Lineas() != 0){
+		fprintf(stderr, "%s: traza PWM no valida\n", argv[optind]);
+		return 1;
+	}
+
+	printf("%llu cambios en %.3f ms\n", (unsigned long long)cab->num_registros, ms(cab->fin_ns));
+	for (uint32_t c = 0; c < cab->num_canales; c++)
+		estadisticas_Canal(c, umbral, max_destello);
+	estadisticas_Desgarro();
+
+	if ((vcd != NULL && escribir_VCD(vcd) != 0) || (csv != NULL && escribir_CSV(csv) != 0) ||
+			(svg != NULL && escribir_SVG(svg) != 0)){
+		perror("rgb_pwm");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,285 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Conversor_Traza.c
+  * @author  MCD Application Team
+  * @brief   Decodificador del volcado del buffer de trazas (comando 'T', formato
+	*					 en Traza.h). Los nombres y el formato de cada evento se leen de
+	*					 la descripcion para el Event Recorder (Traza.scvd), de forma que
+	*					 uVision y este decodificador muestran lo mismo.
+	*
+	*					 Uso: rgb_traza [-s descripcion.scvd] [-c f.csv] captura
+	*							- -s: descripcion de los eventos (../Traza.scvd)
+	*							- -c: un evento por linea: t_us,contexto,id,evento,valor1,valor2
+	*					 La captura son los bytes recibidos por la USART (rgb_sim -t o el
+	*					 puerto serie en modo raw); se decodifica el ultimo volcado valido.
+	*
+	*					 El instante de cada evento se obtiene sumando las diferencias del
+	*					 contador de ciclos entre eventos consecutivos, por lo que una pausa
+	*					 de mas de 2^32 ciclos (23 s a 180 MHz) entre dos eventos se
+	*					 cuenta modulo 2^32. Al final se resume el numero de eventos de
+	*					 cada tipo y la duracion de los envios por la USART.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "Traza.h"
+
+#define MAX_EVENTOS   64
+#define TAM_VALOR     128
+
+typedef struct {
+	uint32_t id;							/*Componente y mensaje (16 bits)*/
+	char nombre[32];
+	char valor[TAM_VALOR];		/*Formato del SCVD: "boton=%d[val1]"*/
+	uint32_t cuenta;
+} Evento;
+
+static Evento eventos[MAX_EVENTOS];
+static uint32_t num_eventos = 0;
+
+/**
+  * @brief Funcion que copia el valor de un atributo XML de una etiqueta
+	* @param etiqueta: Texto de la etiqueta
+	* @param nombre: Nombre del atributo
+	* @param destino: Valor sin comillas
+	* @param tam: Tamano del destino
+  * @retval 0 si existe el atributo, -1 en caso contrario
+  */
+static int atributo (const char *etiqueta, const char *nombre, char *destino, size_t tam){
+	char patron[32];
+	const char *p, *fin;
+	size_t n;
+
+	snprintf(patron, sizeof(patron), " %s=\"", nombre);
+	if ((p = strstr(etiqueta, patron)) == NULL)
+		return -1;
+	p += strlen(patron);
+	if ((fin = strchr(p, '"')) == NULL)
+		return -1;
+	n = (size_t)(fin - p);
+	if (n >= tam)
+		n = tam - 1U;
+	memcpy(destino, p, n);
+	destino[n] = '\0';
+	return 0;
+}
+
+/**
+  * @brief Funcion que lee las etiquetas <event> de la descripcion SCVD
+	* @param ruta: Fichero SCVD
+  * @retval 0 si es correcto, -1 en caso contrario
+  */
+static int leer_Scvd (const char *ruta){
+	FILE *f;
+	char *texto, *p, *fin, id[16];
+	long tam;
+
+	if ((f = fopen(ruta, "rb")) == NULL || fseek(f, 0, SEEK_END) != 0 || (tam = ftell(f)) < 0){
+		perror(ruta);
+		return -1;
+	}
+	rewind(f);
+	texto = malloc((size_t)tam + 1U);
+	if (texto == NULL || fread(texto, 1, (size_t)tam, f) != (size_t)tam){
+		fclose(f);
+		return -1;
+	}
+	texto[tam] = '\0';
+	fclose(f);
+
+	for (p = texto; (p = strstr(p, "<event ")) != NULL && num_eventos < MAX_EVENTOS; p = fin){
+		if ((fin = strchr(p, '>')) == NULL)
+			break;
+		*fin++ = '\0';
+		if (atributo(p, "id", id, sizeof(id)) != 0)
+			continue;
+		eventos[num_eventos].id = (uint32_t)strtoul(id, NULL, 0) & 0xFFFFU;
+		if (atributo(p, "property", eventos[num_eventos].nombre, sizeof(eventos[0].nombre)) != 0)
+			strcpy(eventos[num_eventos].nombre, id);
+		if (atributo(p, "value", eventos[num_eventos].valor, sizeof(eventos[0].valor)) != 0)
+			eventos[num_eventos].valor[0] = '\0';
+		num_eventos++;
+	}
+	free(texto);
+	return 0;
+}
+
+static Evento *buscar_Evento (uint32_t id){
+	for (uint32_t i = 0; i < num_eventos; i++)
+		if (eventos[i].id == (id & 0xFFFFU))
+			return &eventos[i];
+	return NULL;
+}
+
+/**
+  * @brief Funcion que aplica el formato del SCVD a los valores de un evento.
+	*				 Se admiten %d, %u y %x seguidos de [val1] o [val2].
+	* @param formato: Valor del atributo value
+	* @param r: Registro
+	* @param salida: Texto resultante
+	* @param tam: Tamano de la salida
+  * @retval None
+  */
+static void formatear (const char *formato, const Traza_Registro *r, char *salida, size_t tam){
+	size_t n = 0;
+	uint32_t v;
+	char tipo;
+
+	while (*formato != '\0' && n + 12U < tam){
+		if (formato[0] == '%' && formato[1] != '\0' && formato[2] == '[' &&
+				(strncmp(&formato[3], "val1]", 5) == 0 || strncmp(&formato[3], "val2]", 5) == 0)){
+			tipo = formato[1];
+			v = (formato[6] == '1') ? r->valor1 : r->valor2;
+			if (tipo == 'd')
+				n += (size_t)snprintf(&salida[n], tam - n, "%d", (int)(int32_t)v);
+			else
+				n += (size_t)snprintf(&salida[n], tam - n, (tipo == 'x') ? "0x%X" : "%u", (unsigned)v);
+			formato += 8;
+		}
+		else
+			salida[n++] = *formato++;
+	}
+	salida[n] = '\0';
+}
+
+static uint32_t leer_32 (const uint8_t *p){
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+  * @brief Funcion que busca el ultimo volcado valido de la captura
+	* @param datos: Captura
+	* @param tam: Bytes de la captura
+	* @param num: Numero de registros del volcado
+  * @retval Inicio del volcado (en 'T'), NULL si no hay ninguno
+  */
+static const uint8_t *buscar_Volcado (const uint8_t *datos, size_t tam, uint32_t *num){
+	const uint8_t *encontrado = NULL;
+	uint32_t a, b, n, longitud;
+
+	for (size_t i = 0; i + 16U <= tam; i++){
+		if (datos[i] != 'T' || datos[i + 1U] != 'R' || datos[i + 2U] != TRAZA_VERSION ||
+				datos[i + 3U] != sizeof(Traza_Registro))
+			continue;
+		n = (uint32_t)datos[i + 4U] | ((uint32_t)datos[i + 5U] << 8);
+		longitud = 12U + n * (uint32_t)sizeof(Traza_Registro);
+		if (i + 2U + longitud + 2U > tam)
+			continue;
+		a = b = 0;
+		for (uint32_t j = 0; j < longitud; j++){
+			a = (a + datos[i + 2U + j]) % 255U;
+			b = (b + a) % 255U;
+		}
+		if (datos[i + 2U + longitud] == a && datos[i + 3U + longitud] == b){
+			encontrado = &datos[i];
+			*num = n;
+		}
+	}
+	return encontrado;
+}
+
+int main (int argc, char *argv[]){
+	const char *scvd = "../Traza.scvd", *ruta_csv = NULL;
+	FILE *f, *csv = NULL;
+	uint8_t *datos;
+	const uint8_t *v;
+	size_t tam = 0, capacidad = 1 << 16;
+	uint32_t num, frecuencia, total, previo = 0;
+	uint64_t ciclos = 0, inicio_usart = 0;
+	uint64_t usart_n = 0, usart_suma = 0, usart_max = 0, usart_min = UINT64_MAX;
+	Traza_Registro r;
+	Evento *e;
+	char texto[TAM_VALOR + 32];
+	int opcion;
+
+	while ((opcion = getopt(argc, argv, "s:c:")) != -1){
+		switch (opcion){
+			case 's': scvd = optarg; break;
+			case 'c': ruta_csv = optarg; break;
+			default: optind = argc; break;
+		}
+	}
+	if (optind != argc - 1){
+		fprintf(stderr, "uso: %s [-s descripcion.scvd] [-c f.csv] captura\n", argv[0]);
+		return 1;
+	}
+	if (leer_Scvd(scvd) != 0)
+		return 1;
+	if ((f = fopen(argv[optind], "rb")) == NULL){
+		perror(argv[optind]);
+		return 1;
+	}
+	datos = malloc(capacidad);
+	while (datos != NULL && (tam += fread(datos + tam, 1, capacidad - tam, f)) == capacidad)
+		datos = realloc(datos, capacidad *= 2U);
+	fclose(f);
+	if (datos == NULL || (v = buscar_Volcado(datos, tam, &num)) == NULL){
+		fprintf(stderr, "%s: no hay ningun volcado de la traza valido\n", argv[optind]);
+		return 1;
+	}
+	if (ruta_csv != NULL && (csv = fopen(ruta_csv, "w")) == NULL){
+		perror(ruta_csv);
+		return 1;
+	}
+	total = leer_32(v + 6);
+	frecuencia = leer_32(v + 10);
+	if (frecuencia == 0U)
+		frecuencia = 1U;
+	printf("%u eventos de %u trazados, contador a %u Hz\n", (unsigned)num, (unsigned)total, (unsigned)frecuencia);
+	if (csv != NULL)
+		fprintf(csv, "t_us,contexto,id,evento,valor1,valor2\n");
+
+	v += 14;
+	for (uint32_t i = 0; i < num; i++, v += sizeof(Traza_Registro)){
+		r.id = leer_32(v);
+		r.ciclos = leer_32(v + 4);
+		r.valor1 = leer_32(v + 8);
+		r.valor2 = leer_32(v + 12);
+		if (i > 0U)
+			ciclos += (uint32_t)(r.ciclos - previo);
+		previo = r.ciclos;
+
+		if ((e = buscar_Evento(r.id)) != NULL){
+			e->cuenta++;
+			formatear(e->valor, &r, texto, sizeof(texto));
+		}
+		else
+			snprintf(texto, sizeof(texto), "%u %u", (unsigned)r.valor1, (unsigned)r.valor2);
+		printf("%12.3f us  %-4s %-12s %s\n", (double)ciclos * 1e6 / frecuencia,
+					 ((r.id & TRAZA_IRQ) != 0U) ? "IRQ" : "hilo", (e != NULL) ? e->nombre : "?", texto);
+		if (csv != NULL)
+			fprintf(csv, "%.3f,%s,0x%04X,%s,%u,%u\n", (double)ciclos * 1e6 / frecuencia,
+							((r.id & TRAZA_IRQ) != 0U) ? "irq" : "hilo", (unsigned)(r.id & 0xFFFFU),
+							(e != NULL) ? e->nombre : "?", (unsigned)r.valor1, (unsigned)r.valor2);
+
+		/*Duracion de cada envio por la USART*/
+		if ((r.id & ~TRAZA_IRQ) == TRAZA_USART_INICIO)
+			inicio_usart = ciclos + 1U;
+		else if ((r.id & ~TRAZA_IRQ) == TRAZA_USART_FIN && inicio_usart != 0U){
+			uint64_t d = ciclos + 1U - inicio_usart;
+
+			usart_n++;
+			usart_suma += d;
+			usart_max = (d > usart_max) ? d : usart_max;
+			usart_min = (d < usart_min) ? d : usart_min;
+			inicio_usart = 0;
+		}
+	}
+	if (csv != NULL)
+		fclose(csv);
+
+	printf("\nEventos por tipo:\n");
+	for (uint32_t i = 0; i < num_eventos; i++)
+		if (eventos[i].cuenta > 0U)
+			printf("  %-12s %u\n", eventos[i].nombre, (unsigned)eventos[i].cuenta);
+	if (usart_n > 0U)
+		printf("Envios por la USART: %llu, duracion min %.1f us, media %.1f us, max %.1f us\n",
+					 (unsigned long long)usart_n, (double)usart_min * 1e6 / frecuencia,
+					 (double)usart_suma * 1e6 / frecuencia / (double)usart_n, (double)usart_max * 1e6 / frecuencia);
+	free(datos);
+	return 0;
+}
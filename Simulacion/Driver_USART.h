@@ -0,0 +1,107 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Driver_USART.h
+  * @author  MCD Application Team
+  * @brief   Subconjunto del CMSIS Driver USART (API 2.x) para el simulador. La
+	*					 estructura de acceso y los codigos son los de la cabecera de ARM;
+	*					 Driver_USART3 se implementa en Sim_USART.c.
+  *
+  ******************************************************************************
+  */
+
+#ifndef DRIVER_USART_H_
+#define DRIVER_USART_H_
+
+#include <stdint.h>
+
+#define ARM_DRIVER_VERSION_MAJOR_MINOR(major,minor) (((major) << 8) | (minor))
+
+typedef struct {
+	uint16_t api;
+	uint16_t drv;
+} ARM_DRIVER_VERSION;
+
+typedef enum {
+	ARM_POWER_OFF,
+	ARM_POWER_LOW,
+	ARM_POWER_FULL
+} ARM_POWER_STATE;
+
+#define ARM_DRIVER_OK                 0
+#define ARM_DRIVER_ERROR             -1
+#define ARM_DRIVER_ERROR_BUSY        -2
+#define ARM_DRIVER_ERROR_TIMEOUT     -3
+#define ARM_DRIVER_ERROR_UNSUPPORTED -4
+#define ARM_DRIVER_ERROR_PARAMETER   -5
+
+/* Control */
+#define ARM_USART_CONTROL_Pos         0
+#define ARM_USART_CONTROL_Msk        (0xFFUL << ARM_USART_CONTROL_Pos)
+#define ARM_USART_MODE_ASYNCHRONOUS  (0x01UL << ARM_USART_CONTROL_Pos)
+#define ARM_USART_CONTROL_TX         (0x15UL << ARM_USART_CONTROL_Pos)
+#define ARM_USART_CONTROL_RX         (0x16UL << ARM_USART_CONTROL_Pos)
+#define ARM_USART_ABORT_SEND         (0x18UL << ARM_USART_CONTROL_Pos)
+#define ARM_USART_ABORT_RECEIVE      (0x19UL << ARM_USART_CONTROL_Pos)
+#define ARM_USART_DATA_BITS_8        (0UL << 8)
+#define ARM_USART_PARITY_NONE        (0UL << 12)
+#define ARM_USART_STOP_BITS_1        (0UL << 14)
+#define ARM_USART_FLOW_CONTROL_NONE  (0UL << 16)
+
+/* Eventos */
+#define ARM_USART_EVENT_SEND_COMPLETE     (1UL << 0)
+#define ARM_USART_EVENT_RECEIVE_COMPLETE  (1UL << 1)
+#define ARM_USART_EVENT_TRANSFER_COMPLETE (1UL << 2)
+#define ARM_USART_EVENT_TX_COMPLETE       (1UL << 3)
+#define ARM_USART_EVENT_RX_OVERFLOW       (1UL << 5)
+
+typedef struct {
+	uint32_t tx_busy          : 1;
+	uint32_t rx_busy          : 1;
+	uint32_t tx_underflow     : 1;
+	uint32_t rx_overflow      : 1;
+	uint32_t rx_break         : 1;
+	uint32_t rx_framing_error : 1;
+	uint32_t rx_parity_error  : 1;
+	uint32_t reserved         : 25;
+} ARM_USART_STATUS;
+
+typedef enum {
+	ARM_USART_RTS_CLEAR,
+	ARM_USART_RTS_SET,
+	ARM_USART_DTR_CLEAR,
+	ARM_USART_DTR_SET
+} ARM_USART_MODEM_CONTROL;
+
+typedef struct {
+	uint32_t cts      : 1;
+	uint32_t dsr      : 1;
+	uint32_t dcd      : 1;
+	uint32_t ri       : 1;
+	uint32_t reserved : 28;
+} ARM_USART_MODEM_STATUS;
+
+typedef struct {
+	uint32_t asynchronous : 1;
+	uint32_t reserved     : 31;
+} ARM_USART_CAPABILITIES;
+
+typedef void (*ARM_USART_SignalEvent_t) (uint32_t event);
+
+typedef struct {
+	ARM_DRIVER_VERSION     (*GetVersion)      (void);
+	ARM_USART_CAPABILITIES (*GetCapabilities) (void);
+	int32_t                (*Initialize)      (ARM_USART_SignalEvent_t cb_event);
+	int32_t                (*Uninitialize)    (void);
+	int32_t                (*PowerControl)    (ARM_POWER_STATE state);
+	int32_t                (*Send)            (const void *data, uint32_t num);
+	int32_t                (*Receive)         (void *data, uint32_t num);
+	int32_t                (*Transfer)        (const void *data_out, void *data_in, uint32_t num);
+	uint32_t               (*GetTxCount)      (void);
+	uint32_t               (*GetRxCount)      (void);
+	int32_t                (*Control)         (uint32_t control, uint32_t arg);
+	ARM_USART_STATUS       (*GetStatus)       (void);
+	int32_t                (*SetModemControl) (ARM_USART_MODEM_CONTROL control);
+	ARM_USART_MODEM_STATUS (*GetModemStatus)  (void);
+} const ARM_DRIVER_USART;
+
+#endif /* DRIVER_USART_H_ */
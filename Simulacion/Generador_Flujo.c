@@ -0,0 +1,358 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Generador_Flujo.c
+  * @author  MCD Application Team
+  * @brief   Generador del flujo de color del PC (Flujo.h) y medidor de la tasa de
+	*					 tramas y del jitter de extremo a extremo frente al simulador.
+	*
+	*					 Uso: rgb_flujo -g [-f tramas/s] [-n tramas] [-b baudios]
+	*											 [-j us] [-e cada] [-l cada] [-s cada] [-x semilla] > guion
+	*							 rgb_flujo -m guion traza.pwm
+	*							- -g: escribe un guion de rgb_sim con una orden bin por trama
+	*								desde el instante 1000 ms, seguido del comando 'F' y del fin.
+	*								-f fija la tasa (200), -n el numero de tramas (1000), -b la
+	*								velocidad de la linea con la que se serializan (115200), -j
+	*								el retraso aleatorio maximo del PC en cada trama (0), -e
+	*								corrompe la suma de una de cada N tramas (0: ninguna), -l
+	*								sustituye una de cada N por una trama con longitud incorrecta
+	*								cuya carga es el comando 'h', -s quita un byte a una de cada
+	*								N y -x fija la semilla. Ni la carga de las tramas con
+	*								longitud incorrecta ni los bytes desalineados deben llegar
+	*								a los comandos (make flujo lo comprueba en la salida)
+	*							- -m: empareja cada trama del guion con el cambio del CCR del
+	*								rojo que produce en la traza PWM (rgb_sim -p) y muestra las
+	*								tramas mostradas, sustituidas antes de mostrarse y perdidas,
+	*								la tasa conseguida, la latencia desde el inicio del envio
+	*								hasta la entrada en vigor del CCR y su jitter
+	*
+	*					 Cada trama lleva un brillo del rojo distinto, por lo que su CCR
+	*					 identifica la trama en la traza PWM. Las tramas con longitud
+	*					 incorrecta o con un byte de menos no cuentan como enviadas; la
+	*					 trama que sigue a una con un byte de menos se pierde. Los brillos quedan por debajo
+	*					 de los presupuestos del limitador (Energia.h) para que el CCR no
+	*					 se escale.
+  *
+  ******************************************************************************
+  */
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Sim_PWM.h"
+#include "Flujo.h"
+#include "RGB.h"
+
+#define INICIO_NS      1000000000ULL
+#define NS_MS          1000000ULL
+/*Brillo del rojo de la trama k: ROJO_BASE + (k * ROJO_PASO % ROJO_RANGO) pasos del
+	CCR, distinto en ROJO_RANGO tramas seguidas. El CCR conserva los RGB_BITS_PWM bits
+	altos del brillo, por lo que las tramas se emparejan con esos bits*/
+#define ROJO_BASE      1000U
+#define ROJO_PASO      7919U
+#define ROJO_RANGO     1000U
+#define ROJO_ESCALON   (1U << (16U - RGB_BITS_PWM))
+
+/*Trama leida del guion*/
+typedef struct {
+	uint64_t envio_ns;
+	uint64_t efecto_ns;
+	uint16_t secuencia;
+	uint16_t rojo;
+	uint8_t valida;
+	uint8_t estado;
+} Trama;
+
+enum {NO_VISTA, MOSTRADA, SUSTITUIDA};
+
+static uint32_t semilla = 1;
+
+static uint32_t aleatorio (void){
+	semilla = semilla * 1103515245U + 12345U;
+	return semilla >> 8;
+}
+
+static double ms (uint64_t ns){
+	return (double)ns / 1e6;
+}
+
+/**
+  * @brief Funcion que calcula el Fletcher-16 de la carga de una trama
+	* @param d: Carga
+	* @param n: Bytes
+	* @param a, b: Sumas
+  * @retval None
+  */
+static void fletcher (const uint8_t *d, uint32_t n, uint8_t *a, uint8_t *b){
+	uint32_t x = 0, y = 0;
+
+	for (uint32_t i = 0; i < n; i++){
+		x = (x + d[i]) % 255U;
+		y = (y + x) % 255U;
+	}
+	*a = (uint8_t)x;
+	*b = (uint8_t)y;
+}
+
+/**
+  * @brief Funcion que escribe el guion con las tramas del flujo
+	* @param fps: Tramas por segundo
+	* @param num: Numero de tramas
+	* @param baudios: Velocidad de la linea
+	* @param jitter_us: Retraso aleatorio maximo de cada trama
+	* @param cada: Una de cada tantas tramas lleva la suma corrupta (0: ninguna)
+	* @param longitud: Una de cada tantas tramas tiene longitud incorrecta (0: ninguna)
+	* @param sin_byte: A una de cada tantas tramas le falta un byte (0: ninguna)
+  * @retval 0
+  */
+static int generar (double fps, uint32_t num, uint32_t baudios, uint32_t jitter_us, uint32_t cada,
+										uint32_t longitud, uint32_t sin_byte){
+	uint64_t t, libre = 0;
+	uint8_t d[FLUJO_TRAMA + 2U];
+	uint32_t n;
+	uint16_t nivel[NUM_LEDS];
+
+	printf("# Flujo de color generado por rgb_flujo: %u tramas a %.1f tramas/s, %u baudios,\n"
+				 "# jitter del PC hasta %u us, 1 de cada %u tramas con suma corrupta, 1 de cada %u\n"
+				 "# con longitud incorrecta y 1 de cada %u con un byte de menos\n",
+				 (unsigned)num, fps, (unsigned)baudios, (unsigned)jitter_us, (unsigned)cada,
+				 (unsigned)longitud, (unsigned)sin_byte);
+	for (uint32_t k = 0; k < num; k++){
+		/*Un PC ambilight: rojo unico por trama, verde y azul en ondas lentas*/
+		nivel[LED_ROJO] = (uint16_t)(ROJO_BASE + k * ROJO_PASO % ROJO_RANGO * ROJO_ESCALON);
+		nivel[LED_VERDE] = (uint16_t)(8000.0 + 8000.0 * sin(k * 0.05));
+		nivel[LED_AZUL] = (uint16_t)(8000.0 + 8000.0 * cos(k * 0.03));
+
+		d[0] = 'A';
+		d[1] = 'd';
+		d[2] = 'a';
+		d[3] = (uint8_t)(FLUJO_CARGA >> 8);
+		d[4] = (uint8_t)FLUJO_CARGA;
+		d[5] = (uint8_t)(d[3] ^ d[4] ^ FLUJO_COMPROBACION);
+		d[6] = (uint8_t)k;
+		d[7] = (uint8_t)(k >> 8);
+		for (uint32_t c = 0; c < NUM_LEDS; c++){
+			d[8U + 2U * c] = (uint8_t)nivel[c];
+			d[9U + 2U * c] = (uint8_t)(nivel[c] >> 8);
+		}
+		fletcher(&d[FLUJO_CABECERA], FLUJO_CARGA, &d[FLUJO_TRAMA - 2U], &d[FLUJO_TRAMA - 1U]);
+		n = FLUJO_TRAMA;
+		if (cada != 0U && k % cada == cada - 1U)
+			d[FLUJO_TRAMA - 1U] ^= 0x5AU;
+		/*Trama de otro formato, con dos bytes mas de carga: llena de 'h' (ayuda)
+			para que cualquier byte que se escape a los comandos se vea*/
+		if (longitud != 0U && k % longitud == longitud - 1U){
+			n = FLUJO_TRAMA + 2U;
+			d[3] = (uint8_t)((FLUJO_CARGA + 2U) >> 8);
+			d[4] = (uint8_t)(FLUJO_CARGA + 2U);
+			d[5] = (uint8_t)(d[3] ^ d[4] ^ FLUJO_COMPROBACION);
+			memset(&d[FLUJO_CABECERA], 'h', FLUJO_CARGA + 2U);
+			fletcher(&d[FLUJO_CABECERA], FLUJO_CARGA + 2U, &d[n - 2U], &d[n - 1U]);
+		}
+		/*Byte perdido en la linea a mitad de la carga*/
+		else if (sin_byte != 0U && k % sin_byte == sin_byte - 1U){
+			n = FLUJO_TRAMA - 1U;
+			memmove(&d[10], &d[11], FLUJO_TRAMA - 11U);
+		}
+
+		/*La trama sale en su instante, o al quedar libre la linea*/
+		t = INICIO_NS + (uint64_t)(k * 1e9 / fps);
+		if (jitter_us != 0U)
+			t += (uint64_t)(aleatorio() % (jitter_us + 1U)) * 1000U;
+		if (t < libre)
+			t = libre;
+		libre = t + (uint64_t)n * 10U * 1000000000ULL / baudios;
+
+		printf("%llu.%06llu bin ", (unsigned long long)(t / NS_MS), (unsigned long long)(t % NS_MS));
+		for (uint32_t i = 0; i < n; i++)
+			printf("%02X", d[i]);
+		printf("\n");
+	}
+	/*Estadisticas del firmware una vez terminado el flujo (FLUJO_PLAZO_MS)*/
+	printf("%llu rx F\n", (unsigned long long)(libre / NS_MS + FLUJO_PLAZO_MS + 200U));
+	printf("+500 fin\n");
+	return 0;
+}
+
+/**
+  * @brief Funcion que lee las tramas del guion
+	* @param ruta: Guion
+	* @param num: Numero de tramas leidas
+  * @retval Tramas, NULL si hay un error
+  */
+static Trama *leer_Tramas (const char *ruta, uint32_t *num){
+	FILE *f = fopen(ruta, "r");
+	char linea[256], hex[64];
+	Trama *tramas = NULL, *p;
+	uint8_t d[FLUJO_TRAMA], a, b;
+	unsigned v;
+	double t;
+
+	*num = 0;
+	if (f == NULL){
+		perror(ruta);
+		return NULL;
+	}
+	while (fgets(linea, sizeof(linea), f) != NULL){
+		if (sscanf(linea, "%lf bin %63s", &t, hex) != 2 || strlen(hex) != 2U * FLUJO_TRAMA)
+			continue;
+		if ((tramas = realloc(tramas, (*num + 1U) * sizeof(Trama))) == NULL)
+			break;
+		for (uint32_t i = 0; i < FLUJO_TRAMA; i++){
+			sscanf(&hex[2U * i], "%2x", &v);
+			d[i] = (uint8_t)v;
+		}
+		fletcher(&d[FLUJO_CABECERA], FLUJO_CARGA, &a, &b);
+		p = &tramas[(*num)++];
+		memset(p, 0, sizeof(*p));
+		p->envio_ns = (uint64_t)(t * NS_MS + 0.5);
+		p->secuencia = (uint16_t)(d[6] | (d[7] << 8));
+		p->rojo = (uint16_t)(d[8U + 2U * LED_ROJO] | (d[9U + 2U * LED_ROJO] << 8));
+		p->valida = (a == d[FLUJO_TRAMA - 2U] && b == d[FLUJO_TRAMA - 1U]);
+	}
+	fclose(f);
+	return tramas;
+}
+
+/**
+  * @brief Funcion que empareja las tramas con los cambios del CCR del rojo y
+	*				 muestra la tasa, la latencia y el jitter
+	* @param guion: Guion generado con -g
+	* @param traza: Traza PWM de rgb_sim -p
+  * @retval 0 si es correcto, 1 en caso contrario
+  */
+static int medir (const char *guion, const char *traza){
+	const Sim_PWM_Cabecera *cab;
+	const Sim_PWM_Registro *regs, *r, *sig;
+	static int32_t indice[65536];
+	struct stat st;
+	void *mapa;
+	int fd;
+	uint32_t num, validas = 0, mostradas = 0, sustituidas = 0, n_int = 0;
+	uint64_t lat_min = UINT64_MAX, lat_max = 0, primera = 0, ultima = 0, anterior = 0;
+	double lat_suma = 0, lat_suma2 = 0, int_suma = 0, int_suma2 = 0, lat, media, x;
+	Trama *tramas = leer_Tramas(guion, &num), *p;
+
+	if (tramas == NULL || num < 2U)
+		return 1;
+	if ((fd = open(traza, O_RDONLY)) < 0 || fstat(fd, &st) != 0 ||
+			(mapa = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED){
+		perror(traza);
+		return 1;
+	}
+	cab = mapa;
+	regs = (const Sim_PWM_Registro *)(cab + 1);
+	if ((size_t)st.st_size < sizeof(*cab) || memcmp(cab->magico, SIM_PWM_MAGICO, sizeof(cab->magico)) != 0 ||
+			cab->tam_registro != sizeof(Sim_PWM_Registro) ||
+			(size_t)st.st_size < sizeof(*cab) + cab->num_registros * sizeof(Sim_PWM_Registro)){
+		fprintf(stderr, "%s: traza PWM no valida\n", traza);
+		return 1;
+	}
+
+	/*CCR del rojo -> trama valida mas reciente con ese brillo*/
+	memset(indice, 0xFF, sizeof(indice));
+	for (uint32_t k = 0; k < num; k++){
+		validas += tramas[k].valida;
+		if (tramas[k].valida)
+			indice[RGB_CCR(65535U - tramas[k].rojo)] = (int32_t)k;
+	}
+
+	/*Un cambio del rojo al que sigue otro con efecto no posterior no llego a
+		mostrarse: la trama se sustituyo en el mismo periodo de la PWM*/
+	for (uint64_t i = 0; i < cab->num_registros; i++){
+		r = &regs[i];
+		if (r->canal != LED_ROJO || (r->flags & SIM_PWM_ACTIVO) == 0U || indice[RGB_CCR(r->ccr)] < 0)
+			continue;
+		p = &tramas[indice[RGB_CCR(r->ccr)]];
+		if (p->estado != NO_VISTA || r->escrito_ns < p->envio_ns)
+			continue;
+		sig = NULL;
+		for (uint64_t j = i + 1U; j < cab->num_registros && sig == NULL; j++)
+			if (regs[j].canal == LED_ROJO)
+				sig = &regs[j];
+		if (sig != NULL && sig->efecto_ns <= r->efecto_ns){
+			p->estado = SUSTITUIDA;
+			sustituidas++;
+			continue;
+		}
+		p->estado = MOSTRADA;
+		p->efecto_ns = r->efecto_ns;
+		mostradas++;
+	}
+
+	/*Latencia por trama e intervalo entre tramas mostradas*/
+	for (uint32_t k = 0; k < num; k++){
+		p = &tramas[k];
+		if (p->estado != MOSTRADA)
+			continue;
+		lat = (double)(p->efecto_ns - p->envio_ns);
+		lat_suma += lat;
+		lat_suma2 += lat * lat;
+		if (p->efecto_ns - p->envio_ns < lat_min)
+			lat_min = p->efecto_ns - p->envio_ns;
+		if (p->efecto_ns - p->envio_ns > lat_max)
+			lat_max = p->efecto_ns - p->envio_ns;
+		if (primera == 0U)
+			primera = p->efecto_ns;
+		else {
+			x = (double)(p->efecto_ns - anterior);
+			int_suma += x;
+			int_suma2 += x * x;
+			n_int++;
+		}
+		anterior = ultima = p->efecto_ns;
+	}
+
+	printf("Tramas: enviadas=%u corruptas=%u mostradas=%u sustituidas=%u perdidas=%u\n",
+				 (unsigned)num, (unsigned)(num - validas), (unsigned)mostradas, (unsigned)sustituidas,
+				 (unsigned)(validas - mostradas - sustituidas));
+	printf("Tasa: enviada %.1f tramas/s, mostrada %.1f tramas/s\n",
+				 (num - 1U) * 1e9 / (double)(tramas[num - 1U].envio_ns - tramas[0].envio_ns),
+				 (ultima > primera) ? n_int * 1e9 / (double)(ultima - primera) : 0.0);
+	if (mostradas == 0U)
+		return 1;
+	media = lat_suma / mostradas;
+	printf("Latencia (inicio del envio a entrada en vigor): min=%.3f ms avg=%.3f ms max=%.3f ms jitter=%.3f ms\n",
+				 ms(lat_min), media / 1e6, ms(lat_max), sqrt(lat_suma2 / mostradas - media * media) / 1e6);
+	if (n_int != 0U){
+		media = int_suma / n_int;
+		printf("Intervalo entre tramas mostradas: avg=%.3f ms jitter=%.3f ms\n",
+					 media / 1e6, sqrt(int_suma2 / n_int - media * media) / 1e6);
+	}
+	free(tramas);
+	return 0;
+}
+
+int main (int argc, char *argv[]){
+	double fps = 200.0;
+	uint32_t num = 1000, baudios = 115200, jitter_us = 0, cada = 0, longitud = 0, sin_byte = 0;
+	int opcion, modo = 0;
+
+	while ((opcion = getopt(argc, argv, "gmf:n:b:j:e:l:s:x:")) != -1){
+		switch (opcion){
+			case 'g': modo = 'g'; break;
+			case 'm': modo = 'm'; break;
+			case 'f': fps = strtod(optarg, NULL); break;
+			case 'n': num = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'b': baudios = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'j': jitter_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'e': cada = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'l': longitud = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 's': sin_byte = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'x': semilla = (uint32_t)strtoul(optarg, NULL, 0); break;
+			default: modo = 0; optind = argc + 1; break;
+		}
+	}
+	if (modo == 'g' && optind == argc && fps > 0.0 && baudios != 0U && num <= ROJO_RANGO)
+		return generar(fps, num, baudios, jitter_us, cada, longitud, sin_byte);
+	if (modo == 'm' && optind == argc - 2)
+		return medir(argv[optind], argv[optind + 1]);
+	fprintf(stderr, "uso: %s -g [-f tramas/s] [-n tramas] [-b baudios] [-j us] [-e cada] [-l cada]\n"
+									"          [-s cada] [-x semilla]\n"
+									"       %s -m guion traza.pwm\n", argv[0], argv[0]);
+	return 1;
+}
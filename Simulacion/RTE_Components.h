@@ -0,0 +1,19 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/RTE_Components.h
+  * @author  MCD Application Team
+  * @brief   Componentes del RTE en el simulador: el firmware se compila como con
+	*					 el RTX5 de la placa (Sim_RTOS.c sustituye al nucleo).
+  *
+  ******************************************************************************
+  */
+
+#ifndef RTE_COMPONENTS_H
+#define RTE_COMPONENTS_H
+
+#define CMSIS_device_header "stm32f4xx.h"
+
+#define RTE_CMSIS_RTOS2
+#define RTE_CMSIS_RTOS2_RTX5
+
+#endif /* RTE_COMPONENTS_H */
@@ -0,0 +1,568 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Sim.c
+  * @author  MCD Application Team
+  * @brief   Simulador del firmware en el PC. Lee un guion de estimulos, arranca
+	*					 el firmware (main.c compilado como firmware_main) y muestra los
+	*					 cambios del LED y las lineas enviadas por la USART3.
+	*
+	*					 Uso: rgb_sim [-e escala] [-d] [-s] [-l] [-u] [-i] [-p fichero]
+	*											 [-t fichero] [guion]
+	*							 rgb_sim -b
+	*							 rgb_sim -c
+	*							 rgb_sim -z control|firmware [-n entradas] [-x semilla] [-o fallo]
+	*							- -e: factor de aceleracion respecto al tiempo real (100)
+	*							- -d: tiempo virtual discreto, determinista e independiente
+	*								de la carga del PC (se ignora -e)
+	*							- -s: traza de los cambios de hilo del planificador
+	*							- -l: sin traza del LED
+	*							- -u: sin traza de la USART
+	*							- -p fichero: traza binaria de la PWM del LED (Sim_PWM.h) para
+	*								el conversor rgb_pwm
+	*							- -t fichero: bytes enviados por la USART3 sin cambios, para
+	*								el decodificador de metricas rgb_metricas
+	*							- -i: comprueba los invariantes del LED y del IWDG (Sim_Fuzz.c)
+	*							- -b: ejecuta los micro-benchmarks (Bench.c) y escribe el CSV
+	*							- -c: comprueba el resultado de cada par estado x evento de la
+	*								maquina de estados (Sim_Control.c)
+	*							- -z: fuzzing guiado por cobertura (Sim_Fuzz.c) de la maquina de
+	*								estados o del firmware completo; -n limita las entradas, -x
+	*								fija la semilla y -o el fichero que reproduce un fallo
+	*
+	*					 El resumen final se escribe en stderr para que la salida estandar
+	*					 de dos ejecuciones en modo discreto se pueda comparar.
+	*
+	*					 Cada linea del guion es "instante orden [argumentos]"; el instante
+	*					 se da en ms desde el arranque o, con '+', desde la linea anterior.
+	*					 '#' inicia un comentario. Ordenes:
+	*							- pulsar BOTON [ms] [rebotes]: pulsacion del joystick de 100 ms
+	*								por defecto con los rebotes indicados cada 0.5 ms
+	*							- nivel BOTON 0|1: nivel del pin de un boton (1 pulsado)
+	*							- pot BRILLO|TONO valor: valor del potenciometro (0..65535)
+	*							- rx texto: caracteres por la USART3, uno por ms
+	*							- bin HEX: bytes en hexadecimal por la USART3 seguidos, al ritmo
+	*								de su velocidad (10 bits por byte); si la linea esta ocupada
+	*								por la orden bin anterior se envian a continuacion
+	*							- desvio COLOR permil: desvio del tiempo en alto de la PWM de un
+	*								color en su pin, que solo ve la captura del autotest (0: sin
+	*								desvio)
+	*							- grabacion fichero [r|R|x]: carga por la USART3 con el comando
+	*								'C' las lineas G, de un volcado del grabador (se ignora el
+	*								resto y lo que sigue a '#') como ordenes bin y las reproduce
+	*								con el comando indicado ('r' por defecto), que las inyecta en
+	*								el hilo de entrada por flanco_Boton
+	*							- secuencia n: fin de la secuencia n del fuzzing (sin efecto)
+	*							- fin: termina la simulacion
+	*					 Sin guion se lee la entrada estandar.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include "stm32f4xx_hal.h"
+#include "Placa.h"
+#include "RGB.h"
+#include "joystick.h"
+#include "Grabador.h"
+#include "Sim.h"
+
+#define SIM_REBOTE_NS   500000ULL
+
+Sim_Config sim_config = {100, 1, 1, 0, 0, 0};
+
+/*Pasos del guion: el vector crece al leerlo para admitir pruebas largas*/
+static Sim_Paso *pasos = NULL;
+static uint32_t num_pasos = 0;
+static uint32_t capacidad = 0;
+/*Registro de los pasos ejecutados en formato de guion (fuzzing)*/
+static FILE *registro = NULL;
+
+#define SIM_NOMBRE_BOTON(rol, puerto, pin, irq)	#rol,
+static const char *const nombre_boton[NUM_BOTONES] = {
+	PLACA_BOTONES(SIM_NOMBRE_BOTON)
+};
+
+#define SIM_NOMBRE_POT(funcion, puerto, pin, canal)	#funcion,
+static const char *const nombre_pot[NUM_POTS] = {
+	PLACA_POTS(SIM_NOMBRE_POT)
+};
+
+#define SIM_NOMBRE_LED(color, puerto, pin, tim, canal, af)	#color,
+static const char *const nombre_led[NUM_LEDS] = {
+	PLACA_LEDS(SIM_NOMBRE_LED)
+};
+
+int firmware_main (void);
+
+/**
+  * @brief Funcion que muestra una linea de traza con el instante simulado
+	* @param fmt: Formato de printf
+  * @retval None
+  */
+void sim_traza (const char *fmt, ...){
+	va_list args;
+
+	printf("t=%10.3f ms  ", (double)sim_ahora() / SIM_NS_MS);
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+	putchar('\n');
+}
+
+void sim_led (int color, uint32_t ccr, int activo){
+	if (sim_config.invariantes)
+		sim_fuzz_Led(color, ccr, activo);
+	if (!sim_config.traza_led)
+		return;
+	if (activo)
+		sim_traza("LED %-5s CCR=%4u (%3u%%)", nombre_led[color], (unsigned)ccr,
+							(unsigned)((RGB_ARR - (ccr > RGB_ARR ? RGB_ARR : ccr)) * 100U / RGB_ARR));
+	else
+		sim_traza("LED %-5s apagado", nombre_led[color]);
+}
+
+void sim_uart(const char *linea){
+	if (sim_config.traza_uart)
+		sim_traza("UART> %s", linea);
+}
+
+/**
+  * @brief Funcion que termina la simulacion con un resumen
+	* @param codigo: 0 fin del guion, 1 error o bloqueo, 2 reset del IWDG, 3 reset
+	*				 por software, 4 invariante incumplido
+  * @retval None
+  */
+void sim_fin (int codigo){
+	static const char *const motivo[] = {"fin del guion", "error", "reset del IWDG", "reset por software",
+																			 "invariante incumplido"};
+	double simulado = (double)sim_ahora() / SIM_NS_MS;
+	double real = (double)sim_real() / SIM_NS_MS;
+
+	/*El registro termina justo despues del fallo para que el guion lo reproduzca*/
+	if (registro != NULL){
+		fprintf(registro, "%llu fin\n", (unsigned long long)(sim_ahora() / SIM_NS_MS + 1U));
+		fclose(registro);
+	}
+	sim_pwm_Cerrar();
+	sim_usart_Cerrar();
+	fflush(stdout);
+	fprintf(stderr, "sim: %s; %.1f ms simulados en %.1f ms reales (x%.0f), %u bytes por la USART3\n",
+				 motivo[(codigo >= 0 && codigo <= 4) ? codigo : 1], simulado, real,
+				 (real > 0.0) ? simulado / real : 0.0, (unsigned)sim_tx_bytes());
+	_exit(codigo);
+}
+
+/*Ejecucion del guion --------------------------------------------------------*/
+
+static void ejecutar_Paso (uint32_t n);
+
+static void pin_Boton (uint32_t boton, int nivel){
+	const Joystick_Boton *b = &joystick_botones[boton];
+
+	sim_pin(PLACA_GPIO_INDICE(b->Port), 31U - (uint32_t)__builtin_clz(b->Pin), nivel);
+}
+
+/*Arg: boton en los 8 bits bajos y nivel en el bit 8*/
+static void accion_Boton (uint32_t arg){
+	pin_Boton(arg & 0xFFU, (arg >> 8) & 1U);
+}
+
+static void accion_Rx (uint32_t arg){
+	sim_rx((uint8_t)arg);
+}
+
+/*Instante en el que queda libre la linea de recepcion tras la ultima orden bin*/
+static uint64_t linea_libre = 0;
+
+static void accion_Paso (uint32_t n){
+	ejecutar_Paso(n);
+}
+
+/**
+  * @brief Funcion que escribe un paso con el formato del guion
+	* @param f: Fichero
+	* @param p: Paso
+  * @retval None
+  */
+static void escribir_Paso (FILE *f, const Sim_Paso *p){
+	unsigned long long ms = p->instante / SIM_NS_MS, ns = p->instante % SIM_NS_MS;
+
+	if (ns != 0U)
+		fprintf(f, "%llu.%06llu ", ms, ns);
+	else
+		fprintf(f, "%llu ", ms);
+	switch (p->orden){
+		case PASO_PULSAR:
+			fprintf(f, "pulsar %s %u %u\n", nombre_boton[p->indice], (unsigned)p->valor, (unsigned)p->rebotes);
+			break;
+		case PASO_NIVEL:
+			fprintf(f, "nivel %s %u\n", nombre_boton[p->indice], (unsigned)p->valor);
+			break;
+		case PASO_POT:
+			fprintf(f, "pot %s %u\n", nombre_pot[p->indice], (unsigned)p->valor);
+			break;
+		case PASO_RX:
+			fprintf(f, "rx %s\n", p->texto);
+			break;
+		case PASO_BIN:
+			fprintf(f, "bin %s\n", p->texto);
+			break;
+		case PASO_DESVIO:
+			fprintf(f, "desvio %s %d\n", nombre_led[p->indice], (int)(int32_t)p->valor);
+			break;
+		case PASO_SECUENCIA:
+			fprintf(f, "secuencia %u\n", (unsigned)p->valor);
+			break;
+		case PASO_FIN:
+			fprintf(f, "fin\n");
+			break;
+	}
+}
+
+/**
+  * @brief Funcion que aplica un paso del guion y programa el siguiente
+	* @param n: Indice del paso
+  * @retval None
+  */
+static void ejecutar_Paso (uint32_t n){
+	Sim_Paso *p = &pasos[n];
+	uint64_t t = sim_ahora();
+	uint64_t byte_ns;
+	unsigned b;
+
+	if (registro != NULL)
+		escribir_Paso(registro, p);
+	switch (p->orden){
+		case PASO_PULSAR:
+			/*Rebotes: el pin alterna cada 0.5 ms antes de quedarse pulsado*/
+			for (uint32_t r = 0; r < 2U * p->rebotes; r++)
+				sim_programar(t + r * SIM_REBOTE_NS, accion_Boton, p->indice | ((r & 1U) ? 0U : 0x100U));
+			sim_programar(t + 2U * p->rebotes * SIM_REBOTE_NS, accion_Boton, p->indice | 0x100U);
+			sim_programar(t + (uint64_t)p->valor * SIM_NS_MS, accion_Boton, p->indice);
+			break;
+		case PASO_NIVEL:
+			pin_Boton(p->indice, p->valor != 0U);
+			break;
+		case PASO_POT:
+			sim_potenciometro(p->indice, (uint16_t)p->valor);
+			break;
+		case PASO_RX:
+			for (uint32_t i = 0; p->texto[i] != '\0'; i++)
+				sim_programar(t + i * SIM_NS_MS, accion_Rx, (uint8_t)p->texto[i]);
+			break;
+		case PASO_BIN:
+			/*Cada byte llega al terminar su bit de stop*/
+			byte_ns = 10U * 1000000000ULL / sim_usart_Baudios();
+			if (linea_libre > t)
+				t = linea_libre;
+			for (uint32_t i = 0; p->texto[i] != '\0' && p->texto[i + 1U] != '\0'; i += 2U){
+				sscanf(&p->texto[i], "%2x", &b);
+				t += byte_ns;
+				sim_programar(t, accion_Rx, b);
+			}
+			linea_libre = t;
+			break;
+		case PASO_DESVIO:
+			sim_desvio_PWM(p->indice, (int32_t)p->valor);
+			break;
+		case PASO_SECUENCIA:
+			/*Al fuzzear, el guion se sustituye por la siguiente secuencia*/
+			if (sim_fuzz_Secuencia(p->valor)){
+				if (num_pasos > 0U)
+					sim_programar(pasos[0].instante, accion_Paso, 0);
+				return;
+			}
+			break;
+		case PASO_FIN:
+			sim_fin(0);
+			break;
+	}
+	if (n + 1U < num_pasos)
+		sim_programar(pasos[n + 1U].instante, accion_Paso, n + 1U);
+}
+
+/**
+  * @brief Funcion que busca un nombre en una tabla
+	* @retval Indice o -1 si no se encuentra
+  */
+static int buscar (const char *nombre, const char *const tabla[], int num){
+	for (int i = 0; i < num; i++)
+		if (strcmp(nombre, tabla[i]) == 0)
+			return i;
+	return -1;
+}
+
+/**
+  * @brief Funcion que reserva un paso al final del guion
+	* @param None
+  * @retval Paso sin contar en num_pasos, NULL si no hay memoria
+  */
+static Sim_Paso *reservar_Paso (void){
+	if (num_pasos == capacidad){
+		capacidad = (capacidad != 0U) ? 2U * capacidad : 256U;
+		if ((pasos = realloc(pasos, capacidad * sizeof(Sim_Paso))) == NULL)
+			return NULL;
+	}
+	return &pasos[num_pasos];
+}
+
+/**
+  * @brief Funciones con las que el fuzzing sustituye el guion por cada secuencia
+	*				 generada y registra los pasos ejecutados en un guion equivalente
+  */
+void sim_guion_Vaciar (void){
+	num_pasos = 0;
+}
+
+int sim_guion_Anadir (const Sim_Paso *p){
+	Sim_Paso *q = reservar_Paso();
+
+	if (q == NULL)
+		return -1;
+	*q = *p;
+	num_pasos++;
+	return 0;
+}
+
+int sim_guion_Registrar (const char *ruta){
+	if ((registro = fopen(ruta, "w")) == NULL){
+		perror(ruta);
+		return -1;
+	}
+	fprintf(registro, "# Pasos ejecutados por rgb_sim -z firmware; se reproduce con rgb_sim -d -i\n");
+	return 0;
+}
+
+/**
+  * @brief Funcion que anade una orden bin con los bytes de un texto
+	* @param instante: Instante de la orden
+	* @param texto: Bytes a enviar (como mucho SIM_MAX_TEXTO / 2 - 1)
+  * @retval 0 si es correcto, -1 si no hay memoria
+  */
+static int anadir_Bin (uint64_t instante, const char *texto){
+	Sim_Paso *p = reservar_Paso();
+
+	if (p == NULL)
+		return -1;
+	memset(p, 0, sizeof(*p));
+	p->instante = instante;
+	p->orden = PASO_BIN;
+	for (uint32_t i = 0; texto[i] != '\0'; i++)
+		sprintf(&p->texto[2U * i], "%02x", (unsigned)(uint8_t)texto[i]);
+	num_pasos++;
+	return 0;
+}
+
+/**
+  * @brief Funcion que convierte un volcado del grabador en las ordenes bin que lo
+	*				 cargan con el comando 'C' y lo reproducen
+	* @param ruta: Fichero con el volcado
+	* @param instante: Instante de la orden grabacion
+	* @param reproducir: Comando de reproduccion ('r', 'R' o 'x')
+  * @retval 0 si es correcto, -1 en caso contrario
+  */
+static int leer_Grabacion (const char *ruta, uint64_t instante, char reproducir){
+	char linea[SIM_MAX_TEXTO / 2], orden[2] = {reproducir, '\0'};
+	Grabador_Evento e;
+	uint32_t numero = 0, flancos = 0;
+	FILE *f;
+	char *c;
+
+	if ((f = fopen(ruta, "r")) == NULL){
+		perror(ruta);
+		return -1;
+	}
+	if (anadir_Bin(instante, "C\n") != 0)
+		goto error;
+	while (fgets(linea, sizeof(linea) - 1U, f) != NULL){
+		numero++;
+		if ((c = strchr(linea, '#')) != NULL)
+			*c = '\0';
+		if (linea[0] != 'G')
+			continue;
+		if (leer_Grabador(linea, &e) != 0 || ++flancos > GRABADOR_NUM_EVENTOS)
+			goto error;
+		linea[strcspn(linea, " \t\r\n")] = '\0';
+		strcat(linea, "\n");
+		if (anadir_Bin(instante, linea) != 0)
+			goto error;
+	}
+	fclose(f);
+	return (anadir_Bin(instante, ".\n") != 0 || anadir_Bin(instante, orden) != 0) ? -1 : 0;
+
+error:
+	fprintf(stderr, "sim: linea %u de %s no valida\n", (unsigned)numero, ruta);
+	fclose(f);
+	return -1;
+}
+
+/**
+  * @brief Funcion que lee el guion de estimulos
+	* @param f: Fichero
+  * @retval 0 si es correcto, -1 en caso contrario
+  */
+static int leer_Guion (FILE *f){
+	char linea[256];
+	uint64_t anterior = 0;
+	uint32_t numero = 0;
+
+	while (fgets(linea, sizeof(linea), f) != NULL){
+		char *c, *tiempo, *orden, *arg;
+		Sim_Paso *p;
+		double ms;
+		int i;
+
+		numero++;
+		if ((c = strchr(linea, '#')) != NULL)
+			*c = '\0';
+		if ((tiempo = strtok(linea, " \t\r\n")) == NULL)
+			continue;
+		if ((orden = strtok(NULL, " \t\r\n")) == NULL)
+			goto error;
+		if ((p = reservar_Paso()) == NULL)
+			goto error;
+		ms = strtod(tiempo + (tiempo[0] == '+'), NULL);
+		p->instante = (uint64_t)(ms * SIM_NS_MS + 0.5) + ((tiempo[0] == '+') ? anterior : 0U);
+		if (p->instante < anterior)
+			goto error;
+		anterior = p->instante;
+		memset(p->texto, 0, sizeof(p->texto));
+
+		if (strcmp(orden, "pulsar") == 0){
+			if ((arg = strtok(NULL, " \t\r\n")) == NULL || (i = buscar(arg, nombre_boton, NUM_BOTONES)) < 0)
+				goto error;
+			p->orden = PASO_PULSAR;
+			p->indice = (uint32_t)i;
+			p->valor = ((arg = strtok(NULL, " \t\r\n")) != NULL) ? (uint32_t)strtoul(arg, NULL, 0) : 100U;
+			p->rebotes = ((arg = strtok(NULL, " \t\r\n")) != NULL) ? (uint32_t)strtoul(arg, NULL, 0) : 0U;
+		}
+		else if (strcmp(orden, "nivel") == 0){
+			if ((arg = strtok(NULL, " \t\r\n")) == NULL || (i = buscar(arg, nombre_boton, NUM_BOTONES)) < 0 ||
+					(arg = strtok(NULL, " \t\r\n")) == NULL)
+				goto error;
+			p->orden = PASO_NIVEL;
+			p->indice = (uint32_t)i;
+			p->valor = (uint32_t)strtoul(arg, NULL, 0);
+		}
+		else if (strcmp(orden, "pot") == 0){
+			if ((arg = strtok(NULL, " \t\r\n")) == NULL || (i = buscar(arg, nombre_pot, NUM_POTS)) < 0 ||
+					(arg = strtok(NULL, " \t\r\n")) == NULL)
+				goto error;
+			p->orden = PASO_POT;
+			p->indice = (uint32_t)i;
+			p->valor = (uint32_t)strtoul(arg, NULL, 0);
+		}
+		else if (strcmp(orden, "rx") == 0){
+			if ((arg = strtok(NULL, "\r\n")) == NULL)
+				goto error;
+			p->orden = PASO_RX;
+			strncpy(p->texto, arg + strspn(arg, " \t"), SIM_MAX_TEXTO - 1U);
+		}
+		else if (strcmp(orden, "bin") == 0){
+			if ((arg = strtok(NULL, " \t\r\n")) == NULL || strlen(arg) % 2U != 0U ||
+					strlen(arg) >= SIM_MAX_TEXTO || arg[strspn(arg, "0123456789abcdefABCDEF")] != '\0')
+				goto error;
+			p->orden = PASO_BIN;
+			strcpy(p->texto, arg);
+		}
+		else if (strcmp(orden, "desvio") == 0){
+			if ((arg = strtok(NULL, " \t\r\n")) == NULL || (i = buscar(arg, nombre_led, NUM_LEDS)) < 0 ||
+					(arg = strtok(NULL, " \t\r\n")) == NULL)
+				goto error;
+			p->orden = PASO_DESVIO;
+			p->indice = (uint32_t)i;
+			p->valor = (uint32_t)strtol(arg, NULL, 0);
+		}
+		else if (strcmp(orden, "grabacion") == 0){
+			/*Se anaden sus propias ordenes bin al mismo instante*/
+			if ((arg = strtok(NULL, " \t\r\n")) == NULL)
+				goto error;
+			c = strtok(NULL, " \t\r\n");
+			if ((c != NULL && (strlen(c) != 1U || strchr("rRx", c[0]) == NULL)) ||
+					leer_Grabacion(arg, p->instante, (c != NULL) ? c[0] : 'r') != 0)
+				goto error;
+			continue;
+		}
+		else if (strcmp(orden, "secuencia") == 0){
+			p->orden = PASO_SECUENCIA;
+			p->valor = ((arg = strtok(NULL, " \t\r\n")) != NULL) ? (uint32_t)strtoul(arg, NULL, 0) : 0U;
+		}
+		else if (strcmp(orden, "fin") == 0)
+			p->orden = PASO_FIN;
+		else
+			goto error;
+		num_pasos++;
+	}
+	return 0;
+
+error:
+	fprintf(stderr, "sim: linea %u del guion no valida\n", (unsigned)numero);
+	return -1;
+}
+
+int main (int argc, char *argv[]){
+	FILE *guion = stdin;
+	const char *traza_pwm = NULL, *captura = NULL;
+	const char *objetivo = NULL, *fallo = NULL;
+	uint64_t entradas = 0, semilla = 1;
+	int opcion, codigo;
+
+	while ((opcion = getopt(argc, argv, "e:dsluip:t:bcz:n:x:o:")) != -1){
+		switch (opcion){
+			case 'b':
+				sim_init_RTOS();
+				sim_init_HAL();
+				return sim_bench();
+			case 'c':
+				sim_init_RTOS();
+				sim_init_HAL();
+				return sim_control();
+			case 'e': sim_config.escala = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'd': sim_config.discreto = 1; break;
+			case 's': sim_config.traza_rtos = 1; break;
+			case 'p': traza_pwm = optarg; break;
+			case 't': captura = optarg; break;
+			case 'l': sim_config.traza_led = 0; break;
+			case 'u': sim_config.traza_uart = 0; break;
+			case 'i': sim_config.invariantes = 1; break;
+			case 'z': objetivo = optarg; break;
+			case 'n': entradas = strtoull(optarg, NULL, 0); break;
+			case 'x': semilla = strtoull(optarg, NULL, 0); break;
+			case 'o': fallo = optarg; break;
+			default:
+				fprintf(stderr, "uso: %s [-e escala] [-d] [-s] [-l] [-u] [-i] [-p fichero] [-t fichero] [guion] | -b | -c\n"
+												"     %s -z control|firmware [-n entradas] [-x semilla] [-o fallo]\n", argv[0], argv[0]);
+				return 1;
+		}
+	}
+	if (sim_config.escala == 0U)
+		sim_config.escala = 1;
+	if (objetivo == NULL){
+		if (optind < argc && (guion = fopen(argv[optind], "r")) == NULL){
+			perror(argv[optind]);
+			return 1;
+		}
+		if (leer_Guion(guion) != 0)
+			return 1;
+	}
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	sim_init_RTOS();
+	sim_init_HAL();
+	/*El fuzzing del firmware deja su primera secuencia como guion; el resto de
+		objetivos se ejecutan sin arrancar el firmware*/
+	if (objetivo != NULL && (codigo = sim_fuzz(objetivo, entradas, semilla, fallo)) >= 0)
+		return codigo;
+	if (traza_pwm != NULL && sim_pwm_Abrir(traza_pwm) != 0)
+		return 1;
+	if (captura != NULL && sim_usart_Captura(captura) != 0)
+		return 1;
+	if (num_pasos > 0U)
+		sim_programar(pasos[0].instante, accion_Paso, 0);
+	firmware_main();
+	return 0;
+}
@@ -0,0 +1,123 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Sim.h
+  * @author  MCD Application Team
+  * @brief   Interfaz interna del simulador en el PC. El firmware se compila sin
+	*					 cambios contra una HAL simulada (Sim_HAL.c), un CMSIS Driver de la
+	*					 USART3 simulado (Sim_USART.c) y una capa CMSIS-RTOS2 sobre hilos
+	*					 POSIX (Sim_RTOS.c). Sim.c lee el guion de estimulos y muestra los
+	*					 cambios de los CCR del LED y los bytes enviados por la USART.
+	*
+	*					 Solo un hilo del firmware se ejecuta a la vez: el de mayor prioridad
+	*					 de los que estan listos, como en el nucleo. Las interrupciones y
+	*					 los plazos los atiende el hilo del reloj del simulador cuando el
+	*					 hilo en ejecucion se bloquea, por lo que una rutina de interrupcion
+	*					 nunca interrumpe a mitad de una funcion del firmware.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __SIM_H
+#define __SIM_H
+
+#include <stdint.h>
+#include "Sim_PWM.h"
+
+/*Tiempo sin limite*/
+#define SIM_NUNCA  UINT64_MAX
+
+/*Nanosegundos por milisegundo*/
+#define SIM_NS_MS  1000000ULL
+
+/*Evento del hardware simulado: se ejecuta en contexto de interrupcion en su instante*/
+typedef void (*Sim_Accion)(uint32_t arg);
+
+/*Pasos del guion de estimulos (Sim.c)*/
+#define SIM_MAX_TEXTO   64
+
+typedef enum {
+	PASO_PULSAR,
+	PASO_NIVEL,
+	PASO_POT,
+	PASO_RX,
+	PASO_BIN,
+	PASO_DESVIO,
+	PASO_SECUENCIA,
+	PASO_FIN
+} Sim_Orden;
+
+typedef struct {
+	uint64_t instante;
+	Sim_Orden orden;
+	uint32_t indice;
+	uint32_t valor;
+	uint32_t rebotes;
+	char texto[SIM_MAX_TEXTO];
+} Sim_Paso;
+
+/*Configuracion de la simulacion (Sim.c)*/
+typedef struct {
+	uint32_t escala;			/*Factor de aceleracion respecto al tiempo real*/
+	int traza_uart;				/*Muestra las lineas enviadas por la USART*/
+	int traza_led;				/*Muestra los cambios de los CCR y de las salidas del LED*/
+	int discreto;					/*Tiempo virtual: avanza solo con todos los hilos bloqueados*/
+	int traza_rtos;				/*Muestra los cambios de hilo del planificador*/
+	int invariantes;			/*Comprueba los invariantes del LED y del IWDG (Sim_Fuzz.c)*/
+} Sim_Config;
+
+extern Sim_Config sim_config;
+
+/*Reloj y nucleo (Sim_RTOS.c)*/
+void sim_init_RTOS (void);
+uint64_t sim_ahora (void);
+uint64_t sim_real (void);
+void sim_avanzar (void);
+void sim_programar (uint64_t instante, Sim_Accion accion, uint32_t arg);
+void sim_isr (void (*rutina)(void));
+__attribute__((noreturn)) void sim_fin (int codigo);
+
+/*Hardware (Sim_HAL.c)*/
+void sim_init_HAL (void);
+void sim_pin (uint32_t puerto, uint32_t pin, int nivel);
+void sim_potenciometro (uint32_t pot, uint16_t valor);
+void sim_desvio_PWM (uint32_t color, int32_t permil);
+void sim_irq (int irq);
+void sim_revisar (void);
+uint64_t sim_iwdg_limite (void);
+uint64_t sim_iwdg_refresco (void);
+
+/*USART (Sim_USART.c)*/
+void sim_rx (uint8_t c);
+uint32_t sim_usart_Baudios (void);
+uint32_t sim_tx_bytes (void);
+int sim_usart_Captura (const char *ruta);
+void sim_usart_Cerrar (void);
+
+/*Traza de la PWM del LED (Sim_PWM.c)*/
+int sim_pwm_Abrir (const char *ruta);
+void sim_pwm_Registrar (const Sim_PWM_Registro *r, uint32_t periodo_ns, uint32_t arr);
+void sim_pwm_Cerrar (void);
+
+/*Micro-benchmarks en el PC (Sim_Bench.c)*/
+int sim_bench (void);
+
+/*Prueba de la tabla de transiciones de la maquina de estados (Sim_Control.c)*/
+int sim_control (void);
+
+/*Fuzzing guiado por cobertura (Sim_Fuzz.c)*/
+int sim_fuzz (const char *objetivo, uint64_t entradas, uint64_t semilla, const char *fallo);
+int sim_fuzz_Secuencia (uint32_t n);
+void sim_fuzz_Reposo (void);
+void sim_fuzz_Led (int color, uint32_t ccr, int activo);
+
+/*Guion (Sim.c)*/
+void sim_guion_Vaciar (void);
+int sim_guion_Anadir (const Sim_Paso *p);
+int sim_guion_Registrar (const char *ruta);
+
+/*Observacion (Sim.c)*/
+void sim_traza (const char *fmt, ...);
+void sim_led (int color, uint32_t ccr, int activo);
+void sim_uart (const char *linea);
+
+#endif /* __SIM_H */
@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Sim_Bench.c
+  * @author  MCD Application Team
+  * @brief   Ejecucion de los micro-benchmarks del firmware (Bench.c) en el PC.
+	*					 Sustituye las fuentes de tiempo debiles por el reloj monotono del
+	*					 sistema en nanosegundos, inicializa solo los perifericos que usan
+	*					 los benchmarks y escribe las lineas CSV en la salida estandar.
+	*					 Se mide el tiempo real del PC, no el simulado.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <time.h>
+#include "stm32f4xx_hal.h"
+#include "Bench.h"
+#include "RGB.h"
+#include "USART.h"
+#include "joystick.h"
+#include "Traza.h"
+#include "Sim.h"
+
+/*En modo discreto se mide el tiempo virtual del DWT para que la salida del comando
+	'B' sea reproducible*/
+uint32_t bench_Contador (void){
+	struct timespec t;
+
+	if (sim_config.discreto)
+		return DWT->CYCCNT;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint32_t)((uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec);
+}
+
+uint32_t bench_Frecuencia (void){
+	if (sim_config.discreto)
+		return SystemCoreClock;
+	return 1000000000U;
+}
+
+const char *bench_Plataforma (void){
+	return "linux";
+}
+
+static void enviar_Stdout (const char *linea){
+	puts(linea);
+}
+
+/**
+  * @brief Funcion que ejecuta los benchmarks sin arrancar el firmware
+	* @param None
+  * @retval Codigo de salida del programa
+  */
+int sim_bench (void){
+	sim_config.traza_led = 0;
+	sim_config.traza_uart = 0;
+	if (initRGB() != 0 || init_USART() != 0){
+		fprintf(stderr, "sim: no se pueden iniciar los perifericos del benchmark\n");
+		return 1;
+	}
+	Init_GPIO();
+	/*Sin firmware_main la traza esta detenida y su benchmark no la mediria*/
+	init_Traza();
+	ejecutar_Bench(enviar_Stdout);
+	return 0;
+}
@@ -0,0 +1,199 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Sim_Control.c
+  * @author  MCD Application Team
+  * @brief   Prueba determinista de la tabla de transiciones de la maquina de
+	*					 estados del LED (Control.c) en el PC (-c). Para cada par estado x
+	*					 evento se parte de un estado conocido, se despacha el evento con
+	*					 las salidas de RGB.c sobre los Timers simulados y se comparan con
+	*					 la tabla de resultados esperados:
+	*							- El estado, el color de la rotacion, la intensidad y el tono
+	*								de la maquina
+	*							- La habilitacion y el CCR del canal de cada color
+	*
+	*					 Estado de partida de cada fila: color rojo de la rotacion, la
+	*					 intensidad CONTROL_INTENSIDAD y el tono CONTROL_TONO, mostrado en el
+	*					 LED en los estados encendidos. Un evento nuevo sin su fila en la
+	*					 tabla se cuenta como fallo.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include "stm32f4xx_hal.h"
+#include "Placa.h"
+#include "RGB.h"
+#include "Control.h"
+#include "Sim.h"
+
+/*Estado de partida de cada fila*/
+#define CONTROL_COLOR        1U				/*Rojo en la rotacion verde, rojo, azul*/
+#define CONTROL_INTENSIDAD   30000
+#define CONTROL_TONO         10000U
+/*Valores de los potenciometros de EV_BRILLO y EV_TONO*/
+#define CONTROL_BRILLO       50000U
+#define CONTROL_NUEVO_TONO   20000U
+
+/*Canal con la salida PWM deshabilitada*/
+#define SIN_PWM              0xFFFFFFFFU
+
+typedef struct {
+	uint8_t definido;
+	Control_Estado estado;
+	uint8_t color;
+	int intensidad;
+	uint16_t tono;
+	uint32_t ccr[NUM_LEDS];		/*Rojo, verde y azul (SIN_PWM: deshabilitado)*/
+} Caso;
+
+#define CASO(estado, color, intensidad, tono, rojo, verde, azul) \
+	{1, (estado), (color), (intensidad), (tono), {(rojo), (verde), (azul)}}
+/*Apagado con el color, la intensidad y el tono de partida*/
+#define APAGADO_PARTIDA \
+	CASO(EST_APAGADO, 1, 30000, 10000, SIN_PWM, SIN_PWM, SIN_PWM)
+
+/*Resultado esperado de cada par estado x evento. Con el tono las intensidades de
+	cada color salen de la rueda de color de tono_LED*/
+static const Caso casos[NUM_ESTADOS][NUM_EVENTOS] = {
+	[EST_APAGADO] = {
+		[EV_IZQUIERDA]   = APAGADO_PARTIDA,
+		[EV_DERECHA]     = APAGADO_PARTIDA,
+		[EV_SUBIR]       = CASO(EST_APAGADO, 1, 10000, 10000, SIN_PWM, SIN_PWM, SIN_PWM),
+		[EV_BAJAR]       = CASO(EST_APAGADO, 1, 50000, 10000, SIN_PWM, SIN_PWM, SIN_PWM),
+		[EV_CENTRAL]     = CASO(EST_COLOR, 0, 30000, 10000, SIN_PWM, RGB_CCR(30000), SIN_PWM),
+		[EV_BRILLO]      = CASO(EST_APAGADO, 1, 15535, 10000, SIN_PWM, SIN_PWM, SIN_PWM),
+		[EV_TONO]        = CASO(EST_APAGADO, 1, 30000, 20000, SIN_PWM, SIN_PWM, SIN_PWM),
+		[EV_INACTIVIDAD] = APAGADO_PARTIDA,
+	},
+	[EST_COLOR] = {
+		[EV_IZQUIERDA]   = CASO(EST_COLOR, 0, 30000, 10000, SIN_PWM, RGB_CCR(30000), SIN_PWM),
+		[EV_DERECHA]     = CASO(EST_COLOR, 2, 30000, 10000, SIN_PWM, SIN_PWM, RGB_CCR(30000)),
+		[EV_SUBIR]       = CASO(EST_COLOR, 1, 10000, 10000, RGB_CCR(10000), SIN_PWM, SIN_PWM),
+		[EV_BAJAR]       = CASO(EST_COLOR, 1, 50000, 10000, RGB_CCR(50000), SIN_PWM, SIN_PWM),
+		[EV_CENTRAL]     = APAGADO_PARTIDA,
+		[EV_BRILLO]      = CASO(EST_COLOR, 1, 15535, 10000, RGB_CCR(15535), SIN_PWM, SIN_PWM),
+		[EV_TONO]        = CASO(EST_TONO, 1, 30000, 20000, RGB_CCR(59533), RGB_CCR(30000), RGB_CCR(65535)),
+		[EV_INACTIVIDAD] = APAGADO_PARTIDA,
+	},
+	[EST_TONO] = {
+		[EV_IZQUIERDA]   = CASO(EST_COLOR, 0, 30000, 10000, SIN_PWM, RGB_CCR(30000), SIN_PWM),
+		[EV_DERECHA]     = CASO(EST_COLOR, 0, 30000, 10000, SIN_PWM, RGB_CCR(30000), SIN_PWM),
+		[EV_SUBIR]       = CASO(EST_TONO, 1, 10000, 10000, RGB_CCR(10000), RGB_CCR(14692), RGB_CCR(65535)),
+		[EV_BAJAR]       = CASO(EST_TONO, 1, 50000, 10000, RGB_CCR(50000), RGB_CCR(51313), RGB_CCR(65535)),
+		[EV_CENTRAL]     = APAGADO_PARTIDA,
+		[EV_BRILLO]      = CASO(EST_TONO, 1, 15535, 10000, RGB_CCR(15535), RGB_CCR(19759), RGB_CCR(65535)),
+		[EV_TONO]        = CASO(EST_TONO, 1, 30000, 20000, RGB_CCR(59533), RGB_CCR(30000), RGB_CCR(65535)),
+		[EV_INACTIVIDAD] = APAGADO_PARTIDA,
+	},
+};
+
+static const char *const nombre_estado[NUM_ESTADOS] = {"APAGADO", "COLOR", "TONO"};
+static const char *const nombre_evento[NUM_EVENTOS] = {
+	"IZQUIERDA", "DERECHA", "SUBIR", "BAJAR", "CENTRAL", "BRILLO", "TONO", "INACTIVIDAD"
+};
+static const char *const nombre_led[NUM_LEDS] = {"ROJO", "VERDE", "AZUL"};
+
+static void mensaje_nulo (const char *texto){
+	(void)texto;
+}
+
+static const Control_Salidas salidas_prueba = {
+	encender_LED,
+	apagar_LED,
+	intensidad_LED,
+	tono_LED,
+	mensaje_nulo
+};
+
+/**
+  * @brief Funcion que devuelve el CCR de un canal o SIN_PWM si esta deshabilitado
+	* @param c: Color
+  * @retval CCR del canal
+  */
+static uint32_t leer_Canal (int c){
+	if ((rgb_leds[c].htim->Instance->CCER & (TIM_CCER_CC1E << rgb_leds[c].Canal)) == 0U)
+		return SIN_PWM;
+	return *rgb_leds[c].CCR;
+}
+
+/**
+  * @brief Funcion que prepara el estado de partida de una fila con el LED mostrando
+	*				 lo que corresponde al estado
+	* @param c: Maquina de estados
+	* @param estado: Estado de partida
+  * @retval None
+  */
+static void preparar (Control *c, Control_Estado estado){
+	for (int l = 0; l < NUM_LEDS; l++){
+		apagar_LED((Color)l);
+		*rgb_leds[l].CCR = RGB_ARR;
+	}
+	init_Control(c, &salidas_prueba, CONTROL_INTENSIDAD);
+	c->estado = estado;
+	c->color = CONTROL_COLOR;
+	c->tono = CONTROL_TONO;
+	mostrar_Control(c);
+}
+
+/**
+  * @brief Funcion que despacha un evento desde el estado de partida y lo compara con
+	*				 el resultado esperado
+	* @param estado: Estado de partida
+	* @param evento: Evento
+  * @retval Numero de diferencias
+  */
+static int probar (Control_Estado estado, Control_Evento evento){
+	const Caso *e = &casos[estado][evento];
+	Control c;
+	uint16_t valor = (evento == EV_BRILLO) ? CONTROL_BRILLO : (evento == EV_TONO) ? CONTROL_NUEVO_TONO : 0U;
+	uint32_t ccr;
+	int fallos = 0;
+
+	if (!e->definido){
+		printf("control: %s x %s sin resultado esperado\n", nombre_estado[estado], nombre_evento[evento]);
+		return 1;
+	}
+	preparar(&c, estado);
+	despachar_Control(&c, evento, valor);
+	if (c.estado != e->estado || c.color != e->color || c.intensidad != e->intensidad || c.tono != e->tono){
+		printf("control: %s x %s -> estado=%s color=%u intensidad=%d tono=%u, esperado %s %u %d %u\n",
+					 nombre_estado[estado], nombre_evento[evento], nombre_estado[c.estado], (unsigned)c.color,
+					 c.intensidad, (unsigned)c.tono, nombre_estado[e->estado], (unsigned)e->color,
+					 e->intensidad, (unsigned)e->tono);
+		fallos++;
+	}
+	for (int l = 0; l < NUM_LEDS; l++){
+		if ((ccr = leer_Canal(l)) == e->ccr[l])
+			continue;
+		if (ccr != SIN_PWM && e->ccr[l] != SIN_PWM)
+			printf("control: %s x %s -> LED %s CCR=%u, esperado %u\n", nombre_estado[estado],
+						 nombre_evento[evento], nombre_led[l], (unsigned)ccr, (unsigned)e->ccr[l]);
+		else
+			printf("control: %s x %s -> LED %s %s, esperado %s\n", nombre_estado[estado], nombre_evento[evento],
+						 nombre_led[l], (ccr == SIN_PWM) ? "apagado" : "encendido",
+						 (e->ccr[l] == SIN_PWM) ? "apagado" : "encendido");
+		fallos++;
+	}
+	return fallos;
+}
+
+/**
+  * @brief Funcion que recorre la tabla de transiciones sin arrancar el firmware
+	* @param None
+  * @retval Codigo de salida del programa: 0 si todos los pares son correctos
+  */
+int sim_control (void){
+	int fallos = 0;
+
+	sim_config.traza_led = 0;
+	sim_config.traza_uart = 0;
+	if (initRGB() != 0){
+		fprintf(stderr, "sim: no se puede iniciar el LED\n");
+		return 1;
+	}
+	for (int s = 0; s < NUM_ESTADOS; s++)
+		for (int v = 0; v < NUM_EVENTOS; v++)
+			fallos += probar((Control_Estado)s, (Control_Evento)v);
+	printf("control: %u pares estado x evento, %d diferencias\n", (unsigned)(NUM_ESTADOS * NUM_EVENTOS), fallos);
+	return (fallos == 0) ? 0 : 1;
+}
@@ -0,0 +1,587 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Sim_Fuzz.c
+  * @author  MCD Application Team
+  * @brief   Fuzzing guiado por cobertura del firmware en el PC (-z). rgb_fuzz es
+	*					 rgb_sim con el firmware compilado con -fsanitize-coverage=trace-pc:
+	*					 cada arista recorrida suma una pasada en una casilla del mapa de
+	*					 cobertura, como en AFL. Las entradas que alcanzan una casilla nueva
+	*					 (o un nuevo orden de magnitud de pasadas) se guardan en el corpus y
+	*					 las siguientes entradas son mutaciones de las del corpus. Sin la
+	*					 instrumentacion (rgb_sim -z) las entradas son aleatorias.
+	*
+	*					 Objetivos:
+	*							- control: maquina de estados del LED (Control.c) con las
+	*								salidas de RGB.c sobre los Timers simulados, partiendo del
+	*								estado que recupera Arranque.c tras un reset. Cada entrada son
+	*								6 bytes de los registros de backup seguidos de eventos (1 byte
+	*								y 2 mas con el valor de los potenciometros). No arranca el
+	*								nucleo, por lo que ejecuta millones de secuencias por minuto.
+	*							- firmware: el firmware completo en tiempo virtual. Cada entrada
+	*								es una secuencia de pasos de 4 bytes (flancos y pulsaciones con
+	*								rebotes de los botones, potenciometros y caracteres del
+	*								terminal) que se aplica sobre el estado que dejo la anterior.
+	*								Los pasos ejecutados se registran como un guion que reproduce
+	*								el fallo con rgb_sim -d -i.
+	*
+	*					 Invariantes (tambien con rgb_sim -i):
+	*							- El CCR de un canal activo esta entre 0 y RGB_ARR
+	*							- Apagado no hay canales activos y con un unico color (EST_COLOR)
+	*								solo puede estar activo el canal de ese color
+	*							- El estado guardado en los registros de backup se recupera
+	*								igual (objetivo control)
+	*							- El supervisor refresca el IWDG en cada periodo: si un hilo no
+	*								da su latido a tiempo deja de refrescarlo (objetivo firmware)
+	*
+	*					 En el firmware los invariantes del LED se comprueban con todos los
+	*					 hilos bloqueados (sim_fuzz_Reposo), ya que una transicion apaga y
+	*					 enciende varios canales seguidos y el estado se guarda despues.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "Placa.h"
+#include "RGB.h"
+#include "Control.h"
+#include "Arranque.h"
+#include "Watchdog.h"
+#include "Sim.h"
+
+#define FUZZ_MAPA          (1U << 16)
+#define FUZZ_MAX_ENTRADA   256U
+#define FUZZ_MAX_CORPUS    4096U
+/*Instante del primer paso del objetivo firmware, con el arranque terminado*/
+#define FUZZ_INICIO_MS     500U
+/*Tiempo desde el ultimo paso de una secuencia hasta su evaluacion*/
+#define FUZZ_ASENTAR_MS    300U
+/*Mayor intervalo entre refrescos del IWDG: un periodo del supervisor mas la mitad*/
+#define FUZZ_IWDG_MS       (WATCHDOG_PERIODO_MS * 3U / 2U)
+/*Espera del valor 0xFF de un paso: supera la inactividad y el fundido del LED*/
+#define FUZZ_ESPERA_LARGA_MS  65000U
+/*Intervalo entre informes de progreso*/
+#define FUZZ_INFORME_MS    5000U
+
+typedef struct {
+	uint8_t datos[FUZZ_MAX_ENTRADA];
+	uint32_t tam;
+} Fuzz_Entrada;
+
+typedef enum {
+	FUZZ_NINGUNO,
+	FUZZ_CONTROL,
+	FUZZ_FIRMWARE
+} Fuzz_Objetivo;
+
+/*Pasadas por cada arista en la entrada en curso y clases de pasadas ya vistas*/
+static uint64_t mapa64[FUZZ_MAPA / 8U];
+static uint8_t *const mapa = (uint8_t *)mapa64;
+static uint8_t vistos[FUZZ_MAPA];
+static uintptr_t previo;
+static uint32_t aristas;
+
+static Fuzz_Entrada corpus[FUZZ_MAX_CORPUS];
+static uint32_t num_corpus;
+static Fuzz_Entrada actual;
+
+static Fuzz_Objetivo objetivo = FUZZ_NINGUNO;
+static uint64_t azar_estado;
+static uint64_t ejecutadas, limite;
+static uint64_t proximo_informe;
+static const char *fichero_fallo;
+/*Instante de la evaluacion de la secuencia en curso del firmware*/
+static uint64_t fin_secuencia;
+
+static const char *const nombre_evento[NUM_EVENTOS] = {
+	"IZQUIERDA", "DERECHA", "SUBIR", "BAJAR", "CENTRAL", "BRILLO", "TONO", "INACTIVIDAD"
+};
+
+/**
+  * @brief Funcion que llama el codigo instrumentado en cada arista. El indice
+	*				 combina el punto actual con el anterior, como en AFL. Las direcciones
+	*				 se toman respecto a esta funcion para que el mapa no dependa de donde
+	*				 se cargue el programa y la misma semilla de la misma ejecucion.
+  */
+void __sanitizer_cov_trace_pc (void){
+	uintptr_t pc = (uintptr_t)__builtin_return_address(0) - (uintptr_t)__sanitizer_cov_trace_pc;
+
+	mapa[(pc ^ previo) & (FUZZ_MAPA - 1U)]++;
+	previo = pc >> 1;
+}
+
+/*Generador xorshift64: la misma semilla da las mismas entradas*/
+static uint32_t azar (uint32_t n){
+	azar_estado ^= azar_estado << 13;
+	azar_estado ^= azar_estado >> 7;
+	azar_estado ^= azar_estado << 17;
+	return (uint32_t)((azar_estado >> 32) % n);
+}
+
+/*Clase de un numero de pasadas: 1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128-255*/
+static uint8_t clase (uint8_t n){
+	if (n <= 2U)   return n;
+	if (n == 3U)   return 4U;
+	if (n < 8U)    return 8U;
+	if (n < 16U)   return 16U;
+	if (n < 32U)   return 32U;
+	if (n < 128U)  return 64U;
+	return 128U;
+}
+
+static void limpiar_Mapa (void){
+	memset(mapa64, 0, sizeof(mapa64));
+	previo = 0;
+}
+
+/**
+  * @brief Funcion que anade al corpus la entrada en curso si ha recorrido una arista
+	*				 nueva o una conocida con un numero de pasadas de otra clase
+	* @param None
+  * @retval None
+  */
+static void evaluar_Cobertura (void){
+	int nueva = 0;
+	uint8_t c;
+
+	for (uint32_t w = 0; w < FUZZ_MAPA / 8U; w++){
+		if (mapa64[w] == 0U)
+			continue;
+		for (uint32_t i = 8U * w; i < 8U * w + 8U; i++){
+			c = clase(mapa[i]);
+			if ((c & ~vistos[i]) != 0U){
+				if (vistos[i] == 0U)
+					aristas++;
+				vistos[i] |= c;
+				nueva = 1;
+			}
+		}
+	}
+	if (!nueva)
+		return;
+	/*Con el corpus lleno se sustituye una entrada al azar*/
+	corpus[(num_corpus < FUZZ_MAX_CORPUS) ? num_corpus++ : azar(FUZZ_MAX_CORPUS)] = actual;
+}
+
+/**
+  * @brief Funcion que genera la siguiente entrada mutando una del corpus
+	* @param e: Entrada generada
+	* @param max: Tamano maximo
+  * @retval None
+  */
+static void mutar (Fuzz_Entrada *e, uint32_t max){
+	static const uint8_t interesantes[] = {0x00, 0x01, 0x02, 0x07, 0x10, 0x7F, 0x80, 0xA7, 0xC0, 0xFE, 0xFF};
+	const Fuzz_Entrada *otra;
+	uint32_t vueltas, pos, lon, org;
+
+	/*Sin corpus, y de vez en cuando, una entrada totalmente aleatoria*/
+	if (num_corpus == 0U || azar(64U) == 0U){
+		e->tam = 1U + azar(max);
+		for (uint32_t i = 0; i < e->tam; i++)
+			e->datos[i] = (uint8_t)azar(256U);
+		return;
+	}
+	*e = corpus[azar(num_corpus)];
+	for (vueltas = 1U + azar(4U); vueltas > 0U; vueltas--){
+		switch (azar(7U)){
+			case 0:		/*Cambio de un bit*/
+				if (e->tam != 0U)
+					e->datos[azar(e->tam)] ^= (uint8_t)(1U << azar(8U));
+				break;
+			case 1:		/*Byte aleatorio*/
+				if (e->tam != 0U)
+					e->datos[azar(e->tam)] = (uint8_t)azar(256U);
+				break;
+			case 2:		/*Valor de frontera*/
+				if (e->tam != 0U)
+					e->datos[azar(e->tam)] = interesantes[azar(sizeof(interesantes))];
+				break;
+			case 3:		/*Insercion de bytes aleatorios*/
+				lon = 1U + azar(8U);
+				if (e->tam + lon > max)
+					break;
+				pos = azar(e->tam + 1U);
+				memmove(&e->datos[pos + lon], &e->datos[pos], e->tam - pos);
+				for (uint32_t i = 0; i < lon; i++)
+					e->datos[pos + i] = (uint8_t)azar(256U);
+				e->tam += lon;
+				break;
+			case 4:		/*Borrado de un bloque*/
+				if (e->tam < 2U)
+					break;
+				lon = 1U + azar((e->tam - 1U < 8U) ? e->tam - 1U : 8U);
+				pos = azar(e->tam - lon + 1U);
+				memmove(&e->datos[pos], &e->datos[pos + lon], e->tam - pos - lon);
+				e->tam -= lon;
+				break;
+			case 5:		/*Copia de un bloque sobre otra posicion*/
+				if (e->tam < 2U)
+					break;
+				lon = 1U + azar(e->tam / 2U);
+				org = azar(e->tam - lon + 1U);
+				pos = azar(e->tam - lon + 1U);
+				memmove(&e->datos[pos], &e->datos[org], lon);
+				break;
+			default:	/*Empalme con el final de otra entrada*/
+				otra = &corpus[azar(num_corpus)];
+				pos = azar(e->tam + 1U);
+				if (pos < otra->tam && otra->tam <= max){
+					memcpy(&e->datos[pos], &otra->datos[pos], otra->tam - pos);
+					e->tam = otra->tam;
+				}
+				break;
+		}
+	}
+	if (e->tam > max)
+		e->tam = max;
+}
+
+/**
+  * @brief Funcion que muestra el progreso cada FUZZ_INFORME_MS o al terminar
+	* @param final: 1 para el resumen final
+  * @retval None
+  */
+static void informe (int final){
+	uint64_t real = sim_real();
+	double ms = (double)real / SIM_NS_MS;
+
+	if (!final && real < proximo_informe)
+		return;
+	proximo_informe = real + FUZZ_INFORME_MS * SIM_NS_MS;
+	fprintf(stderr, "fuzz: %llu entradas en %.1f s (%.0f/min), %u aristas, corpus %u",
+				 (unsigned long long)ejecutadas, ms / 1000.0, (ms > 0.0) ? ejecutadas * 60000.0 / ms : 0.0,
+				 (unsigned)aristas, (unsigned)num_corpus);
+	if (objetivo == FUZZ_FIRMWARE)
+		fprintf(stderr, ", %.1f s simulados", (double)sim_ahora() / (1000.0 * SIM_NS_MS));
+	fputc('\n', stderr);
+}
+
+/*Invariantes ----------------------------------------------------------------*/
+
+/**
+  * @brief Funcion que comprueba los canales del LED frente al estado de la maquina
+	* @param c: Maquina de estados, NULL si no se conoce su estado
+  * @retval Invariante incumplido, NULL si se cumplen todos
+  */
+static const char *comprobar_LED (const Control *c){
+	uint32_t activos = 0;
+
+	for (int i = 0; i < NUM_LEDS; i++){
+		/*Antes de initRGB el canal aun no tiene Timer*/
+		if (rgb_leds[i].htim->Instance == NULL)
+			continue;
+		if ((rgb_leds[i].htim->Instance->CCER & (TIM_CCER_CC1E << rgb_leds[i].Canal)) == 0U)
+			continue;
+		activos |= 1U << i;
+		if (*rgb_leds[i].CCR > RGB_ARR)
+			return "CCR fuera de rango";
+	}
+	if (c == NULL)
+		return NULL;
+	if (c->estado == EST_APAGADO && activos != 0U)
+		return "canales activos con el LED apagado";
+	if (c->estado == EST_COLOR && (activos & ~(1U << color_Control(c))) != 0U)
+		return "canales de otros colores activos con un unico color";
+	return NULL;
+}
+
+/**
+  * @brief Funcion que termina la simulacion al incumplirse un invariante
+	* @param motivo: Invariante incumplido
+  * @retval None
+  */
+static __attribute__((noreturn)) void incumplido (const char *motivo){
+	sim_traza("INVARIANTE: %s", motivo);
+	if (objetivo == FUZZ_FIRMWARE){
+		informe(1);
+		fprintf(stderr, "fuzz: secuencia %llu; se reproduce con rgb_sim -d -i %s\n",
+					 (unsigned long long)ejecutadas, fichero_fallo);
+	}
+	sim_fin(4);
+}
+
+/**
+  * @brief Funcion que comprueba cada cambio del LED: con un CCR mayor que el ARR la
+	*				 salida no conmuta
+	* @param color: Canal
+	* @param ccr: CCR del canal
+	* @param activo: Salida habilitada
+  * @retval None
+  */
+void sim_fuzz_Led (int color, uint32_t ccr, int activo){
+	(void)color;
+	if (activo && ccr > RGB_ARR)
+		incumplido("CCR fuera de rango");
+}
+
+/**
+  * @brief Funcion que comprueba los invariantes con todos los hilos bloqueados. El
+	*				 estado de la maquina se lee de los registros de backup, donde el hilo
+	*				 de control lo guarda tras cada evento.
+	* @param None
+  * @retval None
+  */
+void sim_fuzz_Reposo (void){
+	Control c;
+	const char *fallo;
+
+	if (sim_iwdg_limite() != SIM_NUNCA && sim_ahora() - sim_iwdg_refresco() > FUZZ_IWDG_MS * SIM_NS_MS)
+		incumplido("IWDG sin refrescar en un periodo del supervisor");
+	init_Control(&c, NULL, 0);
+	fallo = comprobar_LED((restaurar_Arranque(&c) == 0) ? &c : NULL);
+	if (fallo != NULL)
+		incumplido(fallo);
+}
+
+/*Objetivo control -----------------------------------------------------------*/
+
+static void mensaje_nulo (const char *texto){
+	(void)texto;
+}
+
+static const Control_Salidas salidas_fuzz = {
+	encender_LED,
+	apagar_LED,
+	intensidad_LED,
+	tono_LED,
+	mensaje_nulo
+};
+
+static uint32_t leer (const uint8_t *d, uint32_t tam, uint32_t *i, uint32_t bytes){
+	uint32_t v = 0;
+
+	for (uint32_t b = 0; b < bytes; b++)
+		v = (v << 8) | ((*i < tam) ? d[(*i)++] : 0U);
+	return v;
+}
+
+/**
+  * @brief Funcion que comprueba la maquina de estados y el LED tras un evento
+	* @param c: Maquina de estados
+  * @retval Invariante incumplido, NULL si se cumplen todos
+  */
+static const char *comprobar_Control (const Control *c){
+	Control r;
+
+	if ((unsigned)c->estado >= NUM_ESTADOS || c->color >= NUM_LEDS)
+		return "estado o color no valido";
+	if (c->intensidad < 0 || c->intensidad > 0xFFFF)
+		return "intensidad fuera del rango del CCR";
+	guardar_Arranque(c);
+	r = *c;
+	if (restaurar_Arranque(&r) != 0 || r.estado != c->estado || r.color != c->color ||
+			r.intensidad != c->intensidad || r.tono != c->tono)
+		return "el estado guardado no se recupera igual";
+	return comprobar_LED(c);
+}
+
+/**
+  * @brief Funcion que ejecuta una entrada sobre la maquina de estados
+	* @param d: Datos de la entrada
+	* @param tam: Bytes
+	* @param traza: Fichero donde se muestra cada evento, NULL sin traza
+  * @retval Invariante incumplido, NULL si se cumplen todos
+  */
+static const char *ejecutar_Control (const uint8_t *d, uint32_t tam, FILE *traza){
+	Control c;
+	const char *fallo;
+	uint32_t i = 0, evento;
+	uint16_t valor;
+
+	for (int l = 0; l < NUM_LEDS; l++){
+		apagar_LED((Color)l);
+		*rgb_leds[l].CCR = RGB_ARR;
+	}
+	/*Registros de backup antes del reset, como en restaurar_RGB*/
+	ARRANQUE_BKP_LED = leer(d, tam, &i, 4U);
+	ARRANQUE_BKP_TONO = leer(d, tam, &i, 2U);
+	init_Control(&c, &salidas_fuzz, 30000);
+	if (restaurar_Arranque(&c) == 0)
+		mostrar_Control(&c);
+	if (traza != NULL)
+		fprintf(traza, "  arranque: BKP_LED=0x%08X BKP_TONO=%u -> estado=%d color=%u intensidad=%d\n",
+						(unsigned)ARRANQUE_BKP_LED, (unsigned)ARRANQUE_BKP_TONO, (int)c.estado,
+						(unsigned)c.color, c.intensidad);
+	if ((fallo = comprobar_Control(&c)) != NULL)
+		return fallo;
+	while (i < tam){
+		evento = d[i++] & 0x0FU;
+		valor = (evento == EV_BRILLO || evento == EV_TONO) ? (uint16_t)leer(d, tam, &i, 2U) : 0U;
+		despachar_Control(&c, (Control_Evento)evento, valor);
+		if (traza != NULL)
+			fprintf(traza, "  %-11s %5u -> estado=%d color=%u intensidad=%d\n",
+							(evento < NUM_EVENTOS) ? nombre_evento[evento] : "(otro)", (unsigned)valor,
+							(int)c.estado, (unsigned)c.color, c.intensidad);
+		if ((fallo = comprobar_Control(&c)) != NULL)
+			return fallo;
+	}
+	return NULL;
+}
+
+/**
+  * @brief Bucle de fuzzing de la maquina de estados
+	* @param None
+  * @retval Codigo de salida: 0 sin fallos, 4 invariante incumplido
+  */
+static int fuzz_Control (void){
+	const char *fallo;
+	FILE *f;
+
+	sim_config.traza_led = 0;
+	sim_config.traza_uart = 0;
+	if (initRGB() != 0){
+		fprintf(stderr, "sim: no se puede iniciar el LED\n");
+		return 1;
+	}
+	while (limite == 0U || ejecutadas < limite){
+		mutar(&actual, FUZZ_MAX_ENTRADA);
+		limpiar_Mapa();
+		fallo = ejecutar_Control(actual.datos, actual.tam, NULL);
+		ejecutadas++;
+		if (fallo != NULL){
+			fprintf(stderr, "fuzz: invariante incumplido en la entrada %llu: %s\n",
+						 (unsigned long long)ejecutadas, fallo);
+			(void)ejecutar_Control(actual.datos, actual.tam, stderr);
+			if ((f = fopen(fichero_fallo, "wb")) != NULL){
+				fwrite(actual.datos, 1, actual.tam, f);
+				fclose(f);
+				fprintf(stderr, "fuzz: entrada guardada en %s\n", fichero_fallo);
+			}
+			return 4;
+		}
+		evaluar_Cobertura();
+		informe(0);
+	}
+	informe(1);
+	return 0;
+}
+
+/*Objetivo firmware ----------------------------------------------------------*/
+
+/*Caracter del terminal representable en el guion: imprimible, sin espacios ni '#'*/
+static char caracter (uint8_t b){
+	char c = (char)('!' + b % 94U);
+
+	return (c == '#') ? '~' : c;
+}
+
+/**
+  * @brief Funcion que traduce 4 bytes de la entrada a un paso del guion:
+	*				 b0 orden, b1 espera en ms desde el paso anterior (0xFF: espera larga
+	*				 para llegar a la inactividad), b2 y b3 argumentos
+	* @param b: Bytes del paso
+	* @param p: Paso
+	* @param t: Instante del paso anterior, se actualiza
+  * @retval 1 si hay paso, 0 si solo es una espera
+  */
+static int traducir_Paso (const uint8_t *b, Sim_Paso *p, uint64_t *t){
+	*t += (uint64_t)((b[1] != 0xFFU) ? b[1] : FUZZ_ESPERA_LARGA_MS) * SIM_NS_MS;
+	memset(p, 0, sizeof(*p));
+	p->instante = *t;
+	switch (b[0] & 7U){
+		case 0: case 1: case 2:
+			p->orden = PASO_PULSAR;
+			p->indice = b[2] % NUM_BOTONES;
+			p->rebotes = b[2] >> 6;
+			p->valor = b[3];
+			return 1;
+		case 3:
+			p->orden = PASO_NIVEL;
+			p->indice = b[2] % NUM_BOTONES;
+			p->valor = b[3] & 1U;
+			return 1;
+		case 4:
+			p->orden = PASO_POT;
+			p->indice = (b[0] >> 3) % NUM_POTS;
+			p->valor = ((uint32_t)b[2] << 8) | b[3];
+			return 1;
+		case 5: case 6:
+			p->orden = PASO_RX;
+			p->texto[0] = caracter(b[2]);
+			if ((b[0] & 0x08U) != 0U)
+				p->texto[1] = caracter(b[3]);
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+/**
+  * @brief Funcion que genera la siguiente secuencia y la deja como guion, terminada
+	*				 con el paso que la evalua
+	* @param t: Instante de inicio
+	* @param n: Numero de la secuencia
+  * @retval None
+  */
+static void preparar_Secuencia (uint64_t t, uint32_t n){
+	Sim_Paso p;
+
+	mutar(&actual, FUZZ_MAX_ENTRADA);
+	sim_guion_Vaciar();
+	for (uint32_t i = 0; i + 4U <= actual.tam; i += 4U)
+		if (traducir_Paso(&actual.datos[i], &p, &t))
+			(void)sim_guion_Anadir(&p);
+	memset(&p, 0, sizeof(p));
+	p.instante = fin_secuencia = t + FUZZ_ASENTAR_MS * SIM_NS_MS;
+	p.orden = PASO_SECUENCIA;
+	p.valor = n;
+	if (sim_guion_Anadir(&p) != 0){
+		fprintf(stderr, "sim: sin memoria para la secuencia\n");
+		sim_fin(1);
+	}
+	limpiar_Mapa();
+}
+
+/**
+  * @brief Funcion que evalua la secuencia terminada y prepara la siguiente. Se llama
+	*				 desde el paso "secuencia" del guion.
+	* @param n: Numero de la secuencia terminada
+  * @retval 1 si el guion se ha sustituido, 0 si no se esta fuzzeando
+  */
+int sim_fuzz_Secuencia (uint32_t n){
+	if (objetivo != FUZZ_FIRMWARE)
+		return 0;
+	ejecutadas++;
+	evaluar_Cobertura();
+	informe(0);
+	if (limite != 0U && ejecutadas >= limite){
+		informe(1);
+		sim_fin(0);
+	}
+	preparar_Secuencia(fin_secuencia, n + 1U);
+	return 1;
+}
+
+/**
+  * @brief Funcion que inicia el fuzzing
+	* @param nombre: Objetivo (control o firmware)
+	* @param entradas: Numero de entradas a ejecutar, 0 sin limite
+	* @param semilla: Semilla del generador
+	* @param fallo: Fichero de la entrada o del guion que reproduce un fallo
+  * @retval Codigo de salida, o -1 si hay que arrancar el firmware
+  */
+int sim_fuzz (const char *nombre, uint64_t entradas, uint64_t semilla, const char *fallo){
+	limite = entradas;
+	azar_estado = (semilla != 0U) ? semilla : 1U;
+	proximo_informe = FUZZ_INFORME_MS * SIM_NS_MS;
+	if (strcmp(nombre, "control") == 0){
+		objetivo = FUZZ_CONTROL;
+		fichero_fallo = (fallo != NULL) ? fallo : "fuzz_fallo.bin";
+		return fuzz_Control();
+	}
+	if (strcmp(nombre, "firmware") == 0){
+		objetivo = FUZZ_FIRMWARE;
+		fichero_fallo = (fallo != NULL) ? fallo : "fuzz_fallo.txt";
+		sim_config.discreto = 1;
+		sim_config.traza_led = 0;
+		sim_config.traza_uart = 0;
+		sim_config.invariantes = 1;
+		if (sim_guion_Registrar(fichero_fallo) != 0)
+			return 1;
+		preparar_Secuencia(FUZZ_INICIO_MS * SIM_NS_MS, 0);
+		return -1;
+	}
+	fprintf(stderr, "sim: objetivo de fuzzing desconocido: %s\n", nombre);
+	return 1;
+}
@@ -0,0 +1,1035 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Sim_HAL.c
+  * @author  MCD Application Team
+  * @brief   HAL simulada: registros del RCC, Timers, GPIO/EXTI, IWDG, ADC con
+	*					 DMA y NVIC. Solo se simula lo que observa el firmware:
+	*					 - RCC: SystemCoreClockUpdate y las frecuencias de los APB salen de
+	*						 los registros CFGR y PLLCFGR, como en la placa
+	*					 - Timers: los CCR (con precarga) y los bits de habilitacion de los
+	*						 canales; el LED se observa en cada punto de planificacion
+	*						 (sim_revisar) y sus cambios se anaden a la traza PWM (Sim_PWM.c)
+	*					 - GPIO/EXTI: los flancos de los botones del guion ponen el bit
+	*						 pendiente y llaman a la rutina de interrupcion si la linea y la
+	*						 IRQ estan habilitadas
+	*					 - IWDG: se comprueba el plazo del ultimo refresco; al vencer, o con
+	*						 NVIC_SystemReset, termina la simulacion
+	*					 - ADC: cada mitad del buffer del DMA se rellena con el valor de los
+	*						 potenciometros del guion al ritmo del disparo del TIM2
+	*					 - TIM3 en modo PWM input con rafagas de DMA (Autotest.c): cada
+	*						 periodo de la PWM del LED cuyo pin de captura esta conectado se
+	*						 copian en el buffer el periodo y el tiempo en alto, con el desvio
+	*						 del ciclo de trabajo que fije el guion
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "Placa.h"
+#include "RGB.h"
+#include "Reloj.h"
+#include "Sim.h"
+
+Sim_Perifericos sim_perifericos;
+uint32_t SystemCoreClock = HSI_VALUE;
+
+/*Rutinas de interrupcion del firmware (stm32f4xx_it.c)*/
+void EXTI0_IRQHandler (void);
+void EXTI1_IRQHandler (void);
+void EXTI2_IRQHandler (void);
+void EXTI3_IRQHandler (void);
+void EXTI4_IRQHandler (void);
+void EXTI9_5_IRQHandler (void);
+void EXTI15_10_IRQHandler (void);
+void DMA2_Stream0_IRQHandler (void);
+void $Sub$$USART3_IRQHandler (void);
+
+/*NVIC: excepciones del nucleo (-16..-1) e interrupciones de los perifericos*/
+#define NVIC_INDICE(irq)  ((int)(irq) + 16)
+static uint8_t prioridad[SIM_NUM_IRQ + 16];
+static uint8_t habilitada[SIM_NUM_IRQ + 16];
+static uint8_t pendiente[SIM_NUM_IRQ + 16];
+static uint32_t grupo = 0;
+static uint32_t primask = 0;
+
+/*Contador de ciclos: ciclos acumulados, resto en 1/1e9 ciclos y ultimo valor escrito*/
+static uint64_t ciclos = 0;
+static uint64_t resto = 0;
+static uint64_t ns_ciclos = 0;
+static uint32_t cyccnt = 0;
+
+/*IWDG*/
+static int iwdg_activo = 0;
+static uint64_t iwdg_refresco = 0;
+static uint64_t iwdg_plazo = 0;
+
+/*ADC1 con DMA circular disparado por el TIM2*/
+static ADC_HandleTypeDef *adc = NULL;
+static uint16_t *adc_datos = NULL;
+static uint32_t adc_longitud = 0;
+static uint32_t adc_canales[16];
+static uint32_t adc_mitad = 0;
+static int adc_programado = 0;
+static uint16_t potenciometros[NUM_POTS];
+
+#define SIM_CANAL_POT(funcion, puerto, pin, canal)	(canal),
+static const uint32_t canal_pot[NUM_POTS] = {
+	PLACA_POTS(SIM_CANAL_POT)
+};
+
+/*Captura del TIM3 por DMA: buffer circular de pares CCR1, CCR2*/
+static TIM_HandleTypeDef *captura = NULL;
+static uint32_t *captura_datos = NULL;
+static uint32_t captura_longitud = 0;
+static uint32_t captura_pos = 0;
+static int captura_programada = 0;
+/*Desvio del tiempo en alto de cada color en el pin (tanto por mil)*/
+static int32_t desvio[NUM_LEDS];
+
+/*Pines de captura unidos con un puente al pin de cada color*/
+typedef struct {
+	int color;
+	GPIO_TypeDef *puerto;
+	uint32_t pin;
+} Sim_Captura;
+
+#define SIM_CAPTURA(color, puerto, pin)	{LED_##color, puerto, pin},
+static const Sim_Captura pines_captura[] = {
+	PLACA_AUTOTEST(SIM_CAPTURA)
+};
+
+/*Ultimo estado del LED mostrado*/
+static uint32_t led_ccr[NUM_LEDS];
+static int led_activo[NUM_LEDS];
+
+/*Instante en el que arranco cada Timer: origen de sus periodos de PWM. Para la
+	bandera UIF se guarda si estaba en marcha y el ultimo periodo observado*/
+static TIM_TypeDef *const timers[] = {TIM1, TIM2, TIM3, TIM4, TIM5, TIM8};
+static uint64_t origen[sizeof(timers) / sizeof(timers[0])];
+static uint8_t en_marcha[sizeof(timers) / sizeof(timers[0])];
+static uint64_t periodo_visto[sizeof(timers) / sizeof(timers[0])];
+
+static int estado_LED (int c, uint32_t *ccr);
+static void actualizar_Timers (int banderas);
+
+static const uint8_t ahb_presc[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
+static const uint8_t apb_presc[8] = {0, 0, 0, 0, 1, 2, 3, 4};
+
+/**
+  * @brief Funcion que deja los perifericos con sus valores de reset
+	* @param None
+  * @retval None
+  */
+void sim_init_HAL (void){
+	memset(&sim_perifericos, 0, sizeof(sim_perifericos));
+	RCC->CR = RCC_CR_HSION | RCC_CR_HSIRDY;
+	RCC->PLLCFGR = 0x24003010U;
+	USART3->SR = USART_SR_TC | USART_SR_TXE;
+	SystemCoreClock = HSI_VALUE;
+	for (int c = 0; c < NUM_LEDS; c++)
+		led_ccr[c] = 0xFFFFFFFFU;
+	/*timer_Reloj distingue los Timers de cada APB por su direccion*/
+	if ((uint32_t)(uintptr_t)TIM1 < (uint32_t)(uintptr_t)TIM5){
+		fprintf(stderr, "sim: mapa de perifericos no valido\n");
+		sim_fin(1);
+	}
+}
+
+/*Nucleo Cortex-M4 -----------------------------------------------------------*/
+
+void __disable_irq (void){
+	primask = 1;
+}
+
+void __enable_irq (void){
+	primask = 0;
+}
+
+uint32_t __get_PRIMASK (void){
+	return primask;
+}
+
+void __set_PRIMASK (uint32_t valor){
+	primask = valor & 1U;
+}
+
+void __WFI (void){
+}
+
+void __WFE (void){
+}
+
+/**
+  * @brief Funcion que actualiza y devuelve el contador de ciclos. Avanza con el
+	*				 tiempo simulado a la frecuencia actual del sistema y respeta las
+	*				 escrituras del firmware en CYCCNT; en modo discreto cada lectura
+	*				 avanza el tiempo virtual. Como las esperas activas leen el
+	*				 contador, tambien se aplican aqui las escrituras en BSRR y la clave
+	*				 de recarga del IWDG.
+	* @param None
+  * @retval Registros del DWT
+  */
+DWT_Type *sim_DWT (void){
+	uint64_t ahora;
+	unsigned __int128 avance;
+
+	sim_avanzar();
+	ahora = sim_ahora();
+	if (sim_perifericos.dwt.CYCCNT != cyccnt)
+		ciclos = sim_perifericos.dwt.CYCCNT;
+	avance = (unsigned __int128)(ahora - ns_ciclos) * SystemCoreClock + resto;
+	ciclos += (uint64_t)(avance / 1000000000U);
+	resto = (uint64_t)(avance % 1000000000U);
+	ns_ciclos = ahora;
+	cyccnt = (uint32_t)ciclos;
+	sim_perifericos.dwt.CYCCNT = cyccnt;
+	sim_revisar();
+	return &sim_perifericos.dwt;
+}
+
+void NVIC_SetPriorityGrouping (uint32_t g){
+	grupo = g & 7U;
+}
+
+uint32_t NVIC_GetPriorityGrouping (void){
+	return grupo;
+}
+
+void NVIC_SetPriority (IRQn_Type irq, uint32_t p){
+	prioridad[NVIC_INDICE(irq)] = (uint8_t)(p & ((1U << __NVIC_PRIO_BITS) - 1U));
+}
+
+uint32_t NVIC_GetPriority (IRQn_Type irq){
+	return prioridad[NVIC_INDICE(irq)];
+}
+
+void NVIC_EnableIRQ (IRQn_Type irq){
+	habilitada[NVIC_INDICE(irq)] = 1;
+	if (pendiente[NVIC_INDICE(irq)])
+		sim_irq(irq);
+}
+
+void NVIC_DisableIRQ (IRQn_Type irq){
+	habilitada[NVIC_INDICE(irq)] = 0;
+}
+
+uint32_t NVIC_GetEnableIRQ (IRQn_Type irq){
+	return habilitada[NVIC_INDICE(irq)];
+}
+
+void NVIC_SetPendingIRQ (IRQn_Type irq){
+	sim_irq(irq);
+}
+
+void NVIC_ClearPendingIRQ (IRQn_Type irq){
+	pendiente[NVIC_INDICE(irq)] = 0;
+}
+
+void NVIC_SystemReset (void){
+	sim_traza("NVIC_SystemReset");
+	sim_fin(3);
+}
+
+/**
+  * @brief Funcion que solicita una interrupcion. Si esta habilitada y no estan
+	*				 enmascaradas se ejecuta su rutina; si no, queda pendiente.
+	* @param irq: Numero de la interrupcion
+  * @retval None
+  */
+void sim_irq (int irq){
+	void (*rutina)(void) = NULL;
+
+	if (!habilitada[NVIC_INDICE(irq)] || primask != 0U){
+		pendiente[NVIC_INDICE(irq)] = 1;
+		return;
+	}
+	pendiente[NVIC_INDICE(irq)] = 0;
+	/*La rutina debe ver las banderas UIF del instante en que se ejecuta*/
+	actualizar_Timers(1);
+	switch (irq){
+		case EXTI0_IRQn:        rutina = EXTI0_IRQHandler; break;
+		case EXTI1_IRQn:        rutina = EXTI1_IRQHandler; break;
+		case EXTI2_IRQn:        rutina = EXTI2_IRQHandler; break;
+		case EXTI3_IRQn:        rutina = EXTI3_IRQHandler; break;
+		case EXTI4_IRQn:        rutina = EXTI4_IRQHandler; break;
+		case EXTI9_5_IRQn:      rutina = EXTI9_5_IRQHandler; break;
+		case EXTI15_10_IRQn:    rutina = EXTI15_10_IRQHandler; break;
+		case DMA2_Stream0_IRQn: rutina = DMA2_Stream0_IRQHandler; break;
+		case USART3_IRQn:       rutina = $Sub$$USART3_IRQHandler; break;
+		default: break;
+	}
+	if (rutina != NULL)
+		sim_isr(rutina);
+}
+
+/*HAL comun ------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_Init (void){
+	NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
+	NVIC_SetPriority(SysTick_IRQn, (1U << __NVIC_PRIO_BITS) - 1U);
+	HAL_MspInit();
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DeInit (void){
+	HAL_MspDeInit();
+	return HAL_OK;
+}
+
+__weak void HAL_MspInit (void){
+}
+
+__weak void HAL_MspDeInit (void){
+}
+
+void HAL_IncTick (void){
+}
+
+void HAL_Delay (uint32_t ms){
+	uint32_t inicio = HAL_GetTick();
+
+	while (HAL_GetTick() - inicio < ms)
+		;
+}
+
+void HAL_NVIC_SetPriorityGrouping (uint32_t g){
+	NVIC_SetPriorityGrouping(g);
+}
+
+void HAL_NVIC_SetPriority (IRQn_Type irq, uint32_t p, uint32_t sub){
+	(void)sub;
+	NVIC_SetPriority(irq, p);
+}
+
+void HAL_NVIC_EnableIRQ (IRQn_Type irq){
+	NVIC_EnableIRQ(irq);
+}
+
+void HAL_NVIC_DisableIRQ (IRQn_Type irq){
+	NVIC_DisableIRQ(irq);
+}
+
+/*GPIO y EXTI ----------------------------------------------------------------*/
+
+#define GPIO_MODO_IT        0x00010000U
+#define GPIO_FLANCO_SUBIDA  0x00100000U
+#define GPIO_FLANCO_BAJADA  0x00200000U
+
+void HAL_GPIO_Init (GPIO_TypeDef *puerto, GPIO_InitTypeDef *init){
+	uint32_t indice = PLACA_GPIO_INDICE(puerto);
+
+	for (uint32_t p = 0; p < 16U; p++){
+		uint32_t bit = 1U << p;
+		if ((init->Pin & bit) == 0U)
+			continue;
+		puerto->MODER = (puerto->MODER & ~(3U << (2U * p))) | ((init->Mode & 3U) << (2U * p));
+		puerto->PUPDR = (puerto->PUPDR & ~(3U << (2U * p))) | ((init->Pull & 3U) << (2U * p));
+		if ((init->Mode & 3U) == GPIO_MODE_AF_PP)
+			puerto->AFR[p >> 3] = (puerto->AFR[p >> 3] & ~(0xFU << (4U * (p & 7U)))) |
+														(init->Alternate << (4U * (p & 7U)));
+		if ((init->Mode & 0x10000000U) != 0U){
+			SYSCFG->EXTICR[p >> 2] = (SYSCFG->EXTICR[p >> 2] & ~(0xFU << (4U * (p & 3U)))) |
+															 (indice << (4U * (p & 3U)));
+			if ((init->Mode & GPIO_MODO_IT) != 0U)
+				EXTI->IMR |= bit;
+			else
+				EXTI->IMR &= ~bit;
+			if ((init->Mode & GPIO_FLANCO_SUBIDA) != 0U)
+				EXTI->RTSR |= bit;
+			else
+				EXTI->RTSR &= ~bit;
+			if ((init->Mode & GPIO_FLANCO_BAJADA) != 0U)
+				EXTI->FTSR |= bit;
+			else
+				EXTI->FTSR &= ~bit;
+		}
+	}
+}
+
+GPIO_PinState HAL_GPIO_ReadPin (GPIO_TypeDef *puerto, uint16_t pin){
+	return ((puerto->IDR & pin) != 0U) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin (GPIO_TypeDef *puerto, uint16_t pin, GPIO_PinState estado){
+	if (estado != GPIO_PIN_RESET)
+		puerto->ODR |= pin;
+	else
+		puerto->ODR &= ~(uint32_t)pin;
+}
+
+void HAL_GPIO_EXTI_IRQHandler (uint16_t pin){
+	if ((EXTI->PR & pin) != 0U){
+		EXTI->PR &= ~(uint32_t)pin;
+		HAL_GPIO_EXTI_Callback(pin);
+	}
+}
+
+__weak void HAL_GPIO_EXTI_Callback (uint16_t pin){
+	(void)pin;
+}
+
+/**
+  * @brief Funcion que cambia el nivel de un pin de entrada. Si la linea EXTI del pin
+	*				 esta asignada a su puerto, desenmascarada y con el flanco habilitado,
+	*				 se pone el bit pendiente y se solicita la interrupcion.
+	* @param puerto: Indice del puerto (GPIOA = 0...)
+	* @param pin: Numero de pin
+	* @param nivel: 0 o 1
+  * @retval None
+  */
+void sim_pin (uint32_t puerto, uint32_t pin, int nivel){
+	GPIO_TypeDef *gpio = &sim_perifericos.gpio[puerto].r;
+	uint32_t bit = 1U << pin;
+	int previo = (gpio->IDR & bit) != 0U;
+	uint32_t linea;
+	int irq;
+
+	if (previo == (nivel != 0))
+		return;
+	if (nivel)
+		gpio->IDR |= bit;
+	else
+		gpio->IDR &= ~bit;
+
+	linea = (SYSCFG->EXTICR[pin >> 2] >> (4U * (pin & 3U))) & 0xFU;
+	if (linea != puerto || (EXTI->IMR & bit) == 0U)
+		return;
+	if ((nivel && (EXTI->RTSR & bit) == 0U) || (!nivel && (EXTI->FTSR & bit) == 0U))
+		return;
+	EXTI->PR |= bit;
+	if (pin < 5U)
+		irq = EXTI0_IRQn + (int)pin;
+	else if (pin < 10U)
+		irq = EXTI9_5_IRQn;
+	else
+		irq = EXTI15_10_IRQn;
+	sim_irq(irq);
+}
+
+/*RCC y PWR ------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_RCC_OscConfig (RCC_OscInitTypeDef *osc){
+	if ((osc->OscillatorType & RCC_OSCILLATORTYPE_HSI) != 0U && osc->HSIState == RCC_HSI_ON)
+		RCC->CR |= RCC_CR_HSION | RCC_CR_HSIRDY;
+	if ((osc->OscillatorType & RCC_OSCILLATORTYPE_LSI) != 0U && osc->LSIState == RCC_LSI_ON)
+		RCC->CSR |= RCC_CSR_LSION | RCC_CSR_LSIRDY;
+	if (osc->PLL.PLLState == RCC_PLL_ON){
+		RCC->PLLCFGR = osc->PLL.PLLM | (osc->PLL.PLLN << RCC_PLLCFGR_PLLN_Pos) |
+									 (((osc->PLL.PLLP >> 1) - 1U) << RCC_PLLCFGR_PLLP_Pos) | osc->PLL.PLLSource |
+									 (osc->PLL.PLLQ << RCC_PLLCFGR_PLLQ_Pos);
+		RCC->CR |= RCC_CR_PLLON | RCC_CR_PLLRDY;
+	}
+	else if (osc->PLL.PLLState == RCC_PLL_OFF)
+		RCC->CR &= ~(RCC_CR_PLLON | RCC_CR_PLLRDY);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig (RCC_ClkInitTypeDef *clk, uint32_t latencia){
+	FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) | latencia;
+	if ((clk->ClockType & RCC_CLOCKTYPE_HCLK) != 0U)
+		RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_HPRE) | clk->AHBCLKDivider;
+	if ((clk->ClockType & RCC_CLOCKTYPE_SYSCLK) != 0U){
+		if (clk->SYSCLKSource == RCC_SYSCLKSOURCE_PLLCLK && (RCC->CR & RCC_CR_PLLRDY) == 0U)
+			return HAL_ERROR;
+		RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_SW | RCC_CFGR_SWS)) | clk->SYSCLKSource | (clk->SYSCLKSource << 2);
+	}
+	if ((clk->ClockType & RCC_CLOCKTYPE_PCLK1) != 0U)
+		RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_PPRE1) | clk->APB1CLKDivider;
+	if ((clk->ClockType & RCC_CLOCKTYPE_PCLK2) != 0U)
+		RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_PPRE2) | (clk->APB2CLKDivider << 3);
+	SystemCoreClockUpdate();
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig (RCC_PeriphCLKInitTypeDef *periph){
+	(void)periph;
+	return HAL_OK;
+}
+
+uint32_t HAL_RCC_GetSysClockFreq (void){
+	uint32_t pll = RCC->PLLCFGR;
+	uint32_t m = pll & RCC_PLLCFGR_PLLM;
+	uint32_t n = (pll & RCC_PLLCFGR_PLLN) >> RCC_PLLCFGR_PLLN_Pos;
+	uint32_t p = (((pll & RCC_PLLCFGR_PLLP) >> RCC_PLLCFGR_PLLP_Pos) + 1U) * 2U;
+
+	if ((RCC->CFGR & RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL)
+		return (uint32_t)((uint64_t)HSI_VALUE / m * n / p);
+	return HSI_VALUE;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq (void){
+	return HAL_RCC_GetSysClockFreq() >> ahb_presc[(RCC->CFGR & RCC_CFGR_HPRE) >> 4];
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq (void){
+	return HAL_RCC_GetHCLKFreq() >> apb_presc[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq (void){
+	return HAL_RCC_GetHCLKFreq() >> apb_presc[(RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos];
+}
+
+void SystemCoreClockUpdate (void){
+	/*El contador de ciclos acumula lo transcurrido con la frecuencia anterior*/
+	(void)sim_DWT();
+	SystemCoreClock = HAL_RCC_GetHCLKFreq();
+}
+
+void HAL_PWR_EnableBkUpAccess (void){
+	PWR->CR |= PWR_CR_DBP;
+}
+
+void HAL_PWR_EnableSEVOnPend (void){
+}
+
+void HAL_PWREx_EnableFlashPowerDown (void){
+}
+
+/*Timers ---------------------------------------------------------------------*/
+
+__weak void HAL_TIM_Base_MspInit (TIM_HandleTypeDef *htim){
+	(void)htim;
+}
+
+__weak void HAL_TIM_PWM_MspInit (TIM_HandleTypeDef *htim){
+	(void)htim;
+}
+
+static void iniciar_Timer (TIM_HandleTypeDef *htim){
+	htim->Instance->PSC = htim->Init.Prescaler;
+	htim->Instance->ARR = htim->Init.Period;
+	htim->Instance->CR1 = (htim->Instance->CR1 & ~TIM_AUTORELOAD_PRELOAD_ENABLE) | htim->Init.AutoReloadPreload;
+	htim->Instance->EGR = TIM_EGR_UG;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Init (TIM_HandleTypeDef *htim){
+	if (htim == NULL)
+		return HAL_ERROR;
+	if (htim->State == 0U)
+		HAL_TIM_Base_MspInit(htim);
+	htim->State = 1U;
+	iniciar_Timer(htim);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init (TIM_HandleTypeDef *htim){
+	if (htim == NULL)
+		return HAL_ERROR;
+	HAL_TIM_PWM_MspInit(htim);
+	htim->State = 1U;
+	iniciar_Timer(htim);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource (TIM_HandleTypeDef *htim, TIM_ClockConfigTypeDef *config){
+	(void)htim;
+	(void)config;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization (TIM_HandleTypeDef *htim, TIM_MasterConfigTypeDef *config){
+	htim->Instance->CR2 = config->MasterOutputTrigger;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_ConfigBreakDeadTime (TIM_HandleTypeDef *htim, TIM_BreakDeadTimeConfigTypeDef *config){
+	htim->Instance->BDTR = config->DeadTime | config->BreakState | config->BreakPolarity | config->AutomaticOutput;
+	return HAL_OK;
+}
+
+/**
+  * @brief Funcion que arranca el contador de un Timer y anota el origen de sus
+	*				 periodos
+	* @param tim: Timer
+  * @retval None
+  */
+static void arrancar_Timer (TIM_TypeDef *tim){
+	if ((tim->CR1 & TIM_CR1_CEN) != 0U)
+		return;
+	tim->CR1 |= TIM_CR1_CEN;
+	for (uint32_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++)
+		if (timers[i] == tim){
+			origen[i] = sim_ahora();
+			en_marcha[i] = 1;
+			periodo_visto[i] = 0;
+		}
+}
+
+/**
+  * @brief Funcion que anota el origen de los periodos de los Timers arrancados por
+	*				 el firmware sin la HAL (CEN) y, si se pide, activa la bandera UIF de
+	*				 los que han pasado a un nuevo periodo desde la ultima vez, salvo con
+	*				 UDIS. La bandera solo la leen las rutinas de interrupcion, por lo que
+	*				 se calcula antes de cada una y no en cada revision.
+	* @param banderas: 1 para actualizar UIF
+  * @retval None
+  */
+static void actualizar_Timers (int banderas){
+	TIM_TypeDef *tim;
+	uint64_t hz, periodo_ns, n;
+
+	for (uint32_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++){
+		tim = timers[i];
+		if ((tim->CR1 & TIM_CR1_CEN) == 0U){
+			en_marcha[i] = 0;
+			continue;
+		}
+		if (!en_marcha[i]){
+			origen[i] = sim_ahora();
+			en_marcha[i] = 1;
+			periodo_visto[i] = 0;
+		}
+		if (!banderas || (hz = timer_Reloj(tim)) == 0U)
+			continue;
+		periodo_ns = (uint64_t)(tim->PSC + 1U) * (tim->ARR + 1U) * 1000000000ULL / hz;
+		n = (sim_ahora() - origen[i]) / periodo_ns;
+		if (n != periodo_visto[i]){
+			periodo_visto[i] = n;
+			if ((tim->CR1 & TIM_CR1_UDIS) == 0U)
+				tim->SR |= TIM_SR_UIF;
+		}
+	}
+}
+
+/*Registro CCRx de un canal (TIM_CHANNEL_1 = 0, TIM_CHANNEL_2 = 4...)*/
+static __IO uint32_t *ccr_Canal (TIM_TypeDef *tim, uint32_t canal){
+	return &tim->CCR1 + (canal >> 2);
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel (TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *config, uint32_t canal){
+	TIM_TypeDef *tim = htim->Instance;
+	__IO uint32_t *ccmr = (canal < TIM_CHANNEL_3) ? &tim->CCMR1 : &tim->CCMR2;
+	uint32_t desplazamiento = (canal & 4U) ? 8U : 0U;
+
+	/*Como en la HAL, los canales PWM quedan con la precarga del CCR habilitada*/
+	*ccmr = (*ccmr & ~(0xFFU << desplazamiento)) | ((config->OCMode | TIM_CCMR1_OC1PE) << desplazamiento);
+	*ccr_Canal(tim, canal) = config->Pulse;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start (TIM_HandleTypeDef *htim, uint32_t canal){
+	TIM_TypeDef *tim = htim->Instance;
+
+	tim->CCER |= TIM_CCER_CC1E << canal;
+	if (IS_TIM_BREAK_INSTANCE(tim))
+		tim->BDTR |= TIM_BDTR_MOE;
+	arrancar_Timer(tim);
+	return HAL_OK;
+}
+
+__weak void HAL_TIM_IC_MspInit (TIM_HandleTypeDef *htim){
+	(void)htim;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Init (TIM_HandleTypeDef *htim){
+	if (htim == NULL)
+		return HAL_ERROR;
+	HAL_TIM_IC_MspInit(htim);
+	htim->State = 1U;
+	iniciar_Timer(htim);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_ConfigChannel (TIM_HandleTypeDef *htim, TIM_IC_InitTypeDef *config, uint32_t canal){
+	TIM_TypeDef *tim = htim->Instance;
+	__IO uint32_t *ccmr = (canal < TIM_CHANNEL_3) ? &tim->CCMR1 : &tim->CCMR2;
+	uint32_t desplazamiento = (canal & 4U) ? 8U : 0U;
+
+	*ccmr = (*ccmr & ~(0xFFU << desplazamiento)) | ((config->ICSelection | config->ICPrescaler) << desplazamiento);
+	tim->CCER = (tim->CCER & ~(0xAU << canal)) | (config->ICPolarity << canal);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_SlaveConfigSynchro (TIM_HandleTypeDef *htim, TIM_SlaveConfigTypeDef *config){
+	htim->Instance->SMCR = config->InputTrigger | config->SlaveMode;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Start (TIM_HandleTypeDef *htim, uint32_t canal){
+	htim->Instance->CCER |= TIM_CCER_CC1E << canal;
+	arrancar_Timer(htim->Instance);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop (TIM_HandleTypeDef *htim, uint32_t canal){
+	TIM_TypeDef *tim = htim->Instance;
+
+	tim->CCER &= ~(TIM_CCER_CC1E << canal);
+	/*Como en la HAL, el Timer solo se detiene sin ningun canal habilitado*/
+	if ((tim->CCER & 0x1111U) == 0U){
+		if (IS_TIM_BREAK_INSTANCE(tim))
+			tim->BDTR &= ~TIM_BDTR_MOE;
+		tim->CR1 &= ~TIM_CR1_CEN;
+	}
+	return HAL_OK;
+}
+
+/*IWDG -----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_IWDG_Init (IWDG_HandleTypeDef *hiwdg){
+	if (hiwdg == NULL || hiwdg->Init.Prescaler > IWDG_PRESCALER_256 || hiwdg->Init.Reload > 0xFFFU)
+		return HAL_ERROR;
+	hiwdg->Instance->PR = hiwdg->Init.Prescaler;
+	hiwdg->Instance->RLR = hiwdg->Init.Reload;
+	/*Plazo = 4 * 2^PR * (RLR + 1) / LSI*/
+	iwdg_plazo = (4ULL << hiwdg->Init.Prescaler) * (hiwdg->Init.Reload + 1U) * 1000000000ULL / LSI_VALUE;
+	iwdg_refresco = sim_ahora();
+	iwdg_activo = 1;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_IWDG_Refresh (IWDG_HandleTypeDef *hiwdg){
+	(void)hiwdg;
+	iwdg_refresco = sim_ahora();
+	return HAL_OK;
+}
+
+/**
+  * @brief Funcion que devuelve el instante en el que vence el IWDG si no se refresca
+	* @param None
+  * @retval Instante en ns (SIM_NUNCA si no esta en marcha)
+  */
+uint64_t sim_iwdg_limite (void){
+	return iwdg_activo ? iwdg_refresco + iwdg_plazo + 1U : SIM_NUNCA;
+}
+
+/**
+  * @brief Funcion que devuelve el instante del ultimo refresco del IWDG
+	* @param None
+  * @retval Instante en ns
+  */
+uint64_t sim_iwdg_refresco (void){
+	return iwdg_refresco;
+}
+
+/*ADC y DMA ------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_DMA_Init (DMA_HandleTypeDef *hdma){
+	return (hdma == NULL) ? HAL_ERROR : HAL_OK;
+}
+
+__weak void HAL_ADC_MspInit (ADC_HandleTypeDef *hadc){
+	(void)hadc;
+}
+
+__weak void HAL_ADC_ConvHalfCpltCallback (ADC_HandleTypeDef *hadc){
+	(void)hadc;
+}
+
+__weak void HAL_ADC_ConvCpltCallback (ADC_HandleTypeDef *hadc){
+	(void)hadc;
+}
+
+HAL_StatusTypeDef HAL_ADC_Init (ADC_HandleTypeDef *hadc){
+	if (hadc == NULL || hadc->Init.NbrOfConversion == 0U || hadc->Init.NbrOfConversion > 16U)
+		return HAL_ERROR;
+	HAL_ADC_MspInit(hadc);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_ConfigChannel (ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *config){
+	(void)hadc;
+	if (config->Rank == 0U || config->Rank > 16U)
+		return HAL_ERROR;
+	adc_canales[config->Rank - 1U] = config->Channel;
+	return HAL_OK;
+}
+
+/**
+  * @brief Funcion que devuelve el periodo de cada mitad del buffer del DMA: las
+	*				 conversiones de la mitad a una secuencia por desbordamiento del TIM2.
+	* @param None
+  * @retval Periodo en ns
+  */
+static uint64_t periodo_ADC (void){
+	uint64_t hz = (uint64_t)timer_Reloj(TIM2);
+	uint64_t desbordamiento = (uint64_t)(TIM2->PSC + 1U) * (TIM2->ARR + 1U) * 1000000000ULL / hz;
+
+	return desbordamiento * (adc_longitud / 2U / adc->Init.NbrOfConversion);
+}
+
+/**
+  * @brief Evento del DMA: rellena la siguiente mitad del buffer con el valor de los
+	*				 potenciometros y solicita la interrupcion del DMA2 Stream0.
+	* @param arg
+  * @retval None
+  */
+static void conversion_ADC (uint32_t arg){
+	uint32_t mitad = adc_longitud / 2U;
+	uint16_t *destino = &adc_datos[adc_mitad ? mitad : 0U];
+
+	(void)arg;
+	for (uint32_t i = 0; i < mitad; i++){
+		uint32_t canal = adc_canales[i % adc->Init.NbrOfConversion];
+		uint16_t valor = 0;
+		for (int p = 0; p < NUM_POTS; p++)
+			if (canal_pot[p] == canal)
+				valor = potenciometros[p] >> 4;
+		destino[i] = valor;
+	}
+	adc_mitad ^= 1U;
+	sim_irq(DMA2_Stream0_IRQn);
+	if ((TIM2->CR1 & TIM_CR1_CEN) != 0U)
+		sim_programar(sim_ahora() + periodo_ADC(), conversion_ADC, 0);
+	else
+		adc_programado = 0;
+}
+
+static void arrancar_ADC (void){
+	if (adc != NULL && (TIM2->CR1 & TIM_CR1_CEN) != 0U && !adc_programado){
+		adc_programado = 1;
+		sim_programar(sim_ahora() + periodo_ADC(), conversion_ADC, 0);
+	}
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA (ADC_HandleTypeDef *hadc, uint32_t *datos, uint32_t longitud){
+	if (longitud < 2U * hadc->Init.NbrOfConversion)
+		return HAL_ERROR;
+	adc = hadc;
+	adc_datos = (uint16_t *)datos;
+	adc_longitud = longitud;
+	adc_mitad = 0;
+	arrancar_ADC();
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start (TIM_HandleTypeDef *htim){
+	arrancar_Timer(htim->Instance);
+	if (htim->Instance == TIM2)
+		arrancar_ADC();
+	return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler (DMA_HandleTypeDef *hdma){
+	ADC_HandleTypeDef *hadc = hdma->Parent;
+
+	/*adc_mitad indica la mitad que se rellenara a continuacion*/
+	if (adc_mitad)
+		HAL_ADC_ConvHalfCpltCallback(hadc);
+	else
+		HAL_ADC_ConvCpltCallback(hadc);
+}
+
+/**
+  * @brief Funcion que fija el valor de un potenciometro para las siguientes
+	*				 conversiones
+	* @param pot: Potenciometro
+	* @param valor: Valor entre 0 y 65535
+  * @retval None
+  */
+void sim_potenciometro (uint32_t pot, uint16_t valor){
+	if (pot < NUM_POTS)
+		potenciometros[pot] = valor;
+}
+
+/*Captura del TIM3 ----------------------------------------------------------*/
+
+/**
+  * @brief Evento de la captura: si el pin de captura de un color esta en la
+	*				 funcion alternativa del TIM3 y su LED genera flancos, copia en el
+	*				 buffer la rafaga CCR1 (periodo) y CCR2 (tiempo en alto) en cuentas del
+	*				 TIM3 y espera al siguiente periodo. Sin flancos (LED apagado, ciclo de
+	*				 trabajo extremo o pin sin conectar) espera un desbordamiento del TIM3.
+	* @param arg
+  * @retval None
+  */
+static void captura_TIM3 (uint32_t arg){
+	TIM_TypeDef *tim3 = captura->Instance;
+	uint64_t hz = (uint64_t)timer_Reloj(tim3) / (tim3->PSC + 1U);
+	uint64_t espera = 65536U * 1000000000ULL / hz;
+	uint64_t periodo, alto;
+	uint32_t ccr;
+
+	(void)arg;
+	if ((tim3->CR1 & TIM_CR1_CEN) == 0U){
+		captura_programada = 0;
+		return;
+	}
+	for (uint32_t i = 0; i < sizeof(pines_captura) / sizeof(pines_captura[0]); i++){
+		const Sim_Captura *p = &pines_captura[i];
+		const RGB_Led *l = &rgb_leds[p->color];
+		TIM_TypeDef *tim = l->htim->Instance;
+		uint32_t pin_led = 31U - (uint32_t)__builtin_clz(l->Pin);
+
+		if (((p->puerto->MODER >> (2U * p->pin)) & 3U) != GPIO_MODE_AF_PP ||
+				((p->puerto->AFR[p->pin >> 3] >> (4U * (p->pin & 7U))) & 0xFU) != PLACA_AUTOTEST_AF)
+			continue;
+		/*Solo hay un pin conectado al TIM3 a la vez*/
+		if (((l->Port->MODER >> (2U * pin_led)) & 3U) != GPIO_MODE_AF_PP || !estado_LED(p->color, &ccr) ||
+				ccr == 0U || ccr > tim->ARR || (tim3->CCER & TIM_CCER_CC1E) == 0U)
+			break;
+		periodo = (uint64_t)(tim->PSC + 1U) * (tim->ARR + 1U) * hz / timer_Reloj(tim);
+		alto = (uint64_t)(tim->PSC + 1U) * ccr * hz / timer_Reloj(tim);
+		alto = alto * (uint64_t)(1000 + desvio[p->color]) / 1000U;
+		if (alto == 0U || alto >= periodo || periodo == 0U)
+			break;
+		tim3->CCR1 = (uint32_t)periodo & 0xFFFFU;
+		tim3->CCR2 = (uint32_t)alto & 0xFFFFU;
+		if ((tim3->DIER & TIM_DMA_CC1) != 0U){
+			captura_datos[captura_pos] = tim3->CCR1;
+			captura_datos[captura_pos + 1U] = tim3->CCR2;
+			captura_pos = (captura_pos + 2U) % captura_longitud;
+		}
+		espera = periodo * 1000000000ULL / hz;
+		break;
+	}
+	sim_programar(sim_ahora() + espera, captura_TIM3, 0);
+}
+
+/**
+  * @brief Rafagas de DMA del Timer. Solo se simula la del autotest: CCR1 y CCR2
+	*				 en cada captura del canal 1, en un buffer circular.
+  */
+HAL_StatusTypeDef HAL_TIM_DMABurst_MultiReadStart (TIM_HandleTypeDef *htim, uint32_t base, uint32_t fuente,
+																									 uint32_t *datos, uint32_t rafaga, uint32_t longitud){
+	if (datos == NULL || base != TIM_DMABASE_CCR1 || fuente != TIM_DMA_CC1 ||
+			rafaga != TIM_DMABURSTLENGTH_2TRANSFERS || longitud == 0U || longitud % 2U != 0U)
+		return HAL_ERROR;
+	htim->Instance->DCR = base | rafaga;
+	htim->Instance->DIER |= fuente;
+	captura = htim;
+	captura_datos = datos;
+	captura_longitud = longitud;
+	captura_pos = 0;
+	if ((htim->Instance->CR1 & TIM_CR1_CEN) != 0U && !captura_programada){
+		captura_programada = 1;
+		sim_programar(sim_ahora(), captura_TIM3, 0);
+	}
+	return HAL_OK;
+}
+
+/**
+  * @brief Funcion que fija el desvio del tiempo en alto de un color en su pin,
+	*				 que solo observa la captura del autotest
+	* @param color: Color
+	* @param permil: Desvio en tanto por mil (-1000..)
+  * @retval None
+  */
+void sim_desvio_PWM (uint32_t color, int32_t permil){
+	if (color < NUM_LEDS)
+		desvio[color] = (permil < -1000) ? -1000 : permil;
+}
+
+/*RTC ------------------------------------------------------------------------*/
+
+__weak void HAL_RTC_MspInit (RTC_HandleTypeDef *hrtc){
+	(void)hrtc;
+}
+
+HAL_StatusTypeDef HAL_RTC_Init (RTC_HandleTypeDef *hrtc){
+	HAL_RTC_MspInit(hrtc);
+	return HAL_OK;
+}
+
+/*Observacion ----------------------------------------------------------------*/
+
+/**
+  * @brief Funcion que devuelve el estado de un color del LED a partir de sus
+	*				 registros: PWM (funcion alternativa con el canal y el Timer en marcha)
+	*				 o salida (Fallo.c)
+	* @param c: Color
+	* @param ccr: CCR del canal (RGB_ARR apagado, el LED es activo a nivel bajo); como
+	*				 salida, RGB_ARR o 0 segun el pin
+  * @retval 1 si el LED tiene salida, 0 si esta apagado
+  */
+static int estado_LED (int c, uint32_t *ccr){
+	const RGB_Led *l = &rgb_leds[c];
+	TIM_TypeDef *tim = l->htim->Instance;
+	uint32_t pin = 31U - (uint32_t)__builtin_clz(l->Pin);
+	uint32_t modo = (l->Port->MODER >> (2U * pin)) & 3U;
+
+	if (modo == GPIO_MODE_OUTPUT_PP){
+		*ccr = ((l->Port->ODR & l->Pin) != 0U) ? RGB_ARR : 0U;
+		return 1;
+	}
+	*ccr = *l->CCR;
+	if (modo != GPIO_MODE_AF_PP || tim == NULL || (tim->CR1 & TIM_CR1_CEN) == 0U ||
+			(tim->CCER & (TIM_CCER_CC1E << l->Canal)) == 0U)
+		return 0;
+	if (IS_TIM_BREAK_INSTANCE(tim) && (tim->BDTR & TIM_BDTR_MOE) == 0U)
+		return 0;
+	return 1;
+}
+
+/**
+  * @brief Funcion que anade a la traza PWM un cambio de un color. Un cambio del CCR
+	*				 con la salida ya activa entra en vigor al final del periodo en curso
+	*				 por la precarga; el resto de cambios son inmediatos.
+	* @param c: Color
+	* @param ccr: CCR del canal, que se registra como intensidad de 16 bits
+	* @param activo: Salida habilitada
+  * @retval None
+  */
+static void registrar_PWM (int c, uint32_t ccr, int activo){
+	const RGB_Led *l = &rgb_leds[c];
+	TIM_TypeDef *tim = l->htim->Instance;
+	uint32_t pin = 31U - (uint32_t)__builtin_clz(l->Pin);
+	uint64_t ahora = sim_ahora();
+	uint64_t periodo_ns = 1U, t0 = 0;
+	Sim_PWM_Registro r;
+
+	/*Antes de initRGB el canal aun no tiene Timer*/
+	if (tim != NULL){
+		for (uint32_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++)
+			if (timers[i] == tim)
+				t0 = origen[i];
+		periodo_ns = (uint64_t)(tim->PSC + 1U) * (tim->ARR + 1U) * 1000000000ULL / timer_Reloj(tim);
+	}
+
+	r.escrito_ns = ahora;
+	r.efecto_ns = ahora;
+	r.ccr = (uint16_t)RGB_INTENSIDAD(ccr);
+	r.canal = (uint8_t)c;
+	r.flags = activo ? SIM_PWM_ACTIVO : 0U;
+	if (tim != NULL && activo && led_activo[c] && ((l->Port->MODER >> (2U * pin)) & 3U) == GPIO_MODE_AF_PP &&
+			(*(l->Canal < TIM_CHANNEL_3 ? &tim->CCMR1 : &tim->CCMR2) &
+			 (TIM_CCMR1_OC1PE << ((l->Canal & 4U) ? 8U : 0U))) != 0U)
+		r.efecto_ns = t0 + ((ahora - t0) / periodo_ns + 1U) * periodo_ns;
+	else
+		r.flags |= SIM_PWM_INMEDIATO;
+	r.periodo = (uint32_t)((r.efecto_ns - t0) / periodo_ns);
+	sim_pwm_Registrar(&r, (uint32_t)periodo_ns, (tim != NULL) ? tim->ARR : 0U);
+}
+
+/**
+  * @brief Funcion que aplica al hardware simulado lo que el firmware ha escrito en
+	*				 sus registros (BSRR, clave del IWDG), comprueba el plazo del IWDG y
+	*				 muestra los cambios del LED. Se llama en cada punto de planificacion
+	*				 y en cada lectura del contador de ciclos.
+	* @param None
+  * @retval None
+  */
+void sim_revisar (void){
+	uint64_t ahora;
+	uint32_t ccr;
+	int activo;
+
+	for (uint32_t p = 0; p < SIM_NUM_PUERTOS; p++){
+		GPIO_TypeDef *gpio = &sim_perifericos.gpio[p].r;
+		if (gpio->BSRR != 0U){
+			gpio->ODR = (gpio->ODR | (gpio->BSRR & 0xFFFFU)) & ~(gpio->BSRR >> 16);
+			gpio->BSRR = 0;
+		}
+	}
+	if (IWDG->KR == 0xAAAAU){
+		IWDG->KR = 0;
+		iwdg_refresco = sim_ahora();
+	}
+	if (iwdg_activo && (ahora = sim_ahora()) >= sim_iwdg_limite()){
+		sim_traza("IWDG: reset (sin refresco durante %llu ms)",
+							(unsigned long long)((ahora - iwdg_refresco) / SIM_NS_MS));
+		sim_fin(2);
+	}
+	actualizar_Timers(0);
+	for (int c = 0; c < NUM_LEDS; c++){
+		activo = estado_LED(c, &ccr);
+		if (ccr != led_ccr[c] || activo != led_activo[c]){
+			registrar_PWM(c, ccr, activo);
+			led_ccr[c] = ccr;
+			led_activo[c] = activo;
+			sim_led(c, ccr, activo);
+		}
+	}
+}
@@ -0,0 +1,119 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Sim_PWM.c
+  * @author  MCD Application Team
+  * @brief   Escritura de la traza binaria de la PWM del LED (formato en
+	*					 Sim_PWM.h). El fichero se proyecta en memoria con mmap y cada
+	*					 registro es una copia de 24 bytes, sin llamadas al sistema; la
+	*					 proyeccion se duplica al llenarse y el fichero se recorta a su
+	*					 tamano real al cerrar la traza en sim_fin.
+  *
+  ******************************************************************************
+  */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "stm32f4xx_hal.h"
+#include "Placa.h"
+#include "Sim.h"
+#include "Sim_PWM.h"
+
+#define SIM_PWM_INICIAL  (16U * 1024U * 1024U)
+
+static int fd = -1;
+static uint8_t *mapa = NULL;
+static size_t tam_mapa = 0;
+static size_t usado = 0;
+
+#define SIM_PWM_NOMBRE(color, puerto, pin, tim, canal, af)	#color,
+static const char *const nombres[NUM_LEDS] = {
+	PLACA_LEDS(SIM_PWM_NOMBRE)
+};
+
+_Static_assert(NUM_LEDS <= SIM_PWM_CANALES, "demasiados canales para la traza PWM");
+_Static_assert(sizeof(Sim_PWM_Registro) == 24U, "registro de la traza PWM con relleno");
+
+/**
+  * @brief Funcion que proyecta el fichero con el tamano indicado
+	* @param tam: Bytes
+  * @retval 0 si es correcto, -1 en caso contrario
+  */
+static int proyectar (size_t tam){
+	if (mapa != NULL)
+		munmap(mapa, tam_mapa);
+	mapa = NULL;
+	if (ftruncate(fd, (off_t)tam) != 0)
+		return -1;
+	mapa = mmap(NULL, tam, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mapa == MAP_FAILED){
+		mapa = NULL;
+		return -1;
+	}
+	tam_mapa = tam;
+	return 0;
+}
+
+/**
+  * @brief Funcion que crea el fichero de la traza y escribe su cabecera
+	* @param ruta: Fichero de salida
+  * @retval 0 si es correcto, -1 en caso contrario
+  */
+int sim_pwm_Abrir (const char *ruta){
+	Sim_PWM_Cabecera *c;
+
+	if ((fd = open(ruta, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0 || proyectar(SIM_PWM_INICIAL) != 0){
+		perror(ruta);
+		return -1;
+	}
+	c = (Sim_PWM_Cabecera *)mapa;
+	memcpy(c->magico, SIM_PWM_MAGICO, sizeof(c->magico));
+	c->num_canales = NUM_LEDS;
+	c->tam_registro = sizeof(Sim_PWM_Registro);
+	for (int i = 0; i < NUM_LEDS; i++)
+		strncpy(c->canal[i].nombre, nombres[i], sizeof(c->canal[i].nombre));
+	usado = sizeof(Sim_PWM_Cabecera);
+	return 0;
+}
+
+/**
+  * @brief Funcion que anade un cambio de un canal a la traza
+	* @param r: Registro
+	* @param periodo_ns: Periodo actual de la PWM del canal
+	* @param arr: Cuentas por periodo menos uno
+  * @retval None
+  */
+void sim_pwm_Registrar (const Sim_PWM_Registro *r, uint32_t periodo_ns, uint32_t arr){
+	Sim_PWM_Cabecera *c;
+
+	if (mapa == NULL)
+		return;
+	if (usado + sizeof(*r) > tam_mapa && proyectar(2U * tam_mapa) != 0){
+		fprintf(stderr, "sim: no se puede ampliar la traza PWM\n");
+		sim_fin(1);
+	}
+	memcpy(mapa + usado, r, sizeof(*r));
+	usado += sizeof(*r);
+	c = (Sim_PWM_Cabecera *)mapa;
+	c->num_registros++;
+	c->canal[r->canal].periodo_ns = periodo_ns;
+	c->canal[r->canal].arr = arr;
+}
+
+/**
+  * @brief Funcion que completa la cabecera y recorta el fichero
+	* @param None
+  * @retval None
+  */
+void sim_pwm_Cerrar (void){
+	if (mapa == NULL)
+		return;
+	((Sim_PWM_Cabecera *)mapa)->fin_ns = sim_ahora();
+	munmap(mapa, tam_mapa);
+	mapa = NULL;
+	if (ftruncate(fd, (off_t)usado) != 0)
+		perror("sim: traza PWM");
+	close(fd);
+}
@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Sim_PWM.h
+  * @author  MCD Application Team
+  * @brief   Formato de la traza binaria de la PWM del LED (rgb_sim -p) que lee
+	*					 el conversor rgb_pwm. La traza es una cabecera seguida de un
+	*					 registro por cada cambio de un canal; el ciclo de trabajo de cada
+	*					 periodo es el del ultimo registro cuyo instante de efecto no es
+	*					 posterior al inicio del periodo.
+	*
+	*					 Como los CCR tienen precarga (OCxPE), un cambio del CCR entra en
+	*					 vigor en el siguiente evento de actualizacion del Timer de su
+	*					 canal; los cambios de habilitacion y del modo del pin son
+	*					 inmediatos. Los registros de un mismo lote se observaron a la vez,
+	*					 por lo que pertenecen a la misma actualizacion del firmware.
+	*
+	*					 Todos los campos son little-endian.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __SIM_PWM_H
+#define __SIM_PWM_H
+
+#include <stdint.h>
+
+#define SIM_PWM_MAGICO     "RGBPWM01"
+#define SIM_PWM_CANALES    4U
+
+/*Flags de un registro*/
+#define SIM_PWM_ACTIVO     0x01U		/*Salida habilitada (Timer, canal y pin)*/
+#define SIM_PWM_INMEDIATO  0x02U		/*Cambio sin esperar al fin del periodo*/
+
+typedef struct {
+	char nombre[8];
+	uint32_t periodo_ns;				/*Periodo de la PWM al cerrar la traza*/
+	uint32_t arr;								/*Cuentas por periodo menos uno*/
+} Sim_PWM_Canal;
+
+typedef struct {
+	char magico[8];
+	uint32_t num_canales;
+	uint32_t tam_registro;
+	uint64_t num_registros;
+	uint64_t fin_ns;						/*Instante simulado al cerrar la traza*/
+	Sim_PWM_Canal canal[SIM_PWM_CANALES];
+} Sim_PWM_Cabecera;
+
+typedef struct {
+	uint64_t escrito_ns;				/*Instante en el que se observo el cambio (lote)*/
+	uint64_t efecto_ns;					/*Instante en el que entra en vigor*/
+	uint32_t periodo;						/*Indice del periodo del Timer en vigor*/
+	uint16_t ccr;								/*Intensidad de 16 bits del CCR (RGB_INTENSIDAD); 65535:
+																apagado (LED activo a nivel bajo)*/
+	uint8_t canal;
+	uint8_t flags;
+} Sim_PWM_Registro;
+
+#endif /* __SIM_PWM_H */
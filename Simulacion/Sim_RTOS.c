@@ -0,0 +1,983 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Sim_RTOS.c
+  * @author  MCD Application Team
+  * @brief   Capa CMSIS-RTOS2 del simulador sobre hilos POSIX. Cada hilo del
+	*					 firmware es un pthread, pero solo uno tiene la CPU (actual): el
+	*					 resto espera en su variable de condicion. Todo el firmware se
+	*					 ejecuta con el mutex del nucleo tomado, por lo que las funciones de
+	*					 esta capa no necesitan mas exclusion.
+	*
+	*					 Planificacion como en el RTX5: se ejecuta el hilo listo de mayor
+	*					 prioridad y, dentro de una prioridad, por orden de llegada. Un hilo
+	*					 desalojado vuelve al principio de su prioridad. Con osKernelLock el
+	*					 cambio se aplaza hasta osKernelUnlock.
+	*
+	*					 El tiempo simulado es el tiempo real multiplicado por
+	*					 sim_config.escala. Los plazos (esperas, timeouts y temporizadores)
+	*					 se cuentan en ticks de 1 ms. Los plazos vencidos y los eventos del
+	*					 hardware simulado se atienden en cada llamada a esta capa (punto de
+	*					 planificacion) y, cuando todos los hilos estan bloqueados, en el
+	*					 hilo del reloj, que es el hilo principal tras osKernelStart.
+	*
+	*					 En modo discreto (sim_config.discreto) el tiempo es virtual: no
+	*					 avanza mientras un hilo se ejecuta y, cuando todos estan
+	*					 bloqueados, salta directamente al siguiente plazo o evento. Como el
+	*					 hilo con la CPU esta siempre determinado por la planificacion, dos
+	*					 ejecuciones con el mismo guion dan la misma traza. Las esperas
+	*					 activas del firmware leen el DWT, por lo que cada lectura avanza el
+	*					 tiempo SIM_COSTE_LECTURA_NS (sim_avanzar) para que terminen.
+  *
+  ******************************************************************************
+  */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "stm32f4xx_hal.h"
+#include "cmsis_os2.h"
+#include "Sim.h"
+
+#define SIM_MAX_HILOS           16U
+#define SIM_MAX_COLAS           8U
+#define SIM_MAX_TEMPORIZADORES  8U
+/*Eventos del hardware pendientes: cada paso del guion programa hasta 16 flancos*/
+#define SIM_MAX_EVENTOS         1024U
+/*Frecuencia del tick del nucleo (OS_TICK_FREQ de RTX_Config.h)*/
+#define SIM_TICK_HZ             1000U
+#define SIM_NS_TICK             (1000000000ULL / SIM_TICK_HZ)
+/*Flag interno que despierta al hilo de los temporizadores*/
+#define SIG_TEMPORIZADOR        0x01U
+/*Avance del tiempo virtual en cada lectura del contador de ciclos o del SysTimer*/
+#define SIM_COSTE_LECTURA_NS    100U
+
+typedef enum {
+	MOTIVO_NINGUNO,
+	MOTIVO_FLAGS,
+	MOTIVO_ESPERA,
+	MOTIVO_GET,
+	MOTIVO_PUT
+} Motivo;
+
+static const char *const nombre_motivo[] = {"", "flags", "espera", "get", "put"};
+
+typedef struct Cola {
+	const char *nombre;
+	uint32_t num;						/*Capacidad en mensajes*/
+	uint32_t tam;						/*Bytes por mensaje*/
+	uint32_t cuenta;
+	uint32_t cabeza;
+	uint8_t *datos;
+} Cola;
+
+typedef struct Hilo {
+	const char *nombre;
+	osThreadFunc_t func;
+	void *arg;
+	osPriority_t prioridad;
+	osThreadState_t estado;
+	uint32_t pila;
+	int64_t orden;					/*Orden dentro de su prioridad*/
+	pthread_t pt;
+	pthread_cond_t cond;
+	uint32_t flags;
+	/*Espera en curso*/
+	Motivo motivo;
+	uint32_t espera;				/*Flags esperados*/
+	uint32_t opciones;
+	Cola *cola;
+	void *msg;
+	uint64_t plazo;					/*Instante de fin de la espera en ns*/
+	uint32_t resultado;
+} Hilo;
+
+typedef struct {
+	const char *nombre;
+	osTimerFunc_t func;
+	void *arg;
+	osTimerType_t tipo;
+	int activo;
+	int vencido;
+	uint64_t plazo;
+	uint32_t periodo;
+} Temporizador;
+
+typedef struct {
+	uint64_t instante;
+	uint64_t orden;
+	Sim_Accion accion;
+	uint32_t arg;
+} Evento;
+
+static pthread_mutex_t nucleo = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_reloj;
+
+static Hilo hilos[SIM_MAX_HILOS];
+static uint32_t num_hilos = 0;
+static Cola colas[SIM_MAX_COLAS];
+static uint32_t num_colas = 0;
+static Temporizador temporizadores[SIM_MAX_TEMPORIZADORES];
+static uint32_t num_temporizadores = 0;
+/*Eventos ordenados por instante y, a igual instante, por orden de programacion*/
+static Evento eventos[SIM_MAX_EVENTOS];
+static uint32_t num_eventos = 0;
+static uint64_t orden_eventos = 0;
+
+/*Hilo con la CPU (NULL: todos bloqueados o nucleo sin arrancar)*/
+static Hilo *actual = NULL;
+static Hilo *hilo_temporizadores = NULL;
+static osKernelState_t estado_nucleo = osKernelInactive;
+static int32_t bloqueo = 0;
+static int aplazado = 0;
+/*Anidamiento de rutinas de interrupcion en curso (lo lee __get_IPSR)*/
+uint32_t sim_nivel_isr = 0;
+static int64_t orden_final = 0;
+static int64_t orden_frente = 0;
+
+static struct timespec inicio_real;
+/*Instante simulado en modo discreto*/
+static uint64_t tiempo_virtual = 0;
+
+/**
+  * @brief Funcion que devuelve el tiempo real desde el inicio de la simulacion
+	* @param None
+  * @retval Tiempo en ns
+  */
+static uint64_t real_ns (void){
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)(t.tv_sec - inicio_real.tv_sec) * 1000000000ULL + (uint64_t)t.tv_nsec -
+				 (uint64_t)inicio_real.tv_nsec;
+}
+
+/**
+  * @brief Funcion que devuelve el tiempo real transcurrido (resumen de Sim.c)
+	* @param None
+  * @retval Tiempo en ns
+  */
+uint64_t sim_real (void){
+	return real_ns();
+}
+
+/**
+  * @brief Funcion que devuelve el instante simulado actual
+	* @param None
+  * @retval Tiempo en ns desde el reset
+  */
+uint64_t sim_ahora (void){
+	if (sim_config.discreto)
+		return tiempo_virtual;
+	return real_ns() * sim_config.escala;
+}
+
+/**
+  * @brief Funcion que avanza el tiempo virtual el coste de una lectura de un
+	*				 contador. Sin efecto en modo de tiempo real escalado.
+	* @param None
+  * @retval None
+  */
+void sim_avanzar (void){
+	if (sim_config.discreto)
+		tiempo_virtual += SIM_COSTE_LECTURA_NS;
+}
+
+/**
+  * @brief Funcion que inicializa el reloj del simulador. Se llama desde el main del
+	*				 PC antes de ejecutar el firmware, que empieza con el mutex tomado.
+	* @param None
+  * @retval None
+  */
+void sim_init_RTOS (void){
+	pthread_condattr_t attr;
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&cond_reloj, &attr);
+	clock_gettime(CLOCK_MONOTONIC, &inicio_real);
+	pthread_mutex_lock(&nucleo);
+}
+
+static uint32_t tick_actual (void){
+	return (uint32_t)(sim_ahora() / SIM_NS_TICK);
+}
+
+/**
+  * @brief Funcion que devuelve el instante del fin de una espera en ticks. Como en el
+	*				 RTX, se cuenta desde el ultimo tick, por lo que la espera real esta
+	*				 entre ticks - 1 y ticks.
+	* @param ticks: Ticks de espera (osWaitForever: sin limite)
+  * @retval Instante en ns
+  */
+static uint64_t plazo_ticks (uint32_t ticks){
+	if (ticks == osWaitForever)
+		return SIM_NUNCA;
+	return ((uint64_t)tick_actual() + ticks) * SIM_NS_TICK;
+}
+
+/*Planificacion --------------------------------------------------------------*/
+
+static const char *nombre_Hilo (const Hilo *h){
+	if (h == NULL)
+		return "(reposo)";
+	return (h->nombre != NULL) ? h->nombre : "(sin nombre)";
+}
+
+/**
+  * @brief Funcion que muestra una decision del planificador si esta activa la traza
+	* @param de: Hilo que deja la CPU (NULL: reposo)
+	* @param a: Hilo que la recibe (NULL: reposo)
+	* @param causa: Motivo del cambio
+  * @retval None
+  */
+static void trazar (const Hilo *de, const Hilo *a, const char *causa){
+	if (sim_config.traza_rtos && de != a)
+		sim_traza("RTOS: %s -> %s (%s)", nombre_Hilo(de), nombre_Hilo(a), causa);
+}
+
+/**
+  * @brief Funcion que devuelve el hilo listo de mayor prioridad
+	* @param None
+  * @retval Hilo o NULL si no hay ninguno listo
+  */
+static Hilo *siguiente (void){
+	Hilo *s = NULL;
+
+	for (uint32_t i = 0; i < num_hilos; i++){
+		Hilo *h = &hilos[i];
+		if (h->estado != osThreadReady)
+			continue;
+		if (s == NULL || h->prioridad > s->prioridad ||
+				(h->prioridad == s->prioridad && h->orden < s->orden))
+			s = h;
+	}
+	return s;
+}
+
+/**
+  * @brief Funcion que da la CPU al hilo listo de mayor prioridad (o al hilo del reloj
+	*				 si no hay ninguno) y espera a que el hilo h la recupere.
+	* @param h: Hilo que deja la CPU
+	* @param causa: Motivo para la traza
+  * @retval None
+  */
+static void ceder (Hilo *h, const char *causa){
+	Hilo *s = siguiente();
+
+	trazar(h, s, causa);
+	actual = s;
+	if (s != NULL){
+		s->estado = osThreadRunning;
+		pthread_cond_signal(&s->cond);
+	}
+	else
+		pthread_cond_signal(&cond_reloj);
+	while (actual != h)
+		pthread_cond_wait(&h->cond, &nucleo);
+}
+
+/**
+  * @brief Funcion que desaloja al hilo actual si hay uno listo de mayor prioridad.
+	*				 Dentro de una interrupcion o con el nucleo bloqueado se aplaza.
+	* @param None
+  * @retval None
+  */
+static void planificar (void){
+	Hilo *h = actual;
+	Hilo *s;
+
+	if (sim_nivel_isr != 0U || h == NULL)
+		return;
+	if (bloqueo != 0){
+		aplazado = 1;
+		return;
+	}
+	s = siguiente();
+	if (s == NULL || s->prioridad <= h->prioridad)
+		return;
+	h->estado = osThreadReady;
+	h->orden = --orden_frente;
+	ceder(h, "desalojo");
+}
+
+/**
+  * @brief Funcion que pasa un hilo bloqueado a listo con el resultado de su espera
+	* @param h: Hilo
+	* @param resultado: Valor que devuelve la funcion en la que esperaba
+  * @retval None
+  */
+static void despertar (Hilo *h, uint32_t resultado){
+	h->resultado = resultado;
+	h->motivo = MOTIVO_NINGUNO;
+	h->plazo = SIM_NUNCA;
+	h->estado = osThreadReady;
+	h->orden = ++orden_final;
+}
+
+/**
+  * @brief Funcion que bloquea al hilo actual hasta que otro hilo, una interrupcion o
+	*				 el plazo lo despierten.
+	* @param motivo: Objeto por el que espera
+	* @param ticks: Espera maxima
+  * @retval Resultado de la espera
+  */
+static uint32_t bloquear (Motivo motivo, uint32_t ticks){
+	Hilo *h = actual;
+
+	h->motivo = motivo;
+	h->plazo = plazo_ticks(ticks);
+	h->estado = osThreadBlocked;
+	ceder(h, nombre_motivo[motivo]);
+	return h->resultado;
+}
+
+/*Eventos y plazos -----------------------------------------------------------*/
+
+/**
+  * @brief Funcion que programa un evento del hardware simulado. Se ejecuta en
+	*				 contexto de interrupcion al llegar su instante.
+	* @param instante: Instante en ns
+	* @param accion: Funcion del evento
+	* @param arg: Argumento de la funcion
+  * @retval None
+  */
+void sim_programar (uint64_t instante, Sim_Accion accion, uint32_t arg){
+	uint32_t i;
+
+	if (num_eventos == SIM_MAX_EVENTOS){
+		fprintf(stderr, "sim: demasiados eventos programados\n");
+		sim_fin(1);
+	}
+	for (i = num_eventos; i > 0 && eventos[i - 1].instante > instante; i--)
+		eventos[i] = eventos[i - 1];
+	eventos[i].instante = instante;
+	eventos[i].orden = orden_eventos++;
+	eventos[i].accion = accion;
+	eventos[i].arg = arg;
+	num_eventos++;
+}
+
+/**
+  * @brief Funcion que devuelve el instante del siguiente plazo, evento o
+	*				 temporizador, o el limite del IWDG si es anterior.
+	* @param None
+  * @retval Instante en ns
+  */
+static uint64_t proximo (void){
+	uint64_t p = sim_iwdg_limite();
+
+	if (num_eventos != 0U && eventos[0].instante < p)
+		p = eventos[0].instante;
+	for (uint32_t i = 0; i < num_hilos; i++)
+		if (hilos[i].estado == osThreadBlocked && hilos[i].plazo < p)
+			p = hilos[i].plazo;
+	for (uint32_t i = 0; i < num_temporizadores; i++)
+		if (temporizadores[i].activo && temporizadores[i].plazo < p)
+			p = temporizadores[i].plazo;
+	return p;
+}
+
+/**
+  * @brief Funcion que atiende todo lo vencido hasta el instante actual: plazos de los
+	*				 hilos, temporizadores (SysTick del RTX) y eventos del hardware
+	*				 (interrupciones). Se ejecuta en contexto de interrupcion.
+	* @param None
+  * @retval None
+  */
+static void vencer (void){
+	uint64_t ahora = sim_ahora();
+	uint32_t resultado;
+	Evento ev;
+
+	sim_nivel_isr++;
+	for (uint32_t i = 0; i < num_hilos; i++){
+		Hilo *h = &hilos[i];
+		if (h->estado != osThreadBlocked || h->plazo > ahora)
+			continue;
+		if (h->motivo == MOTIVO_FLAGS)
+			resultado = osFlagsErrorTimeout;
+		else if (h->motivo == MOTIVO_ESPERA)
+			resultado = (uint32_t)osOK;
+		else
+			resultado = (uint32_t)osErrorTimeout;
+		despertar(h, resultado);
+	}
+	for (uint32_t i = 0; i < num_temporizadores; i++){
+		Temporizador *t = &temporizadores[i];
+		if (!t->activo || t->plazo > ahora)
+			continue;
+		t->vencido = 1;
+		if (t->tipo == osTimerPeriodic)
+			t->plazo += (uint64_t)t->periodo * SIM_NS_TICK;
+		else
+			t->activo = 0;
+		osThreadFlagsSet(hilo_temporizadores, SIG_TEMPORIZADOR);
+	}
+	while (num_eventos != 0U && eventos[0].instante <= ahora){
+		ev = eventos[0];
+		num_eventos--;
+		memmove(&eventos[0], &eventos[1], num_eventos * sizeof(Evento));
+		ev.accion(ev.arg);
+	}
+	sim_revisar();
+	sim_nivel_isr--;
+}
+
+/**
+  * @brief Punto de planificacion: se llama al entrar en cada funcion de esta capa
+	*				 desde un hilo. Si ha vencido algo se atiende como lo haria el
+	*				 SysTick o la interrupcion correspondiente y se replanifica.
+	* @param None
+  * @retval None
+  */
+static void punto (void){
+	if (sim_nivel_isr != 0U || actual == NULL || __get_PRIMASK() != 0U)
+		return;
+	if (proximo() > sim_ahora()){
+		sim_revisar();
+		return;
+	}
+	vencer();
+	planificar();
+}
+
+/**
+  * @brief Funcion que ejecuta una rutina de interrupcion del hardware simulado y
+	*				 replanifica a su salida, como el PendSV del RTX.
+	* @param rutina: Rutina de interrupcion
+  * @retval None
+  */
+void sim_isr (void (*rutina)(void)){
+	sim_nivel_isr++;
+	rutina();
+	sim_nivel_isr--;
+	planificar();
+}
+
+/**
+  * @brief Hilo del reloj: es el hilo principal del PC una vez arrancado el nucleo.
+	*				 Cuando todos los hilos estan bloqueados espera, escalado, hasta el
+	*				 siguiente plazo (o salta a el en modo discreto) y atiende lo vencido.
+	* @param None
+  * @retval None
+  */
+static __NO_RETURN void reloj (void){
+	struct timespec t;
+	uint64_t p, real;
+	Hilo *s;
+
+	while (1){
+		while (actual != NULL)
+			pthread_cond_wait(&cond_reloj, &nucleo);
+		vencer();
+		s = siguiente();
+		if (s != NULL){
+			trazar(NULL, s, "listo");
+			actual = s;
+			s->estado = osThreadRunning;
+			pthread_cond_signal(&s->cond);
+			continue;
+		}
+		/*Con todos los hilos bloqueados el estado del firmware es estable*/
+		if (sim_config.invariantes)
+			sim_fuzz_Reposo();
+		p = proximo();
+		if (p == SIM_NUNCA){
+			fprintf(stderr, "sim: todos los hilos bloqueados sin plazo\n");
+			sim_fin(1);
+		}
+		if (sim_config.discreto){
+			if (p > tiempo_virtual)
+				tiempo_virtual = p;
+			continue;
+		}
+		real = p / sim_config.escala + 1U;
+		t.tv_sec = inicio_real.tv_sec + (time_t)(real / 1000000000ULL);
+		t.tv_nsec = inicio_real.tv_nsec + (long)(real % 1000000000ULL);
+		if (t.tv_nsec >= 1000000000L){
+			t.tv_sec++;
+			t.tv_nsec -= 1000000000L;
+		}
+		pthread_cond_timedwait(&cond_reloj, &nucleo, &t);
+	}
+}
+
+/*Nucleo ---------------------------------------------------------------------*/
+
+osStatus_t osKernelInitialize (void){
+	estado_nucleo = osKernelReady;
+	return osOK;
+}
+
+osKernelState_t osKernelGetState (void){
+	punto();
+	if (estado_nucleo == osKernelRunning && bloqueo != 0)
+		return osKernelLocked;
+	return estado_nucleo;
+}
+
+/**
+  * @brief Hilo de los temporizadores (osRtxTimerThread): ejecuta las funciones de
+	*				 los temporizadores vencidos.
+	* @param arg
+  * @retval None
+  */
+static __NO_RETURN void temporizadores_RTX (void *arg){
+	(void)arg;
+	while (1){
+		osThreadFlagsWait(SIG_TEMPORIZADOR, osFlagsWaitAny, osWaitForever);
+		for (uint32_t i = 0; i < num_temporizadores; i++){
+			if (temporizadores[i].vencido){
+				temporizadores[i].vencido = 0;
+				temporizadores[i].func(temporizadores[i].arg);
+			}
+		}
+	}
+}
+
+osStatus_t osKernelStart (void){
+	static const osThreadAttr_t attr = {
+		.name = "osRtxTimerThread",
+		.stack_size = 512,
+		.priority = osPriorityHigh
+	};
+
+	hilo_temporizadores = osThreadNew(temporizadores_RTX, NULL, &attr);
+	/*Prioridades del RTX5: SysTick y PendSV la menor, SVC la siguiente*/
+	NVIC_SetPriority(SysTick_IRQn, (1U << __NVIC_PRIO_BITS) - 1U);
+	NVIC_SetPriority(PendSV_IRQn, (1U << __NVIC_PRIO_BITS) - 1U);
+	NVIC_SetPriority(SVCall_IRQn, (1U << __NVIC_PRIO_BITS) - 2U);
+	estado_nucleo = osKernelRunning;
+	reloj();
+}
+
+int32_t osKernelLock (void){
+	int32_t previo = bloqueo;
+
+	punto();
+	bloqueo = 1;
+	return previo;
+}
+
+int32_t osKernelUnlock (void){
+	int32_t previo = bloqueo;
+
+	bloqueo = 0;
+	if (aplazado){
+		aplazado = 0;
+		planificar();
+	}
+	punto();
+	return previo;
+}
+
+int32_t osKernelRestoreLock (int32_t lock){
+	if (lock != 0)
+		(void)osKernelLock();
+	else
+		(void)osKernelUnlock();
+	return lock;
+}
+
+uint32_t osKernelSuspend (void){
+	uint64_t p = proximo();
+	uint64_t ahora = sim_ahora();
+
+	estado_nucleo = osKernelSuspended;
+	if (p == SIM_NUNCA)
+		return osWaitForever;
+	return (p > ahora) ? (uint32_t)((p - ahora) / SIM_NS_TICK) : 0U;
+}
+
+void osKernelResume (uint32_t sleep_ticks){
+	(void)sleep_ticks;
+	estado_nucleo = osKernelRunning;
+}
+
+uint32_t osKernelGetTickCount (void){
+	punto();
+	return tick_actual();
+}
+
+uint32_t osKernelGetTickFreq (void){
+	return SIM_TICK_HZ;
+}
+
+uint32_t osKernelGetSysTimerCount (void){
+	sim_avanzar();
+	punto();
+	return (uint32_t)(((unsigned __int128)sim_ahora() * SystemCoreClock) / 1000000000U);
+}
+
+uint32_t osKernelGetSysTimerFreq (void){
+	return SystemCoreClock;
+}
+
+/*Hilos ----------------------------------------------------------------------*/
+
+/**
+  * @brief Funcion de arranque del pthread de un hilo del firmware: espera a tener
+	*				 la CPU y ejecuta la funcion del hilo.
+	* @param p: Hilo
+  * @retval None
+  */
+static void *arranque (void *p){
+	Hilo *h = p;
+
+	pthread_mutex_lock(&nucleo);
+	while (actual != h)
+		pthread_cond_wait(&h->cond, &nucleo);
+	h->func(h->arg);
+	osThreadExit();
+}
+
+osThreadId_t osThreadNew (osThreadFunc_t func, void *argument, const osThreadAttr_t *attr){
+	Hilo *h;
+	pthread_attr_t pattr;
+
+	punto();
+	if (func == NULL || num_hilos == SIM_MAX_HILOS)
+		return NULL;
+	h = &hilos[num_hilos++];
+	memset(h, 0, sizeof(*h));
+	h->nombre = (attr != NULL) ? attr->name : NULL;
+	h->func = func;
+	h->arg = argument;
+	h->prioridad = (attr != NULL && attr->priority != osPriorityNone) ? attr->priority : osPriorityNormal;
+	h->pila = (attr != NULL && attr->stack_size != 0U) ? attr->stack_size : 1024U;
+	h->plazo = SIM_NUNCA;
+	h->estado = osThreadReady;
+	h->orden = ++orden_final;
+	pthread_cond_init(&h->cond, NULL);
+	pthread_attr_init(&pattr);
+	pthread_attr_setstacksize(&pattr, 256U * 1024U);
+	if (pthread_create(&h->pt, &pattr, arranque, h) != 0){
+		num_hilos--;
+		return NULL;
+	}
+	pthread_attr_destroy(&pattr);
+	planificar();
+	return h;
+}
+
+const char *osThreadGetName (osThreadId_t thread_id){
+	return (thread_id != NULL) ? ((Hilo *)thread_id)->nombre : NULL;
+}
+
+osThreadId_t osThreadGetId (void){
+	return actual;
+}
+
+osThreadState_t osThreadGetState (osThreadId_t thread_id){
+	return (thread_id != NULL) ? ((Hilo *)thread_id)->estado : osThreadError;
+}
+
+uint32_t osThreadGetStackSize (osThreadId_t thread_id){
+	return (thread_id != NULL) ? ((Hilo *)thread_id)->pila : 0U;
+}
+
+/*El uso de la pila del PC no representa el de la placa: se informa la pila libre*/
+uint32_t osThreadGetStackSpace (osThreadId_t thread_id){
+	return osThreadGetStackSize(thread_id);
+}
+
+osPriority_t osThreadGetPriority (osThreadId_t thread_id){
+	return (thread_id != NULL) ? ((Hilo *)thread_id)->prioridad : osPriorityError;
+}
+
+osStatus_t osThreadYield (void){
+	Hilo *h = actual;
+	Hilo *s;
+
+	punto();
+	s = siguiente();
+	if (s != NULL && s->prioridad == h->prioridad){
+		h->estado = osThreadReady;
+		h->orden = ++orden_final;
+		ceder(h, "yield");
+	}
+	return osOK;
+}
+
+void osThreadExit (void){
+	Hilo *h = actual;
+	Hilo *s;
+
+	h->estado = osThreadTerminated;
+	s = siguiente();
+	trazar(h, s, "fin");
+	actual = s;
+	if (s != NULL){
+		s->estado = osThreadRunning;
+		pthread_cond_signal(&s->cond);
+	}
+	else
+		pthread_cond_signal(&cond_reloj);
+	pthread_mutex_unlock(&nucleo);
+	pthread_exit(NULL);
+}
+
+uint32_t osThreadGetCount (void){
+	uint32_t n = 0;
+
+	for (uint32_t i = 0; i < num_hilos; i++)
+		if (hilos[i].estado != osThreadTerminated)
+			n++;
+	return n;
+}
+
+uint32_t osThreadEnumerate (osThreadId_t *thread_array, uint32_t array_items){
+	uint32_t n = 0;
+
+	for (uint32_t i = 0; i < num_hilos && n < array_items; i++)
+		if (hilos[i].estado != osThreadTerminated)
+			thread_array[n++] = &hilos[i];
+	return n;
+}
+
+/*Flags de los hilos ---------------------------------------------------------*/
+
+/**
+  * @brief Funcion que comprueba si los flags de un hilo cumplen su espera y, si es
+	*				 asi, los consume.
+	* @param h: Hilo
+	* @param espera: Flags esperados
+	* @param opciones: osFlagsWaitAny/osFlagsWaitAll y osFlagsNoClear
+	* @param flags: Flags del hilo antes de consumirlos
+  * @retval 1 si se cumple la espera, 0 en caso contrario
+  */
+static int cumplir (Hilo *h, uint32_t espera, uint32_t opciones, uint32_t *flags){
+	uint32_t activos = h->flags & espera;
+
+	if ((opciones & osFlagsWaitAll) != 0U ? (activos != espera) : (activos == 0U))
+		return 0;
+	*flags = h->flags;
+	if ((opciones & osFlagsNoClear) == 0U)
+		h->flags &= ~espera;
+	return 1;
+}
+
+uint32_t osThreadFlagsSet (osThreadId_t thread_id, uint32_t flags){
+	Hilo *h = thread_id;
+	uint32_t previos;
+
+	punto();
+	if (h == NULL || (flags & osFlagsError) != 0U)
+		return osFlagsErrorParameter;
+	h->flags |= flags;
+	previos = h->flags;
+	if (h->estado == osThreadBlocked && h->motivo == MOTIVO_FLAGS){
+		uint32_t resultado;
+		if (cumplir(h, h->espera, h->opciones, &resultado)){
+			despertar(h, resultado);
+			previos = h->flags;
+			planificar();
+		}
+	}
+	return previos;
+}
+
+uint32_t osThreadFlagsClear (uint32_t flags){
+	uint32_t previos = actual->flags;
+
+	punto();
+	actual->flags &= ~flags;
+	return previos;
+}
+
+uint32_t osThreadFlagsGet (void){
+	return (actual != NULL) ? actual->flags : 0U;
+}
+
+uint32_t osThreadFlagsWait (uint32_t flags, uint32_t options, uint32_t timeout){
+	Hilo *h = actual;
+	uint32_t resultado;
+
+	punto();
+	if (sim_nivel_isr != 0U)
+		return osFlagsErrorISR;
+	if (cumplir(h, flags, options, &resultado))
+		return resultado;
+	if (timeout == 0U)
+		return osFlagsErrorResource;
+	h->espera = flags;
+	h->opciones = options;
+	return bloquear(MOTIVO_FLAGS, timeout);
+}
+
+/*Esperas --------------------------------------------------------------------*/
+
+osStatus_t osDelay (uint32_t ticks){
+	punto();
+	if (sim_nivel_isr != 0U)
+		return osErrorISR;
+	if (ticks == 0U)
+		return osOK;
+	return (osStatus_t)bloquear(MOTIVO_ESPERA, ticks);
+}
+
+osStatus_t osDelayUntil (uint32_t ticks){
+	uint32_t ahora;
+
+	punto();
+	ahora = tick_actual();
+	if ((int32_t)(ticks - ahora) <= 0)
+		return osErrorParameter;
+	return (osStatus_t)bloquear(MOTIVO_ESPERA, ticks - ahora);
+}
+
+/*Temporizadores -------------------------------------------------------------*/
+
+osTimerId_t osTimerNew (osTimerFunc_t func, osTimerType_t type, void *argument, const osTimerAttr_t *attr){
+	Temporizador *t;
+
+	if (func == NULL || num_temporizadores == SIM_MAX_TEMPORIZADORES)
+		return NULL;
+	t = &temporizadores[num_temporizadores++];
+	memset(t, 0, sizeof(*t));
+	t->nombre = (attr != NULL) ? attr->name : NULL;
+	t->func = func;
+	t->arg = argument;
+	t->tipo = type;
+	return t;
+}
+
+osStatus_t osTimerStart (osTimerId_t timer_id, uint32_t ticks){
+	Temporizador *t = timer_id;
+
+	punto();
+	if (t == NULL || ticks == 0U)
+		return osErrorParameter;
+	t->periodo = ticks;
+	t->plazo = plazo_ticks(ticks);
+	t->activo = 1;
+	return osOK;
+}
+
+osStatus_t osTimerStop (osTimerId_t timer_id){
+	Temporizador *t = timer_id;
+
+	punto();
+	if (t == NULL)
+		return osErrorParameter;
+	if (!t->activo)
+		return osErrorResource;
+	t->activo = 0;
+	return osOK;
+}
+
+uint32_t osTimerIsRunning (osTimerId_t timer_id){
+	return (timer_id != NULL) ? (uint32_t)((Temporizador *)timer_id)->activo : 0U;
+}
+
+/*Colas de mensajes ----------------------------------------------------------*/
+
+osMessageQueueId_t osMessageQueueNew (uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr){
+	Cola *c;
+
+	if (msg_count == 0U || msg_size == 0U || num_colas == SIM_MAX_COLAS)
+		return NULL;
+	c = &colas[num_colas++];
+	c->nombre = (attr != NULL) ? attr->name : NULL;
+	c->num = msg_count;
+	c->tam = msg_size;
+	c->cuenta = 0;
+	c->cabeza = 0;
+	c->datos = malloc((size_t)msg_count * msg_size);
+	return c;
+}
+
+/**
+  * @brief Funcion que devuelve el hilo de mayor prioridad (y mas antiguo) que espera
+	*				 en una cola por el motivo indicado.
+	* @param c: Cola
+	* @param motivo: MOTIVO_GET o MOTIVO_PUT
+  * @retval Hilo o NULL si no hay ninguno
+  */
+static Hilo *esperando (Cola *c, Motivo motivo){
+	Hilo *s = NULL;
+
+	for (uint32_t i = 0; i < num_hilos; i++){
+		Hilo *h = &hilos[i];
+		if (h->estado != osThreadBlocked || h->motivo != motivo || h->cola != c)
+			continue;
+		if (s == NULL || h->prioridad > s->prioridad ||
+				(h->prioridad == s->prioridad && h->orden < s->orden))
+			s = h;
+	}
+	return s;
+}
+
+osStatus_t osMessageQueuePut (osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout){
+	Cola *c = mq_id;
+	Hilo *h;
+
+	(void)msg_prio;
+	punto();
+	if (c == NULL || msg_ptr == NULL || (sim_nivel_isr != 0U && timeout != 0U))
+		return osErrorParameter;
+	/*Un hilo esperando un mensaje lo recibe directamente*/
+	if ((h = esperando(c, MOTIVO_GET)) != NULL){
+		memcpy(h->msg, msg_ptr, c->tam);
+		despertar(h, (uint32_t)osOK);
+		planificar();
+		return osOK;
+	}
+	if (c->cuenta < c->num){
+		memcpy(&c->datos[((c->cabeza + c->cuenta) % c->num) * c->tam], msg_ptr, c->tam);
+		c->cuenta++;
+		return osOK;
+	}
+	if (timeout == 0U)
+		return osErrorResource;
+	actual->cola = c;
+	actual->msg = (void *)msg_ptr;
+	return (osStatus_t)bloquear(MOTIVO_PUT, timeout);
+}
+
+osStatus_t osMessageQueueGet (osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout){
+	Cola *c = mq_id;
+	Hilo *h;
+
+	punto();
+	if (c == NULL || msg_ptr == NULL || (sim_nivel_isr != 0U && timeout != 0U))
+		return osErrorParameter;
+	if (msg_prio != NULL)
+		*msg_prio = 0;
+	if (c->cuenta != 0U){
+		memcpy(msg_ptr, &c->datos[c->cabeza * c->tam], c->tam);
+		c->cabeza = (c->cabeza + 1U) % c->num;
+		c->cuenta--;
+		/*El hueco liberado pasa al hilo que esperaba para introducir un mensaje*/
+		if ((h = esperando(c, MOTIVO_PUT)) != NULL){
+			memcpy(&c->datos[((c->cabeza + c->cuenta) % c->num) * c->tam], h->msg, c->tam);
+			c->cuenta++;
+			despertar(h, (uint32_t)osOK);
+			planificar();
+		}
+		return osOK;
+	}
+	if (timeout == 0U)
+		return osErrorResource;
+	actual->cola = c;
+	actual->msg = msg_ptr;
+	return (osStatus_t)bloquear(MOTIVO_GET, timeout);
+}
+
+uint32_t osMessageQueueGetCapacity (osMessageQueueId_t mq_id){
+	return (mq_id != NULL) ? ((Cola *)mq_id)->num : 0U;
+}
+
+uint32_t osMessageQueueGetMsgSize (osMessageQueueId_t mq_id){
+	return (mq_id != NULL) ? ((Cola *)mq_id)->tam : 0U;
+}
+
+uint32_t osMessageQueueGetCount (osMessageQueueId_t mq_id){
+	return (mq_id != NULL) ? ((Cola *)mq_id)->cuenta : 0U;
+}
+
+uint32_t osMessageQueueGetSpace (osMessageQueueId_t mq_id){
+	return (mq_id != NULL) ? ((Cola *)mq_id)->num - ((Cola *)mq_id)->cuenta : 0U;
+}
@@ -0,0 +1,247 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/Sim_USART.c
+  * @author  MCD Application Team
+  * @brief   CMSIS Driver de la USART3 simulado. La transmision termina en el
+	*					 acto (tx_busy siempre a 0) y se muestra por lineas; los caracteres
+	*					 del guion llegan con la interrupcion de la USART3, que el firmware
+	*					 intercepta con $Sub$$USART3_IRQHandler como en la placa.
+	*					 Con rgb_sim -t los bytes enviados se guardan ademas sin cambios en
+	*					 un fichero, para los decodificadores de tramas binarias. La
+	*					 velocidad configurada solo marca el ritmo de la orden bin del guion.
+  *
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "Driver_USART.h"
+#include "Sim.h"
+
+#define SIM_USART_LINEA  256
+
+static ARM_USART_SignalEvent_t callback = NULL;
+static int encendida = 0;
+
+/*Recepcion en curso: buffer del firmware, bytes pedidos y recibidos*/
+static uint8_t *rx_datos = NULL;
+static uint32_t rx_pedidos = 0;
+static uint32_t rx_cuenta = 0;
+static uint8_t rx_dato;
+
+/*Velocidad configurada con ARM_USART_MODE_ASYNCHRONOUS*/
+static uint32_t baudios = 9600U;
+
+/*Transmision: linea en curso y total de bytes enviados*/
+static char linea[SIM_USART_LINEA];
+static uint32_t longitud = 0;
+static uint32_t tx_cuenta = 0;
+static uint32_t tx_total = 0;
+static FILE *captura = NULL;
+
+static ARM_DRIVER_VERSION USART_GetVersion (void){
+	ARM_DRIVER_VERSION v = {ARM_DRIVER_VERSION_MAJOR_MINOR(2, 3), ARM_DRIVER_VERSION_MAJOR_MINOR(1, 0)};
+	return v;
+}
+
+static ARM_USART_CAPABILITIES USART_GetCapabilities (void){
+	ARM_USART_CAPABILITIES c = {1, 0};
+	return c;
+}
+
+static int32_t USART_Initialize (ARM_USART_SignalEvent_t cb_event){
+	callback = cb_event;
+	return ARM_DRIVER_OK;
+}
+
+static int32_t USART_Uninitialize (void){
+	callback = NULL;
+	return ARM_DRIVER_OK;
+}
+
+static int32_t USART_PowerControl (ARM_POWER_STATE estado){
+	encendida = (estado == ARM_POWER_FULL);
+	if (encendida)
+		NVIC_EnableIRQ(USART3_IRQn);
+	else
+		NVIC_DisableIRQ(USART3_IRQn);
+	return ARM_DRIVER_OK;
+}
+
+static int32_t USART_Send (const void *datos, uint32_t num){
+	const uint8_t *d = datos;
+
+	if (!encendida)
+		return ARM_DRIVER_ERROR;
+	if (captura != NULL)
+		fwrite(d, 1, num, captura);
+	for (uint32_t i = 0; i < num; i++){
+		if (d[i] == '\n' || longitud == SIM_USART_LINEA - 1U){
+			linea[longitud] = '\0';
+			sim_uart(linea);
+			longitud = 0;
+		}
+		/*Los bytes de control de las tramas binarias se muestran como '.'*/
+		if (d[i] != '\n' && d[i] != '\r')
+			linea[longitud++] = (d[i] < 0x20U || d[i] == 0x7FU) ? '.' : (char)d[i];
+	}
+	tx_cuenta = num;
+	tx_total += num;
+	return ARM_DRIVER_OK;
+}
+
+static int32_t USART_Receive (void *datos, uint32_t num){
+	if (!encendida || num == 0U)
+		return ARM_DRIVER_ERROR_PARAMETER;
+	rx_datos = datos;
+	rx_pedidos = num;
+	rx_cuenta = 0;
+	return ARM_DRIVER_OK;
+}
+
+static int32_t USART_Transfer (const void *salida, void *entrada, uint32_t num){
+	(void)salida;
+	(void)entrada;
+	(void)num;
+	return ARM_DRIVER_ERROR_UNSUPPORTED;
+}
+
+static uint32_t USART_GetTxCount (void){
+	return tx_cuenta;
+}
+
+static uint32_t USART_GetRxCount (void){
+	return rx_cuenta;
+}
+
+static int32_t USART_Control (uint32_t control, uint32_t arg){
+	switch (control & ARM_USART_CONTROL_Msk){
+		case ARM_USART_MODE_ASYNCHRONOUS:
+			if (arg == 0U)
+				return ARM_DRIVER_ERROR_PARAMETER;
+			baudios = arg;
+			return ARM_DRIVER_OK;
+		case ARM_USART_CONTROL_TX:
+		case ARM_USART_CONTROL_RX:
+			return ARM_DRIVER_OK;
+		case ARM_USART_ABORT_RECEIVE:
+			rx_datos = NULL;
+			return ARM_DRIVER_OK;
+		case ARM_USART_ABORT_SEND:
+			return ARM_DRIVER_OK;
+		default:
+			return ARM_DRIVER_ERROR_UNSUPPORTED;
+	}
+}
+
+static ARM_USART_STATUS USART_GetStatus (void){
+	ARM_USART_STATUS st;
+
+	memset(&st, 0, sizeof(st));
+	st.rx_busy = (rx_datos != NULL && rx_cuenta < rx_pedidos);
+	return st;
+}
+
+static int32_t USART_SetModemControl (ARM_USART_MODEM_CONTROL control){
+	(void)control;
+	return ARM_DRIVER_ERROR_UNSUPPORTED;
+}
+
+static ARM_USART_MODEM_STATUS USART_GetModemStatus (void){
+	ARM_USART_MODEM_STATUS st;
+
+	memset(&st, 0, sizeof(st));
+	return st;
+}
+
+ARM_DRIVER_USART Driver_USART3 = {
+	USART_GetVersion,
+	USART_GetCapabilities,
+	USART_Initialize,
+	USART_Uninitialize,
+	USART_PowerControl,
+	USART_Send,
+	USART_Receive,
+	USART_Transfer,
+	USART_GetTxCount,
+	USART_GetRxCount,
+	USART_Control,
+	USART_GetStatus,
+	USART_SetModemControl,
+	USART_GetModemStatus
+};
+
+/**
+  * @brief Rutina de interrupcion de la USART3 del driver: entrega el caracter
+	*				 recibido en el buffer de la recepcion en curso.
+	* @param None
+  * @retval None
+  */
+void $Super$$USART3_IRQHandler (void){
+	uint32_t evento;
+
+	USART3->SR &= ~USART_SR_RXNE;
+	if (rx_datos != NULL && rx_cuenta < rx_pedidos){
+		rx_datos[rx_cuenta++] = rx_dato;
+		evento = (rx_cuenta == rx_pedidos) ? ARM_USART_EVENT_RECEIVE_COMPLETE : 0U;
+	}
+	else
+		evento = ARM_USART_EVENT_RX_OVERFLOW;
+	if (evento != 0U && callback != NULL)
+		callback(evento);
+}
+
+/**
+  * @brief Funcion que hace llegar un caracter a la USART3
+	* @param c: Caracter
+  * @retval None
+  */
+void sim_rx (uint8_t c){
+	rx_dato = c;
+	USART3->DR = c;
+	USART3->SR |= USART_SR_RXNE;
+	sim_irq(USART3_IRQn);
+}
+
+/**
+  * @brief Funcion que devuelve la velocidad de la USART3
+	* @param None
+  * @retval Baudios
+  */
+uint32_t sim_usart_Baudios (void){
+	return baudios;
+}
+
+/**
+  * @brief Funcion que devuelve el numero de bytes enviados por la USART3
+	* @param None
+  * @retval Bytes
+  */
+uint32_t sim_tx_bytes (void){
+	return tx_total;
+}
+
+/**
+  * @brief Funcion que abre el fichero donde se guardan los bytes enviados
+	* @param ruta: Fichero de salida
+  * @retval 0 si es correcto, -1 en caso contrario
+  */
+int sim_usart_Captura (const char *ruta){
+	if ((captura = fopen(ruta, "wb")) == NULL){
+		perror(ruta);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+  * @brief Funcion que cierra el fichero de bytes enviados
+	* @param None
+  * @retval None
+  */
+void sim_usart_Cerrar (void){
+	if (captura != NULL)
+		fclose(captura);
+	captura = NULL;
+}
@@ -0,0 +1,168 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/cmsis_os2.h
+  * @author  MCD Application Team
+  * @brief   Subconjunto de la API CMSIS-RTOS2 que usa el firmware, implementado
+	*					 sobre hilos POSIX en Sim_RTOS.c. Los tipos, constantes y valores
+	*					 de retorno son los de la cabecera original de ARM.
+  *
+  ******************************************************************************
+  */
+
+#ifndef CMSIS_OS2_H_
+#define CMSIS_OS2_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+	osKernelInactive        =  0,
+	osKernelReady           =  1,
+	osKernelRunning         =  2,
+	osKernelLocked          =  3,
+	osKernelSuspended       =  4,
+	osKernelError           = -1,
+	osKernelReserved        = 0x7FFFFFFF
+} osKernelState_t;
+
+typedef enum {
+	osThreadInactive        =  0,
+	osThreadReady           =  1,
+	osThreadRunning         =  2,
+	osThreadBlocked         =  3,
+	osThreadTerminated      =  4,
+	osThreadError           = -1,
+	osThreadReserved        = 0x7FFFFFFF
+} osThreadState_t;
+
+typedef enum {
+	osPriorityNone          =  0,
+	osPriorityIdle          =  1,
+	osPriorityLow           =  8,
+	osPriorityBelowNormal   = 16,
+	osPriorityNormal        = 24,
+	osPriorityAboveNormal   = 32,
+	osPriorityHigh          = 40,
+	osPriorityRealtime      = 48,
+	osPriorityISR           = 56,
+	osPriorityError         = -1,
+	osPriorityReserved      = 0x7FFFFFFF
+} osPriority_t;
+
+typedef enum {
+	osTimerOnce             = 0,
+	osTimerPeriodic         = 1
+} osTimerType_t;
+
+typedef enum {
+	osOK                    =  0,
+	osError                 = -1,
+	osErrorTimeout          = -2,
+	osErrorResource         = -3,
+	osErrorParameter        = -4,
+	osErrorNoMemory         = -5,
+	osErrorISR              = -6,
+	osStatusReserved        = 0x7FFFFFFF
+} osStatus_t;
+
+#define osWaitForever         0xFFFFFFFFU
+
+#define osFlagsWaitAny        0x00000000U
+#define osFlagsWaitAll        0x00000001U
+#define osFlagsNoClear        0x00000002U
+
+#define osFlagsError          0x80000000U
+#define osFlagsErrorUnknown   0xFFFFFFFFU
+#define osFlagsErrorTimeout   0xFFFFFFFEU
+#define osFlagsErrorResource  0xFFFFFFFDU
+#define osFlagsErrorParameter 0xFFFFFFFCU
+#define osFlagsErrorISR       0xFFFFFFFAU
+
+typedef void (*osThreadFunc_t) (void *argument);
+typedef void (*osTimerFunc_t) (void *argument);
+
+typedef void *osThreadId_t;
+typedef void *osTimerId_t;
+typedef void *osMessageQueueId_t;
+
+typedef struct {
+	const char *name;
+	uint32_t attr_bits;
+	void *cb_mem;
+	uint32_t cb_size;
+	void *stack_mem;
+	uint32_t stack_size;
+	osPriority_t priority;
+	uint32_t tz_module;
+	uint32_t reserved;
+} osThreadAttr_t;
+
+typedef struct {
+	const char *name;
+	uint32_t attr_bits;
+	void *cb_mem;
+	uint32_t cb_size;
+} osTimerAttr_t;
+
+typedef struct {
+	const char *name;
+	uint32_t attr_bits;
+	void *cb_mem;
+	uint32_t cb_size;
+	void *mq_mem;
+	uint32_t mq_size;
+} osMessageQueueAttr_t;
+
+/* Nucleo */
+osStatus_t osKernelInitialize (void);
+osKernelState_t osKernelGetState (void);
+osStatus_t osKernelStart (void);
+int32_t osKernelLock (void);
+int32_t osKernelUnlock (void);
+int32_t osKernelRestoreLock (int32_t lock);
+uint32_t osKernelSuspend (void);
+void osKernelResume (uint32_t sleep_ticks);
+uint32_t osKernelGetTickCount (void);
+uint32_t osKernelGetTickFreq (void);
+uint32_t osKernelGetSysTimerCount (void);
+uint32_t osKernelGetSysTimerFreq (void);
+
+/* Hilos */
+osThreadId_t osThreadNew (osThreadFunc_t func, void *argument, const osThreadAttr_t *attr);
+const char *osThreadGetName (osThreadId_t thread_id);
+osThreadId_t osThreadGetId (void);
+osThreadState_t osThreadGetState (osThreadId_t thread_id);
+uint32_t osThreadGetStackSize (osThreadId_t thread_id);
+uint32_t osThreadGetStackSpace (osThreadId_t thread_id);
+osPriority_t osThreadGetPriority (osThreadId_t thread_id);
+osStatus_t osThreadYield (void);
+void osThreadExit (void) __attribute__((__noreturn__));
+uint32_t osThreadGetCount (void);
+uint32_t osThreadEnumerate (osThreadId_t *thread_array, uint32_t array_items);
+
+/* Flags de los hilos */
+uint32_t osThreadFlagsSet (osThreadId_t thread_id, uint32_t flags);
+uint32_t osThreadFlagsClear (uint32_t flags);
+uint32_t osThreadFlagsGet (void);
+uint32_t osThreadFlagsWait (uint32_t flags, uint32_t options, uint32_t timeout);
+
+/* Esperas */
+osStatus_t osDelay (uint32_t ticks);
+osStatus_t osDelayUntil (uint32_t ticks);
+
+/* Temporizadores */
+osTimerId_t osTimerNew (osTimerFunc_t func, osTimerType_t type, void *argument, const osTimerAttr_t *attr);
+osStatus_t osTimerStart (osTimerId_t timer_id, uint32_t ticks);
+osStatus_t osTimerStop (osTimerId_t timer_id);
+uint32_t osTimerIsRunning (osTimerId_t timer_id);
+
+/* Colas de mensajes */
+osMessageQueueId_t osMessageQueueNew (uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr);
+osStatus_t osMessageQueuePut (osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout);
+osStatus_t osMessageQueueGet (osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout);
+uint32_t osMessageQueueGetCapacity (osMessageQueueId_t mq_id);
+uint32_t osMessageQueueGetMsgSize (osMessageQueueId_t mq_id);
+uint32_t osMessageQueueGetCount (osMessageQueueId_t mq_id);
+uint32_t osMessageQueueGetSpace (osMessageQueueId_t mq_id);
+
+#endif /* CMSIS_OS2_H_ */
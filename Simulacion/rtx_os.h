@@ -0,0 +1,33 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/rtx_os.h
+  * @author  MCD Application Team
+  * @brief   Bloques de control del RTX5 para el simulador. Sim_RTOS.c no usa la
+	*					 memoria de los atributos, pero los bloques mantienen el tamano del
+	*					 RTX5 en Cortex-M4 para que Memoria.c compile y su informe ('m')
+	*					 coincida con el de la placa.
+  *
+  ******************************************************************************
+  */
+
+#ifndef RTX_OS_H_
+#define RTX_OS_H_
+
+#include <stdint.h>
+#include "cmsis_os2.h"
+
+typedef struct { uint32_t reservado[17]; } osRtxThread_t;
+typedef struct { uint32_t reservado[13]; } osRtxMessageQueue_t;
+typedef struct { uint32_t reservado[8]; } osRtxTimer_t;
+
+#define osRtxThreadCbSize        sizeof(osRtxThread_t)
+#define osRtxMessageQueueCbSize  sizeof(osRtxMessageQueue_t)
+#define osRtxTimerCbSize         sizeof(osRtxTimer_t)
+
+/*Memoria de una cola: cada mensaje lleva una cabecera de 12 bytes*/
+#define osRtxMessageQueueMemSize(msg_count, msg_size) \
+	(4*(msg_count)*(3+(((msg_size)+3)/4)))
+
+void osRtxIdleThread (void *argument);
+
+#endif /* RTX_OS_H_ */
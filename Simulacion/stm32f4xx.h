@@ -0,0 +1,2 @@
+/* Cabecera del CMSIS del dispositivo: en el simulador todo se define en stm32f4xx_hal.h */
+#include "stm32f4xx_hal.h"
@@ -0,0 +1,815 @@
+/**
+  ******************************************************************************
+  * @file    Simulacion/stm32f4xx_hal.h
+  * @author  MCD Application Team
+  * @brief   HAL simulada del STM32F429 para compilar el firmware en el PC. Solo
+	*					 contiene los registros, tipos, constantes y funciones que usa la
+	*					 aplicacion. Los perifericos son variables de un unico bloque
+	*					 (sim_perifericos) en el mismo orden que en el mapa de memoria del
+	*					 micro (APB1, APB2, AHB1), por lo que las comparaciones de
+	*					 direcciones del firmware (timer_Reloj, PLACA_GPIO_INDICE) siguen
+	*					 siendo validas. Los GPIO ocupan 0x400 bytes cada uno.
+	*
+	*					 Los registros con comportamiento propio del hardware se
+	*					 actualizan en Sim_HAL.c: el DWT->CYCCNT avanza con el reloj del
+	*					 simulador y las escrituras en GPIOx->BSRR e IWDG->KR se aplican en
+	*					 el siguiente punto de planificacion.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __STM32F4xx_HAL_H
+#define __STM32F4xx_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Compilador ---------------------------------------------------------------*/
+#define __IO                volatile
+#define __I                 volatile const
+#define __O                 volatile
+#define __STATIC_INLINE     static inline
+#define __weak              __attribute__((weak))
+#ifndef __NO_RETURN
+#define __NO_RETURN         __attribute__((__noreturn__))
+#endif
+#define UNUSED(X)           (void)(X)
+
+/* Tipos comunes ------------------------------------------------------------*/
+typedef enum { HAL_OK = 0x00U, HAL_ERROR = 0x01U, HAL_BUSY = 0x02U, HAL_TIMEOUT = 0x03U } HAL_StatusTypeDef;
+typedef enum { HAL_UNLOCKED = 0x00U, HAL_LOCKED = 0x01U } HAL_LockTypeDef;
+typedef enum { RESET = 0U, SET = !RESET } FlagStatus, ITStatus;
+typedef enum { DISABLE = 0U, ENABLE = !DISABLE } FunctionalState;
+
+/* Interrupciones -----------------------------------------------------------*/
+typedef enum {
+	NonMaskableInt_IRQn   = -14,
+	MemoryManagement_IRQn = -12,
+	BusFault_IRQn         = -11,
+	UsageFault_IRQn       = -10,
+	SVCall_IRQn           = -5,
+	DebugMonitor_IRQn     = -4,
+	PendSV_IRQn           = -2,
+	SysTick_IRQn          = -1,
+	WWDG_IRQn             = 0,
+	PVD_IRQn              = 1,
+	TAMP_STAMP_IRQn       = 2,
+	RTC_WKUP_IRQn         = 3,
+	FLASH_IRQn            = 4,
+	RCC_IRQn              = 5,
+	EXTI0_IRQn            = 6,
+	EXTI1_IRQn            = 7,
+	EXTI2_IRQn            = 8,
+	EXTI3_IRQn            = 9,
+	EXTI4_IRQn            = 10,
+	ADC_IRQn              = 18,
+	EXTI9_5_IRQn          = 23,
+	TIM1_CC_IRQn          = 27,
+	TIM2_IRQn             = 28,
+	TIM3_IRQn             = 29,
+	TIM4_IRQn             = 30,
+	USART3_IRQn           = 39,
+	EXTI15_10_IRQn        = 40,
+	TIM5_IRQn             = 50,
+	DMA2_Stream0_IRQn     = 56,
+	DMA2_Stream1_IRQn     = 57,
+	DMA2_Stream2_IRQn     = 58,
+	SIM_NUM_IRQ           = 91
+} IRQn_Type;
+
+#define __NVIC_PRIO_BITS          4U
+#define NVIC_PRIORITYGROUP_0      0x00000007U
+#define NVIC_PRIORITYGROUP_1      0x00000006U
+#define NVIC_PRIORITYGROUP_2      0x00000005U
+#define NVIC_PRIORITYGROUP_3      0x00000004U
+#define NVIC_PRIORITYGROUP_4      0x00000003U
+
+/* Registros ----------------------------------------------------------------*/
+typedef struct {
+	__IO uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR;
+	__IO uint32_t CCR1, CCR2, CCR3, CCR4, BDTR, DCR, DMAR, OR;
+} TIM_TypeDef;
+
+typedef struct {
+	__IO uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2];
+} GPIO_TypeDef;
+
+typedef struct {
+	__IO uint32_t IMR, EMR, RTSR, FTSR, SWIER, PR;
+} EXTI_TypeDef;
+
+typedef struct {
+	__IO uint32_t MEMRMP, PMC, EXTICR[4];
+	uint32_t RESERVED[2];
+	__IO uint32_t CMPCR;
+} SYSCFG_TypeDef;
+
+typedef struct {
+	__IO uint32_t CR, PLLCFGR, CFGR, CIR, AHB1RSTR, AHB2RSTR, AHB3RSTR;
+	uint32_t RESERVED0;
+	__IO uint32_t APB1RSTR, APB2RSTR;
+	uint32_t RESERVED1[2];
+	__IO uint32_t AHB1ENR, AHB2ENR, AHB3ENR;
+	uint32_t RESERVED2;
+	__IO uint32_t APB1ENR, APB2ENR;
+	uint32_t RESERVED3[2];
+	__IO uint32_t AHB1LPENR, AHB2LPENR, AHB3LPENR;
+	uint32_t RESERVED4;
+	__IO uint32_t APB1LPENR, APB2LPENR;
+	uint32_t RESERVED5[2];
+	__IO uint32_t BDCR, CSR;
+	uint32_t RESERVED6[2];
+	__IO uint32_t SSCGR, PLLI2SCFGR, PLLSAICFGR, DCKCFGR;
+} RCC_TypeDef;
+
+typedef struct {
+	__IO uint32_t CR, CSR;
+} PWR_TypeDef;
+
+typedef struct {
+	__IO uint32_t ACR, KEYR, OPTKEYR, SR, CR, OPTCR, OPTCR1;
+} FLASH_TypeDef;
+
+typedef struct {
+	__IO uint32_t TR, DR, CR, ISR, PRER, WUTR, CALIBR, ALRMAR, ALRMBR, WPR, SSR, SHIFTR;
+	__IO uint32_t TSTR, TSDR, TSSSR, CALR, TAFCR, ALRMASSR, ALRMBSSR;
+	uint32_t RESERVED7;
+	__IO uint32_t BKP0R, BKP1R, BKP2R, BKP3R, BKP4R, BKP5R, BKP6R, BKP7R, BKP8R, BKP9R;
+	__IO uint32_t BKP10R, BKP11R, BKP12R, BKP13R, BKP14R, BKP15R, BKP16R, BKP17R, BKP18R, BKP19R;
+} RTC_TypeDef;
+
+typedef struct {
+	__IO uint32_t KR, PR, RLR, SR;
+} IWDG_TypeDef;
+
+typedef struct {
+	__IO uint32_t SR, DR, BRR, CR1, CR2, CR3, GTPR;
+} USART_TypeDef;
+
+typedef struct {
+	__IO uint32_t SR, CR1, CR2, SMPR1, SMPR2, JOFR1, JOFR2, JOFR3, JOFR4, HTR, LTR;
+	__IO uint32_t SQR1, SQR2, SQR3, JSQR, JDR1, JDR2, JDR3, JDR4, DR;
+} ADC_TypeDef;
+
+typedef struct {
+	__IO uint32_t CR, NDTR, PAR, M0AR, M1AR, FCR;
+} DMA_Stream_TypeDef;
+
+typedef struct {
+	__IO uint32_t CPUID, ICSR, VTOR, AIRCR, SCR, CCR;
+	__IO uint8_t  SHP[12];
+	__IO uint32_t SHCSR, CFSR, HFSR, DFSR, MMFAR, BFAR, AFSR;
+} SCB_Type;
+
+typedef struct {
+	__IO uint32_t CTRL, LOAD, VAL, CALIB;
+} SysTick_Type;
+
+typedef struct {
+	__IO uint32_t DHCSR, DCRSR, DCRDR, DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+	__IO uint32_t CTRL, CYCCNT, CPICNT, EXCCNT, SLEEPCNT, LSUCNT, FOLDCNT, PCSR;
+} DWT_Type;
+
+/* Mapa de perifericos simulado ---------------------------------------------*/
+#define SIM_NUM_PUERTOS  11U
+
+typedef union {
+	GPIO_TypeDef r;
+	uint8_t hueco[0x400];
+} Sim_Puerto;
+
+typedef struct {
+	/*APB1*/
+	TIM_TypeDef tim2, tim3, tim4, tim5;
+	RTC_TypeDef rtc;
+	IWDG_TypeDef iwdg;
+	USART_TypeDef usart3;
+	PWR_TypeDef pwr;
+	/*APB2*/
+	TIM_TypeDef tim1, tim8;
+	ADC_TypeDef adc1;
+	SYSCFG_TypeDef syscfg;
+	EXTI_TypeDef exti;
+	/*AHB1*/
+	Sim_Puerto gpio[SIM_NUM_PUERTOS];
+	RCC_TypeDef rcc;
+	FLASH_TypeDef flash;
+	DMA_Stream_TypeDef dma1_stream4, dma2_stream0;
+	/*Cortex-M4*/
+	SCB_Type scb;
+	SysTick_Type systick;
+	CoreDebug_Type coredebug;
+	DWT_Type dwt;
+} Sim_Perifericos;
+
+extern Sim_Perifericos sim_perifericos;
+DWT_Type *sim_DWT (void);
+
+#define APB1PERIPH_BASE  ((uint32_t)(uintptr_t)&sim_perifericos.tim2)
+#define APB2PERIPH_BASE  ((uint32_t)(uintptr_t)&sim_perifericos.tim1)
+#define GPIOA_BASE       ((uintptr_t)&sim_perifericos.gpio[0])
+
+#define TIM1          (&sim_perifericos.tim1)
+#define TIM2          (&sim_perifericos.tim2)
+#define TIM3          (&sim_perifericos.tim3)
+#define TIM4          (&sim_perifericos.tim4)
+#define TIM5          (&sim_perifericos.tim5)
+#define TIM8          (&sim_perifericos.tim8)
+#define RTC           (&sim_perifericos.rtc)
+#define IWDG          (&sim_perifericos.iwdg)
+#define USART3        (&sim_perifericos.usart3)
+#define PWR           (&sim_perifericos.pwr)
+#define ADC1          (&sim_perifericos.adc1)
+#define SYSCFG        (&sim_perifericos.syscfg)
+#define EXTI          (&sim_perifericos.exti)
+#define GPIOA         (&sim_perifericos.gpio[0].r)
+#define GPIOB         (&sim_perifericos.gpio[1].r)
+#define GPIOC         (&sim_perifericos.gpio[2].r)
+#define GPIOD         (&sim_perifericos.gpio[3].r)
+#define GPIOE         (&sim_perifericos.gpio[4].r)
+#define GPIOF         (&sim_perifericos.gpio[5].r)
+#define GPIOG         (&sim_perifericos.gpio[6].r)
+#define GPIOH         (&sim_perifericos.gpio[7].r)
+#define GPIOI         (&sim_perifericos.gpio[8].r)
+#define GPIOJ         (&sim_perifericos.gpio[9].r)
+#define GPIOK         (&sim_perifericos.gpio[10].r)
+#define RCC           (&sim_perifericos.rcc)
+#define FLASH         (&sim_perifericos.flash)
+#define DMA1_Stream4  (&sim_perifericos.dma1_stream4)
+#define DMA2_Stream0  (&sim_perifericos.dma2_stream0)
+#define SCB           (&sim_perifericos.scb)
+#define SysTick       (&sim_perifericos.systick)
+#define CoreDebug     (&sim_perifericos.coredebug)
+#define DWT           (sim_DWT())
+
+/* Bits de los registros ----------------------------------------------------*/
+#define TIM_CR1_CEN                 0x0001U
+#define TIM_CR1_UDIS                0x0002U
+#define TIM_EGR_UG                  0x0001U
+#define TIM_SR_UIF                  0x0001U
+#define TIM_SR_CC4IF                0x0010U
+#define TIM_CCER_CC1E               0x0001U
+#define TIM_CCER_CC4E               0x1000U
+#define TIM_CCER_CC4P               0x2000U
+#define TIM_CCMR2_CC4S_0            0x0100U
+#define TIM_CCMR1_OC1PE             0x0008U
+#define TIM_BDTR_MOE                0x8000U
+#define TIM_OR_TI4_RMP_0            0x0040U
+#define TIM_OR_TI4_RMP_1            0x0080U
+
+#define EXTI_IMR_MR0                0x0001U
+
+#define USART_SR_RXNE               0x0020U
+#define USART_SR_TC                 0x0040U
+#define USART_SR_TXE                0x0080U
+#define USART_CR1_UE                0x2000U
+#define USART_CR1_OVER8             0x8000U
+#define UART_BRR_SAMPLING16(_PCLK_, _BAUD_)  (((_PCLK_) + (_BAUD_) / 2U) / (_BAUD_))
+#define UART_BRR_SAMPLING8(_PCLK_, _BAUD_)   (((2U * (_PCLK_)) + (_BAUD_) / 2U) / (_BAUD_))
+
+#define RCC_CR_HSION                0x00000001U
+#define RCC_CR_HSIRDY               0x00000002U
+#define RCC_CR_PLLON                0x01000000U
+#define RCC_CR_PLLRDY               0x02000000U
+#define RCC_CFGR_SW                 0x00000003U
+#define RCC_CFGR_SW_HSI             0x00000000U
+#define RCC_CFGR_SW_PLL             0x00000002U
+#define RCC_CFGR_SWS                0x0000000CU
+#define RCC_CFGR_SWS_HSI            0x00000000U
+#define RCC_CFGR_SWS_PLL            0x00000008U
+#define RCC_CFGR_HPRE               0x000000F0U
+#define RCC_CFGR_PPRE1              0x00001C00U
+#define RCC_CFGR_PPRE1_Pos          10U
+#define RCC_CFGR_PPRE2              0x0000E000U
+#define RCC_CFGR_PPRE2_Pos          13U
+#define RCC_PLLCFGR_PLLM            0x0000003FU
+#define RCC_PLLCFGR_PLLN_Pos        6U
+#define RCC_PLLCFGR_PLLN            0x00007FC0U
+#define RCC_PLLCFGR_PLLP_Pos        16U
+#define RCC_PLLCFGR_PLLP            0x00030000U
+#define RCC_PLLCFGR_PLLSRC          0x00400000U
+#define RCC_PLLCFGR_PLLQ_Pos        24U
+#define RCC_PLLCFGR_PLLQ            0x0F000000U
+#define RCC_CSR_LSION               0x00000001U
+#define RCC_CSR_LSIRDY              0x00000002U
+
+#define PWR_CR_DBP                  0x00000100U
+#define PWR_CR_VOS                  0x0000C000U
+#define PWR_CSR_VOSRDY              0x00004000U
+
+#define FLASH_ACR_LATENCY           0x0000000FU
+
+#define SCB_SCR_SLEEPDEEP_Msk       0x00000004U
+#define SysTick_CTRL_ENABLE_Msk     0x00000001U
+#define SysTick_CTRL_TICKINT_Msk    0x00000002U
+#define DWT_CTRL_CYCCNTENA_Msk      0x00000001U
+#define CoreDebug_DEMCR_TRCENA_Msk  0x01000000U
+
+/* Relojes ------------------------------------------------------------------*/
+#define HSI_VALUE  16000000U
+#define HSE_VALUE  8000000U
+#define LSI_VALUE  32000U
+
+extern uint32_t SystemCoreClock;
+void SystemCoreClockUpdate (void);
+
+/* Nucleo Cortex-M4 ---------------------------------------------------------*/
+void __disable_irq (void);
+void __enable_irq (void);
+uint32_t __get_PRIMASK (void);
+/*Solo distingue el modo hilo (0) de una interrupcion; en linea porque la traza
+	lo lee en cada evento*/
+extern uint32_t sim_nivel_isr;
+__STATIC_INLINE uint32_t __get_IPSR (void) { return (sim_nivel_isr != 0U) ? 16U : 0U; }
+void __set_PRIMASK (uint32_t primask);
+#define __DSB()   __sync_synchronize()
+#define __ISB()   __sync_synchronize()
+#define __DMB()   __sync_synchronize()
+#define __NOP()   ((void)0)
+#define __SEV()   ((void)0)
+void __WFI (void);
+void __WFE (void);
+__STATIC_INLINE uint32_t __CLZ (uint32_t x) { return (x == 0U) ? 32U : (uint32_t)__builtin_clz(x); }
+__STATIC_INLINE uint32_t __RBIT (uint32_t x) {
+	uint32_t r = 0;
+	for (int i = 0; i < 32; i++, x >>= 1)
+		r = (r << 1) | (x & 1U);
+	return r;
+}
+#define __REV(x)  __builtin_bswap32(x)
+/*Acceso exclusivo: solo un hilo del simulador ejecuta firmware a la vez*/
+__STATIC_INLINE uint32_t __LDREXW (volatile uint32_t *p) { return *p; }
+__STATIC_INLINE uint32_t __STREXW (uint32_t v, volatile uint32_t *p) { *p = v; return 0U; }
+#define __CLREX() ((void)0)
+
+void NVIC_SetPriorityGrouping (uint32_t grupo);
+uint32_t NVIC_GetPriorityGrouping (void);
+void NVIC_SetPriority (IRQn_Type irq, uint32_t prioridad);
+uint32_t NVIC_GetPriority (IRQn_Type irq);
+void NVIC_EnableIRQ (IRQn_Type irq);
+void NVIC_DisableIRQ (IRQn_Type irq);
+uint32_t NVIC_GetEnableIRQ (IRQn_Type irq);
+void NVIC_SetPendingIRQ (IRQn_Type irq);
+void NVIC_ClearPendingIRQ (IRQn_Type irq);
+__NO_RETURN void NVIC_SystemReset (void);
+
+/* HAL comun ----------------------------------------------------------------*/
+HAL_StatusTypeDef HAL_Init (void);
+HAL_StatusTypeDef HAL_DeInit (void);
+void HAL_MspInit (void);
+void HAL_MspDeInit (void);
+void HAL_IncTick (void);
+uint32_t HAL_GetTick (void);
+void HAL_Delay (uint32_t ms);
+
+void HAL_NVIC_SetPriorityGrouping (uint32_t grupo);
+void HAL_NVIC_SetPriority (IRQn_Type irq, uint32_t prioridad, uint32_t subprioridad);
+void HAL_NVIC_EnableIRQ (IRQn_Type irq);
+void HAL_NVIC_DisableIRQ (IRQn_Type irq);
+
+/* GPIO ---------------------------------------------------------------------*/
+typedef struct {
+	uint32_t Pin;
+	uint32_t Mode;
+	uint32_t Pull;
+	uint32_t Speed;
+	uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+
+#define GPIO_PIN_0    ((uint16_t)0x0001)
+#define GPIO_PIN_1    ((uint16_t)0x0002)
+#define GPIO_PIN_2    ((uint16_t)0x0004)
+#define GPIO_PIN_3    ((uint16_t)0x0008)
+#define GPIO_PIN_4    ((uint16_t)0x0010)
+#define GPIO_PIN_5    ((uint16_t)0x0020)
+#define GPIO_PIN_6    ((uint16_t)0x0040)
+#define GPIO_PIN_7    ((uint16_t)0x0080)
+#define GPIO_PIN_8    ((uint16_t)0x0100)
+#define GPIO_PIN_9    ((uint16_t)0x0200)
+#define GPIO_PIN_10   ((uint16_t)0x0400)
+#define GPIO_PIN_11   ((uint16_t)0x0800)
+#define GPIO_PIN_12   ((uint16_t)0x1000)
+#define GPIO_PIN_13   ((uint16_t)0x2000)
+#define GPIO_PIN_14   ((uint16_t)0x4000)
+#define GPIO_PIN_15   ((uint16_t)0x8000)
+#define GPIO_PIN_All  ((uint16_t)0xFFFF)
+
+#define GPIO_MODE_INPUT              0x00000000U
+#define GPIO_MODE_OUTPUT_PP          0x00000001U
+#define GPIO_MODE_OUTPUT_OD          0x00000011U
+#define GPIO_MODE_AF_PP              0x00000002U
+#define GPIO_MODE_AF_OD              0x00000012U
+#define GPIO_MODE_ANALOG             0x00000003U
+#define GPIO_MODE_IT_RISING          0x10110000U
+#define GPIO_MODE_IT_FALLING         0x10210000U
+#define GPIO_MODE_IT_RISING_FALLING  0x10310000U
+
+#define GPIO_NOPULL                  0x00000000U
+#define GPIO_PULLUP                  0x00000001U
+#define GPIO_PULLDOWN                0x00000002U
+
+#define GPIO_SPEED_FREQ_LOW          0x00000000U
+#define GPIO_SPEED_FREQ_MEDIUM       0x00000001U
+#define GPIO_SPEED_FREQ_HIGH         0x00000002U
+#define GPIO_SPEED_FREQ_VERY_HIGH    0x00000003U
+
+#define GPIO_AF1_TIM1                ((uint8_t)0x01)
+#define GPIO_AF2_TIM3                ((uint8_t)0x02)
+#define GPIO_AF2_TIM4                ((uint8_t)0x02)
+#define GPIO_AF2_TIM5                ((uint8_t)0x02)
+#define GPIO_AF7_USART3              ((uint8_t)0x07)
+
+void HAL_GPIO_Init (GPIO_TypeDef *puerto, GPIO_InitTypeDef *init);
+GPIO_PinState HAL_GPIO_ReadPin (GPIO_TypeDef *puerto, uint16_t pin);
+void HAL_GPIO_WritePin (GPIO_TypeDef *puerto, uint16_t pin, GPIO_PinState estado);
+void HAL_GPIO_EXTI_IRQHandler (uint16_t pin);
+void HAL_GPIO_EXTI_Callback (uint16_t pin);
+
+/* RCC ----------------------------------------------------------------------*/
+typedef struct {
+	uint32_t PLLState;
+	uint32_t PLLSource;
+	uint32_t PLLM;
+	uint32_t PLLN;
+	uint32_t PLLP;
+	uint32_t PLLQ;
+} RCC_PLLInitTypeDef;
+
+typedef struct {
+	uint32_t OscillatorType;
+	uint32_t HSEState;
+	uint32_t LSEState;
+	uint32_t HSIState;
+	uint32_t HSICalibrationValue;
+	uint32_t LSIState;
+	RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+typedef struct {
+	uint32_t ClockType;
+	uint32_t SYSCLKSource;
+	uint32_t AHBCLKDivider;
+	uint32_t APB1CLKDivider;
+	uint32_t APB2CLKDivider;
+} RCC_ClkInitTypeDef;
+
+typedef struct {
+	uint32_t PeriphClockSelection;
+	uint32_t RTCClockSelection;
+	uint32_t TIMPresSelection;
+} RCC_PeriphCLKInitTypeDef;
+
+#define RCC_OSCILLATORTYPE_NONE      0x00000000U
+#define RCC_OSCILLATORTYPE_HSE       0x00000001U
+#define RCC_OSCILLATORTYPE_HSI       0x00000002U
+#define RCC_OSCILLATORTYPE_LSE       0x00000004U
+#define RCC_OSCILLATORTYPE_LSI       0x00000008U
+#define RCC_HSI_OFF                  0x00000000U
+#define RCC_HSI_ON                   0x00000001U
+#define RCC_LSI_OFF                  0x00000000U
+#define RCC_LSI_ON                   0x00000001U
+#define RCC_HSICALIBRATION_DEFAULT   0x00000010U
+#define RCC_PLL_NONE                 0x00000000U
+#define RCC_PLL_OFF                  0x00000001U
+#define RCC_PLL_ON                   0x00000002U
+#define RCC_PLLSOURCE_HSI            0x00000000U
+#define RCC_PLLSOURCE_HSE            0x00400000U
+#define RCC_PLLP_DIV2                0x00000002U
+#define RCC_PLLP_DIV4                0x00000004U
+#define RCC_PLLP_DIV6                0x00000006U
+#define RCC_PLLP_DIV8                0x00000008U
+#define RCC_CLOCKTYPE_SYSCLK         0x00000001U
+#define RCC_CLOCKTYPE_HCLK           0x00000002U
+#define RCC_CLOCKTYPE_PCLK1          0x00000004U
+#define RCC_CLOCKTYPE_PCLK2          0x00000008U
+#define RCC_SYSCLKSOURCE_HSI         0x00000000U
+#define RCC_SYSCLKSOURCE_HSE         0x00000001U
+#define RCC_SYSCLKSOURCE_PLLCLK      0x00000002U
+#define RCC_SYSCLK_DIV1              0x00000000U
+#define RCC_HCLK_DIV1                0x00000000U
+#define RCC_HCLK_DIV2                0x00001000U
+#define RCC_HCLK_DIV4                0x00001400U
+#define RCC_HCLK_DIV8                0x00001800U
+#define RCC_HCLK_DIV16               0x00001C00U
+#define RCC_PERIPHCLK_RTC            0x00000002U
+#define RCC_RTCCLKSOURCE_LSI         0x00000200U
+#define FLASH_LATENCY_0              0x00000000U
+#define FLASH_LATENCY_1              0x00000001U
+#define FLASH_LATENCY_2              0x00000002U
+#define FLASH_LATENCY_3              0x00000003U
+#define FLASH_LATENCY_4              0x00000004U
+#define FLASH_LATENCY_5              0x00000005U
+
+/*Indicadores de causa de reset: bit del RCC->CSR*/
+#define RCC_FLAG_BORRST              25U
+#define RCC_FLAG_PINRST              26U
+#define RCC_FLAG_PORRST              27U
+#define RCC_FLAG_SFTRST              28U
+#define RCC_FLAG_IWDGRST             29U
+#define RCC_FLAG_WWDGRST             30U
+#define RCC_FLAG_LPWRRST             31U
+#define __HAL_RCC_GET_FLAG(flag)     ((RCC->CSR >> ((flag) & 0x1FU)) & 1U)
+#define __HAL_RCC_CLEAR_RESET_FLAGS() (RCC->CSR &= 0x00FFFFFFU)
+
+#define __HAL_RCC_PWR_CLK_ENABLE()     ((void)0)
+#define __HAL_RCC_SYSCFG_CLK_ENABLE()  ((void)0)
+#define __HAL_RCC_TIM1_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_TIM1_CLK_DISABLE()   ((void)0)
+#define __HAL_RCC_TIM2_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_TIM3_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_TIM4_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_TIM4_CLK_DISABLE()   ((void)0)
+#define __HAL_RCC_TIM5_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_TIM5_CLK_DISABLE()   ((void)0)
+#define __HAL_RCC_ADC1_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_DMA1_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_DMA2_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_RTC_ENABLE()         ((void)0)
+
+HAL_StatusTypeDef HAL_RCC_OscConfig (RCC_OscInitTypeDef *osc);
+HAL_StatusTypeDef HAL_RCC_ClockConfig (RCC_ClkInitTypeDef *clk, uint32_t latencia);
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig (RCC_PeriphCLKInitTypeDef *periph);
+uint32_t HAL_RCC_GetSysClockFreq (void);
+uint32_t HAL_RCC_GetHCLKFreq (void);
+uint32_t HAL_RCC_GetPCLK1Freq (void);
+uint32_t HAL_RCC_GetPCLK2Freq (void);
+
+/* PWR ----------------------------------------------------------------------*/
+#define PWR_REGULATOR_VOLTAGE_SCALE1   0x0000C000U
+#define PWR_REGULATOR_VOLTAGE_SCALE2   0x00008000U
+#define PWR_REGULATOR_VOLTAGE_SCALE3   0x00004000U
+#define __HAL_PWR_VOLTAGESCALING_CONFIG(escala)  (PWR->CR = (PWR->CR & ~PWR_CR_VOS) | (escala))
+
+void HAL_PWR_EnableBkUpAccess (void);
+void HAL_PWR_EnableSEVOnPend (void);
+void HAL_PWREx_EnableFlashPowerDown (void);
+
+/* TIM ----------------------------------------------------------------------*/
+typedef struct {
+	uint32_t Prescaler;
+	uint32_t CounterMode;
+	uint32_t Period;
+	uint32_t ClockDivision;
+	uint32_t RepetitionCounter;
+	uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+	TIM_TypeDef *Instance;
+	TIM_Base_InitTypeDef Init;
+	uint32_t Channel;
+	struct __DMA_HandleTypeDef *hdma[7];
+	HAL_LockTypeDef Lock;
+	uint32_t State;
+} TIM_HandleTypeDef;
+
+typedef struct {
+	uint32_t ClockSource;
+	uint32_t ClockPolarity;
+	uint32_t ClockPrescaler;
+	uint32_t ClockFilter;
+} TIM_ClockConfigTypeDef;
+
+typedef struct {
+	uint32_t MasterOutputTrigger;
+	uint32_t MasterSlaveMode;
+} TIM_MasterConfigTypeDef;
+
+typedef struct {
+	uint32_t OCMode;
+	uint32_t Pulse;
+	uint32_t OCPolarity;
+	uint32_t OCNPolarity;
+	uint32_t OCFastMode;
+	uint32_t OCIdleState;
+	uint32_t OCNIdleState;
+} TIM_OC_InitTypeDef;
+
+typedef struct {
+	uint32_t ICPolarity;
+	uint32_t ICSelection;
+	uint32_t ICPrescaler;
+	uint32_t ICFilter;
+} TIM_IC_InitTypeDef;
+
+typedef struct {
+	uint32_t SlaveMode;
+	uint32_t InputTrigger;
+	uint32_t TriggerPolarity;
+	uint32_t TriggerPrescaler;
+	uint32_t TriggerFilter;
+} TIM_SlaveConfigTypeDef;
+
+typedef struct {
+	uint32_t OffStateRunMode;
+	uint32_t OffStateIDLEMode;
+	uint32_t LockLevel;
+	uint32_t DeadTime;
+	uint32_t BreakState;
+	uint32_t BreakPolarity;
+	uint32_t BreakFilter;
+	uint32_t AutomaticOutput;
+} TIM_BreakDeadTimeConfigTypeDef;
+
+#define TIM_COUNTERMODE_UP              0x00000000U
+#define TIM_CLOCKDIVISION_DIV1          0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_DISABLE  0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_ENABLE   0x00000080U
+#define TIM_CLOCKSOURCE_INTERNAL        0x00001000U
+#define TIM_TRGO_RESET                  0x00000000U
+#define TIM_TRGO_UPDATE                 0x00000020U
+#define TIM_MASTERSLAVEMODE_DISABLE     0x00000000U
+#define TIM_OSSR_DISABLE                0x00000000U
+#define TIM_OSSI_DISABLE                0x00000000U
+#define TIM_LOCKLEVEL_OFF               0x00000000U
+#define TIM_BREAK_DISABLE               0x00000000U
+#define TIM_BREAKPOLARITY_HIGH          0x00002000U
+#define TIM_AUTOMATICOUTPUT_DISABLE     0x00000000U
+#define TIM_OCMODE_PWM1                 0x00000060U
+#define TIM_OCPOLARITY_HIGH             0x00000000U
+#define TIM_OCNPOLARITY_HIGH            0x00000000U
+#define TIM_OCFAST_DISABLE              0x00000000U
+#define TIM_OCIDLESTATE_RESET           0x00000000U
+#define TIM_OCNIDLESTATE_RESET          0x00000000U
+#define TIM_CHANNEL_1                   0x00000000U
+#define TIM_CHANNEL_2                   0x00000004U
+#define TIM_CHANNEL_3                   0x00000008U
+#define TIM_CHANNEL_4                   0x0000000CU
+#define TIM_INPUTCHANNELPOLARITY_RISING  0x00000000U
+#define TIM_INPUTCHANNELPOLARITY_FALLING 0x00000002U
+#define TIM_ICSELECTION_DIRECTTI        0x00000001U
+#define TIM_ICSELECTION_INDIRECTTI      0x00000002U
+#define TIM_ICPSC_DIV1                  0x00000000U
+#define TIM_SLAVEMODE_RESET             0x00000004U
+#define TIM_TS_TI1FP1                   0x00000050U
+#define TIM_TRIGGERPOLARITY_RISING      0x00000000U
+#define TIM_TRIGGERPRESCALER_DIV1       0x00000000U
+#define TIM_DMABASE_CCR1                0x0000000DU
+#define TIM_DMA_CC1                     0x00000200U
+#define TIM_DMABURSTLENGTH_2TRANSFERS   0x00000100U
+#define TIM_DMA_ID_CC1                  ((uint16_t)0x0001)
+
+#define IS_TIM_BREAK_INSTANCE(instancia)  (((instancia) == TIM1) || ((instancia) == TIM8))
+
+HAL_StatusTypeDef HAL_TIM_Base_Init (TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start (TIM_HandleTypeDef *htim);
+void HAL_TIM_Base_MspInit (TIM_HandleTypeDef *htim);
+void HAL_TIM_Base_MspDeInit (TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource (TIM_HandleTypeDef *htim, TIM_ClockConfigTypeDef *config);
+HAL_StatusTypeDef HAL_TIM_PWM_Init (TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel (TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *config, uint32_t canal);
+HAL_StatusTypeDef HAL_TIM_PWM_Start (TIM_HandleTypeDef *htim, uint32_t canal);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop (TIM_HandleTypeDef *htim, uint32_t canal);
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization (TIM_HandleTypeDef *htim, TIM_MasterConfigTypeDef *config);
+HAL_StatusTypeDef HAL_TIMEx_ConfigBreakDeadTime (TIM_HandleTypeDef *htim, TIM_BreakDeadTimeConfigTypeDef *config);
+HAL_StatusTypeDef HAL_TIM_IC_Init (TIM_HandleTypeDef *htim);
+void HAL_TIM_IC_MspInit (TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_IC_ConfigChannel (TIM_HandleTypeDef *htim, TIM_IC_InitTypeDef *config, uint32_t canal);
+HAL_StatusTypeDef HAL_TIM_SlaveConfigSynchro (TIM_HandleTypeDef *htim, TIM_SlaveConfigTypeDef *config);
+HAL_StatusTypeDef HAL_TIM_IC_Start (TIM_HandleTypeDef *htim, uint32_t canal);
+HAL_StatusTypeDef HAL_TIM_DMABurst_MultiReadStart (TIM_HandleTypeDef *htim, uint32_t base, uint32_t fuente,
+																									 uint32_t *datos, uint32_t rafaga, uint32_t longitud);
+
+/* IWDG ---------------------------------------------------------------------*/
+typedef struct {
+	uint32_t Prescaler;
+	uint32_t Reload;
+} IWDG_InitTypeDef;
+
+typedef struct {
+	IWDG_TypeDef *Instance;
+	IWDG_InitTypeDef Init;
+} IWDG_HandleTypeDef;
+
+#define IWDG_PRESCALER_4     0x00000000U
+#define IWDG_PRESCALER_8     0x00000001U
+#define IWDG_PRESCALER_16    0x00000002U
+#define IWDG_PRESCALER_32    0x00000003U
+#define IWDG_PRESCALER_64    0x00000004U
+#define IWDG_PRESCALER_128   0x00000005U
+#define IWDG_PRESCALER_256   0x00000006U
+
+HAL_StatusTypeDef HAL_IWDG_Init (IWDG_HandleTypeDef *hiwdg);
+HAL_StatusTypeDef HAL_IWDG_Refresh (IWDG_HandleTypeDef *hiwdg);
+
+/* DMA ----------------------------------------------------------------------*/
+typedef struct {
+	uint32_t Channel;
+	uint32_t Direction;
+	uint32_t PeriphInc;
+	uint32_t MemInc;
+	uint32_t PeriphDataAlignment;
+	uint32_t MemDataAlignment;
+	uint32_t Mode;
+	uint32_t Priority;
+	uint32_t FIFOMode;
+	uint32_t FIFOThreshold;
+	uint32_t MemBurst;
+	uint32_t PeriphBurst;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+	DMA_Stream_TypeDef *Instance;
+	DMA_InitTypeDef Init;
+	HAL_LockTypeDef Lock;
+	uint32_t State;
+	void *Parent;
+	uint32_t ErrorCode;
+} DMA_HandleTypeDef;
+
+#define DMA_CHANNEL_0            0x00000000U
+#define DMA_CHANNEL_5            0x0A000000U
+#define DMA_PERIPH_TO_MEMORY     0x00000000U
+#define DMA_PINC_DISABLE         0x00000000U
+#define DMA_MINC_ENABLE          0x00000400U
+#define DMA_PDATAALIGN_HALFWORD  0x00000800U
+#define DMA_MDATAALIGN_HALFWORD  0x00002000U
+#define DMA_PDATAALIGN_WORD      0x00001000U
+#define DMA_MDATAALIGN_WORD      0x00004000U
+#define DMA_CIRCULAR             0x00000100U
+#define DMA_PRIORITY_LOW         0x00000000U
+#define DMA_FIFOMODE_DISABLE     0x00000000U
+
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+	do { (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__); (__DMA_HANDLE__).Parent = (__HANDLE__); } while (0)
+
+HAL_StatusTypeDef HAL_DMA_Init (DMA_HandleTypeDef *hdma);
+void HAL_DMA_IRQHandler (DMA_HandleTypeDef *hdma);
+
+/* ADC ----------------------------------------------------------------------*/
+typedef struct {
+	uint32_t ClockPrescaler;
+	uint32_t Resolution;
+	uint32_t DataAlign;
+	uint32_t ScanConvMode;
+	uint32_t EOCSelection;
+	FunctionalState ContinuousConvMode;
+	uint32_t NbrOfConversion;
+	FunctionalState DiscontinuousConvMode;
+	uint32_t NbrOfDiscConversion;
+	uint32_t ExternalTrigConv;
+	uint32_t ExternalTrigConvEdge;
+	FunctionalState DMAContinuousRequests;
+} ADC_InitTypeDef;
+
+typedef struct {
+	ADC_TypeDef *Instance;
+	ADC_InitTypeDef Init;
+	DMA_HandleTypeDef *DMA_Handle;
+	HAL_LockTypeDef Lock;
+	uint32_t State;
+	uint32_t ErrorCode;
+} ADC_HandleTypeDef;
+
+typedef struct {
+	uint32_t Channel;
+	uint32_t Rank;
+	uint32_t SamplingTime;
+	uint32_t Offset;
+} ADC_ChannelConfTypeDef;
+
+#define ADC_CLOCK_SYNC_PCLK_DIV4          0x00010000U
+#define ADC_RESOLUTION_12B                0x00000000U
+#define ADC_EXTERNALTRIGCONVEDGE_RISING   0x10000000U
+#define ADC_EXTERNALTRIGCONV_T2_TRGO      0x06000000U
+#define ADC_DATAALIGN_RIGHT               0x00000000U
+#define ADC_EOC_SEQ_CONV                  0x00000000U
+#define ADC_SAMPLETIME_480CYCLES          0x00000007U
+#define ADC_CHANNEL_0                     0x00000000U
+#define ADC_CHANNEL_3                     0x00000003U
+#define ADC_CHANNEL_10                    0x0000000AU
+#define ADC_CHANNEL_13                    0x0000000DU
+
+HAL_StatusTypeDef HAL_ADC_Init (ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_ConfigChannel (ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *config);
+HAL_StatusTypeDef HAL_ADC_Start_DMA (ADC_HandleTypeDef *hadc, uint32_t *datos, uint32_t longitud);
+void HAL_ADC_MspInit (ADC_HandleTypeDef *hadc);
+void HAL_ADC_ConvHalfCpltCallback (ADC_HandleTypeDef *hadc);
+void HAL_ADC_ConvCpltCallback (ADC_HandleTypeDef *hadc);
+
+/* RTC ----------------------------------------------------------------------*/
+typedef struct {
+	uint32_t HourFormat;
+	uint32_t AsynchPrediv;
+	uint32_t SynchPrediv;
+	uint32_t OutPut;
+	uint32_t OutPutPolarity;
+	uint32_t OutPutType;
+} RTC_InitTypeDef;
+
+typedef struct {
+	RTC_TypeDef *Instance;
+	RTC_InitTypeDef Init;
+	HAL_LockTypeDef Lock;
+	uint32_t State;
+} RTC_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_RTC_Init (RTC_HandleTypeDef *hrtc);
+void HAL_RTC_MspInit (RTC_HandleTypeDef *hrtc);
+
+#endif /* __STM32F4xx_HAL_H */
@@ -3,307 +3,561 @@
   * @file    Templates/Src/Thread.c
   * @author  MCD Application Team
   * @brief   Fichero que trata los distintas funciones de los hilos que se
-	*					 que se ejecutan en el RTOS. En este caso se encuentra el hilo app_main
-	*					 que lanza el hilo rebotes donde se manejan las acciones correspondientes
-	*					 a las pulsaciones y se gestionan los rebotes.
-	*					 Con las pulsaciones UP y DOWN se aumenta o disminuye la intensidad 
+	*					 que se ejecutan en el RTOS. El hilo app_main lanza una cadena de
+	*					 tres hilos con prioridades decrecientes:
+	*							- entrada (AboveNormal): gestiona los rebotes del joystick y los
+	*								cambios de los potenciometros y los convierte en eventos
+	*							- control (Normal): pasa los eventos a la maquina de estados del
+	*								LED RGB (Control.c), que actua sobre el LED
+	*							- salida (BelowNormal): envia por la USART los mensajes de la
+	*								maquina de estados y atiende los comandos del terminal
+	*
+	*					 Con las pulsaciones UP y DOWN se aumenta o disminuye la intensidad
 	*					 del LED RGB, con las pulsaciones LEFT y RIGHT se cambia el color y
 	*					 con la pulsacin central se enciende y se apaga.
 	*
+	*					 Los hilos se comunican con dos colas de mensajes. Politica cuando
+	*					 una cola esta llena:
+	*							- eventos: las pulsaciones esperan hasta PLAZO_COLA_MS a que el
+	*								hilo de control libere sitio; los cambios de potenciometro se
+	*								descartan, ya que el siguiente cambio los sustituye
+	*							- registros: se descarta el mensaje para que la USART (unos 87 us
+	*								por caracter) nunca retrase la respuesta del LED. El hilo de salida
+	*								indica cuantos mensajes se han perdido
+	*					 Cada cola guarda su ocupacion maxima y sus descartes (comando 'q').
+	*
+	*					 Con el LED encendido, tras INACTIVIDAD_MS sin eventos se funde a
+	*					 apagado (Efectos.c). Cualquier evento del usuario interrumpe los
+	*					 efectos en curso antes de llegar a la maquina de estados.
+	*
+	*					 El estado de la maquina se guarda en registros de backup tras cada
+	*					 evento y se restaura en main antes de arrancar el PLL (Arranque.c).
+	*
   * @note    modified by ARM
   *          The modifications allow to use this file as User Code Template
   *          within the Device Family Pack.
   ******************************************************************************
-  * 
+  *
   ******************************************************************************
   */
 
 
 #include "stdio.h"
+#include "string.h"
 #include "stm32f4xx_hal.h"
-#include "cmsis_os2.h"  
+#include "cmsis_os2.h"
 #include "USART.h"
 #include "joystick.h"
 #include "RGB.h"
 #include "Watchdog.h"
+#include "Latencia.h"
+#include "Metricas.h"
+#include "Traza.h"
+#include "Comandos.h"
+#include "Grabador.h"
+#include "Potenciometros.h"
+#include "Control.h"
+#include "Perfil.h"
+#include "Memoria.h"
+#include "Efectos.h"
+#include "Prioridades.h"
+#include "Reloj.h"
+#include "Arranque.h"
+#include "Fallo.h"
+#include "Autotest.h"
+#include "Energia.h"
+#include "Flujo.h"
+
+
+
+/*Senales del hilo de entrada: flancos de subida y bajada de cada boton de la placa*/
+#define SIG_SUBIDA(b)  (1U << (b))
+#define SIG_BAJADA(b)  (1U << ((b) + NUM_BOTONES))
+#define SIG_SUBIDAS    ((1U << NUM_BOTONES) - 1U)
+#define SIG_TODAS      ((1U << (2 * NUM_BOTONES)) - 1U)
+/*Senal de cambio en alguno de los potenciometros*/
+#define SIG_POT        (1U << (2 * NUM_BOTONES))
+
+/*Senales del hilo de salida: registro en la cola y caracter recibido por la USART*/
+#define SIG_REGISTRO   0x01U
+#define SIG_RX         0x02U
+
+/*Espera maxima de cada hilo. Fija el periodo de latido al supervisor del IWDG
+	y el tiempo que puede dormir el sistema sin eventos*/
+#define ESPERA_MS      100U
+/*Plazo de latido de cada hilo en el supervisor del IWDG*/
+#define PLAZO_HILO_MS  500U
 
+/*Espera maxima de una pulsacion con la cola de eventos llena. La profundidad de las
+	colas y la pila de los hilos se fijan en Memoria.h*/
+#define PLAZO_COLA_MS       20U
+/*Longitud maxima de un mensaje de la maquina de estados*/
+#define REGISTRO_LONGITUD   MEMORIA_TAM_registros
 
+/*Tiempo sin eventos hasta el apagado y duracion del fundido*/
+#define INACTIVIDAD_MS      60000U
+#define FUNDIDO_MS          2000U
+/*Semiperiodo del parpadeo y periodo del pulso lanzados desde el terminal*/
+#define PARPADEO_MS         250U
+#define PULSO_MS            2000U
 
-#define SIGLEFT    0x001
-#define SIGDOWN    0x002
-#define SIGRIGHT   0x004
-#define SIGUP 		 0x008
-#define SIGCENTER  0x010
-#define SIGBAJADAL 0X020
-#define SIGBAJADAR 0X040
-#define SIGBAJADAU 0X080
-#define SIGBAJADAD 0X100
-#define SIGBAJADAC 0X200
+typedef struct {
+	uint8_t evento;				/*Control_Evento*/
+	uint16_t valor;
+} Evento;
 
-int UP = 0;
-int DOWN = 0;
-int RIGHT = 0;
-int LEFT = 0;
-int CENTER = 0;
+typedef struct {
+	char texto[REGISTRO_LONGITUD];
+} Registro;
 
-int contUp = 0;
-int contDown = 0;
-int contRight = 0;
-int contLeft = 0;
-int contCenter = 0;
+COMPROBAR(sizeof(Evento) == MEMORIA_TAM_eventos, evento);
+COMPROBAR(sizeof(Registro) == MEMORIA_TAM_registros, registro);
 
-int modo = 0;
-int inten = 30000;
-int encender = 0;
+typedef struct {
+	osMessageQueueId_t id;
+	const char *nombre;
+	uint32_t max;										/*Mayor ocupacion observada*/
+	volatile uint32_t descartes;		/*Mensajes que no han cabido*/
+} Cola;
 
-__NO_RETURN static void rebotes (void *arg); 
-osThreadId_t tid_rebotes;    
+static Cola cola_eventos = { NULL, "eventos" };
+static Cola cola_registros = { NULL, "registros" };
+
+/*Estado (pulsado o no) de cada boton del joystick*/
+static uint8_t pulsado[NUM_BOTONES];
+
+/*Evento de la maquina de estados del LED asociado a cada boton*/
+static const Control_Evento evento_boton[NUM_BOTONES] = {
+	[BOTON_LEFT]   = EV_IZQUIERDA,
+	[BOTON_RIGHT]  = EV_DERECHA,
+	[BOTON_UP]     = EV_SUBIR,
+	[BOTON_DOWN]   = EV_BAJAR,
+	[BOTON_CENTER] = EV_CENTRAL,
+};
+
+static void mensaje_USART (const char *texto);
+
+/*Maquina de estados del LED RGB y sus salidas sobre la placa*/
+static const Control_Salidas salidas_RGB = {
+	encender_LED,
+	apagar_LED,
+	intensidad_LED,
+	tono_LED,
+	mensaje_USART
+};
+static Control control;
+
+__NO_RETURN static void entrada (void *arg);
+__NO_RETURN static void hilo_control (void *arg);
+__NO_RETURN static void salida (void *arg);
+static osThreadId_t tid_entrada;
+static osThreadId_t tid_control;
+static osThreadId_t tid_salida;
+static void flanco_Boton (int boton, int flanco);
+static int lanzar_Efecto (Efecto_Tipo tipo);
 
-#define APP_MAIN_STK_SZ (1024U)
-static uint64_t app_main_stk[APP_MAIN_STK_SZ / 8];
 const osThreadAttr_t app_main_attr = {
-  .stack_mem  = &app_main_stk[0],
-  .stack_size = sizeof(app_main_stk)
+  .name       = "app_main",
+  MEMORIA_HILO_ATTR(app_main)
+};
+
+static const osThreadAttr_t entrada_attr = {
+	.name       = "entrada",
+	MEMORIA_HILO_ATTR(entrada),
+	.priority   = osPriorityAboveNormal
+};
+
+static const osThreadAttr_t control_attr = {
+	.name       = "control",
+	MEMORIA_HILO_ATTR(control),
+	.priority   = osPriorityNormal
+};
+
+static const osThreadAttr_t salida_attr = {
+	.name       = "salida",
+	MEMORIA_HILO_ATTR(salida),
+	.priority   = osPriorityBelowNormal
+};
+
+static const osMessageQueueAttr_t eventos_attr = {
+	.name       = "eventos",
+	MEMORIA_COLA_ATTR(eventos)
+};
+
+static const osMessageQueueAttr_t registros_attr = {
+	.name       = "registros",
+	MEMORIA_COLA_ATTR(registros)
 };
 
 
 
 /**
-  * @brief Hilo main donde se crea el hilo responsable de la gestin de los rebotes
+  * @brief Hilo main donde se crean las colas y los hilos de entrada, control y salida
 	* @param arg
   * @retval None
   */
 __NO_RETURN void app_main (void *arg) {
-	
-	 tid_rebotes = osThreadNew (rebotes, NULL, NULL);
-	
+
+	 marca_Arranque(ARRANQUE_NUCLEO);
+	 /* Inicializacin de la USART (USART_BAUDIOS, 8 bits, un bit de stop, sin paridad
+	 *	 y sin control de flujo). Si se agotan los reintentos se sigue sin terminal*/
+	 FALLO_INTENTAR(USART, init_USART());
+	 marca_Arranque(ARRANQUE_USART);
+	 /*Se crea el hilo supervisor del IWDG y se informa si el ultimo reset lo provoco*/
+	 init_Supervisor();
+	 causa_Watchdog();
+	 causa_Fallo();
+	 cola_eventos.id = osMessageQueueNew(MEMORIA_NUM_eventos, sizeof(Evento), &eventos_attr);
+	 cola_registros.id = osMessageQueueNew(MEMORIA_NUM_registros, sizeof(Registro), &registros_attr);
+	 tid_salida = osThreadNew (salida, NULL, &salida_attr);
+	 tid_control = osThreadNew (hilo_control, NULL, &control_attr);
+	 tid_entrada = osThreadNew (entrada, NULL, &entrada_attr);
+	 /*Solo falla si los atributos no coinciden con la memoria reservada en Memoria.c*/
+	 if (init_Efectos() != 0 || cola_eventos.id == NULL || cola_registros.id == NULL ||
+			 tid_salida == NULL || tid_control == NULL || tid_entrada == NULL)
+		 (void)FALLO(HILOS, osError);
+	 /*Se crea el hilo de reproduccion de flancos grabados*/
+	 init_Grabador(flanco_Boton);
+	 /*Se inicia el muestreo de los potenciometros de brillo y tono*/
+	 init_Potenciometros(tid_entrada, SIG_POT);
+	 /*Se arranca la medida de la PWM del LED por captura (puentes de PLACA_AUTOTEST)*/
+	 init_Autotest();
+	 /*Las tramas del flujo de color se separan de los comandos en la recepcion*/
+	 init_Flujo();
+	 /*Los comandos del terminal despiertan al hilo de salida*/
+	 notificar_USART(tid_salida, SIG_RX);
+	 /*Con el RTX arrancado y todas las interrupciones habilitadas se comprueba el NVIC*/
+	 comprobar_Prioridades();
+	 /*Prueba de regresion del tiempo hasta la primera luz*/
+	 (void)comprobar_Arranque();
+
 	 osThreadExit();
 }
+
+/**
+  * @brief Funcion que introduce un mensaje en una cola y actualiza su ocupacion maxima.
+	*				 Las colas tienen varios productores (el fin del efecto de inactividad o los
+	*				 comandos del terminal), por lo que la estadistica se actualiza con el
+	*				 nucleo bloqueado.
+	* @param c: Cola
+	* @param msg: Mensaje a copiar en la cola
+	* @param plazo: Espera maxima si la cola esta llena (0: se descarta sin esperar)
+  * @retval 0 si se ha introducido, -1 si se ha descartado
+  */
+static int poner_Cola (Cola *c, const void *msg, uint32_t plazo){
+	uint32_t ocupacion;
+
+	if (osMessageQueuePut(c->id, msg, 0U, plazo) != osOK){
+		osKernelLock();
+		c->descartes++;
+		osKernelUnlock();
+		return -1;
+	}
+	osKernelLock();
+	ocupacion = osMessageQueueGetCount(c->id);
+	if (ocupacion > c->max)
+		c->max = ocupacion;
+	osKernelUnlock();
+	return 0;
+}
+
 /**
-  * @brief Hilo de gestin de los rebotes donde se realiza las acciones corespondientes en cada pulsacin.
-	*				 En este caso se realiza el aumento del contador de pulsacin y se enva el mensaje al terminal 
-	*				 a traves de la USART.
+  * @brief Funcion que envia un evento al hilo de control
+	* @param evento: Evento de la maquina de estados
+	* @param valor: Valor asociado (lectura del potenciometro)
+	* @param plazo: Espera maxima si la cola esta llena
+  * @retval None
+  */
+static void enviar_Evento (Control_Evento evento, uint16_t valor, uint32_t plazo){
+	Evento ev;
+
+	ev.evento = (uint8_t)evento;
+	ev.valor = valor;
+	(void)poner_Cola(&cola_eventos, &ev, plazo);
+}
+
+/**
+  * @brief Hilo de entrada donde se gestionan los rebotes de cada pulsacin y los cambios
+	*				 de los potenciometros. Cada pulsacin y cada cambio se convierte en un evento
+	*				 que se envia al hilo de control.
 	* @param arg
   * @retval None
   */
-static __NO_RETURN void rebotes (void *arg) {
-	
+static __NO_RETURN void entrada (void *arg) {
+
 	uint32_t flag;
-	char buf[100];
-	int size = 0;
-	
+	uint32_t boton;
+	uint32_t subidas;
+	uint32_t bajadas;
+	uint32_t cambios;
+
+	registrar_Watchdog("entrada", PLAZO_HILO_MS);
 
   while (1) {
-		
+
 		/*Se espera al envo de la seal desde la funcin de callback de las interrupciones del joystick*/
-		flag = osThreadFlagsWait (0x3FF, osFlagsWaitAny, 10);
+		flag = osThreadFlagsWait (SIG_TODAS | SIG_POT, osFlagsWaitAny, ESPERA_MS);
+		/*La espera borra todas las senales que devuelve y pueden llegar varias a la
+			vez, por lo que se atienden todos los bits de subida y de bajada*/
+		if ((flag & osFlagsError) != 0U)
+			flag = 0;
+		else
+			LATENCIA_MARCA(LAT_DESPIERTA);
 
-		
-		/*Se recibe seal de interrupcin en el flanco de subida de la pulsacin LEFT*/
-		if(flag == SIGLEFT){
-			/*Se realiza un delay de 20 ms para evitar los rebotes*/
-			osDelay(20);
-			/*Se activan las interrupciones por flanco de bajada en la pulsacion LEFT*/
-			IRQ_Fall_Enable(5);
-			/*Se limpia el flag generado por la seal de interrupcin en el flanco de subida de la pulsacin LEFT*/
-			osThreadFlagsClear(SIGLEFT);
-		}
-		
-		/*Se recibe seal de interrupcin en el flanco de subida de la pulsacin RIGHT*/
-		if(flag == SIGRIGHT){
-			/*Se realiza un delay de 20 ms para evitar los rebotes*/
+
+		/*Se recibe seal de interrupcin en el flanco de subida de una pulsacin*/
+		subidas = flag & SIG_SUBIDAS;
+		if(subidas != 0U){
+			/*Se realiza un delay de 20 ms para evitar los rebotes, comun a todos los
+				botones pulsados a la vez: cada uno sigue con su linea EXTI enmascarada
+				hasta que se rearma aqui*/
 			osDelay(20);
-			/*Se activan la interrupciones por flanco de bajada en la pulsacion RIGHT*/
-			IRQ_Fall_Enable(10);
-			/*Se limpia el flag generado por la seal de interrupcin en el flanco de subida de la pulsacin RIGHT*/
-			osThreadFlagsClear(SIGRIGHT);			
-		}
-		
-		/*Se recibe seal de interrupcin en el flanco de subida de la pulsacin DOWN*/
-		if(flag == SIGDOWN){
-			/*Se realiza un delay de 20 ms para evitar los rebotes*/
-			osDelay(20);	
-			/*Se activan las interrupciones por flanco de bajada en la pulsacion DOWN*/
-			IRQ_Fall_Enable(3);
-			/*Se limpia el flag generado por la seal de interrupcin en el flanco de subida de la pulsacin DOWN*/
-			osThreadFlagsClear(SIGDOWN);
+			while (subidas != 0U){
+				boton = __CLZ(__RBIT(subidas));
+				subidas &= subidas - 1U;
+				/*Una pulsacion mas corta que la espera se descarta como rebote: el boton ya
+					esta suelto y el flanco de bajada no llega*/
+				if (METRICAS_ENABLE && !reproduciendo_Grabador() &&
+						HAL_GPIO_ReadPin(joystick_botones[boton].Port, joystick_botones[boton].Pin) == GPIO_PIN_RESET)
+					METRICA_CONTAR(rebotes_filtrados);
+				/*Se activan las interrupciones por flanco de bajada en la pulsacion*/
+				IRQ_Fall_Enable(boton);
+				/*Se limpia el flag generado por la seal de interrupcin en el flanco de subida*/
+				osThreadFlagsClear(SIG_SUBIDA(boton));
+			}
 		}
-		
-		/*Se recibe seal de interrupcin en el flanco de subida de la pulsacin UP*/
-		if(flag == SIGUP){						
-			/*Se realiza un delay de 20 ms para evitar los rebotes*/
-			osDelay(20);						
-			/*Se activan las interrupciones por flanco de bajada en la pulsacion UP*/
-			IRQ_Fall_Enable(2);			
-			/*Se limpia el flag generado por la seal de interrupcin en el flanco de subida de la pulsacin UP*/
-			osThreadFlagsClear(SIGUP);
+
+		/*Se reciben seales de interrupcin en el flanco de bajada de las pulsaciones*/
+		bajadas = (flag >> NUM_BOTONES) & SIG_SUBIDAS;
+		while (bajadas != 0U){
+			boton = __CLZ(__RBIT(bajadas));
+			bajadas &= bajadas - 1U;
+			/*Se activan las interrupciones por flanco de subida en la pulsacion*/
+			IRQ_Rise_Enable(boton);
+			/*Se limpia el flag generado por la seal de interrupcin en el flanco de bajada*/
+			osThreadFlagsClear(SIG_BAJADA(boton));
+			/*Una pulsacion no se pierde salvo que el control este bloqueado PLAZO_COLA_MS*/
+			enviar_Evento(evento_boton[boton], 0, PLAZO_COLA_MS);
+			METRICA_CONTAR(pulsaciones);
 		}
-		
-		/*Se recibe seal de interrupcin en el flanco de subida de la pulsacin CENTER*/
-		if(flag == SIGCENTER){						
-			/*Se realiza un delay de 20 ms para evitar los rebotes*/
-			osDelay(20);						
-			/*Se activan las interrupciones por flanco de bajada en la pulsacion CENTER*/
-			IRQ_Fall_Enable(14);			
-			/*Se limpia el flag generado por la seal de interrupcin en el flanco de subida de la pulsacin LEFT*/
-			osThreadFlagsClear(SIGCENTER);
+
+		/*Se recibe senal de cambio en los potenciometros de brillo o tono*/
+		if((flag & SIG_POT) != 0U){
+			cambios = cambios_Potenciometros();
+			if ((cambios & (1U << POT_BRILLO)) != 0U)
+				enviar_Evento(EV_BRILLO, leer_Potenciometro(POT_BRILLO), 0);
+			if ((cambios & (1U << POT_TONO)) != 0U)
+				enviar_Evento(EV_TONO, leer_Potenciometro(POT_TONO), 0);
 		}
-		
-		/*Se recibe seal de interrupcin en el flanco de bajada de la pulsacin LEFT*/
-		if(flag == SIGBAJADAL){					
-			/*Se activan las interrupciones por flanco de subida en la pulsacion LEFT*/
-			IRQ_Rise_Enable(5);			
-			/*Se limpia el flag generado por la seal de interrupcin en el flanco de bajada de la pulsacin LEFT*/
-			osThreadFlagsClear(SIGBAJADAL);	
-			
-			/*Si esta encendido se realiza el cambio de color del LED RGB*/
-			if (encender == 1){
-				if (modo == 0){
-					apagar_LED_rojo();
-					encender_LED_verde(inten);
-					/*Se enva mensaje al terminal a traves de la USART indicando el color que se enciende*/
-					size = sprintf(buf,"\r Pulsacin izquierda: Se enciende LED verde\n");
-					tx_USART(buf, size);
-					modo = 2;
-				}
-				else if (modo == 1){
-					apagar_LED_azul();
-					encender_LED_rojo(inten);
-					/*Se enva mensaje al terminal a traves de la USART indicando el color que se enciende*/
-					size = sprintf(buf,"\r Pulsacin izquierda: Se enciende LED rojo\n");
-					tx_USART(buf, size);
-					modo = 0;
-				}
-				else if (modo == 2){
-					apagar_LED_verde();
-					encender_LED_azul(inten);
-					/*Se enva mensaje al terminal a traves de la USART indicando el color que se enciende*/
-					size = sprintf(buf,"\r Pulsacin izquierda: Se enciende LED azul\n");
-					tx_USART(buf, size);
-					modo = 1;
-				}	
-			}			 
-			
+
+		reset_Watchdog();
+  }
+}
+
+/**
+  * @brief Hilo de control que pasa cada evento recibido a la maquina de estados del
+	*				 LED RGB (Control.c), que decide la accin a realizar.
+	* @param arg
+  * @retval None
+  */
+static __NO_RETURN void hilo_control (void *arg) {
+	Evento ev;
+
+	init_Reloj();
+	registrar_Watchdog("control", PLAZO_HILO_MS);
+	/*Si se ha restaurado el LED encendido se cuenta su tiempo de inactividad*/
+	if (control.estado != EST_APAGADO)
+		lanzar_Efecto(EFECTO_APAGADO);
+
+	while (1) {
+		/*Mientras el flujo de color del PC tiene el LED los eventos se descartan*/
+		if (osMessageQueueGet(cola_eventos.id, &ev, NULL, ESPERA_MS) == osOK && !activo_Flujo()){
+			/*Solo las pulsaciones tienen una medida de latencia abierta*/
+			if (ev.evento < EV_BRILLO)
+				LATENCIA_MARCA(LAT_DECISION);
+			/*La actividad del usuario interrumpe los efectos antes de actuar sobre el LED*/
+			cancelar_Efectos();
+			despachar_Control(&control, (Control_Evento)ev.evento, ev.valor);
+			TRAZA_EVENTO(TRAZA_TRANSICION, ev.evento, control.estado);
+			/*Con el LED encendido se vuelve a contar el tiempo de inactividad*/
+			if (control.estado != EST_APAGADO)
+				lanzar_Efecto(EFECTO_APAGADO);
+			/*Se acumula la latencia de la pulsacion tratada*/
+			cerrar_Latencia();
+			/*Se conserva el nuevo estado para el siguiente arranque*/
+			guardar_Arranque(&control);
+			/*Con el LED ya actualizado se sube al nivel alto de reloj*/
+			actividad_Reloj();
 		}
-				
-		/*Se recibe seal de interrupcin en el flanco de bajada de la pulsacin RIGHT*/
-		if(flag == SIGBAJADAR){		
-			/*Se activan las interrupciones por flanco de subida en la pulsacion RIGHT*/
-			IRQ_Rise_Enable(10);		
-			/*Se limpia el flag generado por la seal de interrupcin en el flanco de bajada de la pulsacin RIGHT*/
-			osThreadFlagsClear(SIGBAJADAR);					
-			
-			/*Si esta encendido se realiza el cambio de color del LED RGB*/
-			if (encender == 1){
-				if (modo == 0){
-					apagar_LED_verde();
-					encender_LED_rojo(inten);
-					modo = 1;
-					/*Se enva mensaje al terminal a traves de la USART indicando el color que se enciende*/
-					size = sprintf(buf,"\r Pulsacin derecha: Se enciende LED rojo\n");
-					tx_USART(buf, size);
-				}
-				else if (modo == 1){
-					apagar_LED_rojo();
-					encender_LED_azul(inten);
-					/*Se enva mensaje al terminal a traves de la USART indicando el color que se enciende*/
-					size = sprintf(buf,"\r Pulsacin derecha: Se enciende LED azul\n");
-					tx_USART(buf, size);
-					modo = 2;
-				}
-				else if (modo == 2){
-					apagar_LED_azul();
-					encender_LED_verde(inten);
-					/*Se enva mensaje al terminal a traves de la USART indicando el color que se enciende*/
-					size = sprintf(buf,"\r Pulsacin derecha: Se enciende LED verde\n");
-					tx_USART(buf, size);
-					modo = 0;
-				}	
-			}			
+		else
+			periodico_Reloj();
+		/*Al empezar el flujo se retiran los efectos y al terminar se vuelve a mostrar
+			el estado de la maquina de estados*/
+		switch (periodico_Flujo()){
+			case FLUJO_INICIO:
+				cancelar_Efectos();
+				break;
+			case FLUJO_FIN:
+				for (int c = 0; c < NUM_LEDS; c++)
+					apagar_LED((Color)c);
+				mostrar_Control(&control);
+				if (control.estado != EST_APAGADO)
+					lanzar_Efecto(EFECTO_APAGADO);
+				break;
+			default:
+				break;
 		}
-				
-		/*Se recibe seal de interrupcin en el flanco de bajada de la pulsacin UP*/
-		if(flag == SIGBAJADAU){								
-			/*Se activan las interrupciones por flanco de subida en la pulsacion UP*/
-			IRQ_Rise_Enable(2);			
-			/*Se limpia el flag generado por la seal de interrupcin en el flanco de bajada de la pulsacin UP*/
-			osThreadFlagsClear(SIGBAJADAU);	
-			
-			/*Se cambia la intensidad del LED RGB*/
-			if (inten < 2000)
-				inten = 60010;
-			else
-				inten = inten - 20000;
-			if (modo == 0){
-				intensidad_LED_verde(inten);				
-			}
-			else if (modo == 1){
-				intensidad_LED_rojo(inten);
-			}
-			else if (modo == 2) { 
-				intensidad_LED_azul(inten);
-			}
-			
-			/*Se enva mensaje al terminal a traves de la USART indicando que se aumenta la intensidad*/
-			size = sprintf(buf,"\r Pulsacion UP: Se aumenta la intensidad \n");
-				tx_USART(buf, size);			
+		/*El modelo de consumo se evalua mientras el LED esta encendido o caliente*/
+		periodico_Energia();
+		reset_Watchdog();
+	}
+}
+
+/**
+  * @brief Hilo de salida que envia por la USART los mensajes de la maquina de estados
+	*				 y atiende los comandos del terminal. Es el de menor prioridad ya que
+	*				 cada caracter tarda cerca de 87 us a 115200 baudios (1 ms a 9600).
+	* @param arg
+  * @retval None
+  */
+static __NO_RETURN void salida (void *arg) {
+	Registro r;
+	char buf[50];
+	int size;
+	uint32_t descartes, notificados = 0;
+
+	registrar_Watchdog("salida", PLAZO_HILO_MS);
+
+	while (1) {
+		(void)osThreadFlagsWait(SIG_REGISTRO | SIG_RX, osFlagsWaitAny, ESPERA_MS);
+
+		while (osMessageQueueGet(cola_registros.id, &r, NULL, 0U) == osOK){
+			tx_USART(r.texto, (int)strlen(r.texto));
+			reset_Watchdog();
 		}
-				
-		/*Se recibe seal de interrupcin en el flanco de bajada de la pulsacin DOWN*/
-		if(flag == SIGBAJADAD){						
-			/*Se activan las interrupciones por flanco de subida en la pulsacion DOWN*/
-			IRQ_Rise_Enable(3);			
-			/*Se limpia el flag generado por la seal de interrupcin en el flanco de bajada de la pulsacin DOWN*/
-			osThreadFlagsClear(SIGBAJADAD);			
-			
-			/*Se cambia la intensidad del LED RGB*/
-			if (inten > 60000)
-				inten = 10;
-			else
-				inten = inten + 20000;
-			if (modo == 0){
-				intensidad_LED_verde(inten);
-			}
-			else if (modo == 1){
-				intensidad_LED_rojo(inten);
-			}
-			else if (modo == 2){ 
-				intensidad_LED_azul(inten);
-			}		
-			
-			/*Se enva mensaje al terminal a traves de la USART indicando que se disminuye la intensidad*/
-			size = sprintf(buf,"\r Pulsacion DOWN: Se disminuye la intensidad \n");
+		descartes = cola_registros.descartes;
+		if (descartes != notificados){
+			size = sprintf(buf, "\r [%u mensajes descartados]\n", (unsigned)(descartes - notificados));
 			tx_USART(buf, size);
+			notificados = descartes;
 		}
-				
-		/*Se recibe seal de interrupcin en el flanco de bajada de la pulsacin CENTER*/
-		if(flag == SIGBAJADAC){						
-			/*Se activan las interrupciones por flanco de subida en la pulsacion CENTER*/
-			IRQ_Rise_Enable(14);	
-			/*Se limpia el flag generado por la seal de interrupcin en el flanco de bajada de la pulsacin CENTER*/
-			osThreadFlagsClear(SIGBAJADAC);									
-					
-			/*Se enciende/apaga el LED RGB*/
-			if (encender == 0){
-				encender = 1;
-				modo = 0;
-				encender_LED_verde(inten);
-				/*Se enva mensaje al terminal a traves de la USART indicando que se ennciende el RGB*/
-				size = sprintf(buf,"\r Pulsacion Central: Se enciende el RGB \n");
-				tx_USART(buf, size);
-			}
-			else {
-				encender = 0;
-				apagar_LED_verde();
-				apagar_LED_azul();
-				apagar_LED_rojo();
-				/*Se enva mensaje al terminal a traves de la USART indicando que se apaga el RGB*/
-				size = sprintf(buf,"\r Pulsacion Central: Se apaga el RGB \n");
-				tx_USART(buf, size);
-			}
-		}
+
+		/*Se atienden los comandos del terminal y se da el latido al supervisor del IWDG*/
+		procesar_Comandos();
+		periodico_Perfil();
+		periodico_Autotest();
 		reset_Watchdog();
-  }
+	}
+}
+
+/**
+  * @brief Funcion de salida de mensajes de la maquina de estados. El mensaje se copia en
+	*				 la cola del hilo de salida sin esperar; si esta llena se descarta.
+	* @param texto: Mensaje terminado en '\0'
+  * @retval None
+  */
+static void mensaje_USART (const char *texto){
+	Registro r;
+
+	strncpy(r.texto, texto, REGISTRO_LONGITUD - 1U);
+	r.texto[REGISTRO_LONGITUD - 1U] = '\0';
+	if (poner_Cola(&cola_registros, &r, 0U) == 0)
+		osThreadFlagsSet(tid_salida, SIG_REGISTRO);
+}
+
+/**
+  * @brief Funcion que inicializa la maquina de estados del LED y le devuelve el estado
+	*				 que tenia antes del reset. Se llama desde main con los Timers ya
+	*				 inicializados y antes de arrancar el RTX, por lo que no se envian
+	*				 mensajes.
+	* @param None
+  * @retval None
+  */
+void restaurar_RGB (void){
+	init_Control(&control, &salidas_RGB, 30000);
+	if (restaurar_Arranque(&control) == 0)
+		mostrar_Control(&control);
+}
+
+/**
+  * @brief Funcion que muestra el LED con la intensidad de un paso de un efecto,
+	*				 respetando el color o el tono que tenga seleccionado.
+	* @param intensidad: Valor del CCR (65535 apagado)
+  * @retval None
+  */
+static void aplicar_RGB (int intensidad){
+	if (control.estado == EST_TONO)
+		tono_LED(control.tono, intensidad);
+	else
+		intensidad_LED(color_Control(&control), intensidad);
+}
+
+/**
+  * @brief Funcion que se ejecuta al terminar el fundido por inactividad. Se llama
+	*				 desde el hilo de temporizadores y pasa el apagado al hilo de control.
+	* @param None
+  * @retval None
+  */
+static void fin_Inactividad (void){
+	enviar_Evento(EV_INACTIVIDAD, 0, 0U);
+}
+
+/**
+  * @brief Funcion que inicia un efecto sobre el LED con su intensidad actual
+	* @param tipo: Parpadeo, pulso o apagado por inactividad
+  * @retval Identificador del efecto, -1 si no se ha podido iniciar
+  */
+static int lanzar_Efecto (Efecto_Tipo tipo){
+	Efecto e = {
+		.tipo = tipo,
+		.intensidad = control.intensidad,
+		.interrumpible = 1,
+		.aplicar = aplicar_RGB
+	};
+
+	if (tipo == EFECTO_PARPADEO)
+		e.periodo_ms = PARPADEO_MS;
+	else if (tipo == EFECTO_PULSO)
+		e.periodo_ms = PULSO_MS;
+	else {
+		e.periodo_ms = FUNDIDO_MS;
+		e.espera_ms = INACTIVIDAD_MS;
+		e.fin = fin_Inactividad;
+	}
+	return iniciar_Efecto(&e);
+}
+
+/**
+  * @brief Funciones de los comandos del terminal que inician un parpadeo o un pulso
+	*				 indefinido del LED. Se interrumpen con cualquier evento del usuario.
+	* @param None
+  * @retval None
+  */
+static void efecto_Terminal (Efecto_Tipo tipo){
+	if (control.estado == EST_APAGADO || lanzar_Efecto(tipo) < 0)
+		mensaje_USART("\r No se puede iniciar el efecto\n");
+}
+void parpadeo_RGB (void) { efecto_Terminal(EFECTO_PARPADEO); }
+void pulso_RGB (void)    { efecto_Terminal(EFECTO_PULSO); }
+
+/**
+  * @brief Funcion que envia por la USART la capacidad, la ocupacion maxima y los
+	*				 descartes de las colas entre hilos.
+	* @param None
+  * @retval None
+  */
+void informe_Colas (void){
+	static Cola * const colas[] = { &cola_eventos, &cola_registros };
+	char buf[100];
+	int size;
+
+	for (unsigned i = 0; i < sizeof(colas) / sizeof(colas[0]); i++){
+		size = sprintf(buf, "\r %s: capacidad=%u max=%u descartes=%u\n", colas[i]->nombre,
+									 (unsigned)osMessageQueueGetCapacity(colas[i]->id),
+									 (unsigned)colas[i]->max, (unsigned)colas[i]->descartes);
+		tx_USART(buf, size);
+		reset_Watchdog();
+	}
 }
 
 /**
@@ -314,70 +568,49 @@ static __NO_RETURN void rebotes (void *arg) {
   */
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 {
-	/*Gestin de la pulsacin UP*/
-	if( GPIO_Pin == GPIO_PIN_2){
-		/*Se deshabilitan las interrupciones de la pulsacin UP*/
-		HAL_NVIC_DisableIRQ(EXTI2_IRQn);
-		if(UP == 0)
-		{
-			UP = 1;
-			osThreadFlagsSet (tid_rebotes, SIGUP);
-		}	
-		else {
-			UP = 0;
-			osThreadFlagsSet (tid_rebotes, SIGBAJADAU);
-		}		
-}
-	if( GPIO_Pin == GPIO_PIN_3){
-		/*Se deshabilitan las interrupciones de la pulsacin DOWN*/
-		HAL_NVIC_DisableIRQ(EXTI3_IRQn);
-		if(DOWN == 0)
-		{
-			DOWN = 1;
-			osThreadFlagsSet (tid_rebotes, SIGDOWN);
-		}	
-		else {
-			DOWN = 0;
-			osThreadFlagsSet (tid_rebotes, SIGBAJADAD);
-		}		
-}
-	if( GPIO_Pin == GPIO_PIN_5){
-	 /*Se deshabilitan las interrupciones de la pulsacin LEFT*/
-	 HAL_NVIC_DisableIRQ(EXTI9_5_IRQn);
-		if(LEFT == 0)
-		{
-			LEFT = 1;
-			osThreadFlagsSet (tid_rebotes, SIGLEFT);
-		}	
-		else {
-			LEFT = 0;
-			osThreadFlagsSet (tid_rebotes, SIGBAJADAL);
-		}		
-}
-if( GPIO_Pin == GPIO_PIN_14){
-	 /*Se deshabilitan las interrupciones de la pulsacin CENTER*/
-	 HAL_NVIC_DisableIRQ(EXTI15_10_IRQn);
-		if(CENTER == 0)
-		{
-			CENTER = 1;
-			osThreadFlagsSet (tid_rebotes, SIGCENTER);
-		}	
-		else {
-			CENTER = 0;
-			osThreadFlagsSet (tid_rebotes, SIGBAJADAC);
-		}		
-}
-if( GPIO_Pin == GPIO_PIN_10){
-	 /*Se deshabilitan las interrupciones de la pulsacin RIGHT*/
-	 HAL_NVIC_DisableIRQ(EXTI15_10_IRQn);
-		if(RIGHT == 0)
-		{
-			RIGHT = 1;
-			osThreadFlagsSet (tid_rebotes, SIGRIGHT);
-		}	
-		else {
-			RIGHT = 0;
-			osThreadFlagsSet (tid_rebotes, SIGBAJADAR);
-		}		
+	/*Se obtiene el boton asociado a la linea EXTI a partir de la tabla de la placa*/
+	int boton = joystick_linea_boton[31U - __CLZ(GPIO_Pin)] - 1;
+
+	/*Durante la reproduccion de una traza se ignoran las pulsaciones reales*/
+	if (boton < 0 || reproduciendo_Grabador())
+		return;
+	/*La interrupcion alterna entre subida y bajada, por lo que el flanco es el
+		contrario del nivel actual*/
+	flanco_Boton(boton, !pulsado[boton]);
 }
+
+/**
+  * @brief Funcin que introduce un flanco de un boton en el hilo de entrada. Se llama
+	*				 desde la interrupcin EXTI o desde el hilo de reproduccin de flancos,
+	*				 de forma que un flanco reproducido sigue el mismo camino que uno real:
+	*				 con la linea EXTI enmascarada (rebote en curso) se pierde, y si no
+	*				 cambia el nivel del boton (grabacion que empieza a mitad de una
+	*				 pulsacion) se descarta.
+	* @param boton: Indice del boton en la tabla de la placa
+	* @param flanco: 1 si es de subida (pulsacion), 0 si es de bajada
+  * @retval None
+  */
+static void flanco_Boton (int boton, int flanco)
+{
+	uint32_t linea = joystick_botones[boton].Pin;
+	uint32_t primask = __get_PRIMASK();
+
+	/*Desde el hilo de reproduccion la mascara se comprueba y se modifica sin que
+		la interrumpa el hilo de entrada*/
+	__disable_irq();
+	if ((EXTI->IMR & linea) == 0U || pulsado[boton] == (uint8_t)(flanco != 0)){
+		__set_PRIMASK(primask);
+		return;
+	}
+	/*Se enmascara la linea EXTI del boton hasta que se gestione el rebote*/
+	EXTI->IMR &= ~linea;
+	pulsado[boton] = (uint8_t)(flanco != 0);
+	__set_PRIMASK(primask);
+	METRICA_CONTAR(flancos);
+	TRAZA_EVENTO(TRAZA_FLANCO, boton, pulsado[boton]);
+	grabar_Grabador(boton, pulsado[boton]);
+	if (pulsado[boton])
+		osThreadFlagsSet (tid_entrada, SIG_SUBIDA(boton));
+	else
+		osThreadFlagsSet (tid_entrada, SIG_BAJADA(boton));
 }
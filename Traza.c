@@ -0,0 +1,126 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Traza.c
+  * @author  MCD Application Team
+  * @brief   Fichero del buffer de trazas de la aplicacion y de su volcado por la
+	*					 USART (formato en Traza.h).
+	*
+	*					 El volcado de los 128 registros tarda unos 180 ms a 115200
+	*					 baudios, cerca de la ventana de 250 ms del IWDG, y unos 2 s con
+	*					 USART_BAUDIOS=9600, por lo que se envia por bloques refrescando
+	*					 el IWDG entre ellos. La traza se detiene durante el volcado para que los registros
+	*					 enviados no se sobrescriban; los eventos de ese intervalo se
+	*					 pierden. El decodificador del PC es Simulacion/rgb_traza.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#include "Traza.h"
+
+#if TRAZA_ENABLE && !TRAZA_EVENT_RECORDER
+
+#include "USART.h"
+#include "Watchdog.h"
+
+/*Registros enviados entre dos refrescos del IWDG (unos 270 ms)*/
+#define TRAZA_BLOQUE  16U
+
+Traza_Registro traza_buffer[TRAZA_REGISTROS];
+volatile uint32_t traza_total = 0;
+volatile uint32_t traza_activa = 0;
+
+/*Acumuladores del Fletcher-16 del volcado en curso*/
+static uint32_t suma_a, suma_b;
+
+/**
+  * @brief Funcion que habilita el contador de ciclos y la traza
+	* @param None
+  * @retval None
+  */
+void init_Traza (void){
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	traza_activa = 1;
+}
+
+/**
+  * @brief Funcion que envia bytes del volcado acumulando su Fletcher-16
+	* @param p: Datos
+	* @param n: Numero de bytes
+  * @retval None
+  */
+static void enviar (const uint8_t *p, uint32_t n){
+	for (uint32_t i = 0; i < n; i++){
+		suma_a = (suma_a + p[i]) % 255U;
+		suma_b = (suma_b + suma_a) % 255U;
+	}
+	tx_USART((char *)p, (int)n);
+}
+
+/**
+  * @brief Funcion que escribe una palabra en little-endian
+	* @param p: Destino
+	* @param v: Valor
+  * @retval None
+  */
+static void escribir_32 (uint8_t *p, uint32_t v){
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+  * @brief Funcion que envia por la USART el contenido del buffer de trazas
+	* @param None
+  * @retval None
+  */
+void volcar_Traza (void){
+	uint8_t buf[TRAZA_BLOQUE * sizeof(Traza_Registro)];
+	uint32_t total, num, primero, n;
+
+	traza_activa = 0;
+	total = traza_total;
+	num = (total < TRAZA_REGISTROS) ? total : TRAZA_REGISTROS;
+	primero = total - num;
+
+	buf[0] = 'T';
+	buf[1] = 'R';
+	tx_USART((char *)buf, 2);
+	suma_a = suma_b = 0;
+	buf[0] = TRAZA_VERSION;
+	buf[1] = (uint8_t)sizeof(Traza_Registro);
+	buf[2] = (uint8_t)num;
+	buf[3] = (uint8_t)(num >> 8);
+	escribir_32(&buf[4], total);
+	escribir_32(&buf[8], SystemCoreClock);
+	enviar(buf, 12);
+
+	/*Los registros se copian en little-endian campo a campo*/
+	for (uint32_t i = 0; i < num; i += n){
+		n = (num - i < TRAZA_BLOQUE) ? num - i : TRAZA_BLOQUE;
+		for (uint32_t j = 0; j < n; j++){
+			const Traza_Registro *r = &traza_buffer[(primero + i + j) & (TRAZA_REGISTROS - 1U)];
+			uint8_t *p = &buf[j * sizeof(Traza_Registro)];
+
+			escribir_32(p, r->id);
+			escribir_32(p + 4, r->ciclos);
+			escribir_32(p + 8, r->valor1);
+			escribir_32(p + 12, r->valor2);
+		}
+		enviar(buf, n * sizeof(Traza_Registro));
+		reset_Watchdog();
+	}
+
+	buf[0] = (uint8_t)suma_a;
+	buf[1] = (uint8_t)suma_b;
+	tx_USART((char *)buf, 2);
+	traza_activa = 1;
+}
+
+#endif
@@ -0,0 +1,134 @@
+/**
+  ******************************************************************************
+  * @file    Templates/Src/Traza.h
+  * @author  MCD Application Team
+  * @brief   Libreria de trazas de la aplicacion: flancos de los botones,
+	*					 transiciones de la maquina de estados del LED, escrituras de los
+	*					 CCR y envios por la USART. Cada evento se guarda en un buffer
+	*					 circular en RAM con la marca del contador de ciclos DWT CYCCNT.
+	*
+	*					 Los eventos siguen el formato del Event Recorder (EventRecord2): un
+	*					 identificador con el nivel, el componente y el mensaje, y dos
+	*					 valores de 32 bits. Su descripcion esta en Traza.scvd, que usa el
+	*					 visor de eventos de uVision si se enlaza el Event Recorder
+	*					 (TRAZA_EVENT_RECORDER a 1) y el decodificador del PC rgb_traza con
+	*					 el volcado del buffer propio (comando 'T'). En uVision el fichero se
+	*					 anade en Options for Target > Debug > Manage Component Viewer
+	*					 Description Files.
+	*
+	*					 La reserva de una posicion del buffer es un bucle LDREX/STREX, por
+	*					 lo que se puede trazar desde cualquier hilo o interrupcion sin
+	*					 bloqueos. Con TRAZA_ENABLE a 0 los eventos no generan codigo.
+  *
+  * @note    modified by ARM
+  *          The modifications allow to use this file as User Code Template
+  *          within the Device Family Pack.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __TRAZA_H
+#define __TRAZA_H
+
+#include "stm32f4xx_hal.h"
+
+/*Habilitacion de las trazas (0: sin coste en el camino critico)*/
+#ifndef TRAZA_ENABLE
+#define TRAZA_ENABLE 1
+#endif
+
+/*Envio de los eventos al Event Recorder en lugar de al buffer propio. Requiere
+	el componente CMSIS-View:Event Recorder en el RTE*/
+#ifndef TRAZA_EVENT_RECORDER
+#define TRAZA_EVENT_RECORDER 0
+#endif
+
+/*Registros del buffer (potencia de 2)*/
+#define TRAZA_REGISTROS  128U
+
+/*Identificadores de evento: nivel Op (0x20000), componente 0x01 y mensaje.
+	Deben coincidir con Traza.scvd*/
+#define TRAZA_ID(mensaje)  (0x20000U | (0x01U << 8) | (mensaje))
+#define TRAZA_FLANCO       TRAZA_ID(0x00U)		/*boton, nivel*/
+#define TRAZA_TRANSICION   TRAZA_ID(0x01U)		/*evento, estado nuevo*/
+#define TRAZA_CCR          TRAZA_ID(0x02U)		/*color, CCR*/
+#define TRAZA_LED_APAGADO  TRAZA_ID(0x03U)		/*color, 0*/
+#define TRAZA_USART_INICIO TRAZA_ID(0x04U)		/*bytes, 0*/
+#define TRAZA_USART_FIN    TRAZA_ID(0x05U)		/*bytes enviados, estado*/
+#define TRAZA_BENCH        TRAZA_ID(0x06U)		/*iteracion, 0 (comando 'B')*/
+#define TRAZA_AUTOTEST     TRAZA_ID(0x07U)		/*color, desviacion (Autotest.h)*/
+#define TRAZA_ENERGIA      TRAZA_ID(0x08U)		/*causa del limite, factor Q16 (Energia.h)*/
+#define TRAZA_FLUJO        TRAZA_ID(0x09U)		/*motivo, posicion o secuencia (Flujo.h)*/
+
+/*Bit del campo id de un registro que indica que se traza desde una interrupcion*/
+#define TRAZA_IRQ          0x80000000U
+
+/*Volcado (little-endian):
+		'T' 'R' version tam_registro num_registros(16) total(32) frecuencia_hz(32)
+		registro[num_registros] fletcher16(16)
+	Los registros van del mas antiguo al mas reciente; total es el numero de
+	eventos trazados desde el arranque. El Fletcher-16 se calcula desde la version
+	hasta el ultimo registro*/
+#define TRAZA_VERSION  1U
+
+typedef struct {
+	uint32_t id;					/*Identificador del evento y TRAZA_IRQ*/
+	uint32_t ciclos;			/*DWT CYCCNT*/
+	uint32_t valor1;
+	uint32_t valor2;
+} Traza_Registro;
+
+#if TRAZA_ENABLE && TRAZA_EVENT_RECORDER
+
+#include "EventRecorder.h"
+
+#define TRAZA_EVENTO(id, v1, v2)  ((void)EventRecord2((id), (uint32_t)(v1), (uint32_t)(v2)))
+
+#define init_Traza()    ((void)EventRecorderInitialize(EventRecordAll, 1U))
+#define volcar_Traza()  ((void)0)
+
+#elif TRAZA_ENABLE
+
+extern Traza_Registro traza_buffer[TRAZA_REGISTROS];
+extern volatile uint32_t traza_total;
+extern volatile uint32_t traza_activa;
+
+/**
+  * @brief Funcion que guarda un evento en el buffer circular sin bloqueos
+	* @param id: Identificador del evento
+	* @param v1: Primer valor
+	* @param v2: Segundo valor
+  * @retval None
+  */
+__STATIC_INLINE void traza_Evento (uint32_t id, uint32_t v1, uint32_t v2){
+	Traza_Registro *r;
+	uint32_t i;
+
+	if (traza_activa == 0U)
+		return;
+	do {
+		i = __LDREXW(&traza_total);
+	} while (__STREXW(i + 1U, &traza_total) != 0U);
+	r = &traza_buffer[i & (TRAZA_REGISTROS - 1U)];
+	r->ciclos = DWT->CYCCNT;
+	r->valor1 = v1;
+	r->valor2 = v2;
+	r->id = id | ((__get_IPSR() != 0U) ? TRAZA_IRQ : 0U);
+}
+
+#define TRAZA_EVENTO(id, v1, v2)  traza_Evento((id), (uint32_t)(v1), (uint32_t)(v2))
+
+void init_Traza (void);
+void volcar_Traza (void);
+
+#else
+
+#define TRAZA_EVENTO(id, v1, v2)  ((void)0)
+
+#define init_Traza()    ((void)0)
+#define volcar_Traza()  ((void)0)
+
+#endif
+
+#endif /* __TRAZA_H */
@@ -9,11 +9,19 @@
 	*							-Pin de rx: PD9
 	*
 	*					 La USART se ha configurado de la siguiente manera:
-	*							- Baudrate = 9600 baud
+	*							- Baudrate = USART_BAUDIOS (115200 baud por defecto)
 	*							- Word length = 8 bits
 	*							- Un bit de stop
 	*							- Sin bit de paridad
 	*							- Sin control de flujo
+	*					 El terminal del PC se abre a 115200 baudios (antes 9600, que se
+	*					 puede recuperar compilando con USART_BAUDIOS=9600 a costa de
+	*					 limitar el flujo de color a unas 60 tramas por segundo).
+	*
+	*					 La recepcion se relanza en la propia interrupcion: cada byte pasa
+	*					 por el filtro registrado (filtro_USART, el flujo de color de Flujo.h)
+	*					 y, si no lo consume, se guarda en un buffer circular para rx_USART.
+	*					 Asi no se pierden bytes aunque el hilo de salida tarde en leerlos.
   *
   * @note    modified by ARM
   *          The modifications allow to use this file as User Code Template
@@ -26,14 +34,65 @@
 
 #include "USART.h"
 #include "stm32f4xx.h" 
+#include "stm32f4xx_hal.h"
+#include "Metricas.h"
+#include "Traza.h"
+
+/*Velocidad de la USART3; el flujo de color a mas de 60 tramas por segundo
+	requiere 115200 (Flujo.h)*/
+#ifndef USART_BAUDIOS
+#define USART_BAUDIOS 115200U
+#endif
+
+/*Bytes del buffer de recepcion*/
+#define USART_RX_TAM  32U
 
 
 extern ARM_DRIVER_USART Driver_USART3;
 static ARM_DRIVER_USART * USARTdrv = &Driver_USART3;
 
+/*Byte en el que el driver deposita el caracter recibido*/
+static uint8_t rx_byte;
+
+/*Hilo al que se notifica la recepcion de un caracter*/
+static osThreadId_t hilo_rx = NULL;
+static uint32_t senal_rx;
+
+/*Filtro que recibe cada byte en la interrupcion antes que los comandos*/
+static int (*filtro_rx)(uint8_t byte) = NULL;
+
+/*Buffer circular de recepcion: escribe la interrupcion y lee rx_USART*/
+static uint8_t rx_buffer[USART_RX_TAM];
+static volatile uint32_t rx_escritura = 0;
+static volatile uint32_t rx_lectura = 0;
+
+/**
+  * @brief Callback del CMSIS Driver de la USART3 que relanza la recepcion, entrega
+	*				 el caracter al filtro y, si no lo consume, lo guarda en el buffer y
+	*				 avisa al hilo indicado en notificar_USART. Con el buffer lleno el
+	*				 caracter se pierde.
+	* @param event: Eventos del driver
+  * @retval None
+  */
+static void USART_Callback (uint32_t event){
+	uint8_t byte = rx_byte;
+
+	if ((event & ARM_USART_EVENT_RECEIVE_COMPLETE) == 0U)
+		return;
+	(void)USARTdrv->Receive(&rx_byte, 1);
+	if (filtro_rx != NULL && filtro_rx(byte))
+		return;
+	if (rx_escritura - rx_lectura < USART_RX_TAM){
+		rx_buffer[rx_escritura % USART_RX_TAM] = byte;
+		rx_escritura++;
+	}
+	if (hilo_rx != NULL)
+		osThreadFlagsSet(hilo_rx, senal_rx);
+}
+
 /**
   * @brief Funcin de inicializacin de la USART3 y habilitacin de la transmisin
-	*							- Baudrate = 9600 baud
+	*							- Baudrate = USART_BAUDIOS (115200 baud por defecto)
 	*							- Word length = 8 bits
 	*							- Un bit de stop
 	*							- Sin bit de paridad
@@ -46,27 +105,69 @@ int init_USART (void){
 		int status = 0;
 	
 		/*Inicializacin de la USART a traves de la funcin Initialize del CMSIS Driver de la USART*/
-		status =  USARTdrv->Initialize(NULL);
+		status =  USARTdrv->Initialize(USART_Callback);
 		if (status != 0) return status;
 	  /*Encendido del USART a traves de la funcin PowerControl del CMSIS Driver de la USART */
 		status =  USARTdrv->PowerControl(ARM_POWER_FULL);
 		if (status != 0) return status;
-    /*Configuracin de la USART a 9600 baudios con la funcion Control del CMSIS Driver de la USART */
+    /*Configuracin de la USART a USART_BAUDIOS con la funcion Control del CMSIS Driver de la USART */
 		status =   USARTdrv->Control(ARM_USART_MODE_ASYNCHRONOUS |
                       ARM_USART_DATA_BITS_8 |
                       ARM_USART_PARITY_NONE |
                       ARM_USART_STOP_BITS_1 |
-                      ARM_USART_FLOW_CONTROL_NONE, 9600);
+                      ARM_USART_FLOW_CONTROL_NONE, USART_BAUDIOS);
 		if (status != 0) return status;
 
      
 		/* Habilitacin de la lnea de transmisin a traves de la uncin Control del CMSIS Driver de la USART */
 		status =   USARTdrv->Control (ARM_USART_CONTROL_TX, 1);
 		if (status != 0) return status;
+
+		/* Habilitacion de la linea de recepcion y lanzamiento de la recepcion del primer caracter */
+		status =   USARTdrv->Control (ARM_USART_CONTROL_RX, 1);
+		if (status != 0) return status;
+		status =   USARTdrv->Receive (&rx_byte, 1);
+		if (status != 0) return status;
 	
 		return status;
 }
 
+/**
+  * @brief Funcion que indica el hilo y la senal que se activa al recibir un caracter,
+	*				 de forma que el hilo no tenga que consultar la USART periodicamente.
+	* @param hilo: Hilo al que se notifica la recepcion
+	* @param senal: Flag que se activa en el hilo
+	* @retval None
+  */
+void notificar_USART (osThreadId_t hilo, uint32_t senal){
+	senal_rx = senal;
+	hilo_rx = hilo;
+}
+
+/**
+  * @brief Funcion que registra el filtro por el que pasa cada caracter recibido en la
+	*				 interrupcion de la USART3, antes de llegar al buffer de rx_USART.
+	* @param filtro: Funcion que devuelve 1 si consume el caracter
+	* @retval None
+  */
+void filtro_USART (int (*filtro)(uint8_t byte)){
+	filtro_rx = filtro;
+}
+
+/**
+  * @brief Funcion que comprueba, sin bloquearse, si se ha recibido un caracter por la USART3.
+	*				 En caso afirmativo se devuelve el caracter mas antiguo del buffer.
+	* @param c: Puntero donde se guarda el caracter recibido
+	* @retval 1 si se ha recibido un caracter, 0 en caso contrario
+  */
+int rx_USART (char *c){
+	if (rx_lectura == rx_escritura)
+		return 0;
+	*c = (char)rx_buffer[rx_lectura % USART_RX_TAM];
+	rx_lectura++;
+	return 1;
+}
+
 /**
   * @brief Funcin que realiza el envo, de los datos recibidos por parametro, a traves de la USART3
 	*				 que devuelve el estado en el que ha finalizado la transimisin
@@ -76,17 +177,49 @@ int init_USART (void){
   */
 int tx_USART (char ch[], int size ){
 	int status = 0;
+	int i;
 	ARM_USART_STATUS st;
- 	for (int i = 0; i<size; i++){
+	uint32_t inicio = DWT->CYCCNT;
+
+	TRAZA_EVENTO(TRAZA_USART_INICIO, size, 0);
+ 	for (i = 0; i<size; i++){
 		/*Envo de datos por la USART*/
 		status = USARTdrv->Send((uint8_t *)&ch[i], 1);
 		if(status != 0) 
-			return status;
+			break;
 		
 		st = USARTdrv->GetStatus();
 		/* Espera necesaria a que se termine el envo de datos, que se visualiza en el bit TC del registro SR de la USART*/
 		while (st.tx_busy)		st = USARTdrv->GetStatus();
 	}
 	
+	/*Bytes enviados y tiempo que el hilo ha estado bloqueado en el envio*/
+	METRICA_SUMAR(usart_bytes, (uint32_t)i);
+	METRICA_HISTOGRAMA(usart_bloqueo_us, (DWT->CYCCNT - inicio) / (SystemCoreClock / 1000000U));
+	TRAZA_EVENTO(TRAZA_USART_FIN, i, status);
 	return status;
 }
+
+/**
+  * @brief Funcion que indica si la USART3 ha terminado de transmitir (bit TC), en
+	*				 cuyo caso se puede cambiar la frecuencia del sistema sin corromper
+	*				 ningun caracter.
+	* @param None
+	* @retval 1 si no hay transmision en curso, 0 en caso contrario
+  */
+int libre_USART (void){
+	return (USART3->SR & USART_SR_TC) != 0U;
+}
+
+/**
+  * @brief Funcion que recalcula el divisor de la USART3 con la frecuencia actual del
+	*				 APB1 tras un cambio de la frecuencia del sistema.
+	* @param None
+	* @retval None
+  */
+void reloj_USART (void){
+	if ((USART3->CR1 & USART_CR1_OVER8) != 0U)
+		USART3->BRR = UART_BRR_SAMPLING8(HAL_RCC_GetPCLK1Freq(), USART_BAUDIOS);
+	else
+		USART3->BRR = UART_BRR_SAMPLING16(HAL_RCC_GetPCLK1Freq(), USART_BAUDIOS);
+}
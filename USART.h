@@ -16,7 +16,13 @@
 #include <stdio.h>
 #include <string.h>
 #include "Driver_USART.h"
+#include "cmsis_os2.h"
  
 
 int init_USART (void);
 int tx_USART (char ch[], int size );
+int rx_USART (char *c);
+void notificar_USART (osThreadId_t hilo, uint32_t senal);
+void filtro_USART (int (*filtro)(uint8_t byte));
+int libre_USART (void);
+void reloj_USART (void);
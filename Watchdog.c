@@ -9,6 +9,12 @@
 	*					 32 y el reload a 250, ya que la frecuencia del reloj LSI es de 32 kHz.
 	*
 	*					 fiwdg = flsi / ((2^PR) * RL) = 32000 /(32*250) = 4 Hz
+	*
+	*					 El IWDG solo lo refresca el hilo supervisor, y unicamente si todos
+	*					 los hilos registrados con registrar_Watchdog han dado un latido
+	*					 (reset_Watchdog) dentro de su plazo. Si alguno lo incumple se
+	*					 guarda en los registros de backup del RTC cual ha sido y se deja
+	*					 de refrescar el IWDG, que reinicia el sistema.
 	*					
   *
   * @note    modified by ARM
@@ -19,8 +25,36 @@
   ******************************************************************************
   */
 	#include "Watchdog.h"
+	#include "USART.h"
+	#include "Memoria.h"
+	#include "Metricas.h"
 	
 IWDG_HandleTypeDef IwdgHandle;
+
+/*Marca de los registros de backup que indica un fallo registrado por el supervisor*/
+#define MARCA_FALLO   0xD0600000U
+
+typedef struct {
+	osThreadId_t hilo;
+	const char *nombre;
+	uint32_t plazo;
+	volatile uint32_t ultimo;		/*Tick del ultimo latido*/
+	uint32_t max;								/*Mayor intervalo entre latidos*/
+} Tarea;
+
+static Tarea tareas[WATCHDOG_MAX_TAREAS];
+static volatile uint32_t num_tareas = 0;
+
+/*Fallo del arranque anterior leido de los registros de backup*/
+static uint32_t fallo_anterior = 0;
+static uint32_t nombre_anterior;
+static uint32_t retraso_anterior;
+
+static const osThreadAttr_t supervisor_attr = {
+	.name = "supervisor",
+	MEMORIA_HILO_ATTR(supervisor),
+	.priority = osPriorityHigh
+};
 	
 
 /**
@@ -49,12 +83,181 @@ int init_Watchdog (){
 }
 
 /**
-	* @brief Funcin que realiza el reseteo de IWDG para que vuelva a comenzar la cuenta
-	*				 y no se resetee el sistema
+	* @brief Funcin que registra el latido del hilo que la llama. El IWDG lo refresca
+	*				 el supervisor cuando todos los hilos registrados estan dentro de su plazo.
+	*				 Antes de arrancar el sistema operativo se refresca el IWDG directamente.
 	*
   * @param None
   * @retval None
   */
 void reset_Watchdog (){
-	HAL_IWDG_Refresh(&IwdgHandle);
+	osThreadId_t hilo;
+	uint32_t ahora, intervalo;
+
+	/*Antes de arrancar el sistema operativo no hay supervisor*/
+	if (osKernelGetState() != osKernelRunning){
+		HAL_IWDG_Refresh(&IwdgHandle);
+		return;
+	}
+	hilo = osThreadGetId();
+	ahora = osKernelGetTickCount();
+	for (uint32_t i = 0; i < num_tareas; i++){
+		if (tareas[i].hilo == hilo){
+			intervalo = ahora - tareas[i].ultimo;
+			if (intervalo > tareas[i].max)
+				tareas[i].max = intervalo;
+			tareas[i].ultimo = ahora;
+			return;
+		}
+	}
+}
+
+/**
+	* @brief Funcion que registra el hilo que la llama en el supervisor. A partir de
+	*				 ese momento el hilo debe llamar a reset_Watchdog al menos una vez
+	*				 cada plazo_ms o el sistema se reinicia.
+	* @param nombre: Nombre de la tarea (los 4 primeros caracteres se guardan si falla)
+	* @param plazo_ms: Tiempo maximo entre latidos
+  * @retval Indice de la tarea, -1 si no caben mas tareas
+  */
+int registrar_Watchdog (const char *nombre, uint32_t plazo_ms){
+	int id = -1;
+
+	osKernelLock();
+	if (num_tareas < WATCHDOG_MAX_TAREAS){
+		id = (int)num_tareas;
+		tareas[id].hilo = osThreadGetId();
+		tareas[id].nombre = nombre;
+		tareas[id].plazo = plazo_ms;
+		tareas[id].ultimo = osKernelGetTickCount();
+		tareas[id].max = 0;
+		num_tareas = id + 1;
+	}
+	osKernelUnlock();
+	return id;
+}
+
+/**
+	* @brief Funcion que guarda en los registros de backup la tarea que ha incumplido
+	*				 su plazo, para poder consultarla tras el reset.
+	* @param id: Indice de la tarea
+	* @param retraso: Tiempo desde su ultimo latido
+  * @retval None
+  */
+static void guardar_Fallo (uint32_t id, uint32_t retraso){
+	uint32_t nombre = 0;
+
+	for (int i = 0; i < 4 && tareas[id].nombre[i] != '\0'; i++)
+		nombre |= (uint32_t)(uint8_t)tareas[id].nombre[i] << (8 * i);
+	HAL_PWR_EnableBkUpAccess();
+	WATCHDOG_BKP_NOMBRE = nombre;
+	WATCHDOG_BKP_RETRASO = retraso;
+	WATCHDOG_BKP_FALLO = MARCA_FALLO | id;
+}
+
+/**
+	* @brief Hilo supervisor que refresca el IWDG solo si todas las tareas registradas
+	*				 han dado un latido dentro de su plazo.
+	* @param arg
+  * @retval None
+  */
+static __NO_RETURN void supervisor (void *arg){
+	uint32_t ahora, retraso, margen;
+	uint32_t siguiente = osKernelGetTickCount();
+	int fallo, guardado = 0;
+
+	(void)arg;
+	while (1){
+		siguiente += WATCHDOG_PERIODO_MS;
+		osDelayUntil(siguiente);
+
+		ahora = osKernelGetTickCount();
+		fallo = -1;
+		margen = UINT32_MAX;
+		for (uint32_t i = 0; i < num_tareas; i++){
+			retraso = ahora - tareas[i].ultimo;
+			if (retraso > tareas[i].plazo){
+				fallo = (int)i;
+				break;
+			}
+			if (tareas[i].plazo - retraso < margen)
+				margen = tareas[i].plazo - retraso;
+			METRICA_MAXIMO(watchdog_retraso_max_ms, retraso);
+		}
+		if (fallo < 0){
+			/*Tiempo que le queda a la tarea mas ajustada en el ultimo refresco*/
+			METRICA_FIJAR(watchdog_margen_ms, margen);
+			HAL_IWDG_Refresh(&IwdgHandle);
+		}
+		else if (!guardado){
+			/*Se deja de refrescar el IWDG: el reset llega en menos de 250 ms*/
+			guardar_Fallo((uint32_t)fallo, ahora - tareas[fallo].ultimo);
+			guardado = 1;
+		}
+	}
+}
+
+/**
+	* @brief Funcion que recoge el fallo registrado antes del ultimo reset y crea el
+	*				 hilo supervisor. Se llama al arrancar el sistema operativo.
+	* @param None
+  * @retval 0 si se ha creado el supervisor, -1 en caso contrario
+  */
+int init_Supervisor (void){
+	/*Solo se tiene en cuenta el fallo si el ultimo reset lo ha provocado el IWDG*/
+	if (__HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST) && (WATCHDOG_BKP_FALLO & 0xFFFF0000U) == MARCA_FALLO){
+		fallo_anterior = WATCHDOG_BKP_FALLO;
+		nombre_anterior = WATCHDOG_BKP_NOMBRE;
+		retraso_anterior = WATCHDOG_BKP_RETRASO;
+	}
+	HAL_PWR_EnableBkUpAccess();
+	WATCHDOG_BKP_FALLO = 0;
+	__HAL_RCC_CLEAR_RESET_FLAGS();
+
+	if (osThreadNew(supervisor, NULL, &supervisor_attr) == NULL)
+		return -1;
+	return 0;
+}
+
+/**
+	* @brief Funcion que envia por la USART la tarea que provoco el ultimo reset del
+	*				 IWDG, si lo hubo.
+	* @param None
+  * @retval None
+  */
+void causa_Watchdog (void){
+	char buf[100];
+	int size;
+	char nombre[5];
+
+	if (fallo_anterior == 0U)
+		return;
+	for (int i = 0; i < 4; i++)
+		nombre[i] = (char)(nombre_anterior >> (8 * i));
+	nombre[4] = '\0';
+	size = sprintf(buf, "\r Reset por IWDG: tarea %u (%s) sin latido durante %u ms\n",
+								 (unsigned)(fallo_anterior & 0xFFFFU), nombre, (unsigned)retraso_anterior);
+	tx_USART(buf, size);
+}
+
+/**
+	* @brief Funcion que envia por la USART el estado de las tareas supervisadas:
+	*				 plazo, mayor intervalo entre latidos y tiempo desde el ultimo.
+	* @param None
+  * @retval None
+  */
+void informe_Watchdog (void){
+	char buf[100];
+	int size;
+	uint32_t ahora = osKernelGetTickCount();
+
+	causa_Watchdog();
+	reset_Watchdog();
+	for (uint32_t i = 0; i < num_tareas; i++){
+		size = sprintf(buf, "\r %s: plazo=%ums max=%ums ultimo=%ums\n", tareas[i].nombre,
+									 (unsigned)tareas[i].plazo, (unsigned)tareas[i].max,
+									 (unsigned)(ahora - tareas[i].ultimo));
+		tx_USART(buf, size);
+		reset_Watchdog();
+	}
 }
\ No newline at end of file
@@ -1,4 +1,19 @@
 #include "stm32f4xx_hal.h"
+#include "cmsis_os2.h"
+
+/*Numero maximo de hilos supervisados*/
+#define WATCHDOG_MAX_TAREAS   8
+/*Periodo de comprobacion del supervisor (ventana del IWDG: 250 ms)*/
+#define WATCHDOG_PERIODO_MS   100U
+
+/*Registros de backup del RTC que conservan tras el reset la tarea que incumplio su plazo*/
+#define WATCHDOG_BKP_FALLO    (RTC->BKP0R)
+#define WATCHDOG_BKP_NOMBRE   (RTC->BKP1R)
+#define WATCHDOG_BKP_RETRASO  (RTC->BKP2R)
 
 int init_Watchdog ();
 void reset_Watchdog ();
+int init_Supervisor (void);
+int registrar_Watchdog (const char *nombre, uint32_t plazo_ms);
+void causa_Watchdog (void);
+void informe_Watchdog (void);
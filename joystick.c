@@ -15,6 +15,10 @@
 	*					 emplea el pin PF2 en lugar del pin PC3 para la pulsacin UP debido 
 	*					 a que el la lnea de interrupcin para el pin 3 ya se encuentra ocupada
 	*					 para la pulsacin DOWN
+	*
+	*					 La tabla de botones se genera a partir de la lista PLACA_BOTONES de
+	*					 Placa.h, por lo que las funciones de este fichero no dependen de los
+	*					 pines concretos de la placa.
   * @note    modified by ARM
   *          The modifications allow to use this file as User Code Template
   *          within the Device Family Pack.
@@ -24,7 +28,36 @@
   */
 
 #include "joystick.h"
-#include "mbedAppBoard_PINOUT.h"
+
+/*Tabla de botones generada a partir de la descripcion de la placa*/
+#define JOYSTICK_BOTON(rol, puerto, pin, irq)	{puerto, (uint16_t)(1U << (pin)), irq},
+const Joystick_Boton joystick_botones[NUM_BOTONES] = {
+	PLACA_BOTONES(JOYSTICK_BOTON)
+};
+
+/*Boton asociado a cada linea EXTI mas uno (0: linea sin boton)*/
+#define JOYSTICK_LINEA(rol, puerto, pin, irq)	[pin] = BOTON_##rol + 1,
+const uint8_t joystick_linea_boton[16] = {
+	PLACA_BOTONES(JOYSTICK_LINEA)
+};
+
+/**
+  * @brief Funcion que configura el flanco de interrupcion de un boton
+	* @param boton: Indice del boton en la tabla de la placa
+	* @param modo: GPIO_MODE_IT_RISING o GPIO_MODE_IT_FALLING
+  * @retval None
+  */
+static void IRQ_Enable(int boton, uint32_t modo){
+
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	const Joystick_Boton *b = &joystick_botones[boton];
+
+	GPIO_InitStruct.Pin = b->Pin;
+	GPIO_InitStruct.Mode = modo;
+	GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+	HAL_GPIO_Init(b->Port, &GPIO_InitStruct);
+	HAL_NVIC_EnableIRQ(b->IRQn);
+}
 
 /**
   * @brief Funcion de inicializacion del los pulsadores del joystick y de 
@@ -34,130 +67,44 @@
   */
 void Init_GPIO(void)
 {
-  GPIO_InitTypeDef GPIO_InitStruct = {0};
+	for (int i = 0; i < NUM_BOTONES; i++){
+		/* GPIO Ports Clock Enable */
+		PLACA_GPIO_CLK_ENABLE(joystick_botones[i].Port);
 
-  /* GPIO Ports Clock Enable */
-  __HAL_RCC_GPIOF_CLK_ENABLE();
-  __HAL_RCC_GPIOB_CLK_ENABLE();
-
-  /*Configure GPIO pin Output Level */
-  HAL_GPIO_WritePin(GPIOF, SW_UP.IO | SW_RIGHT.IO | SW_CENTER.IO | SW_LEFT.IO | SW_DOWN.IO, GPIO_PIN_RESET);
-
-  /*Configure GPIO pins : UP_Pin DOWN_Pin LEFT_Pin RIGHT_Pin
-                           CENTER_Pin */
-  GPIO_InitStruct.Pin = SW_UP.IO|SW_RIGHT.IO|SW_LEFT.IO|SW_CENTER.IO
-                          |SW_DOWN.IO;
-  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
-  GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-  HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
-
-  /* Habilitacin de las interrupciones*/
-  HAL_NVIC_SetPriority(EXTI2_IRQn, 0, 0);
-  HAL_NVIC_EnableIRQ(EXTI2_IRQn);
-
-  HAL_NVIC_SetPriority(EXTI3_IRQn, 0, 0);
-  HAL_NVIC_EnableIRQ(EXTI3_IRQn);
-
-  HAL_NVIC_SetPriority(EXTI9_5_IRQn, 0, 0);
-  HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
-
-  HAL_NVIC_SetPriority(EXTI15_10_IRQn, 0, 0);
-  HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+		/* Habilitacin de las interrupciones por flanco de subida (prioridad en Prioridades.h)*/
+		IRQ_Enable(i, GPIO_MODE_IT_RISING);
+	}
+}
 
+/**
+  * @brief Funcion que activa las interrupciones por flanco de subida de un boton
+	* @param boton: Indice del boton en la tabla de la placa
+  * @retval None
+  */
+void IRQ_Rise_Enable(int boton){
+	IRQ_Enable(boton, GPIO_MODE_IT_RISING);
 }
 
-void IRQ_Rise_Enable(int pin){
-		
-	GPIO_InitTypeDef GPIO_InitStruct = {0};
-	
-	if (pin == 5){		
-		/*Se activan las interrupciones por flanco de bajada en la pulsacion LEFT*/
-		GPIO_InitStruct.Pin = SW_LEFT.IO;
-		GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
-		GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-		HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
-		HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
-	}
-	
-	if (pin == 10){
-		/*Se activan las interrupciones por flanco de bajada en la pulsacion RIGHT*/
-		GPIO_InitStruct.Pin = SW_RIGHT.IO;
-		GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
-		GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-		HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
-		HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
-	}
-	
-	if(pin == 3){
-		/*Se activan las interrupciones por flanco de bajada en la pulsacion RIGHT*/
-		GPIO_InitStruct.Pin = SW_DOWN.IO;
-		GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
-		GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-		HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
-		HAL_NVIC_EnableIRQ(EXTI3_IRQn);
-	}
-	if(pin == 2){				
-		/*Se activan las interrupciones por flanco de bajada en la pulsacion UP*/
-		GPIO_InitStruct.Pin = SW_UP.IO;
-		GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
-		GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-		HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
-		HAL_NVIC_EnableIRQ(EXTI2_IRQn);		
-	}
-	if(pin == 14){
-		/*Se activan las interrupciones por flanco de bajada en la pulsacion CENTER*/
-		GPIO_InitStruct.Pin = SW_CENTER.IO;
-		GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
-		GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-		HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
-		HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
-	}
+/**
+  * @brief Funcion que activa las interrupciones por flanco de bajada de un boton
+	* @param boton: Indice del boton en la tabla de la placa
+  * @retval None
+  */
+void IRQ_Fall_Enable(int boton){
+	IRQ_Enable(boton, GPIO_MODE_IT_FALLING);
 }
 
-void IRQ_Fall_Enable(int pin){
-	
-	GPIO_InitTypeDef GPIO_InitStruct = {0};
-	
-	if (pin == 5){
-		/*Se activan las interrupciones por flanco de bajada en la pulsacion LEFT*/
-		GPIO_InitStruct.Pin = SW_LEFT.IO;
-		GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
-		GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-		HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
-		HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
-	}
-	
-	if (pin == 10){
-		/*Se activan las interrupciones por flanco de bajada en la pulsacion RIGHT*/
-		GPIO_InitStruct.Pin = SW_RIGHT.IO;
-		GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
-		GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-		HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
-		HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
-	}
-	
-	if(pin == 3){
-		/*Se activan las interrupciones por flanco de bajada en la pulsacion RIGHT*/
-		GPIO_InitStruct.Pin = SW_DOWN.IO;
-		GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
-		GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-		HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
-		HAL_NVIC_EnableIRQ(EXTI3_IRQn);
-	}
-	if(pin == 2){				
-		/*Se activan las interrupciones por flanco de bajada en la pulsacion UP*/
-		GPIO_InitStruct.Pin = SW_UP.IO;
-		GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
-		GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-		HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
-		HAL_NVIC_EnableIRQ(EXTI2_IRQn);		
-	}
-	if(pin == 14){
-		/*Se activan las interrupciones por flanco de bajada en la pulsacion CENTER*/
-		GPIO_InitStruct.Pin = SW_CENTER.IO;
-		GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
-		GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-		HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
-		HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+/**
+  * @brief Funcion que atiende las lineas EXTI pendientes de una rutina de
+	*				 interrupcion, llamando al callback de cada una de ellas.
+	* @param lineas: Mascara de las lineas EXTI que comparten la interrupcion
+  * @retval None
+  */
+void EXTI_Despachar(uint32_t lineas){
+	uint32_t pendientes = EXTI->PR & lineas;
+
+	while (pendientes != 0U){
+		HAL_GPIO_EXTI_IRQHandler((uint16_t)(pendientes & (0U - pendientes)));
+		pendientes &= pendientes - 1U;
 	}
-}
\ No newline at end of file
+}
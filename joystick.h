@@ -1,6 +1,20 @@
 #include "stm32f4xx_hal.h"
+#include "Placa.h"
 
+typedef struct {
+	GPIO_TypeDef *Port;
+	uint16_t Pin;
+	IRQn_Type IRQn;
+} Joystick_Boton;
+
+/*Lineas EXTI que comparten rutina de interrupcion*/
+#define EXTI_LINEAS_9_5    0x03E0U
+#define EXTI_LINEAS_15_10  0xFC00U
+
+extern const Joystick_Boton joystick_botones[NUM_BOTONES];
+extern const uint8_t joystick_linea_boton[16];
 
 void Init_GPIO(void);
-void IRQ_Fall_Enable(int pin);
-void IRQ_Rise_Enable(int pin);
\ No newline at end of file
+void IRQ_Fall_Enable(int boton);
+void IRQ_Rise_Enable(int boton);
+void EXTI_Despachar(uint32_t lineas);
@@ -23,12 +23,16 @@
 	*					 del color azul (PF12) no poda generar la seal PWM se cammbi por el 
 	*					 pin PE13 que si dispone de Timer para generar la seal PWM.
 	*					 Las frecuencias de las seales PWM que se generan tienen una frecuencia 
-	*					 de 1.37 kHz y se modifica la intensidad al variar el ciclo de trabajo
+	*					 de 3906 Hz en todos los niveles de reloj y se modifica la intensidad al variar el ciclo de trabajo
 	*					 de la seal PWM. Para modificar el ciclo de trabajo se modifica el valor 
 	*					 del registro CCRx, donde x es el canal utilizado para generar la seal.
+	*					 Para mantener la frecuencia con el reloj de 16 MHz comun a todos los
+	*					 niveles el periodo es de 4096 cuentas, por lo que el CCR tiene 12 bits
+	*					 de resolucion en lugar de 16 (RGB.h).
 	*
-	*					 Se ha configurado la frecuencia del sistema a 180 MHz utilizando el PLL 
-	*					 con el HSI como fuente de reloj.
+	*					 Se arranca con la frecuencia del sistema a 160 MHz utilizando el PLL 
+	*					 con el HSI como fuente de reloj. En reposo se baja a 80 MHz y a 16 MHz
+	*					 con el HSI sin PLL (Reloj.c).
 	*
   *
   * @note    modified by ARM
@@ -45,6 +49,15 @@
 #include "joystick.h"
 #include "USART.h"
 #include "Watchdog.h"
+#include "Latencia.h"
+#include "Metricas.h"
+#include "Traza.h"
+#include "Reposo.h"
+#include "Perfil.h"
+#include "Prioridades.h"
+#include "Reloj.h"
+#include "Arranque.h"
+#include "Fallo.h"
 
 #ifdef _RTE_
 #include "RTE_Components.h"             // Component selection
@@ -59,19 +72,23 @@
   */
 uint32_t HAL_GetTick (void) {
   static uint32_t ticks = 0U;
-         uint32_t i;
+  static uint32_t ciclo = 0U;
+  static uint32_t resto = 0U;
+         uint32_t ahora;
 
   if (osKernelGetState () == osKernelRunning) {
     return ((uint32_t)osKernelGetTickCount ());
   }
 
-  /* If Kernel is not running wait approximately 1 ms then increment 
-     and return auxiliary tick counter value */
-  for (i = (SystemCoreClock >> 14U); i > 0U; i--) {
-    __NOP(); __NOP(); __NOP(); __NOP(); __NOP(); __NOP();
-    __NOP(); __NOP(); __NOP(); __NOP(); __NOP(); __NOP();
-  }
-  return ++ticks;
+  /* Sin el RTX los milisegundos se cuentan con el contador de ciclos DWT
+     (init_Arranque). La version por defecto esperaba 1 ms en cada llamada,
+     lo que alargaba cada espera de la HAL durante el arranque */
+  ahora = DWT->CYCCNT;
+  resto += ahora - ciclo;
+  ciclo = ahora;
+  ticks += resto / (SystemCoreClock / 1000U);
+  resto %= (SystemCoreClock / 1000U);
+  return ticks;
 }
 
 #endif
@@ -82,7 +99,6 @@ uint32_t HAL_GetTick (void) {
 
 /* Private function prototypes -----------------------------------------------*/
 static void SystemClock_Config(void);
-static void Error_Handler(int fallo);
 
 
 /**
@@ -92,9 +108,17 @@ static void Error_Handler(int fallo);
   */
 int main(void)
 {
-	/*Inicializacin del IWDG*/
-	if (init_Watchdog() != 0)
-			Error_Handler(5);
+	/*Inicializacion del contador de ciclos para las sondas de latencia*/
+	init_Latencia();
+	/*Inicializacion del contador de ciclos para el registro de metricas*/
+	init_Metricas();
+	/*Inicializacion del buffer de trazas de la aplicacion*/
+	init_Traza();
+	/*Inicializacion de la medida de CPU por hilo e interrupcion*/
+	init_Perfil();
+	/*Marca de inicio de la medida de las fases del arranque*/
+	init_Arranque();
+
   /* STM32F4xx HAL library initialization:
        - Configure the Flash prefetch, Flash preread and Buffer caches
        - Systick timer is configured by default as source of time base, but user 
@@ -104,30 +128,40 @@ int main(void)
              handled in milliseconds basis.
        - Low Level Initialization
      */
-  if (HAL_Init() != HAL_OK)
-		Error_Handler(0);
+  FALLO_INTENTAR(HAL, HAL_Init());
+	marca_Arranque(ARRANQUE_HAL);
+
+	/*Prioridades de todas las interrupciones segun el mapa de Prioridades.h*/
+	init_Prioridades();
 
-  /* Configure the system clock to 180 MHz */
+	/*Inicializacin del RGB con el HSI y restauracion del ultimo estado del LED. Es
+		lo primero que ve el usuario, por lo que se hace antes de arrancar el PLL*/
+	FALLO_INTENTAR(RGB, initRGB());
+	restaurar_RGB();
+	marca_Arranque(ARRANQUE_LED);
+
+  /* Configure the system clock to 160 MHz (nivel ALTO de Reloj.h) */
   SystemClock_Config();
   SystemCoreClockUpdate();
+	/*Los prescalers de la PWM se calcularon con el HSI*/
+	reloj_RGB();
+	marca_Arranque(ARRANQUE_RELOJ);
+
+	/*Inicializacin del IWDG*/
+	FALLO_INTENTAR(WATCHDOG, init_Watchdog());
+	marca_Arranque(ARRANQUE_WATCHDOG);
 
 	/*Inicializacin del joystick*/
 	Init_GPIO();
+	marca_Arranque(ARRANQUE_GPIO);
 	
-	/*Inicializacin del RGB*/
-	if (initRGB() != HAL_OK)
-		Error_Handler(4);
-	
-	/* Inicializacin de la USART a traves de la funcin init_USART de la libreria USART
-	*	 y habilitacin de la transmisin
-	*							- Baudrate = 9600 baud
-	*							- Word length = 8 bits
-	*							- Un bit de stop
-	*							- Sin bit de paridad
-	*							- Sin control de flujo
-	*/
-	if (init_USART() != 0)
-		Error_Handler(2);
+	/*Inicializacion del RTC y de la calibracion del LSI para el reposo sin SysTick.
+		La USART se inicializa en app_main, ya que nada la usa antes del RTX*/
+	FALLO_INTENTAR(REPOSO, init_Reposo());
+	/*Sin el RTC no hay despertador: el reposo se limita a WFI con el SysTick*/
+	if (seguro_Fallo(FALLO_REPOSO))
+		profundidad_Reposo(REPOSO_WFI);
+	marca_Arranque(ARRANQUE_REPOSO);
 
 #ifdef RTE_CMSIS_RTOS2
   /* Initialize CMSIS-RTOS2 */
@@ -151,16 +185,16 @@ int main(void)
   * @brief  System Clock Configuration
   *         The system Clock is configured as follow : 
   *            System Clock source            = PLL (HSI)
-  *            SYSCLK(Hz)                     = 180000000
-  *            HCLK(Hz)                       = 180000000
+  *            SYSCLK(Hz)                     = 160000000
+  *            HCLK(Hz)                       = 160000000
   *            AHB Prescaler                  = 1
   *            APB1 Prescaler                 = 4
   *            APB2 Prescaler                 = 2
   *            HSI Frequency(Hz)              = 16000000
   *            PLL_M                          = 8
-  *            PLL_N                          = 180
+  *            PLL_N                          = 160
   *            PLL_P                          = 2
-  *            PLL_Q                          = 4
+  *            PLL_Q                          = 7
   *            VDD(V)                         = 3.3
   *            Main regulator output voltage  = Scale1 mode
   *            Flash Latency(WS)              = 5
@@ -178,36 +212,29 @@ void SystemClock_Config(void)
   __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
 	
   /** Se configura el HSI como fuente de reloj del PLL y se configuran
-	* 	los parametros del PLL para ajusta la frecuencia a 180 MHz con una
-	* 	frecuencia del HSI de 16 MHZ (por defecto).
-	* 	SYSCLK =[(16MHz(frecuencia HSI)/8(PLLM))*180 (PLLN)]/2 (PLLP) = 180 MHz
+	* 	los parametros del PLL para ajusta la frecuencia a 160 MHz con una
+	* 	frecuencia del HSI de 16 MHZ (por defecto). El VCO es comun a los niveles
+	* 	con PLL de Reloj.h, que solo cambian el PLLP.
+	* 	SYSCLK =[(16MHz(frecuencia HSI)/8(PLLM))*160 (PLLN)]/2 (PLLP) = 160 MHz
   */
   RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSI;
   RCC_OscInitStruct.HSIState = RCC_HSI_ON;
   RCC_OscInitStruct.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
   RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
   RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSI;
-  RCC_OscInitStruct.PLL.PLLM = 8;
-  RCC_OscInitStruct.PLL.PLLN = 180;
+  RCC_OscInitStruct.PLL.PLLM = RELOJ_PLLM;
+  RCC_OscInitStruct.PLL.PLLN = RELOJ_PLLN;
   RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
-  RCC_OscInitStruct.PLL.PLLQ = 4;
-  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
-  {
-    Error_Handler(1);
-  }
-  /** Se activa el modo de Over Drive para poder alcanzar los 180 MHz
-	* 	como frecuencia del sistema
+  RCC_OscInitStruct.PLL.PLLQ = RELOJ_PLLQ;
+  FALLO_INTENTAR(RELOJ, HAL_RCC_OscConfig(&RCC_OscInitStruct));
+  /** A 160 MHz no hace falta el modo de Over Drive (Scale1 llega a 168 MHz)
   */
-  if (HAL_PWREx_EnableOverDrive() != HAL_OK)
-  {
-    Error_Handler(1);
-  }
   /** Se selecciona el PLL como fuente de reloj del sistema y se configuran los parametros
 	*		para configurar el HCLK, PCLK1 y PCLK2. La frecuencia mxima del HCLK es 180 MHZ, la 
 	*		frecuencia mxima del PCLK1 es de 45 MHZ y la frecuencia mxima del PCLK2 es de 90 MHz
-	*		HCLK = SYSCK/AHB = 180 MHz / 1 = 180 MHz
-	*		PCLK1 = HCLK/APB1 = 180 MHz / 4 = 45 MHZ
-	*		PCLK2 = HCLK/APB2 = 180 MHz / 2 = 90 MHZ
+	*		HCLK = SYSCK/AHB = 160 MHz / 1 = 160 MHz
+	*		PCLK1 = HCLK/APB1 = 160 MHz / 4 = 40 MHZ
+	*		PCLK2 = HCLK/APB2 = 160 MHz / 2 = 80 MHZ
   */
   RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
                               |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
@@ -216,45 +243,7 @@ void SystemClock_Config(void)
   RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
   RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
 
-  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5) != HAL_OK)
-  {
-    Error_Handler(1);
-  }
-}
-
-/**
-  * @brief  This function is executed in case of error occurrence.
-  * @param  None
-  * @retval None
-  */
-static void Error_Handler(int fallo)
-{
-	char buf [100];
-	
-  if(fallo == 0)
-		/* Mensaje si se ha producido un error en la inicializacn de la librera HAL*/
-		printf(buf,"\r Se ha producido un error al inicializar la librera HAL\n");
-	else if (fallo == 1)
-		/* Mensaje si se ha producido un error en la inicializacn del reloj del sistema*/
-		printf(buf,"\r Se ha producido un error al inicializar el reloj del sistema\n");
-	else if(fallo == 2)
-		/* Mensaje si se ha producido un error en la inicializacn de la USART*/
-		printf(buf,"\r Se ha producido un error al inicializar la USART\n");
-	else if (fallo == 3)
-		/* Mensaje si se ha producido un error en el envo de datos de la USART*/
-		printf(buf,"\r Se ha producido un error al enviar datos por la USART\n");
-	else if (fallo == 4)
-		/* Mensaje si se ha producido un error en la inicializacin del RGB*/
-		printf(buf,"\r Se ha producido un error al inicializar el RGB\n");
-	else if (fallo == 5)
-		/* Mensaje si se ha producido un error en la inicializacin del Watchdog*/
-		printf(buf,"\r Se ha producido un error al inicializar el Watchdog\n");
- 
-  while(1)
-  {
-  }
+  FALLO_INTENTAR(RELOJ, HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_5));
 }
 
-
-
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
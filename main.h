@@ -51,10 +51,12 @@
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
   void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
-	void Error_Handler(int fallo);
-extern uint64_t app_main_stk[];
 extern const osThreadAttr_t app_main_attr;/* Exported macro ------------------------------------------------------------*/
 extern void app_main (void *arg); 
+extern void informe_Colas (void);
+extern void parpadeo_RGB (void);
+extern void pulso_RGB (void);
+extern void restaurar_RGB (void);
 
 
 	/* Exported thread functions,  
@@ -6,35 +6,78 @@
 #include "stm32f4xx_hal_gpio.h"
 
 
-typedef struct {
-	GPIO_TypeDef *Port;
-	__IO uint16_t IO;
-} GPIO;
+/* Conexionado de la mbed application shield. PIN(nombre, puerto, pin) */
 																							// Arduino Uno V3 CN7 & CN8 connectors TOP to BOTTOM
+#define MBED_APP_SHIELD_PINES(PIN) \
+	PIN(XBEE_Tx, 			GPIOG, 9)			/*	D0 */ \
+	PIN(XBEE_Rx, 			GPIOG, 14)		/*	D1 */ \
+	PIN(XBEE_STATUS, 	GPIOF, 15)		/*	D2 */ \
+	PIN(XBEE_NRST, 		GPIOE, 13)		/*	D3 */ \
+	PIN(SW_CENTER, 		GPIOF, 14)		/*	D4 */ \
+	PIN(LED_RED, 			GPIOE, 11)		/*	D5 */ \
+	PIN(SPEAKER, 			GPIOE, 9)			/*	D6 */ \
+	PIN(LCD_A0, 			GPIOF, 13)		/*	D7 */ \
+	PIN(LED_BLUE, 		GPIOF, 12)		/*	D8 */ \
+	PIN(LED_GREEN, 		GPIOD, 15)		/*	D9 */ \
+	PIN(LCD_CS_N, 		GPIOD, 14)		/*	D10 */ \
+	PIN(LCD_MOSI, 		GPIOA, 7)			/*	D11 */ \
+	PIN(LCD_RESET, 		GPIOA, 6)			/*	D12 */ \
+	PIN(LCD_SCK, 			GPIOA, 5)			/*	D13 */ \
+	PIN(SDA, 					GPIOB, 9)			/*	D14 */ \
+	PIN(SCL, 					GPIOB, 8)			/*	D15 */ \
+	PIN(SW_RIGHT, 		GPIOF, 10)		/*	A5 */ \
+	PIN(SW_LEFT, 			GPIOF, 5)			/*	A4 */ \
+	PIN(SW_DOWN, 			GPIOF, 3)			/*	A3 */ \
+	PIN(SW_UP, 				GPIOF, 2)			/*	A2 */ \
+	PIN(POT_2, 				GPIOC, 0)			/*	A1 */ \
+	PIN(POT_3, 				GPIOA, 3)			/*	A0 */
 
-GPIO XBEE_Tx 			= {GPIOG, GPIO_PIN_9};			//	D0
-GPIO XBEE_Rx 			= {GPIOG, GPIO_PIN_14};			//	D1
-GPIO XBEE_STATUS 	= {GPIOF, GPIO_PIN_15};			//	D2
-GPIO XBEE_NRST 		= {GPIOE, GPIO_PIN_13};			//	D3
-GPIO SW_CENTER 		= {GPIOF, GPIO_PIN_14};			//	D4
-GPIO LED_RED 			= {GPIOE, GPIO_PIN_11};			//	D5
-GPIO SPEAKER 			= {GPIOE, GPIO_PIN_9};			//	D6
-GPIO LCD_A0 			= {GPIOF, GPIO_PIN_13};			//	D7
-GPIO LED_BLUE 		= {GPIOF, GPIO_PIN_12};			//	D8
-GPIO LED_GREEN 		= {GPIOD, GPIO_PIN_15};			//	D9
-GPIO LCD_CS_N 		= {GPIOD, GPIO_PIN_14};			//	D10
-GPIO LCD_MOSI 		= {GPIOA, GPIO_PIN_7};			//	D11
-GPIO LCD_RESET 		= {GPIOA, GPIO_PIN_6};			//	D12
-GPIO LCD_SCK 			= {GPIOA, GPIO_PIN_5};			//	D13
-GPIO SDA 					= {GPIOB, GPIO_PIN_9};			//	D14
-GPIO SCL 					= {GPIOB, GPIO_PIN_8}; 			//	D15
-
-GPIO SW_RIGHT 		= {GPIOF, GPIO_PIN_10};			//	A5
-GPIO SW_LEFT 			= {GPIOF, GPIO_PIN_5};			//	A4
-GPIO SW_DOWN 			= {GPIOF, GPIO_PIN_3};			//	A3
-GPIO SW_UP 				= {GPIOF, GPIO_PIN_2};			//	A2
-GPIO POT_2 				= {GPIOC, GPIO_PIN_0};			//	A1
-GPIO POT_3 				= {GPIOA, GPIO_PIN_3};			//	A0
-
-
-#endif
\ No newline at end of file
+
+/* Descripcion de la placa que utiliza el firmware. Los drivers del joystick y
+ * del LED RGB generan sus tablas a partir de estas listas, por lo que para
+ * llevar el firmware a otra revision de la placa basta con definir PLACA_PINOUT
+ * con otro fichero que contenga las mismas listas.
+ *
+ * Joystick: BOTON(rol, puerto, pin, IRQn). El orden de la lista define el
+ * indice de cada boton y el bit de su senal en el hilo de entrada.
+ * Se emplea el pin PF2 en lugar del PC3 para la pulsacion UP ya que la linea
+ * de interrupcion 3 la utiliza la pulsacion DOWN.
+ */
+#define PLACA_BOTONES(BOTON) \
+	BOTON(LEFT,   GPIOF, 5,  EXTI9_5_IRQn)   \
+	BOTON(DOWN,   GPIOF, 3,  EXTI3_IRQn)     \
+	BOTON(RIGHT,  GPIOF, 10, EXTI15_10_IRQn) \
+	BOTON(UP,     GPIOF, 2,  EXTI2_IRQn)     \
+	BOTON(CENTER, GPIOF, 14, EXTI15_10_IRQn)
+
+/* Timers que generan las senales PWM: TIMER(numero) */
+#define PLACA_TIMERS(TIMER) \
+	TIMER(1) \
+	TIMER(4)
+
+/* LED RGB: LED(color, puerto, pin, timer, canal, funcion alternativa).
+ * El pin del LED azul (PF12) no dispone de Timer por lo que se usa el PE13.
+ */
+#define PLACA_LEDS(LED) \
+	LED(ROJO,  GPIOE, 11, 1, 2, GPIO_AF1_TIM1) \
+	LED(VERDE, GPIOD, 15, 4, 4, GPIO_AF2_TIM4) \
+	LED(AZUL,  GPIOE, 13, 1, 3, GPIO_AF1_TIM1)
+
+/* Potenciometros: POT(funcion, puerto, pin, canal del ADC1) */
+#define PLACA_POTS(POT) \
+	POT(BRILLO, GPIOC, 0, ADC_CHANNEL_10) \
+	POT(TONO,   GPIOA, 3, ADC_CHANNEL_3)
+
+/* Autotest de la PWM del LED (Autotest.h): CAPTURA(color, puerto, pin). Cada pin
+ * se une con un puente al pin del LED de su color. Todos son el canal 1 del TIM3
+ * (funcion alternativa PLACA_AUTOTEST_AF), que se conecta a uno de ellos cada vez.
+ * El PA6 es el reset del LCD de la shield, que el firmware no utiliza.
+ */
+#define PLACA_AUTOTEST_AF  GPIO_AF2_TIM3
+#define PLACA_AUTOTEST(CAPTURA) \
+	CAPTURA(ROJO,  GPIOA, 6) \
+	CAPTURA(VERDE, GPIOB, 4) \
+	CAPTURA(AZUL,  GPIOC, 6)
+
+
+#endif
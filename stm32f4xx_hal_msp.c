@@ -45,6 +45,10 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_hal.h"
+#include "RGB.h"
+#include "Potenciometros.h"
+#include "Reposo.h"
+#include "Autotest.h"
 
 /** @addtogroup STM32F4xx_HAL_Driver
   * @{
@@ -120,57 +124,120 @@ void HAL_TIM_Base_MspInit(TIM_HandleTypeDef* htim_base)
 
   /* USER CODE END TIM4_MspInit 1 */
   }
+  else if(htim_base->Instance==TIM2)
+  {
+    /* Peripheral clock enable: disparo de las conversiones del ADC1 */
+    __HAL_RCC_TIM2_CLK_ENABLE();
+  }
 
 }
 /**
   * @}
   */
-void HAL_TIM_MspPostInit(TIM_HandleTypeDef* htim)
+void HAL_RTC_MspInit(RTC_HandleTypeDef* hrtc)
 {
-  GPIO_InitTypeDef GPIO_InitStruct = {0};
-  if(htim->Instance==TIM1)
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_PeriphCLKInitTypeDef PeriphClkInitStruct = {0};
+
+  if(hrtc->Instance==RTC)
   {
-  /* USER CODE BEGIN TIM1_MspPostInit 0 */
+    /* LSI como reloj del RTC (ya encendido por el IWDG) */
+    RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_LSI;
+    RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+    RCC_OscInitStruct.LSIState = RCC_LSI_ON;
+    HAL_RCC_OscConfig(&RCC_OscInitStruct);
 
-  /* USER CODE END TIM1_MspPostInit 0 */
-    __HAL_RCC_GPIOE_CLK_ENABLE();
-    /**TIM1 GPIO Configuration
-    PE11     ------> TIM1_CH2
-    PE13     ------> TIM1_CH3
-    */
-    GPIO_InitStruct.Pin = GPIO_PIN_11|GPIO_PIN_13;
-    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
-    GPIO_InitStruct.Pull = GPIO_NOPULL;
-    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-    GPIO_InitStruct.Alternate = GPIO_AF1_TIM1;
-    HAL_GPIO_Init(GPIOE, &GPIO_InitStruct);
+    PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_RTC;
+    PeriphClkInitStruct.RTCClockSelection = RCC_RTCCLKSOURCE_LSI;
+    HAL_RCCEx_PeriphCLKConfig(&PeriphClkInitStruct);
+
+    /* Peripheral clock enable */
+    __HAL_RCC_RTC_ENABLE();
+  }
+}
+/**
+  * @}
+  */
+void HAL_ADC_MspInit(ADC_HandleTypeDef* hadc)
+{
+  if(hadc->Instance==ADC1)
+  {
+    /* Peripheral clock enable */
+    __HAL_RCC_ADC1_CLK_ENABLE();
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    /* ADC1 DMA Init: DMA2 Stream0 canal 0 en modo circular */
+    hdma_adc1.Instance = DMA2_Stream0;
+    hdma_adc1.Init.Channel = DMA_CHANNEL_0;
+    hdma_adc1.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_adc1.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_adc1.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_adc1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_adc1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_adc1.Init.Mode = DMA_CIRCULAR;
+    hdma_adc1.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_adc1.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&hdma_adc1);
 
-  /* USER CODE BEGIN TIM1_MspPostInit 1 */
+    __HAL_LINKDMA(hadc,DMA_Handle,hdma_adc1);
 
-  /* USER CODE END TIM1_MspPostInit 1 */
+    /* DMA interrupt init: solo mitad y final de buffer (prioridad en Prioridades.h) */
+    HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
   }
-  else if(htim->Instance==TIM4)
+}
+#if AUTOTEST_ENABLE
+/**
+  * @}
+  */
+void HAL_TIM_IC_MspInit(TIM_HandleTypeDef* htim_ic)
+{
+  if(htim_ic->Instance==TIM3)
   {
-  /* USER CODE BEGIN TIM4_MspPostInit 0 */
+    /* Peripheral clock enable: captura del autotest de la PWM */
+    __HAL_RCC_TIM3_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
 
-  /* USER CODE END TIM4_MspPostInit 0 */
+    /* TIM3_CH1 DMA Init: DMA1 Stream4 canal 5 en modo circular. Sin interrupcion:
+       el buffer se lee desde el hilo de salida */
+    hdma_tim3_ch1.Instance = DMA1_Stream4;
+    hdma_tim3_ch1.Init.Channel = DMA_CHANNEL_5;
+    hdma_tim3_ch1.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_tim3_ch1.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_tim3_ch1.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_tim3_ch1.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hdma_tim3_ch1.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdma_tim3_ch1.Init.Mode = DMA_CIRCULAR;
+    hdma_tim3_ch1.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_tim3_ch1.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&hdma_tim3_ch1);
 
-    __HAL_RCC_GPIOD_CLK_ENABLE();
-    /**TIM4 GPIO Configuration
+    __HAL_LINKDMA(htim_ic,hdma[TIM_DMA_ID_CC1],hdma_tim3_ch1);
+  }
+}
+#endif
+/**
+  * @}
+  */
+void HAL_TIM_MspPostInit(TIM_HandleTypeDef* htim)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  /**GPIO Configuration de los canales PWM del Timer segun la tabla de la placa
+    PE11     ------> TIM1_CH2
+    PE13     ------> TIM1_CH3
     PD15     ------> TIM4_CH4
-    */
-    GPIO_InitStruct.Pin = GPIO_PIN_15;
+  */
+  for (int c = 0; c < NUM_LEDS; c++)
+  {
+    if (rgb_leds[c].htim != htim)
+      continue;
+    PLACA_GPIO_CLK_ENABLE(rgb_leds[c].Port);
+    GPIO_InitStruct.Pin = rgb_leds[c].Pin;
     GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
     GPIO_InitStruct.Pull = GPIO_NOPULL;
     GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-    GPIO_InitStruct.Alternate = GPIO_AF2_TIM4;
-    HAL_GPIO_Init(GPIOD, &GPIO_InitStruct);
-
-  /* USER CODE BEGIN TIM4_MspPostInit 1 */
-
-  /* USER CODE END TIM4_MspPostInit 1 */
+    GPIO_InitStruct.Alternate = rgb_leds[c].AF;
+    HAL_GPIO_Init(rgb_leds[c].Port, &GPIO_InitStruct);
   }
-
 }
 /**
   * @}
@@ -42,6 +42,11 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "stm32f4xx_it.h"
+#include "Latencia.h"
+#include "joystick.h"
+#include "Potenciometros.h"
+#include "Reposo.h"
+#include "Perfil.h"
 
 #ifdef _RTE_
 #include "RTE_Components.h"             /* Component selection */
@@ -187,13 +192,50 @@ void SysTick_Handler(void)
 {
 }*/
 
+/**
+  * @brief This function handles EXTI line0 interrupt.
+  */
+void EXTI0_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI0_IRQn 0 */
+  PERFIL_IRQ_ENTRADA();
+  LATENCIA_ISR();
+  /* USER CODE END EXTI0_IRQn 0 */
+  EXTI_Despachar(GPIO_PIN_0);
+  /* USER CODE BEGIN EXTI0_IRQn 1 */
+  PERFIL_IRQ_SALIDA(PERFIL_IRQ_EXTI);
+
+  /* USER CODE END EXTI0_IRQn 1 */
+}
+
+/**
+  * @brief This function handles EXTI line1 interrupt.
+  */
+void EXTI1_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI1_IRQn 0 */
+  PERFIL_IRQ_ENTRADA();
+  LATENCIA_ISR();
+  /* USER CODE END EXTI1_IRQn 0 */
+  EXTI_Despachar(GPIO_PIN_1);
+  /* USER CODE BEGIN EXTI1_IRQn 1 */
+  PERFIL_IRQ_SALIDA(PERFIL_IRQ_EXTI);
+
+  /* USER CODE END EXTI1_IRQn 1 */
+}
+
+/**
+  * @brief This function handles EXTI line2 interrupt.
+  */
 void EXTI2_IRQHandler(void)
 {
   /* USER CODE BEGIN EXTI2_IRQn 0 */
-
+  PERFIL_IRQ_ENTRADA();
+  LATENCIA_ISR();
   /* USER CODE END EXTI2_IRQn 0 */
-  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_2);
+  EXTI_Despachar(GPIO_PIN_2);
   /* USER CODE BEGIN EXTI2_IRQn 1 */
+  PERFIL_IRQ_SALIDA(PERFIL_IRQ_EXTI);
 
   /* USER CODE END EXTI2_IRQn 1 */
 }
@@ -204,24 +246,44 @@ void EXTI2_IRQHandler(void)
 void EXTI3_IRQHandler(void)
 {
   /* USER CODE BEGIN EXTI3_IRQn 0 */
-
+  PERFIL_IRQ_ENTRADA();
+  LATENCIA_ISR();
   /* USER CODE END EXTI3_IRQn 0 */
-  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_3);
+  EXTI_Despachar(GPIO_PIN_3);
   /* USER CODE BEGIN EXTI3_IRQn 1 */
+  PERFIL_IRQ_SALIDA(PERFIL_IRQ_EXTI);
 
   /* USER CODE END EXTI3_IRQn 1 */
 }
 
+/**
+  * @brief This function handles EXTI line4 interrupt.
+  */
+void EXTI4_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI4_IRQn 0 */
+  PERFIL_IRQ_ENTRADA();
+  LATENCIA_ISR();
+  /* USER CODE END EXTI4_IRQn 0 */
+  EXTI_Despachar(GPIO_PIN_4);
+  /* USER CODE BEGIN EXTI4_IRQn 1 */
+  PERFIL_IRQ_SALIDA(PERFIL_IRQ_EXTI);
+
+  /* USER CODE END EXTI4_IRQn 1 */
+}
+
 /**
   * @brief This function handles EXTI line[9:5] interrupts.
   */
 void EXTI9_5_IRQHandler(void)
 {
   /* USER CODE BEGIN EXTI9_5_IRQn 0 */
-
+  PERFIL_IRQ_ENTRADA();
+  LATENCIA_ISR();
   /* USER CODE END EXTI9_5_IRQn 0 */
-  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_5);
+  EXTI_Despachar(EXTI_LINEAS_9_5);
   /* USER CODE BEGIN EXTI9_5_IRQn 1 */
+  PERFIL_IRQ_SALIDA(PERFIL_IRQ_EXTI);
 
   /* USER CODE END EXTI9_5_IRQn 1 */
 }
@@ -232,14 +294,50 @@ void EXTI9_5_IRQHandler(void)
 void EXTI15_10_IRQHandler(void)
 {
   /* USER CODE BEGIN EXTI15_10_IRQn 0 */
-
+  PERFIL_IRQ_ENTRADA();
+  LATENCIA_ISR();
   /* USER CODE END EXTI15_10_IRQn 0 */
-  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_10);
-  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_14);
+  EXTI_Despachar(EXTI_LINEAS_15_10);
   /* USER CODE BEGIN EXTI15_10_IRQn 1 */
+  PERFIL_IRQ_SALIDA(PERFIL_IRQ_EXTI);
 
   /* USER CODE END EXTI15_10_IRQn 1 */
 }
+
+/**
+  * @brief This function handles DMA2 stream0 global interrupt (ADC1 de los potenciometros).
+  */
+void DMA2_Stream0_IRQHandler(void)
+{
+  PERFIL_IRQ_ENTRADA();
+  HAL_DMA_IRQHandler(&hdma_adc1);
+  PERFIL_IRQ_SALIDA(PERFIL_IRQ_ADC);
+}
+
+#if REPOSO_ENABLE
+/**
+  * @brief This function handles RTC wake-up interrupt through EXTI line 22 (fin del reposo).
+  */
+void RTC_WKUP_IRQHandler(void)
+{
+  PERFIL_IRQ_ENTRADA();
+  HAL_RTCEx_WakeUpTimerIRQHandler(&hrtc);
+  PERFIL_IRQ_SALIDA(PERFIL_IRQ_RTC);
+}
+#endif
+
+/**
+  * @brief This function handles USART3 global interrupt. El manejador esta en el CMSIS
+  *        Driver de la USART, por lo que se instrumenta sustituyendolo en el enlazado
+  *        ($Sub$$/$Super$$ de armlink).
+  */
+extern void $Super$$USART3_IRQHandler(void);
+void $Sub$$USART3_IRQHandler(void)
+{
+  PERFIL_IRQ_ENTRADA();
+  $Super$$USART3_IRQHandler();
+  PERFIL_IRQ_SALIDA(PERFIL_IRQ_USART);
+}
 /**
   * @}
   */ 